@@ -0,0 +1,197 @@
+/*! \file   ServerMain.cpp
+ *  \brief  main function of the dedicated server. It runs the game without
+ *          creating any window, GUI, input or sound.
+ *
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ODApplication.h"
+
+#include "network/ODServer.h"
+#include "utils/ConfigManager.h"
+#include "utils/Helper.h"
+#include "utils/LogManager.h"
+#include "utils/Random.h"
+#include "utils/ResourceManager.h"
+
+#include <OgreException.h>
+#include <OgreRoot.h>
+
+#include <SFML/System.hpp>
+
+#include <ctime>
+#include <iostream>
+#include <string>
+
+//! \brief Turns per second used by the benchmark mode. The server still waits for the network
+//! at least 1 ms per turn so it is an upper bound
+static const double BENCHMARK_TURNS_PER_SECOND = 1000.0;
+
+static void printUsage(const char* binaryName)
+{
+    std::cout << "Usage: " << binaryName << " --level <level file> [options]\n"
+        << "Options:\n"
+        << "  --players <n>     Number of human players to wait for before starting the game (default 0).\n"
+        << "                    The seats left are played by the AI.\n"
+        << "  --tickrate <tps>  Number of turns per second.\n"
+        << "  --turns <n>       Stops the server after n turns and logs the turn throughput.\n"
+        << "  --benchmark       Computes the turns as fast as possible (1000 turns by default).\n"
+        << "  --compress        Compresses the messages sent to the clients and logs the compression ratio.\n"
+        << "  --seed <n>        Seeds the random generator with n (default is the current time). 2 games\n"
+        << "                    started with the same seed and the same commands give the same result.\n"
+        << "  --hash-period <n> Logs a hash of the game state every n turns and sends the clients a hash\n"
+        << "                    of the tiles they see to detect desyncs (default 10, 0 to disable).\n"
+        << std::endl;
+}
+
+//! \brief Reads an unsigned 32 bits number. Returns false if text contains anything else than digits
+//! or if the number does not fit in 32 bits
+static bool parseUInt32(const std::string& text, uint32_t& value)
+{
+    if(text.empty() || (text.find_first_not_of("0123456789") != std::string::npos))
+        return false;
+
+    value = Helper::toUInt32(text);
+    // If the number is too big, toUInt32 does not give it back
+    std::string::size_type firstDigit = text.find_first_not_of('0');
+    std::string digits = (firstDigit == std::string::npos) ? "0" : text.substr(firstDigit);
+    return std::to_string(value) == digits;
+}
+
+int main(int argc, char** argv)
+{
+    std::string levelFilename;
+    int32_t nbHumanPlayers = 0;
+    int64_t nbTurns = 0;
+    double turnsPerSecond = 0.0;
+    bool isBenchmark = false;
+    bool isCompressed = false;
+    bool hasSeed = false;
+    uint32_t seed = 0;
+    int64_t stateHashPeriod = ODServer::DEFAULT_STATE_HASH_PERIOD;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if((arg == "--level") && hasValue)
+            levelFilename = argv[++i];
+        else if((arg == "--players") && hasValue)
+            nbHumanPlayers = Helper::toInt(argv[++i]);
+        else if((arg == "--tickrate") && hasValue)
+            turnsPerSecond = Helper::toDouble(argv[++i]);
+        else if((arg == "--turns") && hasValue)
+            nbTurns = Helper::toInt(argv[++i]);
+        else if(arg == "--benchmark")
+            isBenchmark = true;
+        else if(arg == "--compress")
+            isCompressed = true;
+        else if((arg == "--seed") && hasValue)
+        {
+            hasSeed = true;
+            if(!parseUInt32(argv[++i], seed))
+            {
+                std::cout << "Invalid seed: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if((arg == "--hash-period") && hasValue)
+        {
+            uint32_t period = 0;
+            if(!parseUInt32(argv[++i], period))
+            {
+                std::cout << "Invalid hash period: " << argv[i] << std::endl;
+                return 1;
+            }
+            stateHashPeriod = period;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(levelFilename.empty() || (nbHumanPlayers < 0) || (nbTurns < 0) || (turnsPerSecond < 0.0) || (stateHashPeriod < 0))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if(isBenchmark)
+    {
+        // Clients could not follow the pace
+        nbHumanPlayers = 0;
+        turnsPerSecond = BENCHMARK_TURNS_PER_SECOND;
+        if(nbTurns == 0)
+            nbTurns = 1000;
+    }
+
+    if(turnsPerSecond > 0.0)
+        ODApplication::turnsPerSecond = turnsPerSecond;
+
+    int ret = 0;
+    try
+    {
+        if(!hasSeed)
+            seed = static_cast<uint32_t>(std::time(0));
+
+        Random::initialize(seed);
+
+        ResourceManager* resMgr = new ResourceManager;
+
+        // No plugin is loaded: the server does not need any render system
+        Ogre::Root* root = new Ogre::Root("", "", resMgr->getLogFile());
+
+        LogManager* logManager = new LogManager();
+        logManager->setLogDetail(Ogre::LL_BOREME);
+        new ConfigManager;
+
+        ODServer* server = new ODServer();
+        server->setAutomaticSeatConfiguration(nbHumanPlayers);
+        server->setTurnLimit(nbTurns);
+        server->setStreamCompression(isCompressed);
+        server->setStateHashPeriod(stateHashPeriod);
+        logManager->logMessage("Random seed=" + Helper::toString(seed));
+        if(server->startServer(levelFilename, ODServer::ServerMode::ModeGameMultiPlayer))
+        {
+            logManager->logMessage("Dedicated server started with level " + levelFilename
+                + ", waiting for " + Helper::toString(nbHumanPlayers) + " players");
+
+            while(server->isConnected() && !server->isTurnLimitReached())
+                sf::sleep(sf::milliseconds(100));
+
+            server->stopServer();
+        }
+        else
+        {
+            std::cerr << "Could not start the server with level " << levelFilename << std::endl;
+            ret = 1;
+        }
+
+        delete server;
+        delete ConfigManager::getSingletonPtr();
+        delete resMgr;
+        delete logManager;
+        delete root;
+    }
+    catch (Ogre::Exception& e)
+    {
+        std::cerr << "An exception has occurred: " << e.what() << std::endl;
+        ret = 1;
+    }
+
+    return ret;
+}
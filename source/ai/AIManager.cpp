@@ -18,8 +18,15 @@
 #include "ai/AIManager.h"
 #include "ai/KeeperAI.h"
 
+#include "gamemap/GameMap.h"
+
 #include "utils/LogManager.h"
 
+#include <algorithm>
+
+//! \brief Time the AIs can spend on their searches during one turn, shared between them
+const int64_t turnBudgetMicroseconds = 5000;
+
 AIManager::AIManager(GameMap& gameMap)
     : mGameMap(gameMap)
 {
@@ -48,10 +55,26 @@ bool AIManager::assignAI(Player& player, const std::string& type, const std::str
 
 bool AIManager::doTurn(double frameTime)
 {
+    if(mAiList.empty())
+        return true;
+
+    const TurnProfiler& profiler = mGameMap.getTurnProfiler();
+    int64_t turnEnd = profiler.getTimeMicroseconds() + turnBudgetMicroseconds;
+    int64_t nbAisLeft = mAiList.size();
     for(BaseAI* ai : mAiList)
     {
+        // Each AI gets an equal share of the time left. If an AI spends more than its share, the
+        // next ones get less time and will resume their searches during the next turns
+        int64_t now = profiler.getTimeMicroseconds();
+        int64_t timeLeft = std::max(turnEnd - now, static_cast<int64_t>(0));
+        ai->setTurnDeadline(now + timeLeft / nbAisLeft);
         ai->doTurn(frameTime);
+        --nbAisLeft;
     }
+
+    // The AI that played first will play last during the next turn so that the same AIs do not
+    // always get the time left by the others
+    mAiList.splice(mAiList.end(), mAiList, mAiList.begin());
     return true;
 }
 
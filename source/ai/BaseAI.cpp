@@ -25,12 +25,15 @@
 
 #include "network/ODServer.h"
 
+#include <limits>
+
 const int32_t pointsPerWallSpot = 50;
 const int32_t handicapPerTileOffset = 20;
 
 BaseAI::BaseAI(GameMap& gameMap, Player& player, const std::string& parameters):
     mGameMap(gameMap),
-    mPlayer(player)
+    mPlayer(player),
+    mTurnDeadline(std::numeric_limits<int64_t>::max())
 {
     initialize(parameters);
 }
@@ -40,9 +43,14 @@ bool BaseAI::initialize(const std::string& parameters)
     return true;
 }
 
+bool BaseAI::isTurnBudgetExhausted() const
+{
+    return mGameMap.getTurnProfiler().getTimeMicroseconds() >= mTurnDeadline;
+}
+
 Room* BaseAI::getDungeonTemple()
 {
-    std::vector<Room*> dt = mGameMap.getRoomsByTypeAndSeat(Room::dungeonTemple, mPlayer.getSeat());
+    const std::vector<Room*>& dt = mGameMap.getRoomsByTypeAndSeat(Room::dungeonTemple, mPlayer.getSeat());
     if(!dt.empty())
         return dt.front();
     else
@@ -112,7 +120,7 @@ bool BaseAI::shouldWallTileBeConsideredForBestPlaceForRoom(Tile* tile, Seat* mPl
 }
 
 //! To find the position, we try every square of the wantedSize width around the given tile for each possible distance
-bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedSize, bool useWalls,
+BaseAI::SearchStatus BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedSize, bool useWalls,
     int32_t& bestX, int32_t& bestY)
 {
     // We use a point system to find the best position. Once we find a valid position, we will set a handicap
@@ -131,13 +139,19 @@ bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedS
             maxPointsPossible += nbCentralActiveSpots * 4 * pointsPerWallSpot;
     }
 
-    bool isFound = false;
-    int32_t handicap = 0;
-    int32_t bestPoints = 0;
-    int32_t bestDistance = 0;
-    int32_t maxOffset = std::max(mGameMap.getMapSizeX(), mGameMap.getMapSizeY());
+    // If the search was not started in a previous turn or if the parameters changed, we start a new one
+    RoomPlaceSearch& search = mRoomPlaceSearch;
+    if((search.mTile != tile) || (search.mWantedSize != wantedSize) || (search.mUseWalls != useWalls))
+    {
+        search = RoomPlaceSearch();
+        search.mTile = tile;
+        search.mWantedSize = wantedSize;
+        search.mUseWalls = useWalls;
+        search.mOffset = 1;
+    }
 
-    for(int32_t offset = 1; offset < maxOffset; ++offset)
+    int32_t maxOffset = std::max(mGameMap.getMapSizeX(), mGameMap.getMapSizeY());
+    for(int32_t& offset = search.mOffset; offset < maxOffset; ++offset)
     {
         int32_t points = 0;
         int32_t nbTiles = offset * 2 + wantedSize - 1;
@@ -149,19 +163,19 @@ bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedS
             if((t != nullptr) &&
                computePointsForRoom(t, mPlayerSeat, wantedSize, true, useWalls, points))
             {
-                points -= handicap;
+                points -= search.mHandicap;
                 int32_t centerX = t->getX() + (wantedSize / 2);
                 int32_t centerY = t->getY() + (wantedSize / 2);
                 int32_t distance = (tile->getX() - centerX) * (tile->getX() - centerX);
                 distance += (tile->getY() - centerY) * (tile->getY() - centerY);
-                if((points > bestPoints) ||
-                   (points == bestPoints && distance < bestDistance))
+                if((points > search.mBestPoints) ||
+                   (points == search.mBestPoints && distance < search.mBestDistance))
                 {
-                    bestDistance = distance;
-                    bestX = t->getX();
-                    bestY = t->getY();
-                    bestPoints = points;
-                    isFound = true;
+                    search.mBestDistance = distance;
+                    search.mBestX = t->getX();
+                    search.mBestY = t->getY();
+                    search.mBestPoints = points;
+                    search.mIsFound = true;
                 }
             }
             // East
@@ -169,19 +183,19 @@ bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedS
             if((t != nullptr) &&
                computePointsForRoom(t, mPlayerSeat, wantedSize, true, useWalls, points))
             {
-                points -= handicap;
+                points -= search.mHandicap;
                 int32_t centerX = t->getX() + (wantedSize / 2);
                 int32_t centerY = t->getY() + (wantedSize / 2);
                 int32_t distance = (tile->getX() - centerX) * (tile->getX() - centerX);
                 distance += (tile->getY() - centerY) * (tile->getY() - centerY);
-                if((points > bestPoints) ||
-                   (points == bestPoints && distance < bestDistance))
+                if((points > search.mBestPoints) ||
+                   (points == search.mBestPoints && distance < search.mBestDistance))
                 {
-                    bestDistance = distance;
-                    bestX = t->getX();
-                    bestY = t->getY();
-                    bestPoints = points;
-                    isFound = true;
+                    search.mBestDistance = distance;
+                    search.mBestX = t->getX();
+                    search.mBestY = t->getY();
+                    search.mBestPoints = points;
+                    search.mIsFound = true;
                 }
             }
             // South
@@ -189,19 +203,19 @@ bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedS
             if((t != nullptr) &&
                computePointsForRoom(t, mPlayerSeat, wantedSize, false, useWalls, points))
             {
-                points -= handicap;
+                points -= search.mHandicap;
                 int32_t centerX = t->getX() - (wantedSize / 2);
                 int32_t centerY = t->getY() - (wantedSize / 2);
                 int32_t distance = (tile->getX() - centerX) * (tile->getX() - centerX);
                 distance += (tile->getY() - centerY) * (tile->getY() - centerY);
-                if((points > bestPoints) ||
-                   (points == bestPoints && distance < bestDistance))
+                if((points > search.mBestPoints) ||
+                   (points == search.mBestPoints && distance < search.mBestDistance))
                 {
-                    bestDistance = distance;
-                    bestX = t->getX() - wantedSize + 1;
-                    bestY = t->getY() - wantedSize + 1;
-                    bestPoints = points;
-                    isFound = true;
+                    search.mBestDistance = distance;
+                    search.mBestX = t->getX() - wantedSize + 1;
+                    search.mBestY = t->getY() - wantedSize + 1;
+                    search.mBestPoints = points;
+                    search.mIsFound = true;
                 }
             }
             // West
@@ -209,32 +223,62 @@ bool BaseAI::findBestPlaceForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedS
             if((t != nullptr) &&
                computePointsForRoom(t, mPlayerSeat, wantedSize, false, useWalls, points))
             {
-                points -= handicap;
+                points -= search.mHandicap;
                 int32_t centerX = t->getX() - (wantedSize / 2);
                 int32_t centerY = t->getY() - (wantedSize / 2);
                 int32_t distance = (tile->getX() - centerX) * (tile->getX() - centerX);
                 distance += (tile->getY() - centerY) * (tile->getY() - centerY);
-                if((points > bestPoints) ||
-                   (points == bestPoints && distance < bestDistance))
+                if((points > search.mBestPoints) ||
+                   (points == search.mBestPoints && distance < search.mBestDistance))
                 {
-                    bestDistance = distance;
-                    bestX = t->getX() - wantedSize + 1;
-                    bestY = t->getY() - wantedSize + 1;
-                    bestPoints = points;
-                    isFound = true;
+                    search.mBestDistance = distance;
+                    search.mBestX = t->getX() - wantedSize + 1;
+                    search.mBestY = t->getY() - wantedSize + 1;
+                    search.mBestPoints = points;
+                    search.mIsFound = true;
                 }
             }
         }
 
-        if(isFound)
+        if(search.mIsFound)
         {
-            handicap += handicapPerTileOffset;
+            search.mHandicap += handicapPerTileOffset;
             // If we already found the best place, stop searching
-            if(handicap > (maxPointsPossible - bestPoints))
+            if(search.mHandicap > (maxPointsPossible - search.mBestPoints))
                 break;
         }
+
+        // At least one ring is scanned at each call so that the search always ends
+        if((offset + 1 < maxOffset) && isTurnBudgetExhausted())
+        {
+            ++offset;
+            search.mIsResumed = true;
+            return SearchStatus::inProgress;
+        }
+    }
+
+    // If the search was interrupted, the map may have changed since the best place was scored (another
+    // seat may have claimed or built on it). In this case, we search again from the start
+    if(search.mIsFound && search.mIsResumed)
+    {
+        Tile* bestTile = mGameMap.getTile(search.mBestX, search.mBestY);
+        int32_t points;
+        if((bestTile == nullptr) ||
+           !computePointsForRoom(bestTile, mPlayerSeat, wantedSize, true, useWalls, points))
+        {
+            search = RoomPlaceSearch();
+            return findBestPlaceForRoom(tile, mPlayerSeat, wantedSize, useWalls, bestX, bestY);
+        }
+    }
+
+    bool isFound = search.mIsFound;
+    if(isFound)
+    {
+        bestX = search.mBestX;
+        bestY = search.mBestY;
     }
-    return isFound;
+    search = RoomPlaceSearch();
+    return isFound ? SearchStatus::found : SearchStatus::notFound;
 }
 
 bool BaseAI::computePointsForRoom(Tile* tile, Seat* mPlayerSeat, int32_t wantedSize,
@@ -28,9 +28,53 @@ class Room;
 class Tile;
 class Seat;
 
+/*! \brief Cursor of a search for a room place started in a previous turn. The rings around mTile are
+ * scanned from mOffset and the best place found so far is kept.
+ */
+class RoomPlaceSearch
+{
+public:
+    RoomPlaceSearch() :
+        mTile(nullptr),
+        mWantedSize(0),
+        mUseWalls(false),
+        mOffset(0),
+        mHandicap(0),
+        mBestPoints(0),
+        mBestDistance(0),
+        mBestX(0),
+        mBestY(0),
+        mIsFound(false),
+        mIsResumed(false)
+    {}
+
+    //! \brief nullptr if there is no search in progress
+    Tile* mTile;
+    int32_t mWantedSize;
+    bool mUseWalls;
+    //! \brief Next ring to scan
+    int32_t mOffset;
+    int32_t mHandicap;
+    int32_t mBestPoints;
+    int32_t mBestDistance;
+    int32_t mBestX;
+    int32_t mBestY;
+    bool mIsFound;
+    //! \brief True if the search has been interrupted at least once. The best place may then have been
+    //! scored during a previous turn
+    bool mIsResumed;
+};
+
 class BaseAI
 {
 public:
+    enum class SearchStatus
+    {
+        inProgress,
+        found,
+        notFound
+    };
+
     BaseAI(GameMap& gameMap, Player& player, const std::string& parameters = std::string());
     virtual ~BaseAI()
     {}
@@ -43,18 +87,30 @@ public:
      */
     virtual bool doTurn(double frameTime) = 0;
 
+    //! \brief Called by the AIManager before doTurn. deadline is the time given by the turn profiler
+    //! after which the long searches should stop and be resumed during the next turn.
+    inline void setTurnDeadline(int64_t deadline)
+    { mTurnDeadline = deadline; }
+
 protected:
     virtual bool initialize(const std::string& parameters);
     Room* getDungeonTemple();
     bool buildRoom(Room* room, const std::vector<Tile*>& tiles);
 
+    //! \brief Returns true if the time given to the AI for the current turn is spent
+    bool isTurnBudgetExhausted() const;
+
     //! \brief Searches for the best place where to place a room around the given tile. It will take
-    //! into account any constructible tile (even if not digged yet). On success, it returns true and bestX
-    //! and bestY will be set accordingly. It will return false if no constructible square of wantedSize
-    //! is found
-    bool findBestPlaceForRoom(Tile* tile, Seat* playerSeat, int32_t wantedSize, bool useWalls,
+    //! into account any constructible tile (even if not digged yet). On success, it returns found and bestX
+    //! and bestY will be set accordingly. It will return notFound if no constructible square of wantedSize
+    //! is found. If the turn budget is exhausted before the search ends, it returns inProgress and the
+    //! search will be resumed where it stopped when called again with the same parameters.
+    SearchStatus findBestPlaceForRoom(Tile* tile, Seat* playerSeat, int32_t wantedSize, bool useWalls,
         int32_t& bestX, int32_t& bestY);
 
+    inline bool isRoomPlaceSearchInProgress() const
+    { return mRoomPlaceSearch.mTile != nullptr; }
+
     bool digWayToTile(Tile* tileStart, Tile* tileEnd);
     bool computePointsForRoom(Tile* tile, Seat* playerSeat, int32_t wantedSize,
         bool bottomLeft2TopRight, bool useWalls, int32_t& points);
@@ -63,6 +119,11 @@ protected:
     Player& mPlayer;
 
 private:
+    //! \brief Time after which the AI should stop its long searches for this turn
+    int64_t mTurnDeadline;
+
+    RoomPlaceSearch mRoomPlaceSearch;
+
     bool shouldGroundTileBeConsideredForBestPlaceForRoom(Tile* tile, Seat* playerSeat);
     bool shouldWallTileBeConsideredForBestPlaceForRoom(Tile* tile, Seat* playerSeat);
 };
@@ -20,6 +20,7 @@
 #include "entities/Creature.h"
 #include "gamemap/GameMap.h"
 #include "entities/Tile.h"
+#include "game/Seat.h"
 #include "rooms/RoomCrypt.h"
 #include "rooms/RoomDormitory.h"
 #include "rooms/RoomForge.h"
@@ -41,8 +42,11 @@ KeeperAI::KeeperAI(GameMap& gameMap, Player& player, const std::string& paramete
     mRoomSize(-1),
     mNoMoreReachableGold(false),
     mCooldownLookingForGold(0),
+    mGoldSearchDistance(0),
     mCooldownDefense(0)
 {
+    if(mPlayer.getSeat() != nullptr)
+        mRandom.seed(Random::getStreamSeed(Random::StreamType::ai, mPlayer.getSeat()->getId()));
 }
 
 bool KeeperAI::doTurn(double frameTime)
@@ -129,7 +133,7 @@ bool KeeperAI::checkTreasury()
 
                     Room* room = new RoomTreasury(&mGameMap);
                     buildRoom(room, tiles);
-                    mCooldownCheckTreasury = Random::Int(10,30);
+                    mCooldownCheckTreasury = mRandom.Int(10,30);
                     return true;
                 }
             }
@@ -246,51 +250,55 @@ bool KeeperAI::checkTreasury()
 
     Room* room = new RoomTreasury(&mGameMap);
     buildRoom(room, tiles);
-    mCooldownCheckTreasury = Random::Int(10,30);
+    mCooldownCheckTreasury = mRandom.Int(10,30);
     return true;
 }
 
 bool KeeperAI::handleRooms()
 {
-    if(mCooldownLookingForRooms > 0)
+    // A search for a new room place started during a previous turn is resumed without waiting for the cooldown
+    if(!isRoomPlaceSearchInProgress())
     {
-        --mCooldownLookingForRooms;
-        return false;
-    }
-
-    mCooldownLookingForRooms = Random::Int(30,60);
-
-    // We check if the last built room is done
-    if(mRoomSize != -1)
-    {
-        Tile* tile = mGameMap.getTile(mRoomPosX, mRoomPosY);
-        OD_ASSERT_TRUE(tile != nullptr);
-        if(tile == nullptr)
+        if(mCooldownLookingForRooms > 0)
         {
-            mRoomSize = -1;
-            return false;
-        }
-        int32_t points;
-        if(!computePointsForRoom(tile, mPlayer.getSeat(), mRoomSize, true, false, points))
-        {
-            // The room is not valid anymore (may be claimed or built by somebody else). We redo
-            mRoomSize = -1;
+            --mCooldownLookingForRooms;
             return false;
         }
 
-        if(buildMostNeededRoom())
+        mCooldownLookingForRooms = mRandom.Int(30,60);
+
+        // We check if the last built room is done
+        if(mRoomSize != -1)
         {
-            mRoomSize = -1;
-            return true;
-        }
+            Tile* tile = mGameMap.getTile(mRoomPosX, mRoomPosY);
+            OD_ASSERT_TRUE(tile != nullptr);
+            if(tile == nullptr)
+            {
+                mRoomSize = -1;
+                return false;
+            }
+            int32_t points;
+            if(!computePointsForRoom(tile, mPlayer.getSeat(), mRoomSize, true, false, points))
+            {
+                // The room is not valid anymore (may be claimed or built by somebody else). We redo
+                mRoomSize = -1;
+                return false;
+            }
 
-        return false;
+            if(buildMostNeededRoom())
+            {
+                mRoomSize = -1;
+                return true;
+            }
+
+            return false;
+        }
     }
 
     Tile* central = getDungeonTemple()->getCentralTile();
     int32_t bestX = 0;
     int32_t bestY = 0;
-    if(!findBestPlaceForRoom(central, mPlayer.getSeat(), 5, true, bestX, bestY))
+    if(findBestPlaceForRoom(central, mPlayer.getSeat(), 5, true, bestX, bestY) != SearchStatus::found)
         return false;
 
     mRoomSize = 5;
@@ -323,17 +331,21 @@ bool KeeperAI::lookForGold()
     if (mNoMoreReachableGold)
         return false;
 
-    if(mCooldownLookingForGold > 0)
+    // A search started during a previous turn is resumed without waiting for the cooldown
+    if(mGoldSearchDistance == 0)
     {
-        --mCooldownLookingForGold;
-        return false;
-    }
+        if(mCooldownLookingForGold > 0)
+        {
+            --mCooldownLookingForGold;
+            return false;
+        }
 
-    mCooldownLookingForGold = Random::Int(70,120);
+        mCooldownLookingForGold = mRandom.Int(70,120);
+    }
 
     // Do we need gold ?
     int emptyStorage = 0;
-    std::vector<Room*> treasuriesOwned = mGameMap.getRoomsByTypeAndSeat(Room::treasury,
+    const std::vector<Room*>& treasuriesOwned = mGameMap.getRoomsByTypeAndSeat(Room::treasury,
         mPlayer.getSeat());
     for(Room* room : treasuriesOwned)
     {
@@ -343,15 +355,21 @@ bool KeeperAI::lookForGold()
 
     // No need to search for gold
     if(emptyStorage < 100)
+    {
+        mGoldSearchDistance = 0;
         return false;
+    }
 
     Tile* central = getDungeonTemple()->getCentralTile();
     int widerSide = mGameMap.getMapSizeX() > mGameMap.getMapSizeY() ?
         mGameMap.getMapSizeX() : mGameMap.getMapSizeY();
 
     // We search for the closest gold tile
+    if(mGoldSearchDistance == 0)
+        mGoldSearchDistance = 1;
+
     Tile* firstGoldTile = nullptr;
-    for(int32_t distance = 1; distance < widerSide; ++distance)
+    for(int32_t& distance = mGoldSearchDistance; distance < widerSide; ++distance)
     {
         for(int k = 0; k <= distance; ++k)
         {
@@ -362,7 +380,7 @@ bool KeeperAI::lookForGold()
             {
                 // If we already have a tile at same distance, we randomly change to
                 // try to not be too predictable
-                if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                     firstGoldTile = t;
             }
             // North-West
@@ -371,7 +389,7 @@ bool KeeperAI::lookForGold()
                 t = mGameMap.getTile(central->getX() - k, central->getY() + distance);
                 if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
                 {
-                    if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                    if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                         firstGoldTile = t;
                 }
             }
@@ -379,7 +397,7 @@ bool KeeperAI::lookForGold()
             t = mGameMap.getTile(central->getX() + k, central->getY() - distance);
             if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
             {
-                if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                     firstGoldTile = t;
             }
             // South-West
@@ -388,7 +406,7 @@ bool KeeperAI::lookForGold()
                 t = mGameMap.getTile(central->getX() - k, central->getY() - distance);
                 if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
                 {
-                    if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                    if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                         firstGoldTile = t;
                 }
             }
@@ -396,7 +414,7 @@ bool KeeperAI::lookForGold()
             t = mGameMap.getTile(central->getX() + distance, central->getY() + k);
             if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
             {
-                if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                     firstGoldTile = t;
             }
             // East-South
@@ -405,7 +423,7 @@ bool KeeperAI::lookForGold()
                 t = mGameMap.getTile(central->getX() + distance, central->getY() - k);
                 if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
                 {
-                    if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                    if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                         firstGoldTile = t;
                 }
             }
@@ -413,7 +431,7 @@ bool KeeperAI::lookForGold()
             t = mGameMap.getTile(central->getX() - distance, central->getY() + k);
             if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
             {
-                if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                     firstGoldTile = t;
             }
             // West-South
@@ -422,7 +440,7 @@ bool KeeperAI::lookForGold()
                 t = mGameMap.getTile(central->getX() - distance, central->getY() - k);
                 if(t != nullptr && t->getType() == Tile::gold && t->getFullness() > 0.0)
                 {
-                    if((firstGoldTile == nullptr) || (Random::Uint(1,2) == 1))
+                    if((firstGoldTile == nullptr) || (mRandom.Uint(1,2) == 1))
                         firstGoldTile = t;
                 }
             }
@@ -434,7 +452,15 @@ bool KeeperAI::lookForGold()
         // If we found a tile, no need to continue
         if(firstGoldTile != nullptr)
             break;
+
+        // At least one ring is scanned at each call so that the search always ends
+        if((distance + 1 < widerSide) && isTurnBudgetExhausted())
+        {
+            ++distance;
+            return false;
+        }
     }
+    mGoldSearchDistance = 0;
 
     // No more gold
     if (firstGoldTile == nullptr)
@@ -477,11 +503,8 @@ bool KeeperAI::lookForGold()
 
 bool KeeperAI::buildMostNeededRoom()
 {
-    std::vector<Room*> rooms;
-
     // Dormitory
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::dormitory, mPlayer.getSeat());
-    uint32_t nbDormitory = rooms.size();
+    uint32_t nbDormitory = mGameMap.numRoomsByTypeAndSeat(Room::RoomType::dormitory, mPlayer.getSeat());
     if(nbDormitory == 0)
     {
         std::vector<Tile*> tiles;
@@ -499,7 +522,7 @@ bool KeeperAI::buildMostNeededRoom()
         return true;
     }
 
-    std::vector<Room*> treasuriesOwned = mGameMap.getRoomsByTypeAndSeat(Room::treasury,
+    const std::vector<Room*>& treasuriesOwned = mGameMap.getRoomsByTypeAndSeat(Room::treasury,
         mPlayer.getSeat());
     int emptyStorage = 0;
     int totalGold = 0;
@@ -528,8 +551,7 @@ bool KeeperAI::buildMostNeededRoom()
     }
 
     // hatchery
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::hatchery, mPlayer.getSeat());
-    if(rooms.empty())
+    if(mGameMap.numRoomsByTypeAndSeat(Room::RoomType::hatchery, mPlayer.getSeat()) == 0)
     {
         std::vector<Tile*> tiles;
         int goldRequired;
@@ -547,8 +569,7 @@ bool KeeperAI::buildMostNeededRoom()
     }
 
     // trainingHall
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::trainingHall, mPlayer.getSeat());
-    if(rooms.empty())
+    if(mGameMap.numRoomsByTypeAndSeat(Room::RoomType::trainingHall, mPlayer.getSeat()) == 0)
     {
         std::vector<Tile*> tiles;
         int goldRequired;
@@ -566,8 +587,7 @@ bool KeeperAI::buildMostNeededRoom()
     }
 
     // forge
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::forge, mPlayer.getSeat());
-    if(rooms.empty())
+    if(mGameMap.numRoomsByTypeAndSeat(Room::RoomType::forge, mPlayer.getSeat()) == 0)
     {
         std::vector<Tile*> tiles;
         int goldRequired;
@@ -585,8 +605,7 @@ bool KeeperAI::buildMostNeededRoom()
     }
 
     // library
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::library, mPlayer.getSeat());
-    if(rooms.empty())
+    if(mGameMap.numRoomsByTypeAndSeat(Room::RoomType::library, mPlayer.getSeat()) == 0)
     {
         std::vector<Tile*> tiles;
         int goldRequired;
@@ -622,8 +641,7 @@ bool KeeperAI::buildMostNeededRoom()
     }
 
     // Crypt
-    rooms = mGameMap.getRoomsByTypeAndSeat(Room::RoomType::crypt, mPlayer.getSeat());
-    if(rooms.empty())
+    if(mGameMap.numRoomsByTypeAndSeat(Room::RoomType::crypt, mPlayer.getSeat()) == 0)
     {
         std::vector<Tile*> tiles;
         int goldRequired;
@@ -649,7 +667,7 @@ void KeeperAI::saveWoundedCreatures()
     OD_ASSERT_TRUE(dungeonTempleTile != nullptr);
 
     Seat* seat = mPlayer.getSeat();
-    std::vector<Creature*> creatures = mGameMap.getCreaturesBySeat(seat);
+    const std::vector<Creature*>& creatures = mGameMap.getCreaturesBySeat(seat);
     for(Creature* creature : creatures)
     {
         // We take away fleeing creatures not too near our dungeon heart
@@ -687,33 +705,39 @@ void KeeperAI::handleDefense()
     OD_ASSERT_TRUE(dungeonTempleTile != nullptr);
 
     Seat* seat = mPlayer.getSeat();
-    // We drop creatures nearby owned or allied attacked creatures
-    std::vector<Creature*> creatures = mGameMap.getCreaturesByAlliedSeat(seat);
-    for(Creature* creature : creatures)
+    // We drop creatures nearby owned or allied attacked creatures. We return as soon as a creature is
+    // dropped so the creature indexes of the game map do not change while we iterate over them
+    for(Seat* alliedSeat : mGameMap.getSeats())
     {
-        // We check if a creature is fighting near a claimed tile. If yes, we drop a creature nearby
-        if(!creature->isActionInList(CreatureAction::ActionType::fight))
+        if(!seat->isAlliedSeat(alliedSeat))
             continue;
 
-        Tile* tile = creature->getPositionTile();
-        if(tile == nullptr)
-            continue;
+        for(Creature* creature : mGameMap.getCreaturesBySeat(alliedSeat))
+        {
+            // We check if a creature is fighting near a claimed tile. If yes, we drop a creature nearby
+            if(!creature->isActionInList(CreatureAction::ActionType::fight))
+                continue;
 
-        Creature* creatureToDrop = mGameMap.getFighterToPickupBySeat(seat);
-        if(creatureToDrop == nullptr)
-            continue;
+            Tile* tile = creature->getPositionTile();
+            if(tile == nullptr)
+                continue;
 
-        if(!creatureToDrop->tryPickup(seat, false))
-            continue;
+            Creature* creatureToDrop = mGameMap.getFighterToPickupBySeat(seat);
+            if(creatureToDrop == nullptr)
+                continue;
 
-        for(Tile* neigh : tile->getAllNeighbors())
-        {
-            if(creatureToDrop->tryDrop(seat, neigh, false))
+            if(!creatureToDrop->tryPickup(seat, false))
+                continue;
+
+            for(Tile* neigh : tile->getAllNeighbors())
             {
-                mPlayer.pickUpEntity(creatureToDrop, false);
-                OD_ASSERT_TRUE(mPlayer.dropHand(neigh) == creatureToDrop);
-                mCooldownDefense = Random::Int(0,5);
-                return;
+                if(creatureToDrop->tryDrop(seat, neigh, false))
+                {
+                    mPlayer.pickUpEntity(creatureToDrop, false);
+                    OD_ASSERT_TRUE(mPlayer.dropHand(neigh) == creatureToDrop);
+                    mCooldownDefense = mRandom.Int(0,5);
+                    return;
+                }
             }
         }
     }
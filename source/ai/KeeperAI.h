@@ -20,6 +20,8 @@
 
 #include "ai/BaseAI.h"
 
+#include "utils/Random.h"
+
 class KeeperAI : public BaseAI
 {
 
@@ -40,7 +42,8 @@ protected:
 
     //! \brief Look for gold and make way up to it.
     //! \brief Returns whether the action could succeed.
-    //! It will also return false once it's done.
+    //! It will also return false once it's done or if the search will be resumed next turn
+    //! because the turn budget is exhausted.
     bool lookForGold();
 
     //! \brief Picks up wounded creatures and drops then in the dungeon temple
@@ -59,7 +62,13 @@ private:
     int mRoomSize;
     bool mNoMoreReachableGold;
     int mCooldownLookingForGold;
+    //! \brief Next distance from the dungeon temple to scan when looking for gold. 0 if there is
+    //! no search in progress
+    int32_t mGoldSearchDistance;
     int mCooldownDefense;
+
+    //! \brief Generator for the AI decisions, seeded from the seat id of the player
+    RandomGenerator mRandom;
 };
 
 #endif // KEEPERAI_H
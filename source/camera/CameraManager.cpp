@@ -25,6 +25,7 @@
 #include "gamemap/MiniMap.h"
 #include "render/ODFrameListener.h"
 #include "sound/SoundEffectsManager.h"
+#include "utils/Helper.h"
 #include "utils/LogManager.h"
 
 #include "ODApplication.h"
@@ -355,6 +356,36 @@ const Ogre::Vector3 CameraManager::getCameraViewTarget()
     return target;
 }
 
+void CameraManager::getViewedTiles(int& minX, int& minY, int& maxX, int& maxY)
+{
+    const Ogre::Plane floor(Ogre::Vector3::UNIT_Z, 0.0);
+    const Ogre::Real corners[4][2] = { {0.0, 0.0}, {1.0, 0.0}, {0.0, 1.0}, {1.0, 1.0} };
+    Ogre::Real farClip = mActiveCamera->getFarClipDistance();
+    for(int i = 0; i < 4; ++i)
+    {
+        Ogre::Ray ray = mActiveCamera->getCameraToViewportRay(corners[i][0], corners[i][1]);
+        std::pair<bool, Ogre::Real> intersection = ray.intersects(floor);
+        Ogre::Real distance = farClip;
+        if(intersection.first && (intersection.second < farClip))
+            distance = intersection.second;
+
+        Ogre::Vector3 point = ray.getPoint(distance);
+        int x = Helper::round(point.x);
+        int y = Helper::round(point.y);
+        if(i == 0)
+        {
+            minX = maxX = x;
+            minY = maxY = y;
+            continue;
+        }
+
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+}
+
 void CameraManager::setCameraPosition(const Ogre::Vector3& position)
 {
     getActiveCameraNode()->setPosition(position);
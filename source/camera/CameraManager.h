@@ -99,6 +99,11 @@ public:
     */
     const Ogre::Vector3 getCameraViewTarget();
 
+    /*! \brief Computes the bounding box of the tiles shown by the active camera: the points of the floor
+    * under the corners of the viewport. When a corner shows the sky, the point at the far clip distance is used.
+    */
+    void getViewedTiles(int& minX, int& minY, int& maxX, int& maxY);
+
     void onMiniMapClick(Ogre ::Vector2 cc);
 
     /** \brief Starts the camera moving towards a destination position,
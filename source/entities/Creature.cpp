@@ -68,6 +68,8 @@
 //TODO: make this read from definition file?
 static const int MaxGoldCarriedByWorkers = 1500;
 static const int NB_TURN_FLEE_MAX = 5;
+//! \brief Number of turns a worker keeps the task it walks to. Other workers can take it after that
+static const int64_t WORKER_TASK_RESERVATION_TURNS = 20;
 
 const std::string Creature::CREATURE_PREFIX = "Creature_";
 
@@ -548,6 +550,33 @@ void Creature::update(Ogre::Real timeSinceLastFrame)
     }
 }
 
+void Creature::senseSurroundings()
+{
+    if ((getHP() <= 0.0) || !getIsOnMap() || (getPositionTile() == nullptr))
+    {
+        mVisibleTiles.clear();
+        mVisibleEnemyObjects.clear();
+        mReachableEnemyObjects.clear();
+        mReachableEnemyCreatures.clear();
+        mVisibleAlliedObjects.clear();
+        mReachableAlliedObjects.clear();
+        mVisibleMarkedTiles.clear();
+        return;
+    }
+
+    // Look at the surrounding area
+    updateTilesInSight();
+
+    mVisibleEnemyObjects         = getVisibleEnemyObjects();
+    mReachableEnemyObjects       = getReachableAttackableObjects(mVisibleEnemyObjects);
+    mReachableEnemyCreatures     = getCreaturesFromList(mReachableEnemyObjects, getDefinition()->isWorker());
+    mVisibleAlliedObjects        = getVisibleAlliedObjects();
+    mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+
+    if (mDigRate > 0.0)
+        updateVisibleMarkedTiles();
+}
+
 void Creature::computeVisibleTiles()
 {
     if (getHP() <= 0.0)
@@ -556,12 +585,43 @@ void Creature::computeVisibleTiles()
     if (!getIsOnMap())
         return;
 
-    // Look at the surrounding area
-    updateTilesInSight();
     for(Tile* tile : mVisibleTiles)
         tile->notifyVision(getSeat());
 }
 
+//! \brief Returns true if the given object has been killed or removed from the map
+static bool isSensedObjectOutdated(GameEntity* entity)
+{
+    return (entity->getHP(nullptr) <= 0.0) || !entity->getIsOnMap();
+}
+
+static void dropOutdatedObjects(std::vector<GameEntity*>& objects)
+{
+    objects.erase(std::remove_if(objects.begin(), objects.end(), isSensedObjectOutdated), objects.end());
+}
+
+void Creature::dropOutdatedSensedObjects()
+{
+    dropOutdatedObjects(mVisibleEnemyObjects);
+    dropOutdatedObjects(mReachableEnemyObjects);
+    dropOutdatedObjects(mReachableEnemyCreatures);
+    dropOutdatedObjects(mVisibleAlliedObjects);
+    dropOutdatedObjects(mReachableAlliedObjects);
+
+    if(mVisibleMarkedTiles.empty())
+        return;
+
+    Player* player = getGameMap()->getPlayerBySeat(getSeat());
+    if(player == nullptr)
+    {
+        mVisibleMarkedTiles.clear();
+        return;
+    }
+
+    mVisibleMarkedTiles.erase(std::remove_if(mVisibleMarkedTiles.begin(), mVisibleMarkedTiles.end(),
+        [player](Tile* tile) { return !tile->getMarkedForDigging(player); }), mVisibleMarkedTiles.end());
+}
+
 void Creature::setLevel(unsigned int level)
 {
     // Reset XP once the level has been acquired.
@@ -591,6 +651,8 @@ void Creature::doUpkeep()
         // Let the creature lay dead on the ground for a few turns before removing it from the GameMap.
         if (mDeathCounter == 0)
         {
+            getGameMap()->notifyCreatureDeath(this);
+
             stopJob();
             stopEating();
             clearDestinations();
@@ -649,14 +711,9 @@ void Creature::doUpkeep()
     if (mHunger > 100.0)
         mHunger = 100.0;
 
-    mVisibleEnemyObjects         = getVisibleEnemyObjects();
-    mReachableEnemyObjects       = getReachableAttackableObjects(mVisibleEnemyObjects);
-    mReachableEnemyCreatures     = getCreaturesFromList(mReachableEnemyObjects, getDefinition()->isWorker());
-    mVisibleAlliedObjects        = getVisibleAlliedObjects();
-    mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
-
-    if (mDigRate > 0.0)
-        updateVisibleMarkedTiles();
+    // What the creature sees has been computed by senseSurroundings at the beginning of the turn. We
+    // only forget what the creatures that acted before this one have killed or dug
+    dropOutdatedSensedObjects();
 
     decidePrioritaryAction();
 
@@ -791,7 +848,7 @@ void Creature::decidePrioritaryAction()
             return;
 
         // If we are in bad mood, we have a probability to flee
-        if(isInBadMood() && (Random::Int(0,100) > 80))
+        if(isInBadMood() && (mRandom.Int(0,100) > 80))
         {
             clearDestinations();
             clearActionQueue();
@@ -822,7 +879,7 @@ void Creature::decidePrioritaryAction()
 
 bool Creature::handleIdleAction(const CreatureAction& actionItem)
 {
-    double diceRoll = Random::Double(0.0, 1.0);
+    double diceRoll = mRandom.Double(0.0, 1.0);
 
     setAnimationState("Idle");
 
@@ -978,8 +1035,8 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
         // If we have no home tile, we try to find one
         if(mHomeTile == nullptr)
         {
-            std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::dormitory, getSeat());
-            tempRooms = getGameMap()->getReachableRooms(tempRooms, getPositionTile(), this);
+            std::vector<Room*> tempRooms = getGameMap()->getReachableRooms(
+                getGameMap()->getRoomsByTypeAndSeat(Room::dormitory, getSeat()), getPositionTile(), this);
             if (!tempRooms.empty())
             {
                 clearDestinations();
@@ -1024,7 +1081,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
     }
 
     // We check if we are looking for our fee
-    if(!mDefinition->isWorker() && Random::Double(0.0, 1.0) < 0.5 && mGoldFee > 0)
+    if(!mDefinition->isWorker() && mRandom.Double(0.0, 1.0) < 0.5 && mGoldFee > 0)
     {
         if(pushAction(CreatureAction::getFee))
             return true;
@@ -1032,11 +1089,11 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
 
     // Check to see if we have found a "home" tile where we can sleep. Even if we are not sleepy,
     // we want to have a bed
-    if (!mDefinition->isWorker() && mHomeTile == nullptr && Random::Double(0.0, 1.0) < 0.5)
+    if (!mDefinition->isWorker() && mHomeTile == nullptr && mRandom.Double(0.0, 1.0) < 0.5)
     {
         // Check to see if there are any dormitory owned by our color that we can reach.
-        std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::dormitory, getSeat());
-        tempRooms = getGameMap()->getReachableRooms(tempRooms, getPositionTile(), this);
+        std::vector<Room*> tempRooms = getGameMap()->getReachableRooms(
+            getGameMap()->getRoomsByTypeAndSeat(Room::dormitory, getSeat()), getPositionTile(), this);
         if (!tempRooms.empty())
         {
             if(pushAction(CreatureAction::findHome))
@@ -1045,7 +1102,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
     }
 
     // If we are sleepy, we go to sleep
-    if (!mDefinition->isWorker() && mHomeTile != nullptr && Random::Double(0.0, 1.0) < 0.2 && Random::Double(0.0, 50.0) >= mAwakeness)
+    if (!mDefinition->isWorker() && mHomeTile != nullptr && mRandom.Double(0.0, 1.0) < 0.2 && mRandom.Double(0.0, 50.0) >= mAwakeness)
     {
         // Check to see if we can work
         if(pushAction(CreatureAction::sleep))
@@ -1053,7 +1110,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
     }
 
     // If we are hungry, we go to eat
-    if (!mDefinition->isWorker() && Random::Double(0.0, 1.0) < 0.2 && Random::Double(50.0, 100.0) <= mHunger)
+    if (!mDefinition->isWorker() && mRandom.Double(0.0, 1.0) < 0.2 && mRandom.Double(50.0, 100.0) <= mHunger)
     {
         // Check to see if we can work
         if(pushAction(CreatureAction::eatdecided))
@@ -1061,8 +1118,8 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
     }
 
     // Otherwise, we try to work
-    if (!mDefinition->isWorker() && Random::Double(0.0, 1.0) < 0.4
-        && Random::Double(0.0, 50.0) < mAwakeness && Random::Double(50.0, 100.0) > mHunger)
+    if (!mDefinition->isWorker() && mRandom.Double(0.0, 1.0) < 0.4
+        && mRandom.Double(0.0, 50.0) < mAwakeness && mRandom.Double(50.0, 100.0) > mHunger)
     {
         // Check to see if we can work
         if(pushAction(CreatureAction::jobdecided))
@@ -1086,7 +1143,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
         // Non-workers only.
 
         // Check to see if we want to try to follow a worker around or if we want to try to explore.
-        double r = Random::Double(0.0, 1.0);
+        double r = mRandom.Double(0.0, 1.0);
         //if(creatureJob == weakFighter) r -= 0.2;
         if (r < 0.7)
         {
@@ -1105,18 +1162,18 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
                     {
                         // Worker is digging, get near it since it could expose enemies.
                         int x = static_cast<int>(static_cast<double>(tempTile->getX()) + 3.0
-                                * Random::gaussianRandomDouble());
+                                * mRandom.gaussianRandomDouble());
                         int y = static_cast<int>(static_cast<double>(tempTile->getY()) + 3.0
-                                * Random::gaussianRandomDouble());
+                                * mRandom.gaussianRandomDouble());
                         tileDest = getGameMap()->getTile(x, y);
                     }
                     else
                     {
                         // Worker is not digging, wander a bit farther around the worker.
                         int x = static_cast<int>(static_cast<double>(tempTile->getX()) + 8.0
-                                * Random::gaussianRandomDouble());
+                                * mRandom.gaussianRandomDouble());
                         int y = static_cast<int>(static_cast<double>(tempTile->getY()) + 8.0
-                                * Random::gaussianRandomDouble());
+                                * mRandom.gaussianRandomDouble());
                         tileDest = getGameMap()->getTile(x, y);
                     }
                     workerFound = true;
@@ -1127,7 +1184,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
                 {
                     if (!reachableTiles.empty())
                     {
-                        tileDest = reachableTiles[static_cast<unsigned int>(Random::Double(0.6, 0.8)
+                        tileDest = reachableTiles[static_cast<unsigned int>(mRandom.Double(0.6, 0.8)
                                                                            * (reachableTiles.size() - 1))];
                     }
                 }
@@ -1139,7 +1196,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
             if (!reachableTiles.empty())
             {
                 unsigned int tileIndex = static_cast<unsigned int>(reachableTiles.size()
-                                                                   * Random::Double(0.1, 0.3));
+                                                                   * mRandom.Double(0.1, 0.3));
                 tileDest = reachableTiles[tileIndex];
             }
         }
@@ -1151,7 +1208,7 @@ bool Creature::handleIdleAction(const CreatureAction& actionItem)
         // Choose a tile far away from our current position to wander to.
         if (!reachableTiles.empty())
         {
-            tileDest = reachableTiles[Random::Uint(reachableTiles.size() / 2,
+            tileDest = reachableTiles[mRandom.Uint(reachableTiles.size() / 2,
                                                    reachableTiles.size() - 1)];
         }
     }
@@ -1194,7 +1251,7 @@ bool Creature::handleClaimTileAction(const CreatureAction& actionItem)
     if(mForceAction != forcedActionClaimTile)
     {
         // Randomly decide to stop claiming with a small probability
-        if (Random::Double(0.0, 1.0) < 0.1 + 0.2 * mVisibleMarkedTiles.size())
+        if (mRandom.Double(0.0, 1.0) < 0.1 + 0.2 * mVisibleMarkedTiles.size())
         {
             // If there are any visible tiles marked for digging start working on that.
             if (!mVisibleMarkedTiles.empty())
@@ -1237,7 +1294,7 @@ bool Creature::handleClaimTileAction(const CreatureAction& actionItem)
     while (!neighbors.empty())
     {
         // If the current neighbor is claimable, walk into it and skip to the end of this turn
-        int tempInt = Random::Uint(0, neighbors.size() - 1);
+        int tempInt = mRandom.Uint(0, neighbors.size() - 1);
         Tile* tempTile = neighbors[tempInt];
         if (tempTile != nullptr && tempTile->getFullness() == 0.0
             && (!tempTile->isClaimedForSeat(getSeat()) || tempTile->getClaimedPercentage() < 1.0)
@@ -1261,86 +1318,9 @@ bool Creature::handleClaimTileAction(const CreatureAction& actionItem)
         neighbors.erase(neighbors.begin() + tempInt);
     }
 
-    //cout << "\nLooking at the visible tiles to see if I can claim a tile.";
-    // If we still haven't found a tile to claim, check the rest of the visible tiles
-    std::vector<Tile*> claimableTiles;
-    for (Tile* tempTile : mTilesWithinSightRadius)
-    {
-        // if this tile is not fully claimed yet or the tile is of another player's color
-        if (tempTile != nullptr && tempTile->getFullness() == 0.0
-            && (tempTile->getClaimedPercentage() < 1.0 || !tempTile->isClaimedForSeat(getSeat()))
-            && tempTile->isGroundClaimable())
-        {
-            // Check to see if one of the tile's neighbors is claimed for our color
-            for (Tile* t : tempTile->getAllNeighbors())
-            {
-                if (t->isClaimedForSeat(getSeat())
-                        && t->getClaimedPercentage() >= 1.0)
-                {
-                    claimableTiles.push_back(t);
-                }
-            }
-        }
-    }
-
-    //cout << "  I see " << claimableTiles.size() << " tiles I can claim.";
-    // Randomly pick a claimable tile, plot a path to it and walk to it
-    unsigned int tempUnsigned = 0;
-    Tile* tempTile = nullptr;
-    while (!claimableTiles.empty())
-    {
-        // Randomly find a "good" tile to claim.  A good tile is one that has many neighbors
-        // already claimed, this makes the claimed are more "round" and less jagged.
-        do
-        {
-            int numNeighborsClaimed = 0;
-
-            // Start by randomly picking a candidate tile.
-            tempTile = claimableTiles[Random::Uint(0, claimableTiles.size() - 1)];
-
-            // Count how many of the candidate tile's neighbors are already claimed.
-            for (Tile* t : tempTile->getAllNeighbors())
-            {
-                if (t->isClaimedForSeat(getSeat()) && t->getClaimedPercentage() >= 1.0)
-                    ++numNeighborsClaimed;
-            }
-
-            // Pick a random number in [0:1], if this number is high enough, than use this tile to claim.  The
-            // bar for success approaches 0 as numTiles approaches N so this will be guaranteed to succeed at,
-            // or before the time we get to the last unclaimed tile.  The bar for success is also lowered
-            // according to how many neighbors are already claimed.
-            //NOTE: The bar can be negative, when this happens we are guarenteed to use this candidate tile.
-            double bar = 1.0 - (numNeighborsClaimed / 4.0) - (tempUnsigned / static_cast<double>(claimableTiles.size() - 1));
-            if (Random::Double(0.0, 1.0) >= bar)
-                break;
-
-            // Safety catch to prevent infinite loop in case the bar for success is too high and is never met.
-            if (tempUnsigned >= claimableTiles.size() - 1)
-                break;
-
-            // Increment the counter indicating how many candidate tiles we have rejected so far.
-            ++tempUnsigned;
-        } while (true);
-
-        if (tempTile != nullptr)
-        {
-            // If we find a valid path to the tile start walking to it and break
-            if (setDestination(tempTile))
-                return false;
-        }
-
-        // If we got to this point, the tile we randomly picked cannot be gotten to via a
-        // valid path.  Delete it from the claimable tiles vector and repeat the outer
-        // loop to try to find another valid tile.
-        for (unsigned int i = 0; i < claimableTiles.size(); ++i)
-        {
-            if (claimableTiles[i] == tempTile)
-            {
-                claimableTiles.erase(claimableTiles.begin() + i);
-                break; // Break out of this for loop.
-            }
-        }
-    }
+    // If we still haven't found a tile to claim, take the closest claimable tile from the seat task board
+    if (setDestination(reserveWorkerTask(WorkerTaskBoard::TaskType::claimGround)))
+        return false;
 
     // We couldn't find a tile to try to claim so we start searching for claimable walls
     mForceAction = forcedActionNone;
@@ -1361,7 +1341,7 @@ bool Creature::handleClaimWallTileAction(const CreatureAction& actionItem)
     // Randomly decide to stop claiming with a small probability
     if(mForceAction != forcedActionClaimWallTile)
     {
-        if (Random::Double(0.0, 1.0) < 0.1 + 0.2 * mVisibleMarkedTiles.size())
+        if (mRandom.Double(0.0, 1.0) < 0.1 + 0.2 * mVisibleMarkedTiles.size())
         {
             // If there are any visible tiles marked for digging start working on that.
             if (!mVisibleMarkedTiles.empty())
@@ -1406,70 +1386,9 @@ bool Creature::handleClaimWallTileAction(const CreatureAction& actionItem)
         return false;
     //std::cout << "Looking for a wall to claim" << std::endl;
 
-    // Find paths to all of the neighbor tiles for all of the visible wall tiles.
-    std::vector<std::list<Tile*> > possiblePaths;
-    std::vector<Tile*> wallTiles = getVisibleClaimableWallTiles();
-    for (unsigned int i = 0; i < wallTiles.size(); ++i)
-    {
-        for (Tile* neighborTile : wallTiles[i]->getAllNeighbors())
-        {
-            if (getGameMap()->pathExists(this, getPositionTile(), neighborTile))
-                possiblePaths.push_back(getGameMap()->path(this, neighborTile));
-        }
-    }
-
-    // Find the shortest path and start walking toward the tile to be dug out
-    if (!possiblePaths.empty())
-    {
-        // Find the N shortest valid paths, see if there are any valid paths shorter than this first guess
-        std::vector<std::list<Tile*> > shortPaths;
-        for (unsigned int i = 0; i < possiblePaths.size(); ++i)
-        {
-            // If the current path is long enough to be valid
-            unsigned int currentLength = possiblePaths[i].size();
-            if (currentLength >= 2)
-            {
-                shortPaths.push_back(possiblePaths[i]);
-
-                // If we already have enough short paths
-                if (shortPaths.size() > 5)
-                {
-                    unsigned int longestLength, longestIndex;
-
-                    // Kick out the longest
-                    longestLength = shortPaths[0].size();
-                    longestIndex = 0;
-                    for (unsigned int j = 1; j < shortPaths.size(); ++j)
-                    {
-                        if (shortPaths[j].size() > longestLength)
-                        {
-                            longestLength = shortPaths.size();
-                            longestIndex = j;
-                        }
-                    }
-
-                    shortPaths.erase(shortPaths.begin() + longestIndex);
-                }
-            }
-        }
-
-        // Randomly pick a short path to take
-        unsigned int numShortPaths = shortPaths.size();
-        if (numShortPaths > 0)
-        {
-            unsigned int shortestIndex;
-            shortestIndex = Random::Uint(0, numShortPaths - 1);
-            std::list<Tile*> walkPath = shortPaths[shortestIndex];
-
-            // If the path is a legitimate path, walk down it to the tile to be dug out
-            if (setWalkPath(walkPath, 2, false))
-            {
-                setAnimationState("Walk");
-                pushAction(CreatureAction::walkToTile, true);
-                return false;
-            }
-        }
-    }
+    // Walk to the closest claimable wall that no other worker is going to
+    if (setDestination(reserveWorkerTask(WorkerTaskBoard::TaskType::claimWall)))
+        return false;
 
     // If we found no path, let's stop doing this
     mForceAction = forcedActionNone;
@@ -1553,8 +1472,8 @@ bool Creature::handleDigTileAction(const CreatureAction& actionItem)
         obj->createMesh();
         obj->setPosition(pos, false);
 
-        std::vector<Room*> treasuries = getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat());
-        treasuries = getGameMap()->getReachableRooms(treasuries, myTile, this);
+        std::vector<Room*> treasuries = getGameMap()->getReachableRooms(
+            getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat()), myTile, this);
         bool isTreasuryAvailable = false;
         for(Room* room : treasuries)
         {
@@ -1581,69 +1500,9 @@ bool Creature::handleDigTileAction(const CreatureAction& actionItem)
     if (wasANeighbor)
         return false;
 
-    // Find paths to all of the neighbor tiles for all of the marked visible tiles.
-    std::vector<std::list<Tile*> > possiblePaths;
-    for (unsigned int i = 0; i < mVisibleMarkedTiles.size(); ++i)
-    {
-        for (Tile* neighborTile : mVisibleMarkedTiles[i]->getAllNeighbors())
-        {
-            if (getGameMap()->pathExists(this, getPositionTile(), neighborTile))
-                possiblePaths.push_back(getGameMap()->path(this, neighborTile));
-        }
-    }
-
-    // Find the shortest path and start walking toward the tile to be dug out
-    if (!possiblePaths.empty())
-    {
-        // Find the N shortest valid paths, see if there are any valid paths shorter than this first guess
-        std::vector<std::list<Tile*> > shortPaths;
-        for (unsigned int i = 0; i < possiblePaths.size(); ++i)
-        {
-            // If the current path is long enough to be valid
-            unsigned int currentLength = possiblePaths[i].size();
-            if (currentLength >= 2)
-            {
-                shortPaths.push_back(possiblePaths[i]);
-
-                // If we already have enough short paths
-                if (shortPaths.size() > 5)
-                {
-                    unsigned int longestLength, longestIndex;
-
-                    // Kick out the longest
-                    longestLength = shortPaths[0].size();
-                    longestIndex = 0;
-                    for (unsigned int j = 1; j < shortPaths.size(); ++j)
-                    {
-                        if (shortPaths[j].size() > longestLength)
-                        {
-                            longestLength = shortPaths.size();
-                            longestIndex = j;
-                        }
-                    }
-
-                    shortPaths.erase(shortPaths.begin() + longestIndex);
-                }
-            }
-        }
-
-        // Randomly pick a short path to take
-        unsigned int numShortPaths = shortPaths.size();
-        if (numShortPaths > 0)
-        {
-            unsigned int shortestIndex;
-            shortestIndex = Random::Uint(0, numShortPaths - 1);
-            std::list<Tile*> walkPath = shortPaths[shortestIndex];
-
-            // If the path is a legitimate path, walk down it to the tile to be dug out
-            if (setWalkPath(walkPath, 2, false))
-            {
-                setAnimationState("Walk");
-                pushAction(CreatureAction::walkToTile, true);
-                return false;
-            }
-        }
-    }
+    // Walk to the closest marked tile that no other worker is going to
+    if (setDestination(reserveWorkerTask(WorkerTaskBoard::TaskType::dig)))
+        return false;
 
     // If none of our neighbors are marked for digging we got here too late.
     // Finish digging
@@ -1661,8 +1520,8 @@ bool Creature::handleDigTileAction(const CreatureAction& actionItem)
             obj->createMesh();
             obj->setPosition(pos, false);
 
-            std::vector<Room*> treasuries = getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat());
-            treasuries = getGameMap()->getReachableRooms(treasuries, myTile, this);
+            std::vector<Room*> treasuries = getGameMap()->getReachableRooms(
+                getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat()), myTile, this);
             bool isTreasuryAvailable = false;
             for(Room* room : treasuries)
             {
@@ -1690,6 +1549,18 @@ bool Creature::handleDigTileAction(const CreatureAction& actionItem)
     return false;
 }
 
+//! \brief Returns a tile of the given dormitory where a bed of the given creature can be placed (trying both
+//! orientations) or nullptr if there is not enough space
+static Tile* getLocationForBed(Room* dormitory, const CreatureDefinition* definition)
+{
+    RoomDormitory* roomDormitory = static_cast<RoomDormitory*>(dormitory);
+    Tile* tile = roomDormitory->getLocationForBed(definition->getBedDim1(), definition->getBedDim2());
+    if (tile == nullptr)
+        tile = roomDormitory->getLocationForBed(definition->getBedDim2(), definition->getBedDim1());
+
+    return tile;
+}
+
 bool Creature::handleFindHomeAction(const CreatureAction& actionItem)
 {
     // Check to see if we are standing in an open dormitory tile that we can claim as our home.
@@ -1756,58 +1627,34 @@ bool Creature::handleFindHomeAction(const CreatureAction& actionItem)
         return true;
     }
 
-    // Check to see if we can walk to a dormitory that does have an open tile.
-    std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::dormitory, getSeat());
-    std::random_shuffle(tempRooms.begin(), tempRooms.end());
-    unsigned int nearestDormitoryDistance = 0;
-    bool validPathFound = false;
-    std::list<Tile*> tempPath;
-    for (unsigned int i = 0; i < tempRooms.size(); ++i)
+    // Check to see if we can walk to a dormitory that does have an open tile. We try the closest one first and
+    // only sort the others by distance if there is no room for our bed in it
+    Room* closestDormitory = getGameMap()->getClosestReachableRoom(Room::dormitory, getSeat(), this);
+    if (closestDormitory == nullptr)
     {
-        // Get the list of open rooms at the current dormitory and check to see if
-        // there is a place where we could put a bed big enough to sleep in.
-        Tile* tempTile = static_cast<RoomDormitory*>(tempRooms[i])->getLocationForBed(
-                        mDefinition->getBedDim1(), mDefinition->getBedDim2());
-
-        // If the previous attempt to place the bed in this dormitory failed, try again with the bed the other way.
-        if (tempTile == nullptr)
-            tempTile = static_cast<RoomDormitory*>(tempRooms[i])->getLocationForBed(
-                                                                     mDefinition->getBedDim2(), mDefinition->getBedDim1());
+        popAction();
+        return true;
+    }
 
-        // Check to see if either of the two possible bed orientations tried above resulted in a successful placement.
-        if (tempTile != nullptr)
+    Tile* bedTile = getLocationForBed(closestDormitory, mDefinition);
+    if (bedTile == nullptr)
+    {
+        std::vector<Room*> tempRooms = getGameMap()->getReachableRoomsByDistance(Room::dormitory, getSeat(), this);
+        for (Room* room : tempRooms)
         {
-            std::list<Tile*> tempPath2 = getGameMap()->path(this, tempTile);
+            if (room == closestDormitory)
+                continue;
 
-            // Find out the minimum valid path length of the paths determined in the above block.
-            if (!validPathFound)
-            {
-                // If the current path is long enough to be valid then record the path and the distance.
-                if (tempPath2.size() >= 2)
-                {
-                    tempPath = tempPath2;
-                    nearestDormitoryDistance = tempPath.size();
-                    validPathFound = true;
-                }
-            }
-            else
-            {
-                // If the current path is long enough to be valid but shorter than the
-                // shortest path seen so far, then record the path and the distance.
-                if (tempPath2.size() >= 2 && tempPath2.size()
-                        < nearestDormitoryDistance)
-                {
-                    tempPath = tempPath2;
-                    nearestDormitoryDistance = tempPath.size();
-                }
-            }
+            bedTile = getLocationForBed(room, mDefinition);
+            if (bedTile != nullptr)
+                break;
         }
     }
 
-    // If we found a valid path to an open room in a dormitory, then start walking along it.
-    if (validPathFound)
+    if (bedTile != nullptr)
     {
-        if (setWalkPath(tempPath, 2, false))
+        std::list<Tile*> tempPath = getGameMap()->path(this, bedTile);
+        if ((tempPath.size() >= 2) && setWalkPath(tempPath, 2, false))
         {
             setAnimationState("Walk");
             pushAction(CreatureAction::walkToTile, true);
@@ -1831,7 +1678,7 @@ bool Creature::handleJobAction(const CreatureAction& actionItem)
     }
 
     // Randomly decide to stop working, we are more likely to stop when we are tired.
-    if (Random::Double(10.0, 30.0) > mAwakeness)
+    if (mRandom.Double(10.0, 30.0) > mAwakeness)
     {
         popAction();
 
@@ -1859,7 +1706,7 @@ bool Creature::handleJobAction(const CreatureAction& actionItem)
                 if((affinity.getEfficiency() <= 0) ||
                    (room->getType() == Room::RoomType::hatchery))
                 {
-                    int index = Random::Int(0, room->numCoveredTiles() - 1);
+                    int index = mRandom.Int(0, room->numCoveredTiles() - 1);
                     Tile* tileDest = room->getCoveredTile(index);
                     std::list<Tile*> tempPath = getGameMap()->path(this, tileDest);
                     if (setWalkPath(tempPath, 0, false))
@@ -1904,7 +1751,7 @@ bool Creature::handleJobAction(const CreatureAction& actionItem)
             if((affinity.getEfficiency() <= 0) ||
                (room->getType() == Room::RoomType::hatchery))
             {
-                int index = Random::Int(0, room->numCoveredTiles() - 1);
+                int index = mRandom.Int(0, room->numCoveredTiles() - 1);
                 Tile* tileDest = room->getCoveredTile(index);
                 std::list<Tile*> tempPath = getGameMap()->path(this, tileDest);
                 if (setWalkPath(tempPath, 0, false))
@@ -1928,9 +1775,15 @@ bool Creature::handleJobAction(const CreatureAction& actionItem)
 
         // We are not in a room of the good type or we couldn't use it. We check if there is a reachable room
         // of the good type
-        std::vector<Room*> rooms = getGameMap()->getRoomsByTypeAndSeat(affinity.getRoomType(), getSeat());
-        rooms = getGameMap()->getReachableRooms(rooms, myTile, this);
+        std::vector<Room*> rooms = getGameMap()->getReachableRooms(
+            getGameMap()->getRoomsByTypeAndSeat(affinity.getRoomType(), getSeat()), myTile, this);
         std::random_shuffle(rooms.begin(), rooms.end());
+
+        // We try the closest room first
+        Room* closestRoom = getGameMap()->getClosestReachableRoom(affinity.getRoomType(), getSeat(), this);
+        std::vector<Room*>::iterator itClosest = std::find(rooms.begin(), rooms.end(), closestRoom);
+        if(itClosest != rooms.end())
+            std::iter_swap(rooms.begin(), itClosest);
         for(Room* room : rooms)
         {
             // If efficiency is 0, we just want to wander so no need to check if the room
@@ -1938,7 +1791,7 @@ bool Creature::handleJobAction(const CreatureAction& actionItem)
             if((affinity.getEfficiency() <= 0) ||
                room->hasOpenCreatureSpot(this))
             {
-                int index = Random::Int(0, room->numCoveredTiles() - 1);
+                int index = mRandom.Int(0, room->numCoveredTiles() - 1);
                 Tile* tileDest = room->getCoveredTile(index);
                 std::list<Tile*> tempPath = getGameMap()->path(this, tileDest);
                 if (setWalkPath(tempPath, 0, false))
@@ -1982,7 +1835,7 @@ bool Creature::handleEatingAction(const CreatureAction& actionItem)
     }
 
     if (((actionItem.getType() == CreatureAction::ActionType::eatforced) && mHunger < 5.0) ||
-        ((actionItem.getType() != CreatureAction::ActionType::eatforced) && mHunger <= Random::Double(0.0, 15.0)))
+        ((actionItem.getType() != CreatureAction::ActionType::eatforced) && mHunger <= mRandom.Double(0.0, 15.0)))
     {
         popAction();
 
@@ -2034,7 +1887,7 @@ bool Creature::handleEatingAction(const CreatureAction& actionItem)
             ChickenEntity* chicken = static_cast<ChickenEntity*>(chickens.at(0));
             chicken->eatChicken(this);
             foodEaten(ConfigManager::getSingleton().getRoomConfigDouble("HatcheryHungerPerChicken"));
-            mEatCooldown = Random::Int(ConfigManager::getSingleton().getRoomConfigUInt32("HatcheryCooldownChickenMin"),
+            mEatCooldown = mRandom.Int(ConfigManager::getSingleton().getRoomConfigUInt32("HatcheryCooldownChickenMin"),
                 ConfigManager::getSingleton().getRoomConfigUInt32("HatcheryCooldownChickenMax"));
             mHp += ConfigManager::getSingleton().getRoomConfigDouble("HatcheryHpRecoveredPerChicken");
             Ogre::Vector3 walkDirection = Ogre::Vector3(closestChickenTile->getX(), closestChickenTile->getY(), 0) - getPosition();
@@ -2088,41 +1941,34 @@ bool Creature::handleEatingAction(const CreatureAction& actionItem)
         }
     }
 
-    // Get the list of hatchery controlled by our seat and make sure there is at least one.
-    std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::hatchery, getSeat());
-
-    if (tempRooms.empty())
-    {
-        popAction();
-
-        stopEating();
-        return true;
-    }
-
-    // Pick a hatchery and try to walk to it.
+    // Pick the closest hatchery controlled by our seat with an open spot and try to walk to it.
     double maxDistance = 40.0;
-    Room* tempRoom = nullptr;
-    int nbTry = 5;
-    do
+    Room* tempRoom = getGameMap()->getClosestReachableRoom(Room::hatchery, getSeat(), this);
+    if ((tempRoom != nullptr) && !tempRoom->hasOpenCreatureSpot(this))
     {
-        int tempInt = Random::Uint(0, tempRooms.size() - 1);
-        tempRoom = tempRooms[tempInt];
-        tempRooms.erase(tempRooms.begin() + tempInt);
-        double tempDouble = 1.0 / (maxDistance - getGameMap()->crowDistance(myTile, tempRoom->getCoveredTile(0)));
-        if (Random::Double(0.0, 1.0) < tempDouble)
-            break;
-        --nbTry;
-    } while (nbTry > 0 && !tempRoom->hasOpenCreatureSpot(this) && !tempRooms.empty());
+        // The closest hatchery is already being used, we try the others from the closest to the farthest
+        Room* closestHatchery = tempRoom;
+        tempRoom = nullptr;
+        std::vector<Room*> hatcheries = getGameMap()->getReachableRoomsByDistance(Room::hatchery, getSeat(), this);
+        for (Room* hatchery : hatcheries)
+        {
+            if ((hatchery != closestHatchery) && hatchery->hasOpenCreatureSpot(this))
+            {
+                tempRoom = hatchery;
+                break;
+            }
+        }
+    }
 
-    if (!tempRoom || !tempRoom->hasOpenCreatureSpot(this))
+    if (tempRoom == nullptr)
     {
-        // The room is already being used, stop trying to eat
+        // There is no hatchery or they are all already being used, stop trying to eat
         popAction();
         stopEating();
         return true;
     }
 
-    Tile* tempTile = tempRoom->getCoveredTile(Random::Uint(0, tempRoom->numCoveredTiles() - 1));
+    Tile* tempTile = tempRoom->getCoveredTile(mRandom.Uint(0, tempRoom->numCoveredTiles() - 1));
     std::list<Tile*> tempPath = getGameMap()->path(this, tempTile);
     if (tempPath.size() < maxDistance && setWalkPath(tempPath, 2, false))
     {
@@ -2349,12 +2195,12 @@ bool Creature::handleFleeAction(const CreatureAction& actionItem)
     }
 
     // We try to go closer to the dungeon temple. If we are too near or if we cannot go there, we will flee randomly
-    std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::dungeonTemple, getSeat());
-    tempRooms = getGameMap()->getReachableRooms(tempRooms, getPositionTile(), this);
+    std::vector<Room*> tempRooms = getGameMap()->getReachableRooms(
+        getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::dungeonTemple, getSeat()), getPositionTile(), this);
     if(!tempRooms.empty())
     {
         // We can go to one dungeon temple
-        Room* room = tempRooms[Random::Int(0, tempRooms.size() - 1)];
+        Room* room = tempRooms[mRandom.Int(0, tempRooms.size() - 1)];
         Tile* tile = room->getCoveredTile(0);
         std::list<Tile*> result = getGameMap()->path(this, tile);
         // If we are not too near from the dungeon temple, we go there
@@ -2439,7 +2285,7 @@ bool Creature::handleCarryableEntities(const CreatureAction& actionItem)
                 return true;
             }
 
-            uint32_t index = Random::Uint(0,availableEntities.size()-1);
+            uint32_t index = mRandom.Uint(0,availableEntities.size()-1);
             GameEntity* entity = availableEntities[index];
             Tile* t = entity->getPositionTile();
             OD_ASSERT_TRUE_MSG(t != nullptr, "entity=" + entity->getName());
@@ -2519,12 +2365,12 @@ bool Creature::handleGetFee(const CreatureAction& actionItem)
     }
 
     // We try to go to some treasury were there is still some gold
-    std::vector<Room*> tempRooms = getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat());
-    tempRooms = getGameMap()->getReachableRooms(tempRooms, getPositionTile(), this);
+    std::vector<Room*> tempRooms = getGameMap()->getReachableRooms(
+        getGameMap()->getRoomsByTypeAndSeat(Room::RoomType::treasury, getSeat()), getPositionTile(), this);
     while(!tempRooms.empty())
     {
         // We can go to one treasury
-        int index = Random::Int(0, tempRooms.size() - 1);
+        int index = mRandom.Int(0, tempRooms.size() - 1);
         Room* room = tempRooms[index];
         tempRooms.erase(tempRooms.begin() + index);
         RoomTreasury* treasury = static_cast<RoomTreasury*>(room);
@@ -2579,7 +2425,7 @@ double Creature::getPhysicalDamage(double range)
     double hitroll = 0.0;
 
     if (mWeaponlessAtkRange >= range)
-        hitroll += Random::Uint(1.0, mPhysicalAttack);
+        hitroll += mRandom.Uint(1.0, mPhysicalAttack);
 
     if (mWeaponL != nullptr && mWeaponL->getRange() >= range)
         hitroll += mWeaponL->getPhysicalDamage();
@@ -2594,7 +2440,7 @@ double Creature::getMagicalDamage(double range)
     double hitroll = 0.0;
 
     if (mWeaponlessAtkRange >= range)
-        hitroll += Random::Uint(0.0, mMagicalAttack);
+        hitroll += mRandom.Uint(0.0, mMagicalAttack);
 
     if (mWeaponL != nullptr && mWeaponL->getRange() >= range)
         hitroll += mWeaponL->getMagicalDamage();
@@ -2673,7 +2519,7 @@ void Creature::updateTilesInSight()
     mTilesWithinSightRadius = getGameMap()->circularRegion(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
 
     // Only the tiles the creature can "see".
-    mVisibleTiles = getGameMap()->visibleTiles(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
+    getGameMap()->visibleTiles(posTile->getX(), posTile->getY(), mDefinition->getSightRadius(), mVisibleTiles);
 }
 
 std::vector<GameEntity*> Creature::getVisibleEnemyObjects()
@@ -2734,24 +2580,26 @@ std::vector<GameEntity*> Creature::getVisibleAlliedObjects()
 void Creature::updateVisibleMarkedTiles()
 {
     mVisibleMarkedTiles.clear();
+    Tile* posTile = getPositionTile();
+    if ((posTile == nullptr) || (getSeat() == nullptr))
+        return;
+
     Player *player = getGameMap()->getPlayerBySeat(getSeat());
     if (player == nullptr)
         return;
 
-    // Loop over all the visible tiles.
-    for (Tile* tile : mTilesWithinSightRadius)
+    // The task board gives the marked tiles within sight without looking at every tile in sight
+    std::vector<uint32_t> markedTiles;
+    getSeat()->getWorkerTaskBoard().fillTasksInRadius(WorkerTaskBoard::TaskType::dig,
+        posTile->getX(), posTile->getY(), mDefinition->getSightRadius(), markedTiles);
+    for (uint32_t index : markedTiles)
     {
-        // Check to see whether the tile is marked for digging
-        if (tile == nullptr || !tile->getMarkedForDigging(player))
-            continue;
+        Tile* tile = getGameMap()->getTile(index / getGameMap()->getMapSizeY(), index % getGameMap()->getMapSizeY());
 
-        // and can be reached by the creature
+        // Check that the tile can be reached by the creature
         for (Tile* neighborTile : tile->getAllNeighbors())
         {
-            if (neighborTile == nullptr)
-                continue;
-
-            if (getGameMap()->pathExists(this, getPositionTile(), neighborTile))
+            if (getGameMap()->pathExists(this, posTile, neighborTile))
             {
                 mVisibleMarkedTiles.push_back(tile);
                 break;
@@ -2760,36 +2608,88 @@ void Creature::updateVisibleMarkedTiles()
     }
 }
 
-std::vector<Tile*> Creature::getVisibleClaimableWallTiles()
+Tile* Creature::reserveWorkerTask(WorkerTaskBoard::TaskType type)
 {
-    std::vector<Tile*> claimableWallTiles;
+    Tile* posTile = getPositionTile();
+    Seat* seat = getSeat();
+    if ((posTile == nullptr) || (seat == nullptr))
+        return nullptr;
+
+    Player* player = getGameMap()->getPlayerBySeat(seat);
+    if ((type == WorkerTaskBoard::TaskType::dig) && (player == nullptr))
+        return nullptr;
 
-    // Loop over all the visible tiles.
-    for (Tile* tile : mTilesWithinSightRadius)
+    // The board is refreshed once per turn so the tasks are checked again before being reserved.
+    // Ground tiles are claimed by standing on them, walls are dug or claimed from the closest
+    // reachable neighbor
+    GameMap* gameMap = getGameMap();
+    Tile* destination = nullptr;
+    auto isValid = [&](int x, int y) -> bool
     {
-        // Check to see whether the tile is a claimable wall
-        if (tile == nullptr || !tile->isWallClaimable(getSeat()))
-            continue;
+        Tile* tile = gameMap->getTile(x, y);
+        switch(type)
+        {
+            case WorkerTaskBoard::TaskType::dig:
+                if (!tile->getMarkedForDigging(player))
+                    return false;
+                break;
+            case WorkerTaskBoard::TaskType::claimGround:
+                if (!tile->canWorkerClaimGround(seat))
+                    return false;
+                if (!gameMap->pathExists(this, posTile, tile))
+                    return false;
+                destination = tile;
+                return true;
+            case WorkerTaskBoard::TaskType::claimWall:
+                if (!tile->isWallClaimable(seat))
+                    return false;
+                break;
+            default:
+                return false;
+        }
 
-        // and can be reached by the creature
+        int bestDistance = 0;
+        destination = nullptr;
         for (Tile* neighborTile : tile->getAllNeighbors())
         {
-            if (neighborTile == nullptr)
+            if (!gameMap->pathExists(this, posTile, neighborTile))
                 continue;
 
-            if (getGameMap()->pathExists(this, getPositionTile(), neighborTile))
-            {
-                claimableWallTiles.push_back(tile);
-                break;
-            }
+            int diffX = neighborTile->getX() - posTile->getX();
+            int diffY = neighborTile->getY() - posTile->getY();
+            int distance = diffX * diffX + diffY * diffY;
+            if ((destination != nullptr) && (distance >= bestDistance))
+                continue;
+
+            destination = neighborTile;
+            bestDistance = distance;
         }
+        return destination != nullptr;
+    };
+
+    int64_t turn = gameMap->getTurnNumber();
+    int taskX;
+    int taskY;
+    if (!seat->getWorkerTaskBoard().reserveNearestTask(type, posTile->getX(), posTile->getY(),
+        mDefinition->getSightRadius(), getHandle(), turn, turn + WORKER_TASK_RESERVATION_TURNS,
+        isValid, taskX, taskY))
+    {
+        return nullptr;
     }
 
-    return claimableWallTiles;
+    return destination;
 }
 
 std::vector<GameEntity*> Creature::getVisibleForce(Seat* seat, bool invert)
 {
+    // The visible tiles are all within sight radius of the first one (where the creature was when
+    // they were computed). If no chunk around has a matching entity, there is nothing to look for
+    if(mVisibleTiles.empty() ||
+       !getGameMap()->isForcePossiblyInRadius(mVisibleTiles.front(), mDefinition->getSightRadius(), seat, invert))
+    {
+        return std::vector<GameEntity*>();
+    }
+
     return getGameMap()->getVisibleForce(mVisibleTiles, seat, invert);
 }
 
@@ -2805,8 +2705,8 @@ void Creature::computeVisualDebugEntities()
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotification::refreshCreatureVisDebug, nullptr);
 
-    const std::string& name = getName();
-    serverNotification->mPacket << name;
+    uint32_t handle = getHandle();
+    serverNotification->mPacket << handle;
     serverNotification->mPacket << true;
     if(getIsOnMap())
     {
@@ -2868,8 +2768,8 @@ void Creature::stopComputeVisualDebugEntities()
 
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotification::refreshCreatureVisDebug, nullptr);
-    const std::string& name = getName();
-    serverNotification->mPacket << name;
+    uint32_t handle = getHandle();
+    serverNotification->mPacket << handle;
     serverNotification->mPacket << false;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
@@ -2930,8 +2830,8 @@ void Creature::createStatsWindow()
 
     ClientNotification *clientNotification = new ClientNotification(
         ClientNotification::askCreatureInfos);
-    std::string name = getName();
-    clientNotification->mPacket << name << true;
+    uint32_t handle = getHandle();
+    clientNotification->mPacket << handle << true;
     ODClient::getSingleton().queueClientNotification(clientNotification);
 
     CEGUI::WindowManager* wmgr = CEGUI::WindowManager::getSingletonPtr();
@@ -2969,8 +2869,8 @@ void Creature::destroyStatsWindow()
     {
         ClientNotification *clientNotification = new ClientNotification(
             ClientNotification::askCreatureInfos);
-        std::string name = getName();
-        clientNotification->mPacket << name << false;
+        uint32_t handle = getHandle();
+        clientNotification->mPacket << handle << false;
         ODClient::getSingleton().queueClientNotification(clientNotification);
 
         mStatsWindow->destroy();
@@ -3420,7 +3320,7 @@ bool Creature::wanderRandomly(const std::string& animationState)
     if (reachableTiles.empty())
         return false;
 
-    Tile* tileDestination = reachableTiles[Random::Uint(0, reachableTiles.size() - 1)];
+    Tile* tileDestination = reachableTiles[mRandom.Uint(0, reachableTiles.size() - 1)];
 
     std::list<Tile*> result = getGameMap()->path(this, tileDestination);
     if (setWalkPath(result, 1, false))
@@ -3534,8 +3434,9 @@ void Creature::releaseCarriedEntity()
 
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotification::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << carriedEntity->getObjectType();
-        serverNotification->mPacket << carriedEntity->getName();
+        uint32_t handle = getHandle();
+        uint32_t carriedHandle = carriedEntity->getHandle();
+        serverNotification->mPacket << handle << carriedHandle;
         serverNotification->mPacket << mPosition;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
@@ -3631,8 +3532,9 @@ void Creature::fireAddEntity(Seat* seat, bool async)
 
             serverNotification = new ServerNotification(
                 ServerNotification::carryEntity, seat->getPlayer());
-            serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-            serverNotification->mPacket << mCarriedEntity->getName();
+            uint32_t handle = getHandle();
+            uint32_t carriedHandle = mCarriedEntity->getHandle();
+            serverNotification->mPacket << handle << carriedHandle;
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
 
@@ -3646,18 +3548,19 @@ void Creature::fireRemoveEntity(Seat* seat)
     {
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotification::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-        serverNotification->mPacket << mCarriedEntity->getName();
+        uint32_t handle = getHandle();
+        uint32_t carriedHandle = mCarriedEntity->getHandle();
+        serverNotification->mPacket << handle << carriedHandle;
         serverNotification->mPacket << mPosition;
         ODServer::getSingleton().queueServerNotification(serverNotification);
 
         mCarriedEntity->removeSeatWithVision(seat);
     }
 
-    const std::string& name = getName();
+    uint32_t handle = getHandle();
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotification::removeCreature, seat->getPlayer());
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << handle;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
@@ -3670,10 +3573,10 @@ void Creature::fireCreatureRefresh()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t handle = getHandle();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotification::creatureRefresh, seat->getPlayer());
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << handle;
         serverNotification->mPacket << mLevel;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
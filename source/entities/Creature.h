@@ -26,6 +26,10 @@
 #include "entities/CreatureAction.h"
 #include "entities/MovableGameEntity.h"
 
+#include "game/WorkerTaskBoard.h"
+
+#include "utils/Random.h"
+
 #include <OgreVector2.h>
 #include <OgreVector3.h>
 #include <CEGUI/EventArgs.h>
@@ -89,6 +93,11 @@ public:
 
     double getHP() const;
 
+    //! \brief Returns true once the death of the creature has been processed by doUpkeep. It then lays
+    //! dead on the ground until it is removed from the map.
+    inline bool isDead() const
+    { return mDeathCounter > 0; }
+
     //! \brief Gets the maximum HP the creature can have currently
     double getMaxHp()const
     { return mMaxHP; }
@@ -180,7 +189,14 @@ public:
      */
     void doUpkeep();
 
-    //! \brief Computes the visible tiles and tags them to know which are visible
+    /*! \brief Computes the visible tiles and the objects the creature can see and reach.
+     * It is called for every creature at the beginning of the turn before any of them acts. It
+     * only reads the game map and modifies this creature so it can be called for different
+     * creatures from several threads at the same time.
+     */
+    void senseSurroundings();
+
+    //! \brief Tags the tiles computed by senseSurroundings to know which are visible
     void computeVisibleTiles();
 
     virtual bool isAttackable(Tile* tile, Seat* seat) const;
@@ -216,11 +232,12 @@ public:
     //! \brief Loops over the visibleTiles and adds all allied creatures in each tile to a list which it returns.
     std::vector<GameEntity*> getVisibleAlliedObjects();
 
-    //! \brief Loops over the visibleTiles and updates any which are marked for digging, and are reachable.
+    //! \brief Updates the tiles within sight which are marked for digging by the seat, and are reachable.
     void updateVisibleMarkedTiles();
 
-    //! \brief Loops over the visibleTiles and adds any which are claimable walls.
-    std::vector<Tile*> getVisibleClaimableWallTiles();
+    //! \brief Reserves in the seat task board the closest reachable task of the given type within sight. Returns
+    //! the tile to walk to in order to work on it or nullptr if there is none.
+    Tile* reserveWorkerTask(WorkerTaskBoard::TaskType type);
 
     //! \brief Loops over the visibleTiles and returns any creatures in those tiles
     //! allied with the given seat (or if invert is true, does not allied)
@@ -332,6 +349,11 @@ public:
 
     void itsPayDay();
 
+    //! \brief The generator the creature draws its decisions from. On server side, it is seeded from
+    //! the creature handle when the creature is added to the game map
+    inline RandomGenerator& getRandom()
+    { return mRandom; }
+
 protected:
     virtual void createMeshLocal();
     virtual void destroyMeshLocal();
@@ -441,6 +463,8 @@ private:
 
     Ogre::Vector3                   mScale;
 
+    RandomGenerator                 mRandom;
+
     //! \brief The logic in the idle function is basically to roll a dice and, if the value allows, push an action to test if
     //! it is possible. To avoid testing several times the same action, we check in mActionTry if the action as already been
     //! tried. If yes and forcePush is false, the action won't be pushed and pushAction will return false. If the action has
@@ -553,6 +577,10 @@ private:
     void carryEntity(MovableGameEntity* carriedEntity);
 
     void releaseCarriedEntity();
+
+    //! \brief Removes from the lists computed by senseSurroundings the objects killed or removed
+    //! from the map and the tiles that have been dug by the creatures that acted before this one.
+    void dropOutdatedSensedObjects();
 };
 
 #endif // CREATURE_H
@@ -69,7 +69,8 @@ class GameEntity
     mGameMap           (gameMap),
     mIsOnMap           (true),
     mParentSceneNode   (nullptr),
-    mEntityNode        (nullptr)
+    mEntityNode        (nullptr),
+    mHandle            (0)
     {
         assert(mGameMap != nullptr);
     }
@@ -83,6 +84,10 @@ class GameEntity
     inline const std::string& getName() const
     { return mName; }
 
+    //! \brief Get the handle of the object in the game map registry (see EntityRegistry). 0 if it has none
+    inline uint32_t getHandle() const
+    { return mHandle; }
+
     //! \brief Get the mesh name of the object
     inline const std::string& getMeshName() const
     { return mMeshName; }
@@ -124,12 +129,17 @@ class GameEntity
     inline void setName(const std::string& name)
     { mName = name; }
 
+    //! \brief Set the handle of the object. Should only be done by the game map or when reading
+    //! the object from the server
+    inline void setHandle(uint32_t handle)
+    { mHandle = handle; }
+
     //! \brief Set the name of the mesh file
     inline void setMeshName(const std::string& meshName)
     { mMeshName = meshName; }
 
     //! \brief Sets the seat this object belongs to
-    inline void setSeat(Seat* seat)
+    virtual void setSeat(Seat* seat)
     { mSeat = seat; }
 
     //! \brief Set if the mesh exists
@@ -277,6 +287,9 @@ class GameEntity
 
     //! Used by the renderer to save this entity's node
     Ogre::SceneNode* mEntityNode;
+
+    //! \brief Handle given by the server game map. It is the same on the server and on the clients
+    uint32_t mHandle;
 };
 
 #endif // GAMEENTITY_H_
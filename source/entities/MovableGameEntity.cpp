@@ -55,10 +55,10 @@ void MovableGameEntity::setMoveSpeed(double s)
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t handle = getHandle();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotification::setMoveSpeed, seat->getPlayer());
-        serverNotification->mPacket << name << s;
+        serverNotification->mPacket << handle << s;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
@@ -79,10 +79,10 @@ void MovableGameEntity::addDestination(Ogre::Real x, Ogre::Real y, Ogre::Real z)
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t handle = getHandle();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotification::animatedObjectAddDestination, seat->getPlayer());
-        serverNotification->mPacket << name << destination;
+        serverNotification->mPacket << handle << destination;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
@@ -135,10 +135,10 @@ void MovableGameEntity::clearDestinations()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t handle = getHandle();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotification::animatedObjectClearDestinations, seat->getPlayer());
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << handle;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
@@ -380,8 +380,8 @@ void MovableGameEntity::fireObjectAnimationState(const std::string& state, bool
 
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotification::setObjectAnimationState, seat->getPlayer());
-        const std::string& name = getName();
-        serverNotification->mPacket << name << state << loop;
+        uint32_t handle = getHandle();
+        serverNotification->mPacket << handle << state << loop;
         if(direction != Ogre::Vector3::ZERO)
             serverNotification->mPacket << true << direction;
         else if(mWalkDirection != Ogre::Vector3::ZERO)
@@ -395,8 +395,7 @@ void MovableGameEntity::fireObjectAnimationState(const std::string& state, bool
 void MovableGameEntity::firePickupEntity(Player* playerPicking, bool isEditorMode)
 {
     int seatId = playerPicking->getSeat()->getId();
-    GameEntity::ObjectType entityType = getObjectType();
-    const std::string& entityName = getName();
+    uint32_t handle = getHandle();
     for(std::vector<Seat*>::iterator it = mSeatsWithVisionNotified.begin(); it != mSeatsWithVisionNotified.end();)
     {
         Seat* seat = *it;
@@ -426,14 +425,14 @@ void MovableGameEntity::firePickupEntity(Player* playerPicking, bool isEditorMod
         {
             ServerNotification serverNotification(
                 ServerNotification::entityPickedUp, seat->getPlayer());
-            serverNotification.mPacket << isEditorMode << seatId << entityType << entityName;
+            serverNotification.mPacket << isEditorMode << seatId << handle;
             ODServer::getSingleton().sendAsyncMsg(serverNotification);
         }
         else
         {
             ServerNotification* serverNotification = new ServerNotification(
                 ServerNotification::entityPickedUp, seat->getPlayer());
-            serverNotification->mPacket << isEditorMode << seatId << entityType << entityName;
+            serverNotification->mPacket << isEditorMode << seatId << handle;
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
     }
@@ -498,6 +497,9 @@ void MovableGameEntity::importFromStream(std::istream& is)
 
 void MovableGameEntity::exportToPacket(ODPacket& os) const
 {
+    // The client registers the entity with the same handle so that the next messages can use it
+    uint32_t handle = getHandle();
+    os << handle;
     os << mMoveSpeed;
     os << mPrevAnimationState;
     os << mPrevAnimationStateLoop;
@@ -515,6 +517,9 @@ void MovableGameEntity::exportToPacket(ODPacket& os) const
 
 void MovableGameEntity::importFromPacket(ODPacket& is)
 {
+    uint32_t handle;
+    OD_ASSERT_TRUE(is >> handle);
+    setHandle(handle);
     OD_ASSERT_TRUE(is >> mMoveSpeed);
     OD_ASSERT_TRUE(is >> mPrevAnimationState);
     OD_ASSERT_TRUE(is >> mPrevAnimationStateLoop);
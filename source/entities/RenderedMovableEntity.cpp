@@ -107,8 +107,8 @@ void RenderedMovableEntity::setMeshOpacity(float opacity)
 
             ServerNotification* serverNotification = new ServerNotification(
                 ServerNotification::setEntityOpacity, seat->getPlayer());
-            const std::string& name = getName();
-            serverNotification->mPacket << name << opacity;
+            uint32_t handle = getHandle();
+            serverNotification->mPacket << handle << opacity;
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
         return;
@@ -153,8 +153,8 @@ void RenderedMovableEntity::fireRemoveEntity(Seat* seat)
 {
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotification::removeRenderedMovableEntity, seat->getPlayer());
-    const std::string& name = getName();
-    serverNotification->mPacket << name;
+    uint32_t handle = getHandle();
+    serverNotification->mPacket << handle;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
@@ -67,7 +67,9 @@ Tile::Tile(GameMap* gameMap, int x, int y, TileType type, double fullness) :
     mScale              (Ogre::Vector3::ZERO),
     mIsBuilding         (false),
     mLocalPlayerHasVision   (false),
-    mLocalPlayerCanMarkTile (true)
+    mLocalPlayerCanMarkTile (true),
+    mIsMarkedDirty          (false),
+    mIsWorkerTaskDirty      (false)
 {
     for(int i = 0; i < Tile::FloodFillTypeMax; i++)
     {
@@ -104,10 +106,42 @@ void Tile::setType(TileType t)
     // the mesh should be updated
     if (t != mType)
     {
+        Seat* previousSeat = getClaimedTileSeat();
         mType = t;
+        updateClaimedTileCount(previousSeat);
+        getGameMap()->tilePassabilityChanged(this);
+        getGameMap()->markWorkerTasksDirty(this);
     }
 }
 
+void Tile::setSeat(Seat* seat)
+{
+    Seat* previousSeat = getClaimedTileSeat();
+    GameEntity::setSeat(seat);
+    updateClaimedTileCount(previousSeat);
+}
+
+Seat* Tile::getClaimedTileSeat() const
+{
+    if(mType != claimed)
+        return nullptr;
+
+    return getSeat();
+}
+
+void Tile::updateClaimedTileCount(Seat* previousSeat)
+{
+    Seat* seat = getClaimedTileSeat();
+    if(seat == previousSeat)
+        return;
+
+    if(previousSeat != nullptr)
+        previousSeat->getLedger().removeClaimedTile();
+
+    if(seat != nullptr)
+        seat->getLedger().addClaimedTile();
+}
+
 void Tile::setFullness(double f)
 {
     double oldFullness = getFullness();
@@ -126,6 +160,12 @@ void Tile::setFullness(double f)
         getGameMap()->refreshFloodFill(this);
     }
 
+    if ((oldFullness > 0.0) != (mFullness > 0.0))
+    {
+        getGameMap()->tilePassabilityChanged(this);
+        getGameMap()->markWorkerTasksDirty(this);
+    }
+
     // 		4 0 7		    180
     // 		2 8 3		270  .  90
     // 		7 1 5		     0
@@ -413,7 +453,15 @@ bool Tile::isBuildableUpon() const
 
 void Tile::setCoveringBuilding(Building *building)
 {
+    if(mCoveringBuilding != nullptr)
+        getGameMap()->indexBuildingOnTile(mCoveringBuilding, this, false);
+
     mCoveringBuilding = building;
+    if(mCoveringBuilding != nullptr)
+        getGameMap()->indexBuildingOnTile(mCoveringBuilding, this, true);
+
+    getGameMap()->invalidateDistanceFields();
+    getGameMap()->markWorkerTasksDirty(this);
 
     if (mCoveringBuilding == nullptr)
     {
@@ -429,6 +477,7 @@ void Tile::setCoveringBuilding(Building *building)
 
         seatChanged.second = true;
     }
+    getGameMap()->markTileDirty(this);
 
     mIsBuilding = true;
     // Set the tile as claimed and of the team color of the building
@@ -474,6 +523,24 @@ bool Tile::isGroundClaimable() const
         && getCoveringRoom() == nullptr);
 }
 
+bool Tile::canWorkerClaimGround(Seat* seat) const
+{
+    if (!isGroundClaimable())
+        return false;
+
+    if (isClaimedForSeat(seat) && mClaimedPercentage >= 1.0)
+        return false;
+
+    for (Tile* tile : mNeighbors)
+    {
+        if (tile->getFullness() == 0.0 && tile->isClaimedForSeat(seat)
+                && tile->getClaimedPercentage() >= 1.0)
+            return true;
+    }
+
+    return false;
+}
+
 bool Tile::isWallClaimable(Seat* seat)
 {
     if (getFullness() == 0.0)
@@ -1004,6 +1071,9 @@ void Tile::setMarkedForDigging(bool ss, Player *pp)
         addPlayerMarkingTile(pp);
     else
         removePlayerMarkingTile(pp);
+
+    if(getGameMap()->isServerGameMap() && (pp->getSeat() != nullptr))
+        pp->getSeat()->getWorkerTaskBoard().setTask(WorkerTaskBoard::TaskType::dig, mX, mY, ss);
 }
 
 void Tile::setSelected(bool ss, Player* pp)
@@ -1048,6 +1118,8 @@ bool Tile::addEntity(GameEntity *entity)
         return false;
 
     mEntitiesInTile.push_back(entity);
+    getGameMap()->indexEntityOnTile(entity, this, true);
+    getGameMap()->markTileDirty(this);
     return true;
 }
 
@@ -1061,6 +1133,8 @@ bool Tile::removeEntity(GameEntity *entity)
         return false;
 
     mEntitiesInTile.erase(it);
+    getGameMap()->indexEntityOnTile(entity, this, false);
+    getGameMap()->markTileDirty(this);
     return true;
 }
 
@@ -1095,6 +1169,9 @@ void Tile::addNeighbor(Tile *n)
 
 void Tile::claimForSeat(Seat* seat, double nDanceRate)
 {
+    Seat* oldSeat = getSeat();
+    bool wasFullyClaimed = (mClaimedPercentage >= 1.0);
+
     // If the seat is allied, we add to it. If it is an enemy seat, we subtract from it.
     if (getSeat() != nullptr && getSeat()->isAlliedSeat(seat))
     {
@@ -1120,6 +1197,10 @@ void Tile::claimForSeat(Seat* seat, double nDanceRate)
         claimTile(seat);
     }
 
+    // The tile can become a task (or stop being one) for the old and the new seat as well as its neighbors
+    if ((getSeat() != oldSeat) || ((mClaimedPercentage >= 1.0) != wasFullyClaimed))
+        getGameMap()->markWorkerTasksDirty(this);
+
     /*
     // TODO: This should rather add lights along claimed walls, and not on every walls. Maybe each 5 ones?
     // If this is the first time this tile has been claimed, emit a flash of light indicating that the tile was claimed.
@@ -1150,6 +1231,7 @@ void Tile::claimTile(Seat* seat)
     setMarkedForDiggingForAllPlayersExcept(false, seat);
 
     setDirtyForAllSeats();
+    getGameMap()->markWorkerTasksDirty(this);
 
     // Force all the neighbors to recheck their meshes as we have updated this tile.
     for (Tile* tile : mNeighbors)
@@ -1243,51 +1325,6 @@ bool Tile::checkTileName(const std::string& tileName, int& x, int& y)
     return true;
 }
 
-bool Tile::isFloodFillFilled()
-{
-    if(getFullness() > 0.0)
-        return true;
-
-    switch(getType())
-    {
-        case Tile::dirt:
-        case Tile::gold:
-        case Tile::claimed:
-        {
-            if((mFloodFillColor[Tile::FloodFillTypeGround] != -1) &&
-               (mFloodFillColor[Tile::FloodFillTypeGroundWater] != -1) &&
-               (mFloodFillColor[Tile::FloodFillTypeGroundLava] != -1) &&
-               (mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-            {
-                return true;
-            }
-            break;
-        }
-        case Tile::water:
-        {
-            if((mFloodFillColor[Tile::FloodFillTypeGroundWater] != -1) &&
-               (mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-            {
-                return true;
-            }
-            break;
-        }
-        case Tile::lava:
-        {
-            if((mFloodFillColor[Tile::FloodFillTypeGroundLava] != -1) &&
-               (mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-            {
-                return true;
-            }
-            break;
-        }
-        default:
-            return true;
-    }
-
-    return false;
-}
-
 bool Tile::isClaimedForSeat(Seat* seat) const
 {
     Seat* tileSeat = getSeat();
@@ -1462,7 +1499,10 @@ bool Tile::addTreasuryObject(TreasuryObject* obj)
     }
 
     if(!isMerged)
+    {
         mEntitiesInTile.push_back(obj);
+        getGameMap()->indexEntityOnTile(obj, this, true);
+    }
 
     return true;
 }
@@ -1521,15 +1561,13 @@ void Tile::clearVision()
 
 void Tile::notifyVision(Seat* seat)
 {
-    if(std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat) != mSeatsWithVision.end())
-        return;
-
+    // The allied seats will get the vision when the seats merge their vision
     seat->notifyVisionOnTile(this);
-    mSeatsWithVision.push_back(seat);
+}
 
-    // We also notify vision for allied seats
-    for(Seat* alliedSeat : seat->getAlliedSeats())
-        notifyVision(alliedSeat);
+void Tile::addSeatWithVision(Seat* seat)
+{
+    mSeatsWithVision.push_back(seat);
 }
 
 void Tile::setSeats(const std::vector<Seat*>& seats)
@@ -1575,6 +1613,8 @@ void Tile::setDirtyForAllSeats()
 
     for(std::pair<Seat*, bool>& seatChanged : mTileChangedForSeats)
         seatChanged.second = true;
+
+    getGameMap()->markTileDirty(this);
 }
 
 void Tile::notifySeatsWithVision()
@@ -1601,6 +1641,7 @@ bool Tile::registerPersistentObject(PersistentObject* obj)
 
             seatChanged.second = true;
         }
+        getGameMap()->markTileDirty(this);
     }
 
     return true;
@@ -84,6 +84,9 @@ public:
         return mType;
     }
 
+    //! \brief Sets the seat owning the tile and updates the claimed tiles count of the old and the new seat.
+    virtual void setSeat(Seat* seat);
+
     /*! \brief A mutator to change how "filled in" the tile is.
      *
      * Additionally this function reloads the proper mesh to display to the user
@@ -217,6 +220,10 @@ public:
     //! \brief Tells whether the tile fullness is empty (ground tile) and can be claimed.
     bool isGroundClaimable() const;
 
+    //! \brief Tells whether a worker of the given seat can claim this ground tile: it is claimable, not
+    //! already fully claimed for the seat, and next to a tile fully claimed for the seat.
+    bool canWorkerClaimGround(Seat* seat) const;
+
     //! \brief Tells whether the tile is a wall (fullness > 1) and can be claimed for the given seat.
     //! Reinforced walls by another team and hard rocks can't be claimed.
     bool isWallClaimable(Seat* seat);
@@ -313,6 +320,10 @@ public:
     void clearVision();
     void notifyVision(Seat* seat);
 
+    //! \brief Called by the seats having vision on this tile once their vision is computed. A seat
+    //! should be added only once per turn
+    void addSeatWithVision(Seat* seat);
+
     void setSeats(const std::vector<Seat*>& seats);
     bool hasChangedForSeat(Seat* seat) const;
     void changeNotifiedForSeat(Seat* seat);
@@ -333,8 +344,6 @@ protected:
     virtual void createMeshLocal();
     virtual void destroyMeshLocal();
 private:
-    bool isFloodFillFilled();
-
     enum FloodFillType
     {
         FloodFillTypeGround = 0,
@@ -390,6 +399,13 @@ private:
     //! It allows to know if the tile can be marked for digging by the local player.
     bool mLocalPlayerCanMarkTile;
 
+    //! \brief Used on server side. true if the tile is in the GameMap dirty tiles list.
+    bool mIsMarkedDirty;
+
+    //! \brief Used on server side. true if the tile is in the GameMap list of tiles whose worker tasks
+    //! should be refreshed.
+    bool mIsWorkerTaskDirty;
+
     /*! \brief Set the fullness value for the tile.
      *  This only sets the fullness variable. This function is here to change the value
      *  before a map object has been set. setFullness is called once a map is assigned.
@@ -399,6 +415,13 @@ private:
     int getFloodFill(FloodFillType type);
 
     void setDirtyForAllSeats();
+
+    //! \brief Returns the seat whose claimed tiles count includes this tile, nullptr if the tile is not claimed.
+    Seat* getClaimedTileSeat() const;
+
+    //! \brief Moves the tile from the claimed tiles count of previousSeat to the one of its current
+    //! claimed tile seat (see getClaimedTileSeat) if they differ.
+    void updateClaimedTileCount(Seat* previousSeat);
 };
 
 #endif // TILE_H
@@ -62,6 +62,11 @@ void TrapEntity::seatSawTriggering(Seat* seat)
         return;
 
     mSeatsNotHidden.push_back(seat);
+
+    // The seats seeing the trap have to be notified again
+    Tile* tile = getPositionTile();
+    if(tile != nullptr)
+        getGameMap()->markTileDirty(tile);
 }
 
 void TrapEntity::notifySeatsWithVision(const std::vector<Seat*>& seats)
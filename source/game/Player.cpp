@@ -232,7 +232,7 @@ void Player::notifyNoMoreDungeonTemple()
     mIsPlayerLostSent = true;
     // We check if there is still a player in the team with a dungeon temple. If yes, we notify the player he lost his dungeon
     // if no, we notify the team they lost
-    std::vector<Room*> dungeonTemples = mGameMap->getRoomsByType(Room::RoomType::dungeonTemple);
+    const std::vector<Room*>& dungeonTemples = mGameMap->getRoomsByType(Room::RoomType::dungeonTemple);
     bool hasTeamLost = true;
     for(Room* dungeonTemple : dungeonTemples)
     {
@@ -60,20 +60,11 @@ Seat::Seat(GameMap* gameMap) :
 
 void Seat::setMapSize(int x, int y)
 {
-    if(mPlayer == nullptr)
-        return;
-    if(!mPlayer->getIsHuman())
-        return;
-
-    mTilesVision = std::vector<std::vector<std::pair<bool, bool>>>(x);
-    for(int xxx = 0; xxx < x; ++xxx)
-    {
-        mTilesVision[xxx] = std::vector<std::pair<bool, bool>>(y);
-        for(int yyy = 0; yyy < y; ++yyy)
-        {
-            mTilesVision[xxx][yyy] = std::pair<bool, bool>(false, false);
-        }
-    }
+    // Every seat needs its own vision (even AI ones) because allied seats share their vision
+    mTilesVisionOwn.setMapSize(x, y);
+    mTilesVision.setMapSize(x, y);
+    mTilesVisionPrevious.setMapSize(x, y);
+    mWorkerTaskBoard.setMapSize(x, y);
 }
 
 void Seat::setTeamId(int teamId)
@@ -145,16 +136,6 @@ unsigned int Seat::getNumClaimedTiles()
     return mNumClaimedTiles;
 }
 
-void Seat::setNumClaimedTiles(const unsigned int& num)
-{
-    mNumClaimedTiles = num;
-}
-
-void Seat::incrementNumClaimedTiles()
-{
-    ++mNumClaimedTiles;
-}
-
 unsigned int Seat::checkAllGoals()
 {
     // Loop over the goals vector and move any goals that have been met to the completed goals vector.
@@ -375,7 +356,7 @@ const CreatureDefinition* Seat::getNextCreatureClassToSpawn()
         return nullptr;
 
     // We choose randomly a creature to spawn according to their points
-    int32_t cpt = Random::Int(0, nbPointsTotal);
+    int32_t cpt = mRandom.Int(0, nbPointsTotal);
     for(std::pair<const CreatureDefinition*, int32_t>& def : defSpawnable)
     {
         if(cpt < def.second)
@@ -389,34 +370,57 @@ const CreatureDefinition* Seat::getNextCreatureClassToSpawn()
     return nullptr;
 }
 
+Tile* Seat::getTileFromVisionCell(uint32_t cell) const
+{
+    int mapSizeY = mTilesVision.getMapSizeY();
+    return mGameMap->getTile(cell / mapSizeY, cell % mapSizeY);
+}
+
 void Seat::clearTilesWithVision()
 {
-    if(mPlayer == nullptr)
-        return;
-    if(!mPlayer->getIsHuman())
+    if(mTilesVision.isEmpty())
         return;
 
-    for(std::vector<std::pair<bool, bool>>& vec : mTilesVision)
-    {
-        for(std::pair<bool, bool>& p : vec)
-        {
-            p.first = p.second;
-            p.second = false;
-        }
-    }
+    mTilesVision.swap(mTilesVisionPrevious);
+    mTilesVision.clear();
+    mTilesVisionOwn.clear();
+
+    // Only the tiles seen during the last turn have seats with vision to clear
+    mTilesVisionPrevious.fillSetCells(mVisionCells);
+    for(uint32_t cell : mVisionCells)
+        getTileFromVisionCell(cell)->clearVision();
 }
 
 void Seat::notifyVisionOnTile(Tile* tile)
 {
-    if(mPlayer == nullptr)
+    if(mTilesVisionOwn.isEmpty())
         return;
-    if(!mPlayer->getIsHuman())
+
+    OD_ASSERT_TRUE_MSG(tile->getX() < mGameMap->getMapSizeX(), "Tile=" + Tile::displayAsString(tile));
+    OD_ASSERT_TRUE_MSG(tile->getY() < mGameMap->getMapSizeY(), "Tile=" + Tile::displayAsString(tile));
+    mTilesVisionOwn.set(tile->getX(), tile->getY());
+}
+
+void Seat::computeTilesWithVision()
+{
+    if(mTilesVision.isEmpty())
         return;
 
-    OD_ASSERT_TRUE_MSG(tile->getX() < static_cast<int>(mTilesVision.size()), "Tile=" + Tile::displayAsString(tile));
-    OD_ASSERT_TRUE_MSG(tile->getY() < static_cast<int>(mTilesVision[tile->getX()].size()), "Tile=" + Tile::displayAsString(tile));
-    std::pair<bool, bool>& p = mTilesVision[tile->getX()][tile->getY()];
-    p.second = true;
+    mTilesVision.copyFrom(mTilesVisionOwn);
+    for(Seat* alliedSeat : mAlliedSeats)
+        mTilesVision.orWith(alliedSeat->mTilesVisionOwn);
+
+    mTilesVision.fillSetCells(mVisionCells);
+    for(uint32_t cell : mVisionCells)
+        getTileFromVisionCell(cell)->addSeatWithVision(this);
+
+    // The entities on the tiles where the vision changed have to notify this seat and the
+    // tiles that changed while not seen have to be sent
+    VisionPlane::fillChangedCells(mTilesVisionPrevious, mTilesVision, mVisionCells, mVisionLostCells);
+    for(uint32_t cell : mVisionCells)
+        mGameMap->markTileDirty(getTileFromVisionCell(cell));
+    for(uint32_t cell : mVisionLostCells)
+        mGameMap->markTileDirty(getTileFromVisionCell(cell));
 }
 
 bool Seat::hasVisionOnTile(Tile* tile)
@@ -436,11 +440,12 @@ bool Seat::hasVisionOnTile(Tile* tile)
     if(!mPlayer->getIsHuman())
         return true;
 
-    OD_ASSERT_TRUE_MSG(tile->getX() < static_cast<int>(mTilesVision.size()), "Tile=" + Tile::displayAsString(tile));
-    OD_ASSERT_TRUE_MSG(tile->getY() < static_cast<int>(mTilesVision[tile->getX()].size()), "Tile=" + Tile::displayAsString(tile));
-    std::pair<bool, bool>& p = mTilesVision[tile->getX()][tile->getY()];
+    if(mTilesVision.isEmpty())
+        return false;
 
-    return p.second;
+    OD_ASSERT_TRUE_MSG(tile->getX() < mGameMap->getMapSizeX(), "Tile=" + Tile::displayAsString(tile));
+    OD_ASSERT_TRUE_MSG(tile->getY() < mGameMap->getMapSizeY(), "Tile=" + Tile::displayAsString(tile));
+    return mTilesVision.test(tile->getX(), tile->getY());
 }
 
 void Seat::notifyChangedVisibleTiles()
@@ -450,23 +455,21 @@ void Seat::notifyChangedVisibleTiles()
     if(!mPlayer->getIsHuman())
         return;
 
+    if(mTilesVision.isEmpty())
+        return;
+
+    // Tiles where this seat gained vision are dirty too (see computeTilesWithVision) so we only
+    // have to check the dirty tiles
     std::vector<Tile*> tilesToNotify;
-    int xMax = static_cast<int>(mTilesVision.size());
-    for(int xxx = 0; xxx < xMax; ++xxx)
+    for(Tile* tile : mGameMap->getDirtyTiles())
     {
-        int yMax = static_cast<int>(mTilesVision[xxx].size());
-        for(int yyy = 0; yyy < yMax; ++yyy)
-        {
-            if(!mTilesVision[xxx][yyy].second)
-                continue;
-
-            Tile* tile = mGameMap->getTile(xxx, yyy);
-            if(!tile->hasChangedForSeat(this))
-                continue;
+        if(!mTilesVision.test(tile->getX(), tile->getY()))
+            continue;
+        if(!tile->hasChangedForSeat(this))
+            continue;
 
-            tilesToNotify.push_back(tile);
-            tile->changeNotifiedForSeat(this);
-        }
+        tilesToNotify.push_back(tile);
+        tile->changeNotifiedForSeat(this);
     }
 
     if(tilesToNotify.empty())
@@ -541,8 +544,7 @@ void Seat::displaySeatVisualDebug(bool enable)
     if(!mGameMap->isServerGameMap())
         return;
 
-    // Visual debugging do not work for AI players (otherwise, we would have to use
-    // mTilesVision for them which would be memory consuming)
+    // Visual debugging is only available for human players
     if(mPlayer == nullptr)
         return;
     if(!mPlayer->getIsHuman())
@@ -553,19 +555,10 @@ void Seat::displaySeatVisualDebug(bool enable)
     if(enable)
     {
         std::vector<Tile*> tiles;
-        int xMax = static_cast<int>(mTilesVision.size());
-        for(int xxx = 0; xxx < xMax; ++xxx)
-        {
-            int yMax = static_cast<int>(mTilesVision[xxx].size());
-            for(int yyy = 0; yyy < yMax; ++yyy)
-            {
-                if(!mTilesVision[xxx][yyy].second)
-                    continue;
+        mTilesVision.fillSetCells(mVisionCells);
+        for(uint32_t cell : mVisionCells)
+            tiles.push_back(getTileFromVisionCell(cell));
 
-                Tile* tile = mGameMap->getTile(xxx, yyy);
-                tiles.push_back(tile);
-            }
-        }
         uint32_t nbTiles = tiles.size();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotification::refreshSeatVisDebug, nullptr);
@@ -602,46 +595,23 @@ void Seat::sendVisibleTiles()
     uint32_t nbTiles;
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotification::refreshVisibleTiles, getPlayer());
-    std::vector<Tile*> tilesVisionGained;
-    std::vector<Tile*> tilesVisionLost;
-    // Tiles we gained vision
-    int xMax = static_cast<int>(mTilesVision.size());
-    for(int xxx = 0; xxx < xMax; ++xxx)
-    {
-        int yMax = static_cast<int>(mTilesVision[xxx].size());
-        for(int yyy = 0; yyy < yMax; ++yyy)
-        {
-            if(mTilesVision[xxx][yyy].second == mTilesVision[xxx][yyy].first)
-                continue;
-
-            Tile* tile = mGameMap->getTile(xxx, yyy);
-            if(mTilesVision[xxx][yyy].second)
-            {
-                // Vision gained
-                tilesVisionGained.push_back(tile);
-            }
-            else
-            {
-                // Vision lost
-                tilesVisionLost.push_back(tile);
-            }
-        }
-    }
+    // Only the words where the vision changed are processed
+    VisionPlane::fillChangedCells(mTilesVisionPrevious, mTilesVision, mVisionCells, mVisionLostCells);
 
     // Notify tiles we gained vision
-    nbTiles = tilesVisionGained.size();
+    nbTiles = mVisionCells.size();
     serverNotification->mPacket << nbTiles;
-    for(Tile* tile : tilesVisionGained)
+    for(uint32_t cell : mVisionCells)
     {
-        mGameMap->tileToPacket(serverNotification->mPacket, tile);
+        mGameMap->tileToPacket(serverNotification->mPacket, getTileFromVisionCell(cell));
     }
 
     // Notify tiles we lost vision
-    nbTiles = tilesVisionLost.size();
+    nbTiles = mVisionLostCells.size();
     serverNotification->mPacket << nbTiles;
-    for(Tile* tile : tilesVisionLost)
+    for(uint32_t cell : mVisionLostCells)
     {
-        mGameMap->tileToPacket(serverNotification->mPacket, tile);
+        mGameMap->tileToPacket(serverNotification->mPacket, getTileFromVisionCell(cell));
     }
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
@@ -650,7 +620,7 @@ void Seat::computeSeatBeforeSendingToClient()
 {
     if(mPlayer != nullptr)
     {
-        mNbTreasuries = mGameMap->numRoomsByTypeAndSeat(Room::treasury, this);
+        mNbTreasuries = mLedger.getNbRooms(Room::treasury);
     }
 }
 
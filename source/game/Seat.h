@@ -19,6 +19,12 @@
 #define SEAT_H
 
 
+#include "game/SeatLedger.h"
+#include "game/VisionPlane.h"
+#include "game/WorkerTaskBoard.h"
+
+#include "utils/Random.h"
+
 #include <OgreVector3.h>
 #include <OgreColourValue.h>
 #include <string>
@@ -86,10 +92,6 @@ public:
     Goal* getFailedGoal(unsigned int index);
 
     unsigned int getNumClaimedTiles();
-    void setNumClaimedTiles(const unsigned int& num);
-
-    //! \brief Increment the number of claimed tiles by 1.
-    void incrementNumClaimedTiles();
 
     /** \brief See if the goals has changed since we last checked.
      *  For use with the goal window, to avoid having to update it on every frame.
@@ -162,8 +164,22 @@ public:
 
     void initSpawnPool();
 
+    //! \brief Allocates the vision planes and the worker task board for the given map size
     void setMapSize(int x, int y);
 
+    //! \brief The tiles the workers of this seat can dig or claim. Kept up to date by the game map on
+    //! server side only.
+    inline WorkerTaskBoard& getWorkerTaskBoard()
+    { return mWorkerTaskBoard; }
+
+    //! \brief What this seat owns (claimed tiles, rooms and creatures), kept up to date as the map changes.
+    //! The values sent to the clients (like getNumClaimedTiles) are refreshed from it at each turn.
+    inline SeatLedger& getLedger()
+    { return mLedger; }
+
+    inline const SeatLedger& getLedger() const
+    { return mLedger; }
+
     const CreatureDefinition* getNextCreatureClassToSpawn();
 
     //! \brief Returns true if the given seat is allied. False otherwise
@@ -176,9 +192,15 @@ public:
     bool canRoomBeDestroyedBy(Seat* seat);
     bool canTrapBeDestroyedBy(Seat* seat);
 
+    //! \brief Keeps the current vision as the previous turn one and clears it. The tiles
+    //! this seat had vision on are told they are not seen anymore
     void clearTilesWithVision();
     void notifyVisionOnTile(Tile* tile);
 
+    //! \brief Merges the vision of this seat with the allied seats one. Should be called
+    //! once every seat has been notified of the tiles it sees
+    void computeTilesWithVision();
+
     //! \brief Returns true if this seat can see the given tile and false otherwise
     bool hasVisionOnTile(Tile* tile);
 
@@ -277,14 +299,26 @@ private:
     //! if the spawning conditions are not empty and are met, we will set it to true and force spawning of the related creature
     std::vector<std::pair<const CreatureDefinition*, bool> > mSpawnPool;
 
-    //! \brief List of all the tiles in the gamemap (used for human players seats only). The first vector stores the X position.
-    //! The second vector stores the Y position. The first bool from the pair is set to true if the seat had vision on the concerned
-    //! tile during the last turn. The second bool is the same but for the current turn. That allows to notify only the tiles where
-    //! vision changed
-    std::vector<std::vector<std::pair<bool, bool>>> mTilesVision;
+    //! \brief Tiles seen by the entities of this seat during the current turn
+    VisionPlane mTilesVisionOwn;
+
+    //! \brief Tiles seen during the current turn by this seat or its allies
+    VisionPlane mTilesVision;
+
+    //! \brief Tiles seen during the last turn by this seat or its allies. Comparing it with mTilesVision
+    //! allows to notify only the tiles where vision changed
+    VisionPlane mTilesVisionPrevious;
+
+    //! \brief Buffers used to enumerate the bits of the vision planes
+    std::vector<uint32_t> mVisionCells;
+    std::vector<uint32_t> mVisionLostCells;
     std::vector<Tile*> mVisualDebugEntityTiles;
 
-    //! \brief How many tiles have been claimed by this seat, updated in GameMap::doTurn().
+    WorkerTaskBoard mWorkerTaskBoard;
+
+    SeatLedger mLedger;
+
+    //! \brief How many tiles have been claimed by this seat, refreshed from mLedger in GameMap::doMiscUpkeep().
     unsigned int mNumClaimedTiles;
 
     bool mHasGoalsChanged;
@@ -299,6 +333,12 @@ private:
     int mNbTreasuries;
 
     bool mIsDebuggingVision;
+
+    //! \brief Generator used for the seat decisions (creature spawning). Seeded by the game map on server side
+    RandomGenerator mRandom;
+
+    //! \brief Returns the tile corresponding to the given vision plane index
+    Tile* getTileFromVisionCell(uint32_t cell) const;
 };
 
 #endif // SEAT_H
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/SeatLedger.h"
+
+SeatLedger::SeatLedger() :
+    mNbClaimedTiles(0),
+    mNbCreatures(0)
+{
+}
+
+void SeatLedger::clear()
+{
+    mNbClaimedTiles = 0;
+    mNbRooms.clear();
+    mNbCreatures = 0;
+    mNbCreaturesByDefinition.clear();
+}
+
+void SeatLedger::addClaimedTile()
+{
+    ++mNbClaimedTiles;
+}
+
+void SeatLedger::removeClaimedTile()
+{
+    if(mNbClaimedTiles > 0)
+        --mNbClaimedTiles;
+}
+
+uint32_t SeatLedger::getNbRooms(uint32_t roomType) const
+{
+    if(roomType >= mNbRooms.size())
+        return 0;
+
+    return mNbRooms[roomType];
+}
+
+void SeatLedger::addRoom(uint32_t roomType)
+{
+    if(roomType >= mNbRooms.size())
+        mNbRooms.resize(roomType + 1, 0);
+
+    ++mNbRooms[roomType];
+}
+
+void SeatLedger::removeRoom(uint32_t roomType)
+{
+    if((roomType >= mNbRooms.size()) || (mNbRooms[roomType] == 0))
+        return;
+
+    --mNbRooms[roomType];
+}
+
+uint32_t SeatLedger::getNbCreatures(const CreatureDefinition* definition) const
+{
+    std::map<const CreatureDefinition*, uint32_t>::const_iterator it = mNbCreaturesByDefinition.find(definition);
+    if(it == mNbCreaturesByDefinition.end())
+        return 0;
+
+    return it->second;
+}
+
+void SeatLedger::addCreature(const CreatureDefinition* definition)
+{
+    ++mNbCreatures;
+    ++mNbCreaturesByDefinition[definition];
+}
+
+void SeatLedger::removeCreature(const CreatureDefinition* definition)
+{
+    std::map<const CreatureDefinition*, uint32_t>::iterator it = mNbCreaturesByDefinition.find(definition);
+    if(it == mNbCreaturesByDefinition.end())
+        return;
+
+    --mNbCreatures;
+    --it->second;
+    if(it->second == 0)
+        mNbCreaturesByDefinition.erase(it);
+}
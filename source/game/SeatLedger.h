@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEATLEDGER_H
+#define SEATLEDGER_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class CreatureDefinition;
+
+/*! \brief Counters about what a seat owns, kept up to date when the map changes so that they
+ * can be read without going through the tiles, rooms or creatures of the map.
+ *
+ * The game map updates the room and creature counts when rooms and creatures are added to or
+ * removed from the map (creatures stop being counted when they die). The tiles update the claimed
+ * tiles count when their type or seat changes.
+ * Room types are given as integers so that this class does not depend on the rooms.
+ */
+class SeatLedger
+{
+public:
+    SeatLedger();
+
+    //! \brief Resets every counter to 0.
+    void clear();
+
+    //! \brief Number of claimed tiles owned by the seat
+    inline uint32_t getNbClaimedTiles() const
+    { return mNbClaimedTiles; }
+
+    void addClaimedTile();
+    void removeClaimedTile();
+
+    //! \brief Number of rooms of the given type on map owned by the seat
+    uint32_t getNbRooms(uint32_t roomType) const;
+
+    void addRoom(uint32_t roomType);
+    void removeRoom(uint32_t roomType);
+
+    //! \brief Number of alive creatures owned by the seat
+    inline uint32_t getNbCreatures() const
+    { return mNbCreatures; }
+
+    //! \brief Number of alive creatures of the given class owned by the seat
+    uint32_t getNbCreatures(const CreatureDefinition* definition) const;
+
+    void addCreature(const CreatureDefinition* definition);
+    void removeCreature(const CreatureDefinition* definition);
+
+private:
+    uint32_t mNbClaimedTiles;
+
+    //! \brief Number of rooms indexed by room type. Grows when a new type is added
+    std::vector<uint32_t> mNbRooms;
+
+    uint32_t mNbCreatures;
+    std::map<const CreatureDefinition*, uint32_t> mNbCreaturesByDefinition;
+};
+
+#endif // SEATLEDGER_H
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/VisionPlane.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//! \brief Returns the index of the lowest bit set. word must not be 0.
+static inline uint32_t lowestBitIndex(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+}
+
+static inline uint32_t bitCount(uint64_t word)
+{
+#ifdef _MSC_VER
+    return static_cast<uint32_t>(__popcnt64(word));
+#else
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#endif
+}
+
+//! \brief Adds to cells the indexes of the bits set in word, word being the wordIndex-th word of a plane
+static inline void addSetBits(uint64_t word, uint32_t wordIndex, std::vector<uint32_t>& cells)
+{
+    while(word != 0)
+    {
+        cells.push_back((wordIndex << 6) + lowestBitIndex(word));
+        // Clears the lowest bit set
+        word &= word - 1;
+    }
+}
+
+VisionPlane::VisionPlane() :
+    mMapSizeY(0)
+{
+}
+
+void VisionPlane::setMapSize(int sizeX, int sizeY)
+{
+    mMapSizeY = sizeY;
+    uint32_t nbBits = static_cast<uint32_t>(sizeX * sizeY);
+    mWords.assign((nbBits + 63) / 64, 0);
+}
+
+void VisionPlane::clear()
+{
+    std::fill(mWords.begin(), mWords.end(), 0);
+}
+
+void VisionPlane::copyFrom(const VisionPlane& other)
+{
+    mMapSizeY = other.mMapSizeY;
+    mWords = other.mWords;
+}
+
+void VisionPlane::orWith(const VisionPlane& other)
+{
+    uint32_t nbWords = std::min(mWords.size(), other.mWords.size());
+    for(uint32_t i = 0; i < nbWords; ++i)
+        mWords[i] |= other.mWords[i];
+}
+
+void VisionPlane::swap(VisionPlane& other)
+{
+    std::swap(mMapSizeY, other.mMapSizeY);
+    mWords.swap(other.mWords);
+}
+
+uint32_t VisionPlane::count() const
+{
+    uint32_t nb = 0;
+    for(uint64_t word : mWords)
+        nb += bitCount(word);
+
+    return nb;
+}
+
+void VisionPlane::fillSetCells(std::vector<uint32_t>& cells) const
+{
+    cells.clear();
+    uint32_t nbWords = mWords.size();
+    for(uint32_t i = 0; i < nbWords; ++i)
+        addSetBits(mWords[i], i, cells);
+}
+
+void VisionPlane::fillChangedCells(const VisionPlane& previous, const VisionPlane& current,
+    std::vector<uint32_t>& gained, std::vector<uint32_t>& lost)
+{
+    gained.clear();
+    lost.clear();
+    uint32_t nbWords = std::min(previous.mWords.size(), current.mWords.size());
+    for(uint32_t i = 0; i < nbWords; ++i)
+    {
+        uint64_t changed = previous.mWords[i] ^ current.mWords[i];
+        if(changed == 0)
+            continue;
+
+        addSetBits(changed & current.mWords[i], i, gained);
+        addSetBits(changed & previous.mWords[i], i, lost);
+    }
+}
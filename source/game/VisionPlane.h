@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VISIONPLANE_H
+#define VISIONPLANE_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief One bit per tile of the map telling if a seat has vision on it.
+ *
+ * The bits are packed in 64 bits words (tile index is x * sizeY + y) so that planes
+ * can be cleared, merged and compared a word at a time. Set bits are enumerated
+ * by jumping from one to the next instead of testing every tile.
+ */
+class VisionPlane
+{
+public:
+    VisionPlane();
+
+    //! \brief Sets the map size. All the bits are cleared.
+    void setMapSize(int sizeX, int sizeY);
+
+    inline bool isEmpty() const
+    { return mWords.empty(); }
+
+    inline int getMapSizeY() const
+    { return mMapSizeY; }
+
+    //! \brief Clears all the bits
+    void clear();
+
+    inline void set(int x, int y)
+    {
+        uint32_t index = x * mMapSizeY + y;
+        mWords[index >> 6] |= (static_cast<uint64_t>(1) << (index & 63));
+    }
+
+    inline bool test(int x, int y) const
+    {
+        uint32_t index = x * mMapSizeY + y;
+        return (mWords[index >> 6] & (static_cast<uint64_t>(1) << (index & 63))) != 0;
+    }
+
+    //! \brief Copies the bits of the given plane. Both planes must have the same size.
+    void copyFrom(const VisionPlane& other);
+
+    //! \brief Sets the bits set in the given plane. Both planes must have the same size.
+    void orWith(const VisionPlane& other);
+
+    //! \brief Exchanges the content of the 2 planes without copying.
+    void swap(VisionPlane& other);
+
+    //! \brief Returns the number of bits set.
+    uint32_t count() const;
+
+    //! \brief Fills cells with the indexes of the bits set, in increasing order. cells is cleared first.
+    void fillSetCells(std::vector<uint32_t>& cells) const;
+
+    //! \brief Fills gained with the indexes of the bits set in current but not in previous and lost
+    //! with the ones set in previous but not in current. Both vectors are cleared first.
+    static void fillChangedCells(const VisionPlane& previous, const VisionPlane& current,
+        std::vector<uint32_t>& gained, std::vector<uint32_t>& lost);
+
+private:
+    int mMapSizeY;
+    std::vector<uint64_t> mWords;
+};
+
+#endif // VISIONPLANE_H
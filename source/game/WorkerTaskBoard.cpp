@@ -0,0 +1,232 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/WorkerTaskBoard.h"
+
+#include <algorithm>
+
+const int WorkerTaskBoard::BUCKET_SIZE = 8;
+const uint32_t WorkerTaskBoard::NO_WORKER = 0;
+
+//! \brief Returns the bit of mTaskFlags used for the given type
+static inline uint8_t getTaskFlag(WorkerTaskBoard::TaskType type)
+{
+    return static_cast<uint8_t>(1 << static_cast<uint32_t>(type));
+}
+
+WorkerTaskBoard::WorkerTaskBoard() :
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mNbBucketsX(0),
+    mNbBucketsY(0)
+{
+    std::fill(mNbTasks, mNbTasks + static_cast<uint32_t>(TaskType::nbTaskTypes), 0);
+}
+
+void WorkerTaskBoard::setMapSize(int sizeX, int sizeY)
+{
+    mMapSizeX = sizeX;
+    mMapSizeY = sizeY;
+    mNbBucketsX = (sizeX + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    mNbBucketsY = (sizeY + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    mTaskFlags.assign(sizeX * sizeY, 0);
+    for(uint32_t type = 0; type < static_cast<uint32_t>(TaskType::nbTaskTypes); ++type)
+    {
+        mBuckets[type].clear();
+        mBuckets[type].resize(mNbBucketsX * mNbBucketsY);
+        mNbTasks[type] = 0;
+    }
+}
+
+void WorkerTaskBoard::setTask(TaskType type, int x, int y, bool isTask)
+{
+    if(!isInMap(x, y))
+        return;
+
+    uint32_t tile = x * mMapSizeY + y;
+    uint8_t flag = getTaskFlag(type);
+    if(((mTaskFlags[tile] & flag) != 0) == isTask)
+        return;
+
+    std::vector<Task>& bucket = mBuckets[static_cast<uint32_t>(type)][getBucketIndex(x, y)];
+    if(isTask)
+    {
+        mTaskFlags[tile] |= flag;
+        bucket.push_back(Task(tile));
+        ++mNbTasks[static_cast<uint32_t>(type)];
+        return;
+    }
+
+    mTaskFlags[tile] &= ~flag;
+    for(Task& task : bucket)
+    {
+        if(task.mTile != tile)
+            continue;
+
+        // The order of the tasks in a bucket does not matter
+        task = bucket.back();
+        bucket.pop_back();
+        break;
+    }
+    --mNbTasks[static_cast<uint32_t>(type)];
+}
+
+bool WorkerTaskBoard::hasTask(TaskType type, int x, int y) const
+{
+    if(!isInMap(x, y))
+        return false;
+
+    return (mTaskFlags[x * mMapSizeY + y] & getTaskFlag(type)) != 0;
+}
+
+WorkerTaskBoard::Task* WorkerTaskBoard::findTask(TaskType type, int x, int y)
+{
+    if(!hasTask(type, x, y))
+        return nullptr;
+
+    uint32_t tile = x * mMapSizeY + y;
+    for(Task& task : mBuckets[static_cast<uint32_t>(type)][getBucketIndex(x, y)])
+    {
+        if(task.mTile == tile)
+            return &task;
+    }
+
+    return nullptr;
+}
+
+const WorkerTaskBoard::Task* WorkerTaskBoard::findTask(TaskType type, int x, int y) const
+{
+    return const_cast<WorkerTaskBoard*>(this)->findTask(type, x, y);
+}
+
+void WorkerTaskBoard::fillTasksInRadius(TaskType type, int x, int y, int radius, std::vector<uint32_t>& tiles) const
+{
+    tiles.clear();
+    if((mNbTasks[static_cast<uint32_t>(type)] == 0) || (radius < 0))
+        return;
+
+    int radiusSquared = radius * radius;
+    int minBucketX = std::max(0, x - radius) / BUCKET_SIZE;
+    int maxBucketX = std::min(mMapSizeX - 1, x + radius) / BUCKET_SIZE;
+    int minBucketY = std::max(0, y - radius) / BUCKET_SIZE;
+    int maxBucketY = std::min(mMapSizeY - 1, y + radius) / BUCKET_SIZE;
+    const std::vector<std::vector<Task>>& buckets = mBuckets[static_cast<uint32_t>(type)];
+    for(int bucketX = minBucketX; bucketX <= maxBucketX; ++bucketX)
+    {
+        for(int bucketY = minBucketY; bucketY <= maxBucketY; ++bucketY)
+        {
+            for(const Task& task : buckets[bucketX * mNbBucketsY + bucketY])
+            {
+                int diffX = static_cast<int>(task.mTile) / mMapSizeY - x;
+                int diffY = static_cast<int>(task.mTile) % mMapSizeY - y;
+                if(diffX * diffX + diffY * diffY <= radiusSquared)
+                    tiles.push_back(task.mTile);
+            }
+        }
+    }
+}
+
+bool WorkerTaskBoard::reserveNearestTask(TaskType type, int x, int y, int maxDistance, uint32_t worker,
+    int64_t turn, int64_t expirationTurn, const std::function<bool(int, int)>& isValid,
+    int& taskX, int& taskY)
+{
+    if((mNbTasks[static_cast<uint32_t>(type)] == 0) || !isInMap(x, y) || (maxDistance < 0))
+        return false;
+
+    int maxDistanceSquared = maxDistance * maxDistance;
+    int bucketX = x / BUCKET_SIZE;
+    int bucketY = y / BUCKET_SIZE;
+    int maxRing = maxDistance / BUCKET_SIZE + 1;
+    std::vector<std::vector<Task>>& buckets = mBuckets[static_cast<uint32_t>(type)];
+    mCandidates.clear();
+
+    // The buckets are scanned ring by ring around the bucket of (x, y). Once a ring is scanned, the
+    // candidates closer than any tile of the next ring can be tested by increasing distance
+    for(int ring = 0; ring <= maxRing; ++ring)
+    {
+        for(int bx = bucketX - ring; bx <= bucketX + ring; ++bx)
+        {
+            if((bx < 0) || (bx >= mNbBucketsX))
+                continue;
+
+            // Inside the ring, only the first and last columns are scanned entirely
+            bool isBorderColumn = (bx == bucketX - ring) || (bx == bucketX + ring);
+            int step = isBorderColumn ? 1 : std::max(1, 2 * ring);
+            for(int by = bucketY - ring; by <= bucketY + ring; by += step)
+            {
+                if((by < 0) || (by >= mNbBucketsY))
+                    continue;
+
+                for(Task& task : buckets[bx * mNbBucketsY + by])
+                {
+                    if((task.mWorker != NO_WORKER) && (task.mWorker != worker) && (task.mExpirationTurn >= turn))
+                        continue;
+
+                    int diffX = static_cast<int>(task.mTile) / mMapSizeY - x;
+                    int diffY = static_cast<int>(task.mTile) % mMapSizeY - y;
+                    int distanceSquared = diffX * diffX + diffY * diffY;
+                    if(distanceSquared <= maxDistanceSquared)
+                        mCandidates.push_back(std::make_pair(distanceSquared, &task));
+                }
+            }
+        }
+
+        // Every tile of the next ring is at least ring * BUCKET_SIZE + 1 tiles away on one axis
+        int nextRingDistance = ring * BUCKET_SIZE + 1;
+        int boundSquared = (ring == maxRing) ? maxDistanceSquared + 1 : nextRingDistance * nextRingDistance;
+        std::sort(mCandidates.begin(), mCandidates.end(),
+            [](const std::pair<int, Task*>& a, const std::pair<int, Task*>& b)
+            {
+                // Ties are broken by tile index so that the result does not depend on the bucket order
+                if(a.first != b.first)
+                    return a.first < b.first;
+                return a.second->mTile < b.second->mTile;
+            });
+
+        uint32_t nbTested = 0;
+        for(const std::pair<int, Task*>& candidate : mCandidates)
+        {
+            if(candidate.first >= boundSquared)
+                break;
+
+            ++nbTested;
+            Task& task = *candidate.second;
+            int candidateX = static_cast<int>(task.mTile) / mMapSizeY;
+            int candidateY = static_cast<int>(task.mTile) % mMapSizeY;
+            if(!isValid(candidateX, candidateY))
+                continue;
+
+            task.mWorker = worker;
+            task.mExpirationTurn = expirationTurn;
+            taskX = candidateX;
+            taskY = candidateY;
+            return true;
+        }
+        mCandidates.erase(mCandidates.begin(), mCandidates.begin() + nbTested);
+    }
+
+    return false;
+}
+
+uint32_t WorkerTaskBoard::getReservingWorker(TaskType type, int x, int y, int64_t turn) const
+{
+    const Task* task = findTask(type, x, y);
+    if((task == nullptr) || (task->mExpirationTurn < turn))
+        return NO_WORKER;
+
+    return task->mWorker;
+}
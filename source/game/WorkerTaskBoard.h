@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKERTASKBOARD_H
+#define WORKERTASKBOARD_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*! \brief The tiles the workers of a seat can work on (dig, claim ground or claim walls).
+ *
+ * The tasks are stored in buckets of BUCKET_SIZE x BUCKET_SIZE tiles and updated when the tiles
+ * change, so finding work does not require scanning the sight area of every worker. Workers
+ * reserve the task they are going to so that several workers do not walk to the same tile. A
+ * reservation lasts until the given expiration turn and does not need to be released: a worker
+ * that gets picked up or changes its mind will not block the task for long.
+ * Tiles are identified by their coordinates so that this class does not depend on the tiles.
+ */
+class WorkerTaskBoard
+{
+public:
+    enum class TaskType
+    {
+        dig,
+        claimGround,
+        claimWall,
+        nbTaskTypes
+    };
+
+    static const int BUCKET_SIZE;
+
+    //! \brief Worker value for tasks that are not reserved
+    static const uint32_t NO_WORKER;
+
+    WorkerTaskBoard();
+
+    //! \brief Sets the map size and removes every task
+    void setMapSize(int sizeX, int sizeY);
+
+    //! \brief Adds or removes the given task. Removing a task that does not exist does nothing.
+    void setTask(TaskType type, int x, int y, bool isTask);
+
+    bool hasTask(TaskType type, int x, int y) const;
+
+    inline uint32_t getNbTasks(TaskType type) const
+    { return mNbTasks[static_cast<uint32_t>(type)]; }
+
+    //! \brief Fills tiles with the coordinates (x * sizeY + y) of the tasks of the given type within
+    //! radius of (x, y). tiles is cleared first. Can be called from several threads.
+    void fillTasksInRadius(TaskType type, int x, int y, int radius, std::vector<uint32_t>& tiles) const;
+
+    /*! \brief Reserves for worker the closest task to (x, y) within maxDistance that is not reserved by another
+     * worker and for which isValid returns true. The tasks are tested by increasing distance. Returns true and sets
+     * (taskX, taskY) if a task was found. The reservation expires after the turn expirationTurn.
+     */
+    bool reserveNearestTask(TaskType type, int x, int y, int maxDistance, uint32_t worker,
+        int64_t turn, int64_t expirationTurn, const std::function<bool(int, int)>& isValid,
+        int& taskX, int& taskY);
+
+    //! \brief Returns the worker that reserved the given task at the given turn or NO_WORKER
+    uint32_t getReservingWorker(TaskType type, int x, int y, int64_t turn) const;
+
+private:
+    class Task
+    {
+    public:
+        Task(uint32_t tile) :
+            mTile(tile),
+            mWorker(NO_WORKER),
+            mExpirationTurn(0)
+        {}
+
+        uint32_t mTile;
+        uint32_t mWorker;
+        int64_t mExpirationTurn;
+    };
+
+    int mMapSizeX;
+    int mMapSizeY;
+    int mNbBucketsX;
+    int mNbBucketsY;
+
+    //! \brief For each tile, one bit per task type
+    std::vector<uint8_t> mTaskFlags;
+
+    //! \brief mBuckets[type][bucket] contains the tasks of the given type in the bucket
+    std::vector<std::vector<Task>> mBuckets[static_cast<uint32_t>(TaskType::nbTaskTypes)];
+
+    uint32_t mNbTasks[static_cast<uint32_t>(TaskType::nbTaskTypes)];
+
+    //! \brief Candidates of reserveNearestTask (squared distance, task), kept to avoid allocations
+    std::vector<std::pair<int, Task*>> mCandidates;
+
+    inline bool isInMap(int x, int y) const
+    { return (x >= 0) && (y >= 0) && (x < mMapSizeX) && (y < mMapSizeY); }
+
+    inline int getBucketIndex(int x, int y) const
+    { return (x / BUCKET_SIZE) * mNbBucketsY + (y / BUCKET_SIZE); }
+
+    Task* findTask(TaskType type, int x, int y);
+    const Task* findTask(TaskType type, int x, int y) const;
+};
+
+#endif // WORKERTASKBOARD_H
@@ -0,0 +1,253 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/AstarSearch.h"
+
+#include "entities/Creature.h"
+#include "entities/Tile.h"
+
+#include "gamemap/TileContainer.h"
+
+#include <cmath>
+
+static const uint32_t NO_PARENT = 0xFFFFFFFF;
+
+AstarSearch::AstarSearch()
+{
+}
+
+double AstarSearch::computeHeuristic(int x1, int y1, int x2, int y2)
+{
+    return fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
+}
+
+double AstarSearch::computeWeightToParent(Tile* tile, const Tile* neighbor, const Creature* creature)
+{
+    double weightToParent = computeHeuristic(neighbor->getX(), neighbor->getY(),
+        tile->getX(), tile->getY());
+
+    if(tile->getFullness() == 0)
+        weightToParent /= creature->getMoveSpeed(tile);
+    else
+        weightToParent /= creature->getMoveSpeedGround();
+
+    return weightToParent;
+}
+
+std::list<Tile*> AstarSearch::path(TileContainer& tileContainer, Tile* start, Tile* destination,
+    const Creature* creature, Seat* seat, bool throughDiggableTiles)
+{
+    std::list<Tile*> returnList;
+
+    mEntries.clear();
+    mOpenHeap.clear();
+    tileContainer.startTileSearch();
+
+    int x2 = destination->getX();
+    int y2 = destination->getY();
+
+    mEntries.push_back(AstarEntry(start, NO_PARENT, 0.0,
+        computeHeuristic(start->getX(), start->getY(), x2, y2)));
+    tileContainer.setTileSearchSlot(start, 0);
+    pushOpen(0);
+
+    uint32_t destinationIndex = NO_PARENT;
+    while (!mOpenHeap.empty())
+    {
+        // Get the lowest fScore from the open list and move it to the closed list
+        uint32_t currentIndex = popOpen();
+        mEntries[currentIndex].mIsClosed = true;
+        Tile* currentTile = mEntries[currentIndex].mTile;
+
+        // We found the path, break out of the search loop
+        if (currentTile == destination)
+        {
+            destinationIndex = currentIndex;
+            break;
+        }
+
+        int x = currentTile->getX();
+        int y = currentTile->getY();
+
+        // Check the tiles surrounding the current square
+        bool areTilesPassable[4] = {false, false, false, false};
+        // Note : to disable diagonals, process tiles from 0 to 3. To allow them, process tiles from 0 to 7
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            Tile* neighborTile = nullptr;
+            switch(i)
+            {
+                // We process the 4 adjacent tiles
+                case 0:
+                    neighborTile = tileContainer.getTile(x - 1, y);
+                    break;
+                case 1:
+                    neighborTile = tileContainer.getTile(x + 1, y);
+                    break;
+                case 2:
+                    neighborTile = tileContainer.getTile(x, y - 1);
+                    break;
+                case 3:
+                    neighborTile = tileContainer.getTile(x, y + 1);
+                    break;
+                // We process the 4 diagonal tiles. We only process a diagonal tile if the 2 tiles adjacent to the original one are
+                // passable.
+                case 4:
+                    if(areTilesPassable[0] && areTilesPassable[2])
+                        neighborTile = tileContainer.getTile(x - 1, y - 1);
+                    break;
+                case 5:
+                    if(areTilesPassable[0] && areTilesPassable[3])
+                        neighborTile = tileContainer.getTile(x - 1, y + 1);
+                    break;
+                case 6:
+                    if(areTilesPassable[1] && areTilesPassable[2])
+                        neighborTile = tileContainer.getTile(x + 1, y - 1);
+                    break;
+                case 7:
+                    if(areTilesPassable[1] && areTilesPassable[3])
+                        neighborTile = tileContainer.getTile(x + 1, y + 1);
+                    break;
+            }
+            if(neighborTile == nullptr)
+                continue;
+
+            bool processNeighbor = false;
+            if(creature->canGoThroughTile(neighborTile))
+            {
+                processNeighbor = true;
+                // We set passability for the 4 adjacent tiles only
+                if(i < 4)
+                    areTilesPassable[i] = true;
+            }
+            else if(throughDiggableTiles && neighborTile->isDiggable(seat))
+                processNeighbor = true;
+
+            if (!processNeighbor)
+                continue;
+
+            uint32_t neighborIndex = tileContainer.getTileSearchSlot(neighborTile);
+
+            // Ignore the neighbor if it is on the closed list
+            if ((neighborIndex != TileContainer::TILE_SEARCH_NO_SLOT) &&
+                mEntries[neighborIndex].mIsClosed)
+            {
+                continue;
+            }
+
+            double weightToParent = computeWeightToParent(currentTile, neighborTile, creature);
+            double newG = mEntries[currentIndex].mG + weightToParent;
+
+            // If the neighbor is not in the open list
+            if (neighborIndex == TileContainer::TILE_SEARCH_NO_SLOT)
+            {
+                neighborIndex = static_cast<uint32_t>(mEntries.size());
+                // Use the manhattan distance for the heuristic
+                mEntries.push_back(AstarEntry(neighborTile, currentIndex, newG,
+                    computeHeuristic(neighborTile->getX(), neighborTile->getY(), x2, y2)));
+                tileContainer.setTileSearchSlot(neighborTile, neighborIndex);
+                pushOpen(neighborIndex);
+                continue;
+            }
+
+            // If this path to the given neighbor tile is a shorter path than the
+            // one already given, make this the new parent.
+            AstarEntry& neighborEntry = mEntries[neighborIndex];
+            if (newG < neighborEntry.mG)
+            {
+                neighborEntry.mG = newG;
+                neighborEntry.mParent = currentIndex;
+                siftUp(neighborEntry.mHeapIndex);
+            }
+        }
+    }
+
+    // Follow the parent chain back the the starting tile
+    uint32_t curIndex = destinationIndex;
+    while (curIndex != NO_PARENT)
+    {
+        const AstarEntry& entry = mEntries[curIndex];
+        returnList.push_front(entry.mTile);
+        curIndex = entry.mParent;
+    }
+
+    return returnList;
+}
+
+void AstarSearch::pushOpen(uint32_t index)
+{
+    mEntries[index].mHeapIndex = static_cast<uint32_t>(mOpenHeap.size());
+    mOpenHeap.push_back(index);
+    siftUp(mEntries[index].mHeapIndex);
+}
+
+uint32_t AstarSearch::popOpen()
+{
+    uint32_t top = mOpenHeap.front();
+    uint32_t last = mOpenHeap.back();
+    mOpenHeap.pop_back();
+    if(!mOpenHeap.empty())
+    {
+        mOpenHeap[0] = last;
+        mEntries[last].mHeapIndex = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void AstarSearch::siftUp(uint32_t heapPos)
+{
+    uint32_t index = mOpenHeap[heapPos];
+    while(heapPos > 0)
+    {
+        uint32_t parentPos = (heapPos - 1) / 2;
+        uint32_t parentIndex = mOpenHeap[parentPos];
+        if(!isBefore(index, parentIndex))
+            break;
+
+        mOpenHeap[heapPos] = parentIndex;
+        mEntries[parentIndex].mHeapIndex = heapPos;
+        heapPos = parentPos;
+    }
+    mOpenHeap[heapPos] = index;
+    mEntries[index].mHeapIndex = heapPos;
+}
+
+void AstarSearch::siftDown(uint32_t heapPos)
+{
+    uint32_t size = static_cast<uint32_t>(mOpenHeap.size());
+    uint32_t index = mOpenHeap[heapPos];
+    while(true)
+    {
+        uint32_t childPos = 2 * heapPos + 1;
+        if(childPos >= size)
+            break;
+
+        if((childPos + 1 < size) && isBefore(mOpenHeap[childPos + 1], mOpenHeap[childPos]))
+            ++childPos;
+
+        uint32_t childIndex = mOpenHeap[childPos];
+        if(!isBefore(childIndex, index))
+            break;
+
+        mOpenHeap[heapPos] = childIndex;
+        mEntries[childIndex].mHeapIndex = heapPos;
+        heapPos = childPos;
+    }
+    mOpenHeap[heapPos] = index;
+    mEntries[index].mHeapIndex = heapPos;
+}
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASTARSEARCH_H
+#define ASTARSEARCH_H
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+class Creature;
+class Seat;
+class Tile;
+class TileContainer;
+
+/*! \brief The A* search engine used by GameMap::path.
+ *
+ * The open list is an indexed binary heap sorted by fCost. When 2 entries have the
+ * same fCost, the one that was added first in the open list is used. That is the same
+ * order as the linear scan that was used before so the computed paths do not change.
+ * Knowing if a tile is in the open or the closed list is done in O(1) thanks to the
+ * per tile search slots of the TileContainer. The entries are stored in vectors that are
+ * kept from one search to another to avoid allocating memory at each call.
+ *
+ * The A* description can be found here:
+ * http://en.wikipedia.org/wiki/A*_search_algorithm
+ */
+class AstarSearch
+{
+public:
+    AstarSearch();
+
+    //! \brief Computes the path between start and destination for the given creature. The
+    //! returned path contains both start and destination tiles. If no path can be found, it is empty.
+    //! \param seat The seat is used when searching a diggable path to know
+    //! what tile actually diggable for the given team.
+    std::list<Tile*> path(TileContainer& tileContainer, Tile* start, Tile* destination,
+        const Creature* creature, Seat* seat, bool throughDiggableTiles);
+
+    //! \brief Computes the cost to go from the given tile to one of its neighbors.
+    static double computeWeightToParent(Tile* tile, const Tile* neighbor, const Creature* creature);
+
+    //! \brief Manhattan distance between 2 tiles. Used as heuristic.
+    static double computeHeuristic(int x1, int y1, int x2, int y2);
+
+private:
+    //! \brief A helper class storing the data about a tile reached by the search.
+    class AstarEntry
+    {
+    public:
+        AstarEntry(Tile* tile, uint32_t parent, double g, double h) :
+            mTile       (tile),
+            mParent     (parent),
+            mG          (g),
+            mH          (h),
+            mHeapIndex  (0),
+            mIsClosed   (false)
+        {}
+
+        inline double fCost() const
+        { return mG + mH; }
+
+        Tile*       mTile;
+        uint32_t    mParent;
+        double      mG;
+        double      mH;
+        //! \brief Position in the open heap. Only valid when the entry is not closed.
+        uint32_t    mHeapIndex;
+        bool        mIsClosed;
+    };
+
+    //! \brief Returns true if the entry at index1 should be processed before the one at index2.
+    //! As entries are added in the arena in the same order as they are added in the open list,
+    //! the arena index is used to break ties.
+    inline bool isBefore(uint32_t index1, uint32_t index2) const
+    {
+        double f1 = mEntries[index1].fCost();
+        double f2 = mEntries[index2].fCost();
+        if(f1 < f2)
+            return true;
+        if(f2 < f1)
+            return false;
+
+        return index1 < index2;
+    }
+
+    void pushOpen(uint32_t index);
+    uint32_t popOpen();
+    void siftUp(uint32_t heapPos);
+    void siftDown(uint32_t heapPos);
+
+    //! \brief Arena containing every entry reached by the current search.
+    std::vector<AstarEntry> mEntries;
+
+    //! \brief Binary heap of indexes in mEntries.
+    std::vector<uint32_t> mOpenHeap;
+};
+
+#endif // ASTARSEARCH_H
@@ -0,0 +1,490 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/ClusterGraph.h"
+
+#include "entities/Creature.h"
+#include "entities/Tile.h"
+
+#include "gamemap/AstarSearch.h"
+#include "gamemap/TileContainer.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+const int ClusterGraph::CLUSTER_SIZE = 10;
+
+//! \brief Entrances longer than this will give 2 nodes (one at each end) instead of one in the middle
+static const int MAX_SINGLE_TRANSITION_ENTRANCE = 6;
+
+static const uint32_t NO_PARENT = 0xFFFFFFFF;
+
+ClusterGraph::ClusterGraph(TileContainer& tileContainer) :
+    mTileContainer(tileContainer),
+    mNbClustersX(0),
+    mNbClustersY(0),
+    mDistancesClusterX(-1),
+    mDistancesClusterY(-1)
+{
+}
+
+void ClusterGraph::init()
+{
+    mNbClustersX = (mTileContainer.getMapSizeX() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    mNbClustersY = (mTileContainer.getMapSizeY() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    mClusters.clear();
+    mClusters.resize(mNbClustersX * mNbClustersY);
+    mDistances.assign(CLUSTER_SIZE * CLUSTER_SIZE, -1);
+    mDistancesClusterX = -1;
+    mDistancesClusterY = -1;
+}
+
+ClusterGraph::MovementClass ClusterGraph::getMovementClass(const Creature* creature)
+{
+    if((creature->getMoveSpeedWater() > 0.0) &&
+        (creature->getMoveSpeedLava() > 0.0))
+    {
+        return MovementClassGroundWaterLava;
+    }
+
+    if(creature->getMoveSpeedWater() > 0.0)
+        return MovementClassGroundWater;
+
+    if(creature->getMoveSpeedLava() > 0.0)
+        return MovementClassGroundLava;
+
+    return MovementClassGround;
+}
+
+bool ClusterGraph::isPassable(const Tile* tile, MovementClass movementClass)
+{
+    if(tile == nullptr)
+        return false;
+
+    // We use the same rules as Creature::canGoThroughTile
+    switch(tile->getType())
+    {
+        case Tile::dirt:
+        case Tile::gold:
+        case Tile::claimed:
+            return (tile->getFullness() == 0.0);
+        case Tile::water:
+            return (movementClass == MovementClassGroundWater) ||
+                (movementClass == MovementClassGroundWaterLava);
+        case Tile::lava:
+            return (movementClass == MovementClassGroundLava) ||
+                (movementClass == MovementClassGroundWaterLava);
+        default:
+            return false;
+    }
+}
+
+int ClusterGraph::getClusterIndex(const Tile* tile) const
+{
+    return (tile->getX() / CLUSTER_SIZE) * mNbClustersY + (tile->getY() / CLUSTER_SIZE);
+}
+
+void ClusterGraph::setClusterDirty(int clusterX, int clusterY)
+{
+    if((clusterX < 0) || (clusterX >= mNbClustersX))
+        return;
+    if((clusterY < 0) || (clusterY >= mNbClustersY))
+        return;
+
+    Cluster& cluster = mClusters[clusterX * mNbClustersY + clusterY];
+    for(int i = 0; i < MovementClassMax; ++i)
+        cluster.mIsDirty[i] = true;
+}
+
+void ClusterGraph::setTileDirty(const Tile* tile)
+{
+    if(mClusters.empty())
+        return;
+
+    int x = tile->getX();
+    int y = tile->getY();
+    if((x < 0) || (x >= mTileContainer.getMapSizeX()) ||
+       (y < 0) || (y >= mTileContainer.getMapSizeY()))
+    {
+        return;
+    }
+
+    int clusterX = x / CLUSTER_SIZE;
+    int clusterY = y / CLUSTER_SIZE;
+    setClusterDirty(clusterX, clusterY);
+
+    // If the tile is on a border, the entrances of the neighbor cluster may change too
+    if((x % CLUSTER_SIZE) == 0)
+        setClusterDirty(clusterX - 1, clusterY);
+    if((x % CLUSTER_SIZE) == (CLUSTER_SIZE - 1))
+        setClusterDirty(clusterX + 1, clusterY);
+    if((y % CLUSTER_SIZE) == 0)
+        setClusterDirty(clusterX, clusterY - 1);
+    if((y % CLUSTER_SIZE) == (CLUSTER_SIZE - 1))
+        setClusterDirty(clusterX, clusterY + 1);
+}
+
+void ClusterGraph::computeBorderTransitions(int clusterX, int clusterY, int neighborX, int neighborY,
+    MovementClass movementClass, std::vector<Tile*>& transitions)
+{
+    // We process the border from the cluster with the lowest coordinates so that the transitions
+    // are the same when computed from both sides
+    bool isFirst = (clusterX < neighborX) || (clusterY < neighborY);
+    int firstX = isFirst ? clusterX : neighborX;
+    int firstY = isFirst ? clusterY : neighborY;
+    bool isVertical = (clusterX != neighborX);
+
+    int length;
+    if(isVertical)
+        length = std::min(CLUSTER_SIZE, mTileContainer.getMapSizeY() - firstY * CLUSTER_SIZE);
+    else
+        length = std::min(CLUSTER_SIZE, mTileContainer.getMapSizeX() - firstX * CLUSTER_SIZE);
+
+    int entranceStart = -1;
+    for(int i = 0; i <= length; ++i)
+    {
+        bool isOpen = false;
+        if(i < length)
+        {
+            Tile* tileFirst;
+            Tile* tileSecond;
+            if(isVertical)
+            {
+                int x = (firstX + 1) * CLUSTER_SIZE - 1;
+                int y = firstY * CLUSTER_SIZE + i;
+                tileFirst = mTileContainer.getTile(x, y);
+                tileSecond = mTileContainer.getTile(x + 1, y);
+            }
+            else
+            {
+                int x = firstX * CLUSTER_SIZE + i;
+                int y = (firstY + 1) * CLUSTER_SIZE - 1;
+                tileFirst = mTileContainer.getTile(x, y);
+                tileSecond = mTileContainer.getTile(x, y + 1);
+            }
+            isOpen = isPassable(tileFirst, movementClass) && isPassable(tileSecond, movementClass);
+        }
+
+        if(isOpen)
+        {
+            if(entranceStart == -1)
+                entranceStart = i;
+            continue;
+        }
+
+        if(entranceStart == -1)
+            continue;
+
+        // We have found an entrance from entranceStart to i - 1
+        int entranceEnd = i - 1;
+        std::vector<int> offsets;
+        if(entranceEnd - entranceStart + 1 < MAX_SINGLE_TRANSITION_ENTRANCE)
+        {
+            offsets.push_back((entranceStart + entranceEnd) / 2);
+        }
+        else
+        {
+            offsets.push_back(entranceStart);
+            offsets.push_back(entranceEnd);
+        }
+        entranceStart = -1;
+
+        for(int offset : offsets)
+        {
+            Tile* tileFirst;
+            Tile* tileSecond;
+            if(isVertical)
+            {
+                int x = (firstX + 1) * CLUSTER_SIZE - 1;
+                int y = firstY * CLUSTER_SIZE + offset;
+                tileFirst = mTileContainer.getTile(x, y);
+                tileSecond = mTileContainer.getTile(x + 1, y);
+            }
+            else
+            {
+                int x = firstX * CLUSTER_SIZE + offset;
+                int y = (firstY + 1) * CLUSTER_SIZE - 1;
+                tileFirst = mTileContainer.getTile(x, y);
+                tileSecond = mTileContainer.getTile(x, y + 1);
+            }
+
+            if(isFirst)
+            {
+                transitions.push_back(tileFirst);
+                transitions.push_back(tileSecond);
+            }
+            else
+            {
+                transitions.push_back(tileSecond);
+                transitions.push_back(tileFirst);
+            }
+        }
+    }
+}
+
+void ClusterGraph::computeDistances(Tile* tile, MovementClass movementClass)
+{
+    mDistancesClusterX = tile->getX() / CLUSTER_SIZE;
+    mDistancesClusterY = tile->getY() / CLUSTER_SIZE;
+    int minX = mDistancesClusterX * CLUSTER_SIZE;
+    int minY = mDistancesClusterY * CLUSTER_SIZE;
+    int maxX = std::min(minX + CLUSTER_SIZE, mTileContainer.getMapSizeX()) - 1;
+    int maxY = std::min(minY + CLUSTER_SIZE, mTileContainer.getMapSizeY()) - 1;
+
+    std::fill(mDistances.begin(), mDistances.end(), -1);
+    mQueue.clear();
+    mDistances[(tile->getX() - minX) * CLUSTER_SIZE + (tile->getY() - minY)] = 0;
+    mQueue.push_back(tile);
+
+    // Breadth first search limited to the tiles of the cluster. We only use the 4 adjacent tiles
+    // because a diagonal move costs the same as 2 adjacent ones (manhattan distance)
+    for(uint32_t index = 0; index < mQueue.size(); ++index)
+    {
+        Tile* current = mQueue[index];
+        int distance = mDistances[(current->getX() - minX) * CLUSTER_SIZE + (current->getY() - minY)];
+        for(Tile* neigh : current->getAllNeighbors())
+        {
+            if((neigh->getX() < minX) || (neigh->getX() > maxX) ||
+               (neigh->getY() < minY) || (neigh->getY() > maxY))
+            {
+                continue;
+            }
+
+            int& neighDistance = mDistances[(neigh->getX() - minX) * CLUSTER_SIZE + (neigh->getY() - minY)];
+            if(neighDistance != -1)
+                continue;
+
+            if(!isPassable(neigh, movementClass))
+                continue;
+
+            neighDistance = distance + 1;
+            mQueue.push_back(neigh);
+        }
+    }
+}
+
+int ClusterGraph::getDistance(const Tile* tile) const
+{
+    int minX = mDistancesClusterX * CLUSTER_SIZE;
+    int minY = mDistancesClusterY * CLUSTER_SIZE;
+    int x = tile->getX() - minX;
+    int y = tile->getY() - minY;
+    if((x < 0) || (x >= CLUSTER_SIZE) || (y < 0) || (y >= CLUSTER_SIZE))
+        return -1;
+
+    return mDistances[x * CLUSTER_SIZE + y];
+}
+
+void ClusterGraph::rebuildCluster(int clusterX, int clusterY, MovementClass movementClass)
+{
+    Cluster& cluster = mClusters[clusterX * mNbClustersY + clusterY];
+    std::vector<ClusterNode>& nodes = cluster.mNodes[movementClass];
+    nodes.clear();
+    cluster.mIsDirty[movementClass] = false;
+
+    std::vector<Tile*> transitions;
+    if(clusterX > 0)
+        computeBorderTransitions(clusterX, clusterY, clusterX - 1, clusterY, movementClass, transitions);
+    if(clusterX < mNbClustersX - 1)
+        computeBorderTransitions(clusterX, clusterY, clusterX + 1, clusterY, movementClass, transitions);
+    if(clusterY > 0)
+        computeBorderTransitions(clusterX, clusterY, clusterX, clusterY - 1, movementClass, transitions);
+    if(clusterY < mNbClustersY - 1)
+        computeBorderTransitions(clusterX, clusterY, clusterX, clusterY + 1, movementClass, transitions);
+
+    // Inter cluster edges. A tile in a corner can be used by 2 borders. In this case, we
+    // only use one node
+    for(uint32_t i = 0; i + 1 < transitions.size(); i += 2)
+    {
+        Tile* tile = transitions[i];
+        ClusterNode* node = findNode(tile, movementClass);
+        if(node == nullptr)
+        {
+            nodes.push_back(ClusterNode(tile));
+            node = &nodes.back();
+        }
+        node->mEdges.push_back(ClusterEdge(transitions[i + 1], 1.0));
+    }
+
+    // Intra cluster edges
+    for(ClusterNode& node : nodes)
+    {
+        computeDistances(node.mTile, movementClass);
+        for(const ClusterNode& other : nodes)
+        {
+            if(&other == &node)
+                continue;
+
+            int distance = getDistance(other.mTile);
+            if(distance <= 0)
+                continue;
+
+            node.mEdges.push_back(ClusterEdge(other.mTile, static_cast<double>(distance)));
+        }
+    }
+}
+
+ClusterGraph::ClusterNode* ClusterGraph::findNode(Tile* tile, MovementClass movementClass)
+{
+    std::vector<ClusterNode>& nodes = mClusters[getClusterIndex(tile)].mNodes[movementClass];
+    for(ClusterNode& node : nodes)
+    {
+        if(node.mTile == tile)
+            return &node;
+    }
+    return nullptr;
+}
+
+bool ClusterGraph::findWaypoints(Tile* start, Tile* destination, MovementClass movementClass,
+    std::vector<Tile*>& waypoints)
+{
+    waypoints.clear();
+    if(mClusters.empty())
+        return false;
+
+    int startCluster = getClusterIndex(start);
+    int destinationCluster = getClusterIndex(destination);
+    if(startCluster == destinationCluster)
+        return false;
+
+    // We refresh the clusters that have changed since the last search
+    for(int clusterX = 0; clusterX < mNbClustersX; ++clusterX)
+    {
+        for(int clusterY = 0; clusterY < mNbClustersY; ++clusterY)
+        {
+            if(mClusters[clusterX * mNbClustersY + clusterY].mIsDirty[movementClass])
+                rebuildCluster(clusterX, clusterY, movementClass);
+        }
+    }
+
+    // Temporary edges from the start tile to the nodes of its cluster and from the nodes of the
+    // destination cluster to the destination tile
+    mStartEdges.clear();
+    computeDistances(start, movementClass);
+    for(const ClusterNode& node : mClusters[startCluster].mNodes[movementClass])
+    {
+        int distance = getDistance(node.mTile);
+        if(distance >= 0)
+            mStartEdges.push_back(ClusterEdge(node.mTile, static_cast<double>(distance)));
+    }
+
+    mDestinationEdges.clear();
+    computeDistances(destination, movementClass);
+    for(const ClusterNode& node : mClusters[destinationCluster].mNodes[movementClass])
+    {
+        int distance = getDistance(node.mTile);
+        if(distance >= 0)
+            mDestinationEdges.push_back(ClusterEdge(node.mTile, static_cast<double>(distance)));
+    }
+
+    if(mStartEdges.empty() || mDestinationEdges.empty())
+        return false;
+
+    typedef std::pair<double, uint32_t> OpenEntry;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList;
+    mEntries.clear();
+    mTileContainer.startTileSearch();
+
+    int x2 = destination->getX();
+    int y2 = destination->getY();
+    mEntries.push_back(ClusterSearchEntry(start, NO_PARENT, 0.0,
+        AstarSearch::computeHeuristic(start->getX(), start->getY(), x2, y2)));
+    mTileContainer.setTileSearchSlot(start, 0);
+    openList.push(OpenEntry(mEntries[0].mF, 0));
+
+    std::vector<const ClusterEdge*> edges;
+    uint32_t destinationIndex = NO_PARENT;
+    while(!openList.empty())
+    {
+        uint32_t currentIndex = openList.top().second;
+        openList.pop();
+        if(mEntries[currentIndex].mIsClosed)
+            continue;
+
+        mEntries[currentIndex].mIsClosed = true;
+        Tile* currentTile = mEntries[currentIndex].mTile;
+        if(currentTile == destination)
+        {
+            destinationIndex = currentIndex;
+            break;
+        }
+
+        edges.clear();
+        if(currentTile == start)
+        {
+            for(const ClusterEdge& edge : mStartEdges)
+                edges.push_back(&edge);
+        }
+        ClusterNode* node = findNode(currentTile, movementClass);
+        if(node != nullptr)
+        {
+            for(const ClusterEdge& edge : node->mEdges)
+                edges.push_back(&edge);
+        }
+
+        double destinationCost = -1.0;
+        if(getClusterIndex(currentTile) == destinationCluster)
+        {
+            for(const ClusterEdge& edge : mDestinationEdges)
+            {
+                if(edge.mTarget == currentTile)
+                {
+                    destinationCost = edge.mCost;
+                    break;
+                }
+            }
+        }
+        ClusterEdge destinationEdge(destination, destinationCost);
+        if(destinationCost >= 0.0)
+            edges.push_back(&destinationEdge);
+
+        for(const ClusterEdge* edge : edges)
+        {
+            Tile* target = edge->mTarget;
+            double newG = mEntries[currentIndex].mG + edge->mCost;
+            uint32_t targetIndex = mTileContainer.getTileSearchSlot(target);
+            if(targetIndex == TileContainer::TILE_SEARCH_NO_SLOT)
+            {
+                targetIndex = static_cast<uint32_t>(mEntries.size());
+                mEntries.push_back(ClusterSearchEntry(target, currentIndex, newG,
+                    newG + AstarSearch::computeHeuristic(target->getX(), target->getY(), x2, y2)));
+                mTileContainer.setTileSearchSlot(target, targetIndex);
+                openList.push(OpenEntry(mEntries[targetIndex].mF, targetIndex));
+                continue;
+            }
+
+            ClusterSearchEntry& targetEntry = mEntries[targetIndex];
+            if(targetEntry.mIsClosed || (newG >= targetEntry.mG))
+                continue;
+
+            targetEntry.mF += newG - targetEntry.mG;
+            targetEntry.mG = newG;
+            targetEntry.mParent = currentIndex;
+            openList.push(OpenEntry(targetEntry.mF, targetIndex));
+        }
+    }
+
+    if(destinationIndex == NO_PARENT)
+        return false;
+
+    for(uint32_t index = destinationIndex; index != NO_PARENT; index = mEntries[index].mParent)
+        waypoints.push_back(mEntries[index].mTile);
+
+    std::reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUSTERGRAPH_H
+#define CLUSTERGRAPH_H
+
+#include <cstdint>
+#include <vector>
+
+class Creature;
+class Tile;
+class TileContainer;
+
+/*! \brief Abstract graph used for hierarchical path finding (HPA*).
+ *
+ * The map is split in square clusters of CLUSTER_SIZE tiles. For each movement class, the
+ * passable tiles on both sides of a border between 2 clusters are grouped in entrances and
+ * each entrance gives 1 or 2 nodes on each side. The nodes of a cluster are linked together
+ * with their walking distance inside the cluster and to the node on the other side of the
+ * border with a cost of 1.
+ * When a tile changes, the clusters it belongs to are flagged as dirty and they will be
+ * rebuilt on the next search using their movement class. That way, only the clusters that
+ * have changed since the last search are computed again.
+ * The costs do not depend on the creature speed. The returned waypoints have to be refined
+ * with a tile level search using the creature.
+ */
+class ClusterGraph
+{
+public:
+    //! \brief The different kind of tiles a creature can walk through.
+    enum MovementClass
+    {
+        MovementClassGround = 0,
+        MovementClassGroundWater,
+        MovementClassGroundLava,
+        MovementClassGroundWaterLava,
+        MovementClassMax
+    };
+
+    //! \brief Size (in tiles) of the side of a cluster.
+    static const int CLUSTER_SIZE;
+
+    ClusterGraph(TileContainer& tileContainer);
+
+    //! \brief Resets the graph for the current map size. Every cluster will be computed
+    //! on the next search.
+    void init();
+
+    //! \brief Should be called when the type or the fullness of the given tile changes.
+    void setTileDirty(const Tile* tile);
+
+    //! \brief Searches the abstract path between start and destination for the given movement class.
+    //! If found, waypoints will contain start, the entrances crossed and destination. Two consecutive waypoints
+    //! are either in the same cluster or neighbors on both sides of a cluster border.
+    //! \returns false if no path could be found or if start and destination are within the same cluster
+    bool findWaypoints(Tile* start, Tile* destination, MovementClass movementClass,
+        std::vector<Tile*>& waypoints);
+
+    //! \brief Returns the movement class to use for the given creature. It uses the same rules as
+    //! GameMap::pathExists
+    static MovementClass getMovementClass(const Creature* creature);
+
+    //! \brief Returns true if the given tile can be walked through by the given movement class
+    static bool isPassable(const Tile* tile, MovementClass movementClass);
+
+private:
+    class ClusterEdge
+    {
+    public:
+        ClusterEdge(Tile* target, double cost) :
+            mTarget (target),
+            mCost   (cost)
+        {}
+
+        Tile*   mTarget;
+        double  mCost;
+    };
+
+    class ClusterNode
+    {
+    public:
+        ClusterNode(Tile* tile) :
+            mTile   (tile)
+        {}
+
+        Tile*                       mTile;
+        std::vector<ClusterEdge>    mEdges;
+    };
+
+    class Cluster
+    {
+    public:
+        Cluster()
+        {
+            for(int i = 0; i < MovementClassMax; ++i)
+                mIsDirty[i] = true;
+        }
+
+        std::vector<ClusterNode>    mNodes[MovementClassMax];
+        bool                        mIsDirty[MovementClassMax];
+    };
+
+    //! \brief A helper class storing the data about a node reached by the abstract search.
+    class ClusterSearchEntry
+    {
+    public:
+        ClusterSearchEntry(Tile* tile, uint32_t parent, double g, double f) :
+            mTile       (tile),
+            mParent     (parent),
+            mG          (g),
+            mF          (f),
+            mIsClosed   (false)
+        {}
+
+        Tile*       mTile;
+        uint32_t    mParent;
+        double      mG;
+        double      mF;
+        bool        mIsClosed;
+    };
+
+    TileContainer& mTileContainer;
+
+    int mNbClustersX;
+    int mNbClustersY;
+    std::vector<Cluster> mClusters;
+
+    //! \brief Buffers used by computeDistances. They are kept to avoid allocating memory at each call
+    std::vector<int> mDistances;
+    std::vector<Tile*> mQueue;
+    int mDistancesClusterX;
+    int mDistancesClusterY;
+
+    //! \brief Buffers used by findWaypoints
+    std::vector<ClusterSearchEntry> mEntries;
+    std::vector<ClusterEdge> mStartEdges;
+    std::vector<ClusterEdge> mDestinationEdges;
+
+    int getClusterIndex(const Tile* tile) const;
+    void setClusterDirty(int clusterX, int clusterY);
+
+    //! \brief Computes the nodes and the edges of the given cluster for the given movement class
+    void rebuildCluster(int clusterX, int clusterY, MovementClass movementClass);
+
+    //! \brief Adds in transitions the tiles pairs (tile in the first cluster, tile in the second one) that
+    //! are used to cross the border between the 2 given clusters. They are in the same order for both clusters.
+    void computeBorderTransitions(int clusterX, int clusterY, int neighborX, int neighborY,
+        MovementClass movementClass, std::vector<Tile*>& transitions);
+
+    //! \brief Fills mDistances with the walking distance from the given tile to every tile of its
+    //! cluster. Unreachable tiles are set to -1.
+    void computeDistances(Tile* tile, MovementClass movementClass);
+
+    //! \brief Returns the distance computed by the last call to computeDistances for the given tile.
+    int getDistance(const Tile* tile) const;
+
+    ClusterNode* findNode(Tile* tile, MovementClass movementClass);
+};
+
+#endif // CLUSTERGRAPH_H
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/DistanceField.h"
+
+#include "entities/Tile.h"
+
+#include "gamemap/TileContainer.h"
+
+const uint32_t DistanceField::UNREACHABLE = 0xFFFFFFFF;
+
+DistanceField::DistanceField() :
+    mMapSizeY(0)
+{
+}
+
+int DistanceField::getIndex(const Tile* tile) const
+{
+    return tile->getX() * mMapSizeY + tile->getY();
+}
+
+void DistanceField::compute(const TileContainer& tileContainer, const std::vector<Tile*>& targets,
+    ClusterGraph::MovementClass movementClass)
+{
+    mMapSizeY = tileContainer.getMapSizeY();
+    uint32_t nbTiles = tileContainer.getMapSizeX() * tileContainer.getMapSizeY();
+    mDistances.assign(nbTiles, UNREACHABLE);
+    mClosestTargets.assign(nbTiles, nullptr);
+    mQueue.clear();
+
+    for(Tile* target : targets)
+    {
+        int index = getIndex(target);
+        if(mDistances[index] == 0)
+            continue;
+
+        mDistances[index] = 0;
+        mClosestTargets[index] = target;
+        mQueue.push_back(target);
+    }
+
+    // As every step costs the same, the queue is always sorted by distance
+    for(uint32_t i = 0; i < mQueue.size(); ++i)
+    {
+        Tile* tile = mQueue[i];
+        int index = getIndex(tile);
+        for(Tile* neigh : tile->getAllNeighbors())
+        {
+            int neighIndex = getIndex(neigh);
+            if(mDistances[neighIndex] != UNREACHABLE)
+                continue;
+
+            if(!ClusterGraph::isPassable(neigh, movementClass))
+                continue;
+
+            mDistances[neighIndex] = mDistances[index] + 1;
+            mClosestTargets[neighIndex] = mClosestTargets[index];
+            mQueue.push_back(neigh);
+        }
+    }
+}
+
+uint32_t DistanceField::getDistance(const Tile* tile) const
+{
+    if(mDistances.empty())
+        return UNREACHABLE;
+
+    return mDistances[getIndex(tile)];
+}
+
+Tile* DistanceField::getClosestTarget(const Tile* tile) const
+{
+    if(mClosestTargets.empty())
+        return nullptr;
+
+    return mClosestTargets[getIndex(tile)];
+}
@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include "gamemap/ClusterGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+class Tile;
+class TileContainer;
+
+/*! \brief Walking distance from every tile of the map to the closest tile of a set of targets.
+ *
+ * The field is computed once with a multi-source search (Dijkstra with unit costs) starting
+ * from all the targets at the same time. After that, the distance to the closest target and
+ * the target itself can be read in O(1) for any tile. Only the 4 adjacent tiles are used and
+ * the passability only depends on the movement class, not on the creature speed.
+ */
+class DistanceField
+{
+public:
+    //! \brief Distance returned for tiles from where no target can be reached.
+    static const uint32_t UNREACHABLE;
+
+    DistanceField();
+
+    //! \brief Computes the field for the given targets. Previous values are forgotten.
+    void compute(const TileContainer& tileContainer, const std::vector<Tile*>& targets,
+        ClusterGraph::MovementClass movementClass);
+
+    //! \brief Returns the number of tiles to walk from the given tile to the closest target
+    //! or UNREACHABLE.
+    uint32_t getDistance(const Tile* tile) const;
+
+    //! \brief Returns the closest target from the given tile or nullptr if none can be reached.
+    Tile* getClosestTarget(const Tile* tile) const;
+
+private:
+    int mMapSizeY;
+    std::vector<uint32_t> mDistances;
+    std::vector<Tile*> mClosestTargets;
+    std::vector<Tile*> mQueue;
+
+    int getIndex(const Tile* tile) const;
+};
+
+#endif // DISTANCEFIELD_H
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/EntityChunkIndex.h"
+
+#include <algorithm>
+
+const int EntityChunkIndex::CHUNK_SIZE = 8;
+const uint32_t EntityChunkIndex::NB_SEAT_SLOTS = 64;
+const uint32_t EntityChunkIndex::NO_SEAT_SLOT = NB_SEAT_SLOTS - 1;
+const uint64_t EntityChunkIndex::ALL_SEATS = 0xFFFFFFFFFFFFFFFFull;
+
+static const uint32_t NB_CATEGORIES = static_cast<uint32_t>(EntityChunkIndex::Category::nbCategories);
+
+EntityChunkIndex::EntityChunkIndex() :
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mNbChunksX(0),
+    mNbChunksY(0)
+{
+}
+
+void EntityChunkIndex::setMapSize(int sizeX, int sizeY)
+{
+    mMapSizeX = sizeX;
+    mMapSizeY = sizeY;
+    mNbChunksX = (sizeX + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    mNbChunksY = (sizeY + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    uint32_t nbChunks = static_cast<uint32_t>(mNbChunksX * mNbChunksY);
+    mMasks.assign(nbChunks * NB_CATEGORIES, 0);
+    mCounts.assign(nbChunks * NB_CATEGORIES * NB_SEAT_SLOTS, 0);
+}
+
+void EntityChunkIndex::clear()
+{
+    std::fill(mMasks.begin(), mMasks.end(), 0);
+    std::fill(mCounts.begin(), mCounts.end(), 0);
+}
+
+int EntityChunkIndex::getChunkIndex(int x, int y) const
+{
+    if((x < 0) || (y < 0) || (x >= mMapSizeX) || (y >= mMapSizeY))
+        return -1;
+
+    return (x / CHUNK_SIZE) * mNbChunksY + (y / CHUNK_SIZE);
+}
+
+void EntityChunkIndex::add(Category category, uint32_t slot, int x, int y)
+{
+    int chunkIndex = getChunkIndex(x, y);
+    if(chunkIndex < 0)
+        return;
+
+    slot = std::min(slot, NO_SEAT_SLOT);
+    uint32_t maskIndex = chunkIndex * NB_CATEGORIES + static_cast<uint32_t>(category);
+    uint16_t& count = mCounts[maskIndex * NB_SEAT_SLOTS + slot];
+    ++count;
+    mMasks[maskIndex] |= getSeatSlotBit(slot);
+}
+
+void EntityChunkIndex::remove(Category category, uint32_t slot, int x, int y)
+{
+    int chunkIndex = getChunkIndex(x, y);
+    if(chunkIndex < 0)
+        return;
+
+    slot = std::min(slot, NO_SEAT_SLOT);
+    uint32_t maskIndex = chunkIndex * NB_CATEGORIES + static_cast<uint32_t>(category);
+    uint16_t& count = mCounts[maskIndex * NB_SEAT_SLOTS + slot];
+    if(count == 0)
+        return;
+
+    --count;
+    if(count == 0)
+        mMasks[maskIndex] &= ~getSeatSlotBit(slot);
+}
+
+uint32_t EntityChunkIndex::getCount(Category category, uint32_t slot, int x, int y) const
+{
+    int chunkIndex = getChunkIndex(x, y);
+    if(chunkIndex < 0)
+        return 0;
+
+    slot = std::min(slot, NO_SEAT_SLOT);
+    uint32_t maskIndex = chunkIndex * NB_CATEGORIES + static_cast<uint32_t>(category);
+    return mCounts[maskIndex * NB_SEAT_SLOTS + slot];
+}
+
+bool EntityChunkIndex::chunkHasEntity(int chunkIndex, uint32_t categories, uint64_t seatMask) const
+{
+    const uint64_t* masks = &mMasks[chunkIndex * NB_CATEGORIES];
+    for(uint32_t category = 0; category < NB_CATEGORIES; ++category)
+    {
+        if(((categories >> category) & 1) == 0)
+            continue;
+
+        if((masks[category] & seatMask) != 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool EntityChunkIndex::hasEntityInChunk(uint32_t categories, uint64_t seatMask, int x, int y) const
+{
+    int chunkIndex = getChunkIndex(x, y);
+    if(chunkIndex < 0)
+        return false;
+
+    return chunkHasEntity(chunkIndex, categories, seatMask);
+}
+
+bool EntityChunkIndex::hasEntityInRadius(uint32_t categories, uint64_t seatMask, int x, int y, int radius) const
+{
+    if((mNbChunksX == 0) || (mNbChunksY == 0) || (radius < 0))
+        return false;
+
+    int minChunkX = std::max(0, x - radius) / CHUNK_SIZE;
+    int minChunkY = std::max(0, y - radius) / CHUNK_SIZE;
+    int maxChunkX = std::min(mMapSizeX - 1, x + radius) / CHUNK_SIZE;
+    int maxChunkY = std::min(mMapSizeY - 1, y + radius) / CHUNK_SIZE;
+    for(int chunkX = minChunkX; chunkX <= maxChunkX; ++chunkX)
+    {
+        for(int chunkY = minChunkY; chunkY <= maxChunkY; ++chunkY)
+        {
+            if(chunkHasEntity(chunkX * mNbChunksY + chunkY, categories, seatMask))
+                return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYCHUNKINDEX_H
+#define ENTITYCHUNKINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*! \brief Counts the entities of the map per chunk of CHUNK_SIZE x CHUNK_SIZE tiles, per category
+ * and per seat slot.
+ *
+ * Each chunk keeps, for each category, a 64 bits mask with the bit of a seat slot set when at least one
+ * entity of this slot is in the chunk. Queries like "is there an enemy creature around this tile"
+ * only check the masks of the chunks overlapping the area instead of looping over the entities of
+ * every tile. The answer is conservative: an entity found by the index may not match the query (it may
+ * be outside of the exact area or not attackable), but if the index finds nothing, there is nothing.
+ * Seat slots are given by the user of the index (the game map uses the seat position in its seat list).
+ * The entities without seat or with a slot too high use NO_SEAT_SLOT.
+ * This class does not depend on the entities so that it can be tested alone. Queries are read only and
+ * can be done from several threads as long as the index is not modified at the same time.
+ */
+class EntityChunkIndex
+{
+public:
+    enum class Category
+    {
+        creature,
+        building,
+        movableObject,
+        nbCategories
+    };
+
+    static const int CHUNK_SIZE;
+    static const uint32_t NB_SEAT_SLOTS;
+    static const uint32_t NO_SEAT_SLOT;
+    //! \brief Mask with every seat slot
+    static const uint64_t ALL_SEATS;
+
+    EntityChunkIndex();
+
+    //! \brief Sets the map size. Every chunk is emptied.
+    void setMapSize(int sizeX, int sizeY);
+
+    //! \brief Empties every chunk.
+    void clear();
+
+    //! \brief Returns the bit to use in the category masks of the queries.
+    static inline uint32_t getCategoryBit(Category category)
+    { return 1 << static_cast<uint32_t>(category); }
+
+    //! \brief Returns the bit of the given slot in the seat masks of the queries.
+    static inline uint64_t getSeatSlotBit(uint32_t slot)
+    { return static_cast<uint64_t>(1) << std::min(slot, NO_SEAT_SLOT); }
+
+    //! \brief Adds an entity of the given category and seat slot on tile (x, y).
+    void add(Category category, uint32_t slot, int x, int y);
+
+    //! \brief Removes an entity added with the same parameters.
+    void remove(Category category, uint32_t slot, int x, int y);
+
+    //! \brief Returns the number of entities of the given category and slot in the chunk containing (x, y).
+    uint32_t getCount(Category category, uint32_t slot, int x, int y) const;
+
+    /*! \brief Returns true if the chunk containing (x, y) has at least one entity of one of the
+     * categories in categories (see getCategoryBit) and one of the slots in seatMask.
+     */
+    bool hasEntityInChunk(uint32_t categories, uint64_t seatMask, int x, int y) const;
+
+    //! \brief Same as hasEntityInChunk for every chunk overlapping the square of tiles within radius of (x, y).
+    bool hasEntityInRadius(uint32_t categories, uint64_t seatMask, int x, int y, int radius) const;
+
+private:
+    int mMapSizeX;
+    int mMapSizeY;
+    int mNbChunksX;
+    int mNbChunksY;
+
+    //! \brief Seat slot masks, indexed by chunk index * nbCategories + category
+    std::vector<uint64_t> mMasks;
+
+    //! \brief Entity counts, indexed by (chunk index * nbCategories + category) * NB_SEAT_SLOTS + slot
+    std::vector<uint16_t> mCounts;
+
+    //! \brief Returns the index of the chunk containing (x, y) or -1 if it is outside of the map
+    int getChunkIndex(int x, int y) const;
+
+    //! \brief Returns true if the chunk has at least one entity of the given categories and slots
+    bool chunkHasEntity(int chunkIndex, uint32_t categories, uint64_t seatMask) const;
+};
+
+#endif // ENTITYCHUNKINDEX_H
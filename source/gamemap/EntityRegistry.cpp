@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/EntityRegistry.h"
+
+const uint32_t EntityRegistry::INVALID_HANDLE = 0;
+
+EntityRegistry::EntityRegistry()
+{
+}
+
+uint32_t EntityRegistry::nextGeneration(uint32_t generation)
+{
+    // Generations use the bits left by the slot index
+    uint32_t maxGeneration = (static_cast<uint32_t>(1) << (32 - SLOT_INDEX_BITS)) - 1;
+    if(generation >= maxGeneration)
+        return 1;
+
+    return generation + 1;
+}
+
+void EntityRegistry::clear()
+{
+    // We keep the generations so that the old handles stay invalid
+    mFreeSlots.clear();
+    for(uint32_t i = 0; i < mSlots.size(); ++i)
+    {
+        Slot& slot = mSlots[i];
+        if(slot.mEntity != nullptr)
+            slot.mGeneration = nextGeneration(slot.mGeneration);
+
+        slot.mEntity = nullptr;
+        slot.mIsOnMap = false;
+        mFreeSlots.push_back(i);
+    }
+    mEntitiesByName.clear();
+}
+
+uint32_t EntityRegistry::createHandle(GameEntity* entity)
+{
+    uint32_t slotIndex;
+    // Slots used with useHandle may still be in the free list
+    while(!mFreeSlots.empty() && (mSlots[mFreeSlots.back()].mEntity != nullptr))
+        mFreeSlots.pop_back();
+
+    if(!mFreeSlots.empty())
+    {
+        slotIndex = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slotIndex = mSlots.size();
+        mSlots.emplace_back();
+    }
+
+    Slot& slot = mSlots[slotIndex];
+    slot.mEntity = entity;
+    slot.mIsOnMap = false;
+    return (slot.mGeneration << SLOT_INDEX_BITS) | slotIndex;
+}
+
+bool EntityRegistry::useHandle(GameEntity* entity, uint32_t handle)
+{
+    if(handle == INVALID_HANDLE)
+        return false;
+
+    uint32_t slotIndex = getSlotIndex(handle);
+    if(slotIndex >= mSlots.size())
+        mSlots.resize(slotIndex + 1);
+
+    Slot& slot = mSlots[slotIndex];
+    bool isSlotFree = (slot.mEntity == nullptr) || (slot.mEntity == entity);
+    if(slot.mEntity != entity)
+        slot.mIsOnMap = false;
+
+    slot.mEntity = entity;
+    slot.mGeneration = getGeneration(handle);
+    return isSlotFree;
+}
+
+void EntityRegistry::releaseHandle(GameEntity* entity, uint32_t handle)
+{
+    uint32_t slotIndex = getSlotIndex(handle);
+    if((handle == INVALID_HANDLE) || (slotIndex >= mSlots.size()))
+        return;
+
+    Slot& slot = mSlots[slotIndex];
+    if((slot.mEntity != entity) || (slot.mGeneration != getGeneration(handle)))
+        return;
+
+    slot.mEntity = nullptr;
+    slot.mIsOnMap = false;
+    slot.mGeneration = nextGeneration(slot.mGeneration);
+    mFreeSlots.push_back(slotIndex);
+}
+
+void EntityRegistry::setOnMap(uint32_t handle, bool isOnMap)
+{
+    if(getSlot(handle) == nullptr)
+        return;
+
+    mSlots[getSlotIndex(handle)].mIsOnMap = isOnMap;
+}
+
+const EntityRegistry::Slot* EntityRegistry::getSlot(uint32_t handle) const
+{
+    uint32_t slotIndex = getSlotIndex(handle);
+    if((handle == INVALID_HANDLE) || (slotIndex >= mSlots.size()))
+        return nullptr;
+
+    const Slot& slot = mSlots[slotIndex];
+    if((slot.mEntity == nullptr) || (slot.mGeneration != getGeneration(handle)))
+        return nullptr;
+
+    return &slot;
+}
+
+GameEntity* EntityRegistry::getEntity(uint32_t handle) const
+{
+    const Slot* slot = getSlot(handle);
+    if((slot == nullptr) || !slot->mIsOnMap)
+        return nullptr;
+
+    return slot->mEntity;
+}
+
+void EntityRegistry::addName(const std::string& name, GameEntity* entity)
+{
+    mEntitiesByName[name] = entity;
+}
+
+void EntityRegistry::removeName(const std::string& name, GameEntity* entity)
+{
+    auto it = mEntitiesByName.find(name);
+    if((it == mEntitiesByName.end()) || (it->second != entity))
+        return;
+
+    mEntitiesByName.erase(it);
+}
+
+GameEntity* EntityRegistry::getEntity(const std::string& name) const
+{
+    auto it = mEntitiesByName.find(name);
+    if(it == mEntitiesByName.end())
+        return nullptr;
+
+    return it->second;
+}
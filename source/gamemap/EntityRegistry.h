@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYREGISTRY_H
+#define ENTITYREGISTRY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GameEntity;
+
+/*! \brief Finds the entities of a game map by handle or by name in constant time.
+ *
+ * Each entity gets a 32 bits handle the first time it is added to the server game map and keeps
+ * it until it is deleted, even if it is removed from the map in between (when picked up or carried).
+ * The handles are sent to the clients which register their copy of the entity with the same handle,
+ * so that the network messages can reference entities without sending their name.
+ * A handle is made of a slot index (low bits) and of the generation of the slot (high bits). The
+ * generation is incremented each time the slot is released so that the handle of a deleted
+ * entity is not valid anymore, even if its slot is reused.
+ * Names are only indexed for the entities on the map. They are used by the save files and the console.
+ */
+class EntityRegistry
+{
+public:
+    //! \brief Never given to an entity. Entities without handle have this one.
+    static const uint32_t INVALID_HANDLE;
+
+    EntityRegistry();
+
+    //! \brief Forgets every entity. Handles given after that will be different from the previous ones.
+    void clear();
+
+    //! \brief Gives a new handle to the entity. The entity is not on map until setOnMap is called.
+    uint32_t createHandle(GameEntity* entity);
+
+    /*! \brief Registers the entity with a handle given by another registry (the server one). If the
+     * slot is already used by another entity, it is replaced and false is returned.
+     */
+    bool useHandle(GameEntity* entity, uint32_t handle);
+
+    //! \brief Frees the handle of a deleted entity. Does nothing if the handle is not used by the entity.
+    void releaseHandle(GameEntity* entity, uint32_t handle);
+
+    //! \brief Sets if the entity with the given handle is on map
+    void setOnMap(uint32_t handle, bool isOnMap);
+
+    //! \brief Returns the entity with the given handle if it is on map, nullptr otherwise
+    GameEntity* getEntity(uint32_t handle) const;
+
+    //! \brief Indexes the name of an entity added to the map
+    void addName(const std::string& name, GameEntity* entity);
+
+    //! \brief Removes the name of an entity removed from the map
+    void removeName(const std::string& name, GameEntity* entity);
+
+    //! \brief Returns the entity on map with the given name, nullptr if there is none
+    GameEntity* getEntity(const std::string& name) const;
+
+private:
+    //! \brief The 20 lowest bits of a handle are the slot index. The others are the generation
+    static const uint32_t SLOT_INDEX_BITS = 20;
+    static const uint32_t SLOT_INDEX_MASK = (1 << SLOT_INDEX_BITS) - 1;
+
+    class Slot
+    {
+    public:
+        Slot() :
+            mEntity(nullptr),
+            mGeneration(1),
+            mIsOnMap(false)
+        {}
+
+        GameEntity* mEntity;
+        uint32_t mGeneration;
+        bool mIsOnMap;
+    };
+
+    std::vector<Slot> mSlots;
+    std::vector<uint32_t> mFreeSlots;
+    std::unordered_map<std::string, GameEntity*> mEntitiesByName;
+
+    static inline uint32_t getSlotIndex(uint32_t handle)
+    { return handle & SLOT_INDEX_MASK; }
+
+    static inline uint32_t getGeneration(uint32_t handle)
+    { return handle >> SLOT_INDEX_BITS; }
+
+    //! \brief Returns the generation following the given one. 0 is skipped so that no handle is 0
+    static uint32_t nextGeneration(uint32_t generation);
+
+    //! \brief Returns the slot used by the handle or nullptr if the handle is not valid
+    const Slot* getSlot(uint32_t handle) const;
+};
+
+#endif // ENTITYREGISTRY_H
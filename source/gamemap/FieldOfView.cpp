@@ -0,0 +1,245 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FieldOfView.h"
+
+#include <algorithm>
+
+//! \brief Returns num / den rounded down. den must be positive.
+static int floorDiv(int num, int den)
+{
+    int result = num / den;
+    if((num % den != 0) && (num < 0))
+        --result;
+
+    return result;
+}
+
+//! \brief Returns num / den rounded up. den must be positive.
+static int ceilDiv(int num, int den)
+{
+    int result = num / den;
+    if((num % den != 0) && (num > 0))
+        ++result;
+
+    return result;
+}
+
+//! \brief A row of a quadrant to scan. The slopes are stored as fractions so that the
+//! scan only uses integers.
+class ScanRow
+{
+public:
+    ScanRow(int depth, int startNum, int startDen, int endNum, int endDen) :
+        mDepth(depth),
+        mStartNum(startNum),
+        mStartDen(startDen),
+        mEndNum(endNum),
+        mEndDen(endDen)
+    {}
+
+    int mDepth;
+    int mStartNum;
+    int mStartDen;
+    int mEndNum;
+    int mEndDen;
+};
+
+//! \brief Buffers used while scanning. There is one per thread so that several threads can
+//! compute fields of view at the same time.
+class FieldOfViewScratch
+{
+public:
+    FieldOfViewScratch() :
+        mVisitGeneration(0)
+    {}
+
+    //! \brief A cell has already been added to the result if its stamp is mVisitGeneration.
+    //! Incrementing the generation invalidates every stamp without clearing anything.
+    std::vector<uint32_t> mVisitStamps;
+    uint32_t mVisitGeneration;
+
+    //! \brief Rows waiting to be scanned
+    std::vector<ScanRow> mRows;
+
+    //! \brief Prepares the stamps for a new computation on a map with nbCells cells.
+    void startComputation(uint32_t nbCells)
+    {
+        if(mVisitStamps.size() < nbCells)
+            mVisitStamps.resize(nbCells, 0);
+
+        ++mVisitGeneration;
+        if(mVisitGeneration == 0)
+        {
+            // The generation has wrapped around. We clear the stamps so that no cell is
+            // considered as already added
+            std::fill(mVisitStamps.begin(), mVisitStamps.end(), 0);
+            mVisitGeneration = 1;
+        }
+    }
+};
+
+static thread_local FieldOfViewScratch scratch;
+
+FieldOfView::FieldOfView() :
+    mMapSizeX(0),
+    mMapSizeY(0)
+{
+}
+
+void FieldOfView::setMapSize(int sizeX, int sizeY)
+{
+    mMapSizeX = sizeX;
+    mMapSizeY = sizeY;
+    mOpaque.assign(sizeX * sizeY, 1);
+}
+
+void FieldOfView::setOpaque(int x, int y, bool opaque)
+{
+    if((x < 0) || (y < 0) || (x >= mMapSizeX) || (y >= mMapSizeY))
+        return;
+
+    mOpaque[x * mMapSizeY + y] = opaque ? 1 : 0;
+}
+
+bool FieldOfView::isOpaque(int x, int y) const
+{
+    if((x < 0) || (y < 0) || (x >= mMapSizeX) || (y >= mMapSizeY))
+        return true;
+
+    return mOpaque[x * mMapSizeY + y] != 0;
+}
+
+void FieldOfView::prepareRadius(int radius)
+{
+    for(int r = static_cast<int>(mOctantMasks.size()); r <= radius; ++r)
+    {
+        int radiusSquared = r * r;
+        std::vector<int> mask(r + 1, 0);
+        int col = r;
+        for(int depth = 0; depth <= r; ++depth)
+        {
+            while(depth * depth + col * col > radiusSquared)
+                --col;
+
+            mask[depth] = col;
+        }
+        mOctantMasks.push_back(mask);
+    }
+}
+
+void FieldOfView::compute(int x, int y, int radius, std::vector<uint32_t>& cells)
+{
+    cells.clear();
+    if((x < 0) || (y < 0) || (x >= mMapSizeX) || (y >= mMapSizeY) || (radius < 0))
+        return;
+
+    if(radius >= static_cast<int>(mOctantMasks.size()))
+        prepareRadius(radius);
+
+    const std::vector<int>& mask = mOctantMasks[radius];
+    std::vector<uint32_t>& visitStamps = scratch.mVisitStamps;
+    std::vector<ScanRow>& rows = scratch.mRows;
+    scratch.startComputation(mOpaque.size());
+    uint32_t generation = scratch.mVisitGeneration;
+
+    cells.push_back(x * mMapSizeY + y);
+    visitStamps[x * mMapSizeY + y] = generation;
+
+    // Each quadrant is scanned from the viewer to the radius. Depth is the distance from the viewer
+    // along the quadrant direction and col the offset on the perpendicular axis.
+    for(int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        rows.clear();
+        rows.push_back(ScanRow(1, -1, 1, 1, 1));
+        while(!rows.empty())
+        {
+            ScanRow row = rows.back();
+            rows.pop_back();
+
+            int depth = row.mDepth;
+            if(depth > radius)
+                continue;
+
+            // The first column is the one whose center is at or after the start slope (rounding ties up)
+            // and the last one the one whose center is at or before the end slope (rounding ties down)
+            int minCol = floorDiv(2 * depth * row.mStartNum + row.mStartDen, 2 * row.mStartDen);
+            int maxCol = ceilDiv(2 * depth * row.mEndNum - row.mEndDen, 2 * row.mEndDen);
+            minCol = std::max(minCol, -mask[depth]);
+            maxCol = std::min(maxCol, mask[depth]);
+
+            // -1 for no previous cell, 0 for a floor and 1 for a wall
+            int previous = -1;
+            for(int col = minCol; col <= maxCol; ++col)
+            {
+                int cellX;
+                int cellY;
+                switch(quadrant)
+                {
+                    case 0:
+                        cellX = x + col;
+                        cellY = y + depth;
+                        break;
+                    case 1:
+                        cellX = x + depth;
+                        cellY = y + col;
+                        break;
+                    case 2:
+                        cellX = x + col;
+                        cellY = y - depth;
+                        break;
+                    default:
+                        cellX = x - depth;
+                        cellY = y + col;
+                        break;
+                }
+
+                bool opaque = isOpaque(cellX, cellY);
+                bool isSymmetric = (col * row.mStartDen >= depth * row.mStartNum) &&
+                    (col * row.mEndDen <= depth * row.mEndNum);
+                if((opaque || isSymmetric) &&
+                   (cellX >= 0) && (cellY >= 0) && (cellX < mMapSizeX) && (cellY < mMapSizeY))
+                {
+                    uint32_t index = cellX * mMapSizeY + cellY;
+                    if(visitStamps[index] != generation)
+                    {
+                        visitStamps[index] = generation;
+                        cells.push_back(index);
+                    }
+                }
+
+                // The slope going through the left side of the current cell
+                int slopeNum = 2 * col - 1;
+                int slopeDen = 2 * depth;
+                if((previous == 1) && !opaque)
+                {
+                    row.mStartNum = slopeNum;
+                    row.mStartDen = slopeDen;
+                }
+                else if((previous == 0) && opaque)
+                {
+                    rows.push_back(ScanRow(depth + 1, row.mStartNum, row.mStartDen, slopeNum, slopeDen));
+                }
+
+                previous = opaque ? 1 : 0;
+            }
+
+            if(previous == 0)
+                rows.push_back(ScanRow(depth + 1, row.mStartNum, row.mStartDen, row.mEndNum, row.mEndDen));
+        }
+    }
+}
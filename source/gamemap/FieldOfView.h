@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FIELDOFVIEW_H
+#define FIELDOFVIEW_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Computes the cells visible from a given cell with symmetric shadowcasting.
+ *
+ * The map is stored as a flat opacity grid (cells are indexed by x * sizeY + y) so that
+ * this class does not depend on the tiles. The 4 quadrants around the viewer are scanned
+ * row by row. Walls narrow the slopes of the next rows and floor cells are only seen if their
+ * center is within the lit slopes, which makes the vision symmetric: if A sees B, B sees A.
+ * Walls are seen as soon as a part of them is lit. The circle of each radius is precomputed
+ * once (the number of cells to scan for each row) so there is no distance computation while scanning.
+ * Cells outside of the map block vision.
+ * The buffers used while scanning are per thread so compute can be called from several threads
+ * at the same time once the circles of the used radius have been prepared.
+ */
+class FieldOfView
+{
+public:
+    FieldOfView();
+
+    //! \brief Sets the map size. Every cell is opaque until setOpaque is called for it.
+    void setMapSize(int sizeX, int sizeY);
+
+    void setOpaque(int x, int y, bool opaque);
+
+    //! \brief Returns true if the given cell blocks vision or is outside of the map.
+    bool isOpaque(int x, int y) const;
+
+    //! \brief Precomputes the circles up to the given radius. Should be called before calling
+    //! compute from several threads.
+    void prepareRadius(int radius);
+
+    /*! \brief Fills cells with the indexes (x * sizeY + y) of the cells visible from the cell (x, y)
+     * and within radius (squared distance <= radius * radius). The viewer cell is always the first
+     * one. The given vector is cleared first and can be reused from one call to another to avoid
+     * allocating memory.
+     */
+    void compute(int x, int y, int radius, std::vector<uint32_t>& cells);
+
+    inline int getMapSizeX() const
+    { return mMapSizeX; }
+
+    inline int getMapSizeY() const
+    { return mMapSizeY; }
+
+private:
+    int mMapSizeX;
+    int mMapSizeY;
+
+    //! \brief 1 if the cell blocks vision, 0 otherwise
+    std::vector<uint8_t> mOpaque;
+
+    //! \brief mOctantMasks[radius][depth] is the highest column within radius for the given depth
+    std::vector<std::vector<int>> mOctantMasks;
+};
+
+#endif // FIELDOFVIEW_H
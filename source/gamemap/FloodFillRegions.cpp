@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FloodFillRegions.h"
+
+FloodFillRegions::FloodFillRegions()
+{
+}
+
+void FloodFillRegions::clear()
+{
+    mParents.clear();
+    mSizes.clear();
+}
+
+void FloodFillRegions::computeRegions(const std::vector<bool>& passable, int sizeX, int sizeY, std::vector<int>& colors)
+{
+    clear();
+    uint32_t nbCells = static_cast<uint32_t>(sizeX * sizeY);
+    colors.assign(nbCells, -1);
+
+    for(uint32_t start = 0; start < nbCells; ++start)
+    {
+        if(!passable[start] || (colors[start] != -1))
+            continue;
+
+        // Breadth first search from the first cell not colored yet
+        int color = newColor();
+        colors[start] = color;
+        mQueue.clear();
+        mQueue.push_back(start);
+        for(uint32_t i = 0; i < mQueue.size(); ++i)
+        {
+            uint32_t cell = mQueue[i];
+            int x = cell / sizeY;
+            int y = cell % sizeY;
+            uint32_t neighbors[4];
+            uint32_t nbNeighbors = 0;
+            if(x > 0)
+                neighbors[nbNeighbors++] = cell - sizeY;
+            if(x < sizeX - 1)
+                neighbors[nbNeighbors++] = cell + sizeY;
+            if(y > 0)
+                neighbors[nbNeighbors++] = cell - 1;
+            if(y < sizeY - 1)
+                neighbors[nbNeighbors++] = cell + 1;
+
+            for(uint32_t k = 0; k < nbNeighbors; ++k)
+            {
+                uint32_t neigh = neighbors[k];
+                if(!passable[neigh] || (colors[neigh] != -1))
+                    continue;
+
+                colors[neigh] = color;
+                mQueue.push_back(neigh);
+            }
+        }
+    }
+}
+
+int FloodFillRegions::newColor()
+{
+    int color = static_cast<int>(mParents.size());
+    mParents.push_back(color);
+    mSizes.push_back(1);
+    return color;
+}
+
+int FloodFillRegions::getRegion(int color) const
+{
+    if(color < 0)
+        return -1;
+
+    // The paths are not compressed so that looking for a region does not change anything. As the
+    // smallest region is always linked to the biggest one, the depth stays logarithmic
+    while(mParents[color] != color)
+        color = mParents[color];
+
+    return color;
+}
+
+void FloodFillRegions::mergeColors(int color1, int color2)
+{
+    int root1 = getRegion(color1);
+    int root2 = getRegion(color2);
+    if((root1 < 0) || (root2 < 0) || (root1 == root2))
+        return;
+
+    // The smallest region is linked to the biggest one
+    if(mSizes[root1] < mSizes[root2])
+    {
+        mParents[root1] = root2;
+        mSizes[root2] += mSizes[root1];
+    }
+    else
+    {
+        mParents[root2] = root1;
+        mSizes[root1] += mSizes[root2];
+    }
+}
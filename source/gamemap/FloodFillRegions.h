@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLOODFILLREGIONS_H
+#define FLOODFILLREGIONS_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Keeps track of the contiguous regions of the map for one flood fill type.
+ *
+ * Each tile stores a flood fill color. When 2 regions are joined (for example when a
+ * tile is dug), their colors are merged in a disjoint set (union-find) instead of
+ * replacing the color of every tile of one of the regions. 2 tiles are in the same
+ * region if getRegion gives the same value for their colors.
+ */
+class FloodFillRegions
+{
+public:
+    FloodFillRegions();
+
+    //! \brief Forgets all the colors.
+    void clear();
+
+    //! \brief Colors the contiguous (using the 4 adjacent tiles) passable cells of the given grid. The
+    //! previous colors are forgotten. Cells are indexed by x * sizeY + y. Not passable cells get -1.
+    void computeRegions(const std::vector<bool>& passable, int sizeX, int sizeY, std::vector<int>& colors);
+
+    //! \brief Returns a new color, in its own region.
+    int newColor();
+
+    //! \brief Returns the color representing the region of the given color. -1 if color is -1.
+    //! It does not modify the set so it can be called from several threads at the same time.
+    int getRegion(int color) const;
+
+    //! \brief Joins the regions of the 2 given colors.
+    void mergeColors(int color1, int color2);
+
+    inline uint32_t numColors() const
+    { return mParents.size(); }
+
+private:
+    //! \brief For each color, the parent color in the disjoint set. A region root is its own parent.
+    std::vector<int> mParents;
+
+    //! \brief For each root color, the number of colors in its region.
+    std::vector<uint32_t> mSizes;
+
+    //! \brief Buffer used by computeRegions
+    std::vector<uint32_t> mQueue;
+};
+
+#endif // FLOODFILLREGIONS_H
@@ -40,8 +40,6 @@
 #include "network/ODServer.h"
 #include "network/ServerNotification.h"
 
-#include "render/ODFrameListener.h"
-
 #include "rooms/RoomDungeonTemple.h"
 #include "rooms/RoomTreasury.h"
 
@@ -49,7 +47,9 @@
 
 #include "utils/LogManager.h"
 #include "utils/ConfigManager.h"
+#include "utils/Random.h"
 #include "utils/ResourceManager.h"
+#include "utils/StateHash.h"
 
 #include <OgreTimer.h>
 #include <OgreStringConverter.h>
@@ -67,71 +67,14 @@ const std::string DEFAULT_NICK = "Player";
 
 using namespace std;
 
-/*! \brief A helper class for the A* search in the GameMap::path function.
-*
-* This class stores the requisite information about a tile which is placed in
-* the search queue for the A-star, or A*, algorithm which is used to
-* calculate paths in the path function.
-*
-* The A* description can be found here:
-* http://en.wikipedia.org/wiki/A*_search_algorithm
-*/
-class AstarEntry
+//! \brief Removes the given entity from an index vector, keeping the order of the others
+template<typename T>
+static void removeFromIndex(std::vector<T*>& index, T* entity)
 {
-public:
-    AstarEntry() :
-        tile    (nullptr),
-        parent  (0),
-        g       (0),
-        h       (0)
-    {}
-
-    AstarEntry(Tile* tile, int x1, int y1, int x2, int y2) :
-        tile    (tile),
-        parent  (0),
-        g       (0),
-        h       (0)
-    {
-        h = computeHeuristic(x1, y1, x2, y2);
-    }
-
-    static double computeHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        return fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    void setHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        h = fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    inline double fCost() const
-    { return g + h; }
-
-    inline Tile* getTile() const
-    { return tile; }
-
-    inline void setTile(Tile* newTile)
-    { tile = newTile; }
-
-    inline AstarEntry* getParent() const
-    { return parent; }
-
-    inline void setParent(AstarEntry* newParent)
-    { parent = newParent; }
-
-    inline const double& getG() const
-    { return g; }
-
-    inline void setG(const double& newG)
-    { g = newG; }
-
-private:
-    Tile*       tile;
-    AstarEntry* parent;
-    double      g;
-    double      h;
-};
+    typename std::vector<T*>::iterator it = std::find(index.begin(), index.end(), entity);
+    if(it != index.end())
+        index.erase(it);
+}
 
 GameMap::GameMap(bool isServerGameMap) :
         TileContainer(isServerGameMap ? 15 : 0),
@@ -144,6 +87,11 @@ GameMap::GameMap(bool isServerGameMap) :
         mFloodFillEnabled(false),
         mIsFOWActivated(true),
         mNumCallsTo_path(0),
+        mTimeSpentIn_path(0),
+        mClusterGraph(*this),
+        mDistanceFieldsVersion(1),
+        mNumDirtyTiles(0),
+        mWorkerTasksNeedRebuild(true),
         mAiManager(*this)
 {
     resetUniqueNumbers();
@@ -193,6 +141,16 @@ bool GameMap::createNewMap(int sizeX, int sizeY)
     if (!allocateMapMemory(sizeX, sizeY))
         return false;
 
+    mClusterGraph.init();
+    mDistanceFields.clear();
+    mDirtyTiles.clear();
+    mWorkerTaskDirtyTiles.clear();
+    mWorkerTasksNeedRebuild = true;
+    mEntityChunkIndex.setMapSize(sizeX, sizeY);
+
+    for (Seat* seat : mSeats)
+        seat->setMapSize(sizeX, sizeY);
+
     for (int jj = 0; jj < mMapSizeY; ++jj)
     {
         for (int ii = 0; ii < mMapSizeX; ++ii)
@@ -234,6 +192,10 @@ void GameMap::clearAll()
     // NOTE : clearRenderedMovableEntities should be called after clearRooms because clearRooms will try to remove the objects from the room
     clearRenderedMovableEntities();
     clearTiles();
+    mDirtyTiles.clear();
+    mWorkerTaskDirtyTiles.clear();
+    mWorkerTasksNeedRebuild = true;
+    mEntityChunkIndex.clear();
 
     clearActiveObjects();
 
@@ -244,6 +206,8 @@ void GameMap::clearAll()
 
     clearAiManager();
 
+    mEntityRegistry.clear();
+
     mLocalPlayerNick = DEFAULT_NICK;
     mTurnNumber = -1;
     resetUniqueNumbers();
@@ -256,10 +220,13 @@ void GameMap::clearCreatures()
     for (Creature* creature : mCreatures)
     {
         removeAnimatedObject(creature);
+        unregisterEntity(creature);
         creature->deleteYourself();
     }
 
     mCreatures.clear();
+    mCreaturesBySeat.clear();
+    mCreaturesBySeatAndDefinition.clear();
 }
 
 void GameMap::clearAiManager()
@@ -302,6 +269,7 @@ void GameMap::clearRenderedMovableEntities()
         RenderedMovableEntity* obj = *it;
         removeActiveObject(obj);
         removeAnimatedObject(obj);
+        unregisterEntity(obj);
         obj->deleteYourself();
     }
 
@@ -418,6 +386,15 @@ void GameMap::addCreature(Creature *cc)
         + ", seatId=" + (cc->getSeat() != nullptr ? Ogre::StringConverter::toString(cc->getSeat()->getId()) : std::string("null")));
 
     mCreatures.push_back(cc);
+    registerEntity(cc);
+    if(cc->getSeat() != nullptr)
+    {
+        cc->getSeat()->getLedger().addCreature(cc->getDefinition());
+        mCreaturesBySeat[cc->getSeat()].push_back(cc);
+        mCreaturesBySeatAndDefinition[std::make_pair(cc->getSeat(), cc->getDefinition())].push_back(cc);
+    }
+    if(isServerGameMap())
+        cc->getRandom().seed(Random::getStreamSeed(Random::StreamType::creature, cc->getHandle()));
 
     addAnimatedObject(cc);
     addActiveObject(cc);
@@ -435,15 +412,65 @@ void GameMap::removeCreature(Creature *c)
 
     // Creature found
     mCreatures.erase(it);
+    // Dead creatures have already been removed from the ledger and the index when they died
+    if(!c->isDead())
+        notifyCreatureDeath(c);
     removeAnimatedObject(c);
+    unregisterEntity(c);
     removeActiveObject(c);
 }
 
 void GameMap::queueEntityForDeletion(GameEntity *ge)
 {
+    // The handle of a deleted entity should not be valid anymore
+    mEntityRegistry.releaseHandle(ge, ge->getHandle());
     mEntitiesToDelete.push_back(ge);
 }
 
+void GameMap::registerEntity(GameEntity* entity)
+{
+    uint32_t handle = entity->getHandle();
+    if(handle != EntityRegistry::INVALID_HANDLE)
+    {
+        OD_ASSERT_TRUE_MSG(mEntityRegistry.useHandle(entity, handle), "name=" + entity->getName()
+            + ", handle=" + Ogre::StringConverter::toString(handle));
+    }
+    else if(isServerGameMap())
+    {
+        handle = mEntityRegistry.createHandle(entity);
+        entity->setHandle(handle);
+    }
+    // On client side, entities not sent by the server (rooms and traps) have no handle. They can only be found by name
+
+    mEntityRegistry.setOnMap(handle, true);
+    mEntityRegistry.addName(entity->getName(), entity);
+}
+
+void GameMap::unregisterEntity(GameEntity* entity)
+{
+    mEntityRegistry.setOnMap(entity->getHandle(), false);
+    mEntityRegistry.removeName(entity->getName(), entity);
+}
+
+//! \brief Returns the entity as a MovableGameEntity if it is one, nullptr otherwise
+static MovableGameEntity* toMovableGameEntity(GameEntity* entity)
+{
+    if(entity == nullptr)
+        return nullptr;
+
+    switch(entity->getObjectType())
+    {
+        case GameEntity::ObjectType::creature:
+            return static_cast<Creature*>(entity);
+
+        case GameEntity::ObjectType::renderedMovableEntity:
+            return static_cast<RenderedMovableEntity*>(entity);
+
+        default:
+            return nullptr;
+    }
+}
+
 const CreatureDefinition* GameMap::getClassDescription(const std::string& className)
 {
     for (std::pair<const CreatureDefinition*,CreatureDefinition*>& def : mClassDescriptions)
@@ -487,32 +514,37 @@ unsigned int GameMap::numCreatures() const
     return mCreatures.size();
 }
 
-std::vector<Creature*> GameMap::getCreaturesByAlliedSeat(Seat* seat)
+const std::vector<Creature*>& GameMap::getCreaturesBySeat(const Seat* seat) const
 {
-    std::vector<Creature*> tempVector;
-
-    // Loop over all the creatures in the GameMap and add them to the temp vector if their seat matches the one in parameter.
-    for (Creature* creature : mCreatures)
-    {
-        if (seat->isAlliedSeat(creature->getSeat()) && creature->getHP() > 0.0)
-            tempVector.push_back(creature);
-    }
+    static const std::vector<Creature*> noCreature;
+    std::map<const Seat*, std::vector<Creature*>>::const_iterator it = mCreaturesBySeat.find(seat);
+    if(it == mCreaturesBySeat.end())
+        return noCreature;
 
-    return tempVector;
+    return it->second;
 }
 
-std::vector<Creature*> GameMap::getCreaturesBySeat(Seat* seat)
+const std::vector<Creature*>& GameMap::getCreaturesBySeatAndDefinition(const Seat* seat,
+    const CreatureDefinition* definition) const
 {
-    std::vector<Creature*> tempVector;
+    static const std::vector<Creature*> noCreature;
+    std::map<std::pair<const Seat*, const CreatureDefinition*>, std::vector<Creature*>>::const_iterator it =
+        mCreaturesBySeatAndDefinition.find(std::make_pair(seat, definition));
+    if(it == mCreaturesBySeatAndDefinition.end())
+        return noCreature;
 
-    // Loop over all the creatures in the GameMap and add them to the temp vector if their seat matches the one in parameter.
-    for (Creature* creature : mCreatures)
-    {
-        if (creature->getSeat() == seat && creature->getHP() > 0.0)
-            tempVector.push_back(creature);
-    }
+    return it->second;
+}
+
+void GameMap::notifyCreatureDeath(Creature* creature)
+{
+    if(creature->getSeat() == nullptr)
+        return;
 
-    return tempVector;
+    creature->getSeat()->getLedger().removeCreature(creature->getDefinition());
+    removeFromIndex(mCreaturesBySeat[creature->getSeat()], creature);
+    removeFromIndex(mCreaturesBySeatAndDefinition[std::make_pair(creature->getSeat(), creature->getDefinition())],
+        creature);
 }
 
 Creature* GameMap::getWorkerToPickupBySeat(Seat* seat)
@@ -534,7 +566,7 @@ Creature* GameMap::getWorkerToPickupBySeat(Seat* seat)
     Creature* diggerWorker = nullptr;
     uint32_t otherWorkerLevel = 0;
     Creature* otherWorker = nullptr;
-    std::vector<Creature*> creatures = getCreaturesBySeat(seat);
+    const std::vector<Creature*>& creatures = getCreaturesBySeat(seat);
     for(Creature* creature : creatures)
     {
         if(!creature->getDefinition()->isWorker())
@@ -654,7 +686,7 @@ Creature* GameMap::getFighterToPickupBySeat(Seat* seat)
     Creature* busyFighter = nullptr;
     uint32_t otherFighterLevel = 0;
     Creature* otherFighter = nullptr;
-    std::vector<Creature*> creatures = getCreaturesBySeat(seat);
+    const std::vector<Creature*>& creatures = getCreaturesBySeat(seat);
     for(Creature* creature : creatures)
     {
         if(creature->getDefinition()->isWorker())
@@ -774,20 +806,31 @@ MovableGameEntity* GameMap::getAnimatedObject(int index)
 
 MovableGameEntity* GameMap::getAnimatedObject(const std::string& name)
 {
-    for (MovableGameEntity* mge : mAnimatedObjects)
+    MovableGameEntity* entity = toMovableGameEntity(mEntityRegistry.getEntity(name));
+    if(entity != nullptr)
+        return entity;
+
+    // Map lights are not in the registry as they are not sent through it. There are few of them
+    for(MapLight* mapLight : mMapLights)
     {
-        if (mge->getName().compare(name) == 0)
-            return mge;
+        if(mapLight->getName() == name)
+            return mapLight;
     }
 
     return nullptr;
 }
 
+MovableGameEntity* GameMap::getAnimatedObjectFromHandle(uint32_t handle)
+{
+    return toMovableGameEntity(mEntityRegistry.getEntity(handle));
+}
+
 void GameMap::addRenderedMovableEntity(RenderedMovableEntity *obj)
 {
     LogManager::getSingleton().logMessage(serverStr() + "Adding rendered object " + obj->getName()
         + ",MeshName=" + obj->getMeshName());
     mRenderedMovableEntities.push_back(obj);
+    registerEntity(obj);
 
     addActiveObject(obj);
     addAnimatedObject(obj);
@@ -805,17 +848,26 @@ void GameMap::removeRenderedMovableEntity(RenderedMovableEntity *obj)
 
     mRenderedMovableEntities.erase(it);
     removeAnimatedObject(obj);
+    unregisterEntity(obj);
     removeActiveObject(obj);
 }
 
 RenderedMovableEntity* GameMap::getRenderedMovableEntity(const std::string& name)
 {
-    for(RenderedMovableEntity* renderedMovableEntity : mRenderedMovableEntities)
-    {
-        if(name.compare(renderedMovableEntity->getName()) == 0)
-            return renderedMovableEntity;
-    }
-    return nullptr;
+    GameEntity* entity = mEntityRegistry.getEntity(name);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::renderedMovableEntity))
+        return nullptr;
+
+    return static_cast<RenderedMovableEntity*>(entity);
+}
+
+RenderedMovableEntity* GameMap::getRenderedMovableEntityFromHandle(uint32_t handle)
+{
+    GameEntity* entity = mEntityRegistry.getEntity(handle);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::renderedMovableEntity))
+        return nullptr;
+
+    return static_cast<RenderedMovableEntity*>(entity);
 }
 
 
@@ -975,29 +1027,38 @@ void GameMap::destroyAllEntities()
 
 Creature* GameMap::getCreature(const std::string& cName)
 {
-    for (Creature* creature : mCreatures)
-    {
-        if (creature->getName().compare(cName) == 0)
-            return creature;
-    }
-    return nullptr;
+    GameEntity* entity = mEntityRegistry.getEntity(cName);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::creature))
+        return nullptr;
+
+    return static_cast<Creature*>(entity);
 }
 
 const Creature* GameMap::getCreature(const std::string& cName) const
 {
-    for (Creature* creature : mCreatures)
-    {
-        if (creature->getName().compare(cName) == 0)
-            return creature;
-    }
-    return nullptr;
+    GameEntity* entity = mEntityRegistry.getEntity(cName);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::creature))
+        return nullptr;
+
+    return static_cast<Creature*>(entity);
+}
+
+Creature* GameMap::getCreatureFromHandle(uint32_t handle)
+{
+    GameEntity* entity = mEntityRegistry.getEntity(handle);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::creature))
+        return nullptr;
+
+    return static_cast<Creature*>(entity);
 }
 
 void GameMap::doTurn()
 {
     std::cout << "\nComputing turn " << mTurnNumber;
     unsigned int numCallsTo_path_atStart = mNumCallsTo_path;
+    unsigned long int timeSpentIn_path_atStart = mTimeSpentIn_path;
 
+    TurnProfilerZone zone(mTurnProfiler, TurnProfiler::doTurn);
     uint32_t miscUpkeepTime = doMiscUpkeep();
 
     // Count how many creatures the player controls
@@ -1013,8 +1074,10 @@ void GameMap::doTurn()
     }
 
     std::cout << "\nDuring this turn there were " << mNumCallsTo_path
-              - numCallsTo_path_atStart << " calls to GameMap::path()."
-              << "miscUpkeepTime=" << miscUpkeepTime << std::endl;
+              - numCallsTo_path_atStart << " calls to GameMap::path() taking "
+              << mTimeSpentIn_path - timeSpentIn_path_atStart << " microseconds."
+              << "miscUpkeepTime=" << miscUpkeepTime
+              << "\n" << mNumDirtyTiles << " dirty tiles were processed during the last entities update." << std::endl;
 }
 
 void GameMap::doPlayerAITurn(double frameTime)
@@ -1024,13 +1087,12 @@ void GameMap::doPlayerAITurn(double frameTime)
 
 unsigned long int GameMap::doMiscUpkeep()
 {
-    Tile *tempTile;
-    Seat *tempSeat;
     Ogre::Timer stopwatch;
     unsigned long int timeTaken;
 
     // Loop over all the filled seats in the game and check all the unfinished goals for each seat.
     // Add any seats with no remaining goals to the winningSeats vector.
+    TurnProfilerZone goalsZone(mTurnProfiler, TurnProfiler::goals);
     for (Seat* seat : mSeats)
     {
         if(seat->getPlayer() == nullptr)
@@ -1048,6 +1110,7 @@ unsigned long int GameMap::doMiscUpkeep()
         // Set the creatures count to 0. It will be reset by the next count in doTurn()
         seat->mNumCreaturesControlled = 0;
     }
+    goalsZone.stop();
 
     // Count how many of each kobold there are per seat.
     std::map<Seat*, int> koboldCounts;
@@ -1061,7 +1124,7 @@ unsigned long int GameMap::doMiscUpkeep()
     }
 
     // Count how many dungeon temples each seat controls.
-    std::vector<Room*> dungeonTemples = getRoomsByType(Room::dungeonTemple);
+    const std::vector<Room*>& dungeonTemples = getRoomsByType(Room::dungeonTemple);
     std::map<Seat*, int> dungeonTempleSeatCounts;
     for (Room* dungeonTemple : dungeonTemples)
     {
@@ -1105,18 +1168,13 @@ unsigned long int GameMap::doMiscUpkeep()
         }
     }
 
+    updateWorkerTasks();
+
     // At each upkeep, we re-compute tiles with vision
+    TurnProfilerZone visionZone(mTurnProfiler, TurnProfiler::vision);
     for (Seat* seat : mSeats)
         seat->clearTilesWithVision();
 
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            getTile(ii,jj)->clearVision();
-        }
-    }
-
     // Compute vision. We need to compute every seats including AI because
     // a human can be allied with an AI and they would share vision
     for (int jj = 0; jj < getMapSizeY(); ++jj)
@@ -1127,11 +1185,31 @@ unsigned long int GameMap::doMiscUpkeep()
         }
     }
 
+    // Sense phase: every creature looks at its surroundings before any of them acts. As the map is
+    // not modified while sensing, the creatures can be processed in parallel and the result does not
+    // depend on the number of threads used
+    if(mSenseThreadPool.getNbThreads() == 0)
+        mSenseThreadPool.start(ConfigManager::getSingleton().getSenseWorkerThreads());
+
+    int maxSightRadius = 0;
+    for (Creature* creature : mCreatures)
+        maxSightRadius = std::max(maxSightRadius, creature->getDefinition()->getSightRadius());
+
+    prepareVisionQueries(maxSightRadius);
+    mSenseThreadPool.parallelFor(mCreatures.size(), [this](uint32_t index)
+    {
+        mCreatures[index]->senseSurroundings();
+    });
+
     for (Creature* creature : mCreatures)
     {
         creature->computeVisibleTiles();
     }
 
+    // Now that every seat knows what it sees, allied seats can share their vision
+    for (Seat* seat : mSeats)
+        seat->computeTilesWithVision();
+
     for (Seat* seat : mSeats)
     {
         if(!seat->getIsDebuggingVision())
@@ -1144,7 +1222,10 @@ unsigned long int GameMap::doMiscUpkeep()
     for (Seat* seat : mSeats)
         seat->sendVisibleTiles();
 
+    visionZone.stop();
+
     // Carry out the upkeep round of all the active objects in the game.
+    TurnProfilerZone activeObjectsZone(mTurnProfiler, TurnProfiler::activeObjects);
     unsigned int activeObjectCount = 0;
     unsigned int nbActiveObjectCount = mActiveObjects.size();
     while (activeObjectCount < nbActiveObjectCount)
@@ -1173,18 +1254,21 @@ unsigned long int GameMap::doMiscUpkeep()
         if(it != mActiveObjects.end())
             mActiveObjects.erase(it);
     }
-
+    activeObjectsZone.stop();
 
     // Carry out the upkeep round for each seat.  This means recomputing how much gold is
     // available in their treasuries, how much mana they gain/lose during this turn, etc.
+    TurnProfilerZone seatUpkeepZone(mTurnProfiler, TurnProfiler::seatUpkeep);
     for (Seat* seat : mSeats)
     {
+        // The claimed tiles are counted by the ledger as they change
+        seat->mNumClaimedTiles = seat->getLedger().getNbClaimedTiles();
+
         if(seat->getPlayer() == nullptr)
             continue;
 
         // Add the amount of mana this seat accrued this turn if the player has a dungeon temple
-        std::vector<Room*> dungeonTemples = getRoomsByTypeAndSeat(Room::RoomType::dungeonTemple, seat);
-        if(dungeonTemples.empty())
+        if(seat->getLedger().getNbRooms(Room::RoomType::dungeonTemple) == 0)
         {
             seat->mManaDelta = 0;
         }
@@ -1200,33 +1284,7 @@ unsigned long int GameMap::doMiscUpkeep()
         seat->mGold = getTotalGoldForSeat(seat);
     }
 
-    // Determine the number of tiles claimed by each seat.
-    // Begin by setting the number of claimed tiles for each seat to 0.
-    for (Seat* seat : mSeats)
-        seat->setNumClaimedTiles(0);
-
-    // Now loop over all of the tiles, if the tile is claimed increment the given seats count.
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            tempTile = getTile(ii,jj);
-
-            // Check to see if the current tile is claimed by anyone.
-            if (tempTile->getType() == Tile::claimed)
-            {
-                // Increment the count of the seat who owns the tile.
-                tempSeat = tempTile->getSeat();
-                if (tempSeat != nullptr)
-                {
-                    tempSeat->incrementNumClaimedTiles();
-                }
-            }
-        }
-    }
-
-    // Updates the minimap at least once per turn
-    ODFrameListener::getSingleton().updateMinimap();
+    seatUpkeepZone.stop();
 
     timeTaken = stopwatch.getMicroseconds();
     return timeTaken;
@@ -1342,20 +1400,20 @@ bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEn
         (creature->getMoveSpeedWater() > 0.0) &&
         (creature->getMoveSpeedLava() > 0.0))
     {
-        return (tileStart->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == tileEnd->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava]);
+        return isInSameFloodFillRegion(Tile::FloodFillTypeGroundWaterLava, tileStart, tileEnd);
     }
     if((creature->getMoveSpeedGround() > 0.0) &&
         (creature->getMoveSpeedWater() > 0.0))
     {
-        return (tileStart->mFloodFillColor[Tile::FloodFillTypeGroundWater] == tileEnd->mFloodFillColor[Tile::FloodFillTypeGroundWater]);
+        return isInSameFloodFillRegion(Tile::FloodFillTypeGroundWater, tileStart, tileEnd);
     }
     if((creature->getMoveSpeedGround() > 0.0) &&
         (creature->getMoveSpeedLava() > 0.0))
     {
-        return (tileStart->mFloodFillColor[Tile::FloodFillTypeGroundLava] == tileEnd->mFloodFillColor[Tile::FloodFillTypeGroundLava]);
+        return isInSameFloodFillRegion(Tile::FloodFillTypeGroundLava, tileStart, tileEnd);
     }
 
-    return (tileStart->mFloodFillColor[Tile::FloodFillTypeGround] == tileEnd->mFloodFillColor[Tile::FloodFillTypeGround]);
+    return isInSameFloodFillRegion(Tile::FloodFillTypeGround, tileStart, tileEnd);
 }
 
 std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles)
@@ -1380,183 +1438,45 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
     if (!throughDiggableTiles && !pathExists(creature, start, destination))
         return returnList;
 
-    AstarEntry *currentEntry = new AstarEntry(getTile(x1, y1), x1, y1, x2, y2);
-    AstarEntry neighbor;
-
-    std::vector<AstarEntry*> openList;
-    openList.push_back(currentEntry);
+    Ogre::Timer stopwatch;
 
-    std::vector<AstarEntry*> closedList;
-    AstarEntry* destinationEntry = nullptr;
-    while (true)
+    // For long distances, we use the cluster graph to know what entrances we have to cross and
+    // only compute the path at the tile level between them. If one of the segments cannot
+    // be computed for the given creature, we fall back on the tile level search.
+    uint32_t minDistance = ConfigManager::getSingleton().getHierarchicalPathMinDistance();
+    if(!throughDiggableTiles && (minDistance > 0) &&
+       (std::abs(x2 - x1) + std::abs(y2 - y1) >= static_cast<int>(minDistance)))
     {
-        // if the openList is empty we failed to find a path
-        if (openList.empty())
-            break;
-
-        // Get the lowest fScore from the openList and move it to the closed list
-        std::vector<AstarEntry*>::iterator smallestAstar = openList.begin();
-        for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-        {
-            if ((*itr)->fCost() < (*smallestAstar)->fCost())
-                smallestAstar = itr;
-        }
-
-        currentEntry = *smallestAstar;
-        openList.erase(smallestAstar);
-        closedList.push_back(currentEntry);
-
-        // We found the path, break out of the search loop
-        if (currentEntry->getTile() == destination)
-        {
-            destinationEntry = currentEntry;
-            break;
-        }
-
-        // Check the tiles surrounding the current square
-        bool areTilesPassable[4] = {false, false, false, false};
-        // Note : to disable diagonals, process tiles from 0 to 3. To allow them, process tiles from 0 to 7
-        for (unsigned int i = 0; i < 8; ++i)
+        std::vector<Tile*> waypoints;
+        if(mClusterGraph.findWaypoints(start, destination, ClusterGraph::getMovementClass(creature), waypoints))
         {
-            Tile* neighborTile = nullptr;
-            switch(i)
-            {
-                // We process the 4 adjacent tiles
-                case 0:
-                    neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY());
-                    break;
-                case 1:
-                    neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY());
-                    break;
-                case 2:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() - 1);
-                    break;
-                case 3:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() + 1);
-                    break;
-                // We process the 4 diagonal tiles. We only process a diagonal tile if the 2 tiles adjacent to the original one are
-                // passable.
-                case 4:
-                    if(areTilesPassable[0] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() - 1);
-                    break;
-                case 5:
-                    if(areTilesPassable[0] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() + 1);
-                    break;
-                case 6:
-                    if(areTilesPassable[1] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() - 1);
-                    break;
-                case 7:
-                    if(areTilesPassable[1] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() + 1);
-                    break;
-            }
-            if(neighborTile == nullptr)
-                continue;
-
-            neighbor.setTile(neighborTile);
-
-            bool processNeighbor = false;
-            if(creature->canGoThroughTile(neighbor.getTile()))
-            {
-                processNeighbor = true;
-                // We set passability for the 4 adjacent tiles only
-                if(i < 4)
-                    areTilesPassable[i] = true;
-             }
-            else if(throughDiggableTiles && neighbor.getTile()->isDiggable(seat))
-                processNeighbor = true;
-
-            if (!processNeighbor)
-                continue;
-
-            // See if the neighbor is in the closed list
-            AstarEntry* neighborEntry = nullptr;
-            for(std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
+            for(uint32_t i = 0; i + 1 < waypoints.size(); ++i)
             {
-                if (neighbor.getTile() == (*itr)->getTile())
+                std::list<Tile*> segment = mAstarSearch.path(*this, waypoints[i], waypoints[i + 1],
+                    creature, seat, false);
+                if(segment.empty())
                 {
-                    neighborEntry = *itr;
+                    returnList.clear();
                     break;
                 }
-            }
 
-            // Ignore the neighbor if it is on the closed list
-            if (neighborEntry != nullptr)
-                continue;
+                // The first tile of the segment is the last one of the previous segment
+                if(!returnList.empty())
+                    segment.pop_front();
 
-            // See if the neighbor is in the open list
-            for(std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-            {
-                if (neighbor.getTile() == (*itr)->getTile())
-                {
-                    neighborEntry = *itr;
-                    break;
-                }
+                returnList.splice(returnList.end(), segment);
             }
 
-            // If the neighbor is not in the open list
-            if (neighborEntry == nullptr)
+            if(!returnList.empty())
             {
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
-                neighbor.setG(currentEntry->getG() + weightToParent);
-
-                // Use the manhattan distance for the heuristic
-                neighbor.setHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(), x2, y2);
-                neighbor.setParent(currentEntry);
-
-                openList.push_back(new AstarEntry(neighbor));
-            }
-            else
-            {
-                // If this path to the given neighbor tile is a shorter path than the
-                // one already given, make this the new parent.
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
-
-                if (currentEntry->getG() + weightToParent < neighborEntry->getG())
-                {
-                    neighborEntry->setG(currentEntry->getG() + weightToParent);
-                    neighborEntry->setParent(currentEntry);
-                }
+                mTimeSpentIn_path += stopwatch.getMicroseconds();
+                return returnList;
             }
         }
     }
 
-    if (destinationEntry != nullptr)
-    {
-        // Follow the parent chain back the the starting tile
-        AstarEntry* curEntry = destinationEntry;
-        do
-        {
-            if (curEntry->getTile() != nullptr)
-            {
-                returnList.push_front(curEntry->getTile());
-                curEntry = curEntry->getParent();
-            }
-
-        } while (curEntry != nullptr);
-    }
-
-    // Clean up the memory we allocated by deleting the astarEntries in the open and closed lists
-    for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-        delete *itr;
-
-    for (std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
-        delete *itr;
+    returnList = mAstarSearch.path(*this, start, destination, creature, seat, throughDiggableTiles);
+    mTimeSpentIn_path += stopwatch.getMicroseconds();
 
     return returnList;
 }
@@ -1645,9 +1565,20 @@ Player* GameMap::getPlayerBySeat(Seat* seat)
     return nullptr;
 }
 
+bool GameMap::isForcePossiblyInRadius(Tile* tile, int radius, Seat* seat, bool invert) const
+{
+    uint32_t categories = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::creature) |
+        EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::building);
+    return mEntityChunkIndex.hasEntityInRadius(categories, getEntityChunkSeatMask(seat, invert),
+        tile->getX(), tile->getY(), radius);
+}
+
 std::vector<GameEntity*> GameMap::getVisibleForce(const std::vector<Tile*>& visibleTiles, Seat* seat, bool invert)
 {
     std::vector<GameEntity*> returnList;
+    uint32_t categories = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::creature) |
+        EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::building);
+    uint64_t seatMask = getEntityChunkSeatMask(seat, invert);
 
     // Loop over the visible tiles
     for (Tile* tile : visibleTiles)
@@ -1656,6 +1587,10 @@ std::vector<GameEntity*> GameMap::getVisibleForce(const std::vector<Tile*>& visi
         if(tile == nullptr)
             continue;
 
+        // Nothing to look for if there is no matching entity in the chunk of the tile
+        if(!mEntityChunkIndex.hasEntityInChunk(categories, seatMask, tile->getX(), tile->getY()))
+            continue;
+
         tile->fillWithAttackableCreatures(returnList, seat, invert);
         tile->fillWithAttackableRoom(returnList, seat, invert);
         tile->fillWithAttackableTrap(returnList, seat, invert);
@@ -1667,6 +1602,8 @@ std::vector<GameEntity*> GameMap::getVisibleForce(const std::vector<Tile*>& visi
 std::vector<GameEntity*> GameMap::getVisibleCreatures(const std::vector<Tile*>& visibleTiles, Seat* seat, bool invert)
 {
     std::vector<GameEntity*> returnList;
+    uint32_t categories = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::creature);
+    uint64_t seatMask = getEntityChunkSeatMask(seat, invert);
 
     // Loop over the visible tiles
     for (Tile* tile : visibleTiles)
@@ -1675,6 +1612,9 @@ std::vector<GameEntity*> GameMap::getVisibleCreatures(const std::vector<Tile*>&
         if(tile == nullptr)
             continue;
 
+        if(!mEntityChunkIndex.hasEntityInChunk(categories, seatMask, tile->getX(), tile->getY()))
+            continue;
+
         tile->fillWithAttackableCreatures(returnList, seat, invert);
     }
 
@@ -1684,6 +1624,8 @@ std::vector<GameEntity*> GameMap::getVisibleCreatures(const std::vector<Tile*>&
 std::vector<MovableGameEntity*> GameMap::getVisibleCarryableEntities(const std::vector<Tile*>& visibleTiles)
 {
     std::vector<MovableGameEntity*> returnList;
+    uint32_t categories = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::creature) |
+        EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::movableObject);
 
     // Loop over the visible tiles
     for (Tile* tile : visibleTiles)
@@ -1692,22 +1634,97 @@ std::vector<MovableGameEntity*> GameMap::getVisibleCarryableEntities(const std::
         if(tile == nullptr)
             continue;
 
+        if(!mEntityChunkIndex.hasEntityInChunk(categories, EntityChunkIndex::ALL_SEATS, tile->getX(), tile->getY()))
+            continue;
+
         tile->fillWithCarryableEntities(returnList);
     }
 
     return returnList;
 }
 
+uint32_t GameMap::getEntityChunkSlot(const Seat* seat) const
+{
+    if(seat == nullptr)
+        return EntityChunkIndex::NO_SEAT_SLOT;
+
+    uint32_t nbSeats = mSeats.size();
+    for(uint32_t slot = 0; slot < nbSeats; ++slot)
+    {
+        if(mSeats[slot] == seat)
+            return slot;
+    }
+
+    return EntityChunkIndex::NO_SEAT_SLOT;
+}
+
+uint64_t GameMap::getEntityChunkSeatMask(Seat* seat, bool invert) const
+{
+    uint64_t seatMask = EntityChunkIndex::getSeatSlotBit(EntityChunkIndex::NO_SEAT_SLOT);
+    uint32_t nbSeats = mSeats.size();
+    for(uint32_t slot = 0; slot < nbSeats; ++slot)
+    {
+        if(mSeats[slot]->isAlliedSeat(seat) != invert)
+            seatMask |= EntityChunkIndex::getSeatSlotBit(slot);
+    }
+
+    return seatMask;
+}
+
+void GameMap::indexEntityOnTile(GameEntity* entity, Tile* tile, bool isAdded)
+{
+    if(!isServerGameMap())
+        return;
+
+    // Creatures keep their seat while they are on map. The other entities are only looked for
+    // regardless of their seat so they all use the same slot
+    EntityChunkIndex::Category category;
+    uint32_t slot;
+    switch(entity->getObjectType())
+    {
+        case GameEntity::ObjectType::creature:
+            category = EntityChunkIndex::Category::creature;
+            slot = getEntityChunkSlot(entity->getSeat());
+            break;
+        case GameEntity::ObjectType::renderedMovableEntity:
+            category = EntityChunkIndex::Category::movableObject;
+            slot = EntityChunkIndex::NO_SEAT_SLOT;
+            break;
+        default:
+            return;
+    }
+
+    if(isAdded)
+        mEntityChunkIndex.add(category, slot, tile->getX(), tile->getY());
+    else
+        mEntityChunkIndex.remove(category, slot, tile->getX(), tile->getY());
+}
+
+void GameMap::indexBuildingOnTile(Building* building, Tile* tile, bool isAdded)
+{
+    if(!isServerGameMap())
+        return;
+
+    uint32_t slot = getEntityChunkSlot(building->getSeat());
+    if(isAdded)
+        mEntityChunkIndex.add(EntityChunkIndex::Category::building, slot, tile->getX(), tile->getY());
+    else
+        mEntityChunkIndex.remove(EntityChunkIndex::Category::building, slot, tile->getX(), tile->getY());
+}
+
 void GameMap::clearRooms()
 {
     for (Room *tempRoom : mRooms)
     {
         removeActiveObject(tempRoom);
         tempRoom->removeAllBuildingObjects();
+        unregisterEntity(tempRoom);
         tempRoom->deleteYourself();
     }
 
     mRooms.clear();
+    mRoomsByType.clear();
+    mRoomsBySeatAndType.clear();
 }
 
 void GameMap::addRoom(Room *r)
@@ -1721,6 +1738,10 @@ void GameMap::addRoom(Room *r)
     }
 
     mRooms.push_back(r);
+    registerEntity(r);
+    r->getSeat()->getLedger().addRoom(r->getType());
+    mRoomsByType[r->getType()].push_back(r);
+    mRoomsBySeatAndType[std::make_pair(r->getSeat(), r->getType())].push_back(r);
     addActiveObject(r);
     r->setIsOnMap(true);
 }
@@ -1736,6 +1757,10 @@ void GameMap::removeRoom(Room *r)
         return;
 
     mRooms.erase(it);
+    unregisterEntity(r);
+    r->getSeat()->getLedger().removeRoom(r->getType());
+    removeFromIndex(mRoomsByType[r->getType()], r);
+    removeFromIndex(mRoomsBySeatAndType[std::make_pair(r->getSeat(), r->getType())], r);
     r->removeAllBuildingObjects();
     removeActiveObject(r);
 }
@@ -1750,51 +1775,30 @@ unsigned int GameMap::numRooms()
     return mRooms.size();
 }
 
-std::vector<Room*> GameMap::getRoomsByType(Room::RoomType type)
+const std::vector<Room*>& GameMap::getRoomsByType(Room::RoomType type) const
 {
-    std::vector<Room*> returnList;
-    for (Room* room : mRooms)
-    {
-        if (room->getType() == type  && room->getHP(nullptr) > 0.0)
-            returnList.push_back(room);
-    }
+    static const std::vector<Room*> noRoom;
+    std::map<Room::RoomType, std::vector<Room*>>::const_iterator it = mRoomsByType.find(type);
+    if(it == mRoomsByType.end())
+        return noRoom;
 
-    return returnList;
+    return it->second;
 }
 
-std::vector<Room*> GameMap::getRoomsByTypeAndSeat(Room::RoomType type, Seat* seat)
+const std::vector<Room*>& GameMap::getRoomsByTypeAndSeat(Room::RoomType type, const Seat* seat) const
 {
-    std::vector<Room*> returnList;
-    for (Room* room : mRooms)
-    {
-        if (room->getType() == type && room->getSeat() == seat && room->getHP(nullptr) > 0.0)
-            returnList.push_back(room);
-    }
+    static const std::vector<Room*> noRoom;
+    std::map<std::pair<const Seat*, Room::RoomType>, std::vector<Room*>>::const_iterator it =
+        mRoomsBySeatAndType.find(std::make_pair(seat, type));
+    if(it == mRoomsBySeatAndType.end())
+        return noRoom;
 
-    return returnList;
+    return it->second;
 }
 
-std::vector<const Room*> GameMap::getRoomsByTypeAndSeat(Room::RoomType type, Seat* seat) const
+unsigned int GameMap::numRoomsByTypeAndSeat(Room::RoomType type, const Seat* seat) const
 {
-    std::vector<const Room*> returnList;
-    for (const Room* room : mRooms)
-    {
-        if (room->getType() == type && room->getSeat() == seat && room->getHP(nullptr) > 0.0)
-            returnList.push_back(room);
-    }
-
-    return returnList;
-}
-
-unsigned int GameMap::numRoomsByTypeAndSeat(Room::RoomType type, Seat* seat) const
-{
-    int cptRooms = 0;
-    for (Room* room : mRooms)
-    {
-        if (room->getType() == type && room->getSeat() == seat && room->getHP(nullptr) > 0.0)
-            ++cptRooms;
-    }
-    return cptRooms;
+    return getRoomsByTypeAndSeat(type, seat).size();
 }
 
 std::vector<Room*> GameMap::getReachableRooms(const std::vector<Room*>& vec,
@@ -1851,26 +1855,92 @@ std::vector<Building*> GameMap::getReachableBuildingsPerSeat(Seat* seat,
     return returnList;
 }
 
-Room* GameMap::getRoomByName(const std::string& name)
+const DistanceField& GameMap::getRoomsDistanceField(Room::RoomType type, Seat* seat, ClusterGraph::MovementClass movementClass)
 {
-    for (Room* room : mRooms)
+    CachedDistanceField& cache = mDistanceFields[std::make_tuple(seat->getId(), static_cast<int>(type),
+        static_cast<int>(movementClass))];
+    if(cache.mVersion == mDistanceFieldsVersion)
+        return cache.mField;
+
+    std::vector<Tile*> targets;
+    for(Room* room : mRooms)
     {
-        if(room->getName().compare(name) == 0)
-            return room;
+        if((room->getType() != type) || (room->getSeat() != seat))
+            continue;
+
+        for(Tile* tile : room->getCoveredTiles())
+            targets.push_back(tile);
     }
 
-    return nullptr;
+    cache.mField.compute(*this, targets, movementClass);
+    cache.mVersion = mDistanceFieldsVersion;
+    return cache.mField;
 }
 
-Trap* GameMap::getTrapByName(const std::string& name)
+Room* GameMap::getClosestReachableRoom(Room::RoomType type, Seat* seat, const Creature* creature)
 {
-    for (Trap* trap : mTraps)
+    Tile* positionTile = creature->getPositionTile();
+    if(positionTile == nullptr)
+        return nullptr;
+
+    const DistanceField& field = getRoomsDistanceField(type, seat, ClusterGraph::getMovementClass(creature));
+    Tile* closestTile = field.getClosestTarget(positionTile);
+    if(closestTile == nullptr)
+        return nullptr;
+
+    return closestTile->getCoveringRoom();
+}
+
+std::vector<Room*> GameMap::getReachableRoomsByDistance(Room::RoomType type, Seat* seat, const Creature* creature)
+{
+    std::vector<Room*> returnList;
+    Tile* positionTile = creature->getPositionTile();
+    if(positionTile == nullptr)
+        return returnList;
+
+    // As every step costs the same in both directions, the distance from the creature to a tile is the distance
+    // from that tile to the creature
+    DistanceField creatureField;
+    creatureField.compute(*this, std::vector<Tile*>(1, positionTile), ClusterGraph::getMovementClass(creature));
+
+    std::vector<std::pair<uint32_t, Room*>> rooms;
+    for(Room* room : getRoomsByTypeAndSeat(type, seat))
     {
-        if(trap->getName().compare(name) == 0)
-            return trap;
+        uint32_t roomDistance = DistanceField::UNREACHABLE;
+        for(Tile* tile : room->getCoveredTiles())
+            roomDistance = std::min(roomDistance, creatureField.getDistance(tile));
+
+        if(roomDistance != DistanceField::UNREACHABLE)
+            rooms.push_back(std::make_pair(roomDistance, room));
     }
 
-    return nullptr;
+    // The rooms at the same distance keep the order of the index so that the result is deterministic
+    std::stable_sort(rooms.begin(), rooms.end(),
+        [](const std::pair<uint32_t, Room*>& a, const std::pair<uint32_t, Room*>& b)
+        { return a.first < b.first; });
+
+    for(const std::pair<uint32_t, Room*>& room : rooms)
+        returnList.push_back(room.second);
+
+    return returnList;
+}
+
+Room* GameMap::getRoomByName(const std::string& name)
+{
+    GameEntity* entity = mEntityRegistry.getEntity(name);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::room))
+        return nullptr;
+
+    return static_cast<Room*>(entity);
+}
+
+Trap* GameMap::getTrapByName(const std::string& name)
+{
+    GameEntity* entity = mEntityRegistry.getEntity(name);
+    if((entity == nullptr) || (entity->getObjectType() != GameEntity::ObjectType::trap))
+        return nullptr;
+
+    return static_cast<Trap*>(entity);
 }
 
 void GameMap::clearTraps()
@@ -1878,6 +1948,7 @@ void GameMap::clearTraps()
     for (Trap* trap : mTraps)
     {
         removeActiveObject(trap);
+        unregisterEntity(trap);
         trap->deleteYourself();
     }
 
@@ -1891,6 +1962,7 @@ void GameMap::addTrap(Trap *trap)
         + Ogre::StringConverter::toString(nbTiles) + ", seatId=" + Ogre::StringConverter::toString(trap->getSeat()->getId()));
 
     mTraps.push_back(trap);
+    registerEntity(trap);
     addActiveObject(trap);
     trap->setIsOnMap(true);
 }
@@ -1904,6 +1976,7 @@ void GameMap::removeTrap(Trap *t)
         return;
 
     mTraps.erase(it);
+    unregisterEntity(t);
     removeActiveObject(t);
 }
 
@@ -1920,7 +1993,7 @@ unsigned int GameMap::numTraps()
 int GameMap::getTotalGoldForSeat(Seat* seat)
 {
     int tempInt = 0;
-    std::vector<Room*> treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
+    const std::vector<Room*>& treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
     for (unsigned int i = 0; i < treasuriesOwned.size(); ++i)
     {
         tempInt += static_cast<RoomTreasury*>(treasuriesOwned[i])->getTotalGold();
@@ -1937,7 +2010,7 @@ bool GameMap::withdrawFromTreasuries(int gold, Seat* seat)
 
     // Loop over the treasuries withdrawing gold until the full amount has been withdrawn.
     int goldStillNeeded = gold;
-    std::vector<Room*> treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
+    const std::vector<Room*>& treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
     for (unsigned int i = 0; i < treasuriesOwned.size() && goldStillNeeded > 0; ++i)
     {
         goldStillNeeded -= static_cast<RoomTreasury*>(treasuriesOwned[i])->withdrawGold(goldStillNeeded);
@@ -2017,6 +2090,12 @@ void GameMap::addSeat(Seat *s)
         return;
 
     mSeats.push_back(s);
+    mWorkerTasksNeedRebuild = true;
+    if(isServerGameMap())
+        s->mRandom.seed(Random::getStreamSeed(Random::StreamType::seat, s->getId()));
+
+    if((getMapSizeX() > 0) && (getMapSizeY() > 0))
+        s->setMapSize(getMapSizeX(), getMapSizeY());
 
     // Add the goals for all seats to this seat.
     for (Goal* goal : mGoalsForAllSeats)
@@ -2122,291 +2201,100 @@ Ogre::Real GameMap::crowDistance(int x1, int x2, int y1, int y2)
                 + pow(static_cast<Ogre::Real>(y2 - y1), 2.0f));
 }
 
-bool GameMap::doFloodFill(Tile* tile)
+bool GameMap::isFloodFillPassable(const Tile* tile, Tile::FloodFillType floodFillType)
 {
-    if (!mFloodFillEnabled)
-        return false;
-
-    if(tile->isFloodFillFilled())
+    if(tile->getFullness() > 0.0)
         return false;
 
-    bool hasChanged = false;
-    // If a neigboor is colored with the same colors, we color the tile
-    for(Tile* neigh : tile->getAllNeighbors())
+    switch(tile->getType())
     {
-        switch(neigh->getType())
-        {
-            case Tile::dirt:
-            case Tile::gold:
-            case Tile::claimed:
-            {
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGround] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGround] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGround] = neigh->mFloodFillColor[Tile::FloodFillTypeGround];
-                    hasChanged = true;
-                }
-
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundWater] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundWater];
-                    hasChanged = true;
-                }
-
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundLava] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundLava];
-                    hasChanged = true;
-                }
-
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava];
-                    hasChanged = true;
-                }
-                break;
-            }
-            case Tile::water:
-            {
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundWater] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundWater];
-                    hasChanged = true;
-                }
-
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava];
-                    hasChanged = true;
-                }
-                break;
-            }
-            case Tile::lava:
-            {
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundLava] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundLava];
-                    hasChanged = true;
-                }
-
-                if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == -1) &&
-                   (neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] != -1))
-                {
-                    tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] = neigh->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava];
-                    hasChanged = true;
-                }
-                break;
-            }
-            default:
-                continue;
-        }
-
-        // If the tile is fully filled, no need to continue
-        if(tile->isFloodFillFilled())
+        case Tile::dirt:
+        case Tile::gold:
+        case Tile::claimed:
             return true;
+        case Tile::water:
+            return (floodFillType == Tile::FloodFillTypeGroundWater) ||
+                (floodFillType == Tile::FloodFillTypeGroundWaterLava);
+        case Tile::lava:
+            return (floodFillType == Tile::FloodFillTypeGroundLava) ||
+                (floodFillType == Tile::FloodFillTypeGroundWaterLava);
+        default:
+            return false;
     }
-
-    return hasChanged;
 }
 
-void GameMap::replaceFloodFill(Tile::FloodFillType floodFillType, int colorOld, int colorNew)
+bool GameMap::isInSameFloodFillRegion(Tile::FloodFillType floodFillType, Tile* tile1, Tile* tile2)
 {
-    OD_ASSERT_TRUE(floodFillType < Tile::FloodFillType::FloodFillTypeMax);
-    if(floodFillType >= Tile::FloodFillType::FloodFillTypeMax)
-        return;
-
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            Tile* tile = getTile(ii,jj);
-            if(tile->mFloodFillColor[floodFillType] == colorOld)
-                tile->mFloodFillColor[floodFillType] = colorNew;
-        }
-    }
+    FloodFillRegions& regions = mFloodFillRegions[floodFillType];
+    return regions.getRegion(tile1->mFloodFillColor[floodFillType]) ==
+        regions.getRegion(tile2->mFloodFillColor[floodFillType]);
 }
 
 void GameMap::refreshFloodFill(Tile* tile)
 {
-    int colors[Tile::FloodFillTypeMax];
-    for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
-        colors[i] = -1;
+    if (!mFloodFillEnabled)
+        return;
 
-    // If the tile has opened a new place, we use the same floodfillcolor for all the areas
-    for(Tile* neigh : tile->getAllNeighbors())
+    // If the tile has opened a new place, we merge the regions of all its neighbors
+    for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
     {
-        for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
+        Tile::FloodFillType floodFillType = static_cast<Tile::FloodFillType>(i);
+        tile->mFloodFillColor[i] = -1;
+        if(!isFloodFillPassable(tile, floodFillType))
+            continue;
+
+        for(Tile* neigh : tile->getAllNeighbors())
         {
-            if(colors[i] == -1)
-            {
-                colors[i] = neigh->mFloodFillColor[i];
+            if(neigh->mFloodFillColor[i] == -1)
+                continue;
+
+            if(!isFloodFillPassable(neigh, floodFillType))
+                continue;
+
+            if(tile->mFloodFillColor[i] == -1)
                 tile->mFloodFillColor[i] = neigh->mFloodFillColor[i];
-            }
-            else if((colors[i] != -1) &&
-               (neigh->mFloodFillColor[i] != -1) &&
-               (neigh->mFloodFillColor[i] != colors[i]))
-            {
-                replaceFloodFill(static_cast<Tile::FloodFillType>(i), neigh->mFloodFillColor[i], colors[i]);
-            }
+            else
+                mFloodFillRegions[i].mergeColors(tile->mFloodFillColor[i], neigh->mFloodFillColor[i]);
         }
+
+        // If the tile is not connected to anything, it is a new region
+        if(tile->mFloodFillColor[i] == -1)
+            tile->mFloodFillColor[i] = mFloodFillRegions[i].newColor();
     }
 }
 
-void GameMap::enableFloodFill()
+void GameMap::tilePassabilityChanged(const Tile* tile)
 {
-    // Carry out a flood fill of the whole level to make sure everything is good.
-    // Start by setting the flood fill color for every tile on the map to -1.
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            for(int kk = 0; kk < Tile::FloodFillTypeMax; ++kk)
-            {
-                getTile(ii,jj)->mFloodFillColor[kk] = -1;
-            }
-        }
-    }
+    mClusterGraph.setTileDirty(tile);
+    refreshTileOpacity(tile);
+    invalidateDistanceFields();
+}
 
+void GameMap::enableFloodFill()
+{
     // The algorithm used to find a path is efficient when the path exists but not if it doesn't.
     // To improve path finding, we tag the contiguous tiles to know if a path exists between 2 tiles or not.
     // Because creatures can go through ground, water or lava, we process all of theses.
     // Note : when a tile is digged, floodfill will have to be refreshed.
     mFloodFillEnabled = true;
 
-    // To optimize floodfilling, we start by tagging the dirt tiles with fullness = 0
-    // because they are walkable for most creatures. When we will have tagged all
-    // thoses, we will deal with water/lava remaining (there can be some left if
-    // surrounded by not passable tiles).
-    Tile::FloodFillType currentType = Tile::FloodFillTypeGround;
-    int floodFillValue = 0;
-    while(true)
+    std::vector<bool> passable(getMapSizeX() * getMapSizeY(), false);
+    std::vector<int> colors;
+    for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
     {
-        int yy = 0;
-
-        bool isTileFound;
-        isTileFound = false;
-        while(!isTileFound && (yy < getMapSizeY()))
+        Tile::FloodFillType floodFillType = static_cast<Tile::FloodFillType>(i);
+        for (int xx = 0; xx < getMapSizeX(); ++xx)
         {
-            for(int xx = 0; xx < getMapSizeX(); ++xx)
-            {
-                Tile* tile = getTile(xx, yy);
-                if(tile->getFullness() > 0.0)
-                    continue;
-
-                if(currentType == Tile::FloodFillTypeGround)
-                {
-                    if((tile->mFloodFillColor[Tile::FloodFillTypeGround] == -1) &&
-                       ((tile->getType() == Tile::dirt) ||
-                        (tile->getType() == Tile::gold) ||
-                        (tile->getType() == Tile::claimed)))
-                    {
-                        isTileFound = true;
-                        for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
-                        {
-                            if(tile->mFloodFillColor[i] == -1)
-                                tile->mFloodFillColor[i] = ++floodFillValue;
-                        }
-                        break;
-                    }
-                }
-                else if(currentType == Tile::FloodFillTypeGroundWater)
-                {
-                    if((tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] == -1) &&
-                       (tile->getType() == Tile::water))
-                    {
-                        isTileFound = true;
-                        if(tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] == -1)
-                            tile->mFloodFillColor[Tile::FloodFillTypeGroundWater] = ++floodFillValue;
-                        if(tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == -1)
-                            tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] = ++floodFillValue;
-                        break;
-                    }
-                }
-                else if(currentType == Tile::FloodFillTypeGroundLava)
-                {
-                    if((tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] == -1) &&
-                       (tile->getType() == Tile::lava))
-                    {
-                        isTileFound = true;
-                        if(tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] == -1)
-                            tile->mFloodFillColor[Tile::FloodFillTypeGroundLava] = ++floodFillValue;
-                        if(tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] == -1)
-                            tile->mFloodFillColor[Tile::FloodFillTypeGroundWaterLava] = ++floodFillValue;
-                        break;
-                    }
-                }
-            }
-
-            if(!isTileFound)
-                ++yy;
-        }
-
-        // If there are no more walkable tiles, we go for water. Then, for lava. After that, floodfill should be complete
-        if(!isTileFound)
-        {
-            switch(currentType)
-            {
-                case Tile::FloodFillTypeGround:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = Tile::FloodFillTypeGroundWater;
-                    isTileFound = true;
-                    break;
-                }
-                case Tile::FloodFillTypeGroundWater:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = Tile::FloodFillTypeGroundLava;
-                    isTileFound = true;
-                    break;
-                }
-                case Tile::FloodFillTypeGroundLava:
-                {
-                    // There are no more tiles. We can stop
-                    break;
-                }
-                default:
-                    OD_ASSERT_TRUE_MSG(false, "Unexpected enum value=" + Ogre::StringConverter::toString(
-                        static_cast<int>(currentType)));
-                    break;
-            }
+            for (int yy = 0; yy < getMapSizeY(); ++yy)
+                passable[xx * getMapSizeY() + yy] = isFloodFillPassable(getTile(xx, yy), floodFillType);
         }
 
-        if(!isTileFound)
-            break;
+        mFloodFillRegions[i].computeRegions(passable, getMapSizeX(), getMapSizeY(), colors);
 
-        while(yy < getMapSizeY())
+        for (int xx = 0; xx < getMapSizeX(); ++xx)
         {
-            int nbTiles = 0;
-            for(int xx = 0; xx < getMapSizeX(); ++xx)
-            {
-                Tile* tile = getTile(xx, yy);
-                if(doFloodFill(tile))
-                    ++nbTiles;
-            }
-
-            // For optimization purposes, if a tile has changed, we go on the other side
-            if(nbTiles > 0)
-            {
-                for(int xx = getMapSizeX() - 1; xx >= 0; --xx)
-                {
-                    Tile* tile = getTile(xx, yy);
-                    if(doFloodFill(tile))
-                        ++nbTiles;
-                }
-            }
-
-            // If at least one tile as been changed, we go back to the previous line
-            if((nbTiles > 0) && (yy > 0))
-                --yy;
-            else
-                ++yy;
+            for (int yy = 0; yy < getMapSizeY(); ++yy)
+                getTile(xx, yy)->mFloodFillColor[i] = colors[xx * getMapSizeY() + yy];
         }
     }
 }
@@ -2577,8 +2465,8 @@ int GameMap::addGoldToSeat(int gold, int seatId)
     if(seat == nullptr)
         return gold;
 
-    std::vector<Room*> treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
-    for (std::vector<Room*>::iterator it = treasuriesOwned.begin(); it != treasuriesOwned.end(); ++it)
+    const std::vector<Room*>& treasuriesOwned = getRoomsByTypeAndSeat(Room::treasury, seat);
+    for (std::vector<Room*>::const_iterator it = treasuriesOwned.begin(); it != treasuriesOwned.end(); ++it)
     {
         RoomTreasury* treasury = static_cast<RoomTreasury*>(*it);
         if(treasury->numCoveredTiles() == 0)
@@ -2667,24 +2555,6 @@ std::string GameMap::nextUniqueNameMapLight()
     return ret;
 }
 
-MovableGameEntity* GameMap::getEntityFromTypeAndName(GameEntity::ObjectType entityType,
-    const std::string& entityName)
-{
-    switch(entityType)
-    {
-        case GameEntity::ObjectType::creature:
-            return getCreature(entityName);
-
-        case GameEntity::ObjectType::renderedMovableEntity:
-            return getRenderedMovableEntity(entityName);
-
-        default:
-            break;
-    }
-
-    return nullptr;
-}
-
 void GameMap::logFloodFileTiles()
 {
     for(int yy = 0; yy < getMapSizeY(); ++yy)
@@ -2697,8 +2567,9 @@ void GameMap::logFloodFileTiles()
                 + " - seatId=" + std::string(tile->getSeat() == nullptr ? "0" : Ogre::StringConverter::toString(tile->getSeat()->getId()));
             for(int i = 0; i < Tile::FloodFillTypeMax; ++i)
             {
+                int color = tile->getFloodFill(static_cast<Tile::FloodFillType>(i));
                 str += ", [" + Ogre::StringConverter::toString(i) + "]=" +
-                    Ogre::StringConverter::toString(tile->getFloodFill(static_cast<Tile::FloodFillType>(i)));
+                    Ogre::StringConverter::toString(mFloodFillRegions[i].getRegion(color));
             }
             LogManager::getSingleton().logMessage(str);
         }
@@ -2755,17 +2626,37 @@ void GameMap::consoleAskToggleFOW()
     mIsFOWActivated = !mIsFOWActivated;
 }
 
-Creature* GameMap::getKoboldForPathFinding(Seat* seat)
+void GameMap::consoleProfiler(const std::string& traceFile)
 {
-    std::vector<Creature*> creatures = getCreaturesBySeat(seat);
-    for (Creature* creature : creatures)
+    LogManager::getSingleton().logMessage(mTurnProfiler.getReport());
+
+    if(traceFile.empty())
+        return;
+
+    if(traceFile == "off")
     {
-        if (creature->getDefinition()->getClassName() == "Kobold")
-        {
-            return creature;
-        }
+        mTurnProfiler.stopTrace();
+        LogManager::getSingleton().logMessage("Turn profiler trace stopped");
+        return;
     }
-    return nullptr;
+
+    if(mTurnProfiler.startTrace(traceFile))
+        LogManager::getSingleton().logMessage("Turn profiler trace written in " + traceFile);
+    else
+        LogManager::getSingleton().logMessage("Cannot open turn profiler trace file " + traceFile, Ogre::LML_CRITICAL);
+}
+
+Creature* GameMap::getKoboldForPathFinding(Seat* seat)
+{
+    const CreatureDefinition* koboldDefinition = getClassDescription("Kobold");
+    if (koboldDefinition == nullptr)
+        return nullptr;
+
+    const std::vector<Creature*>& kobolds = getCreaturesBySeatAndDefinition(seat, koboldDefinition);
+    if (kobolds.empty())
+        return nullptr;
+
+    return kobolds.front();
 }
 
 bool GameMap::pathToBestFightingPosition(std::list<Tile*>& pathToTarget, Creature* attackingCreature,
@@ -2882,17 +2773,167 @@ void GameMap::fillBuildableTilesAndPriceForPlayerInArea(int x1, int y1, int x2,
 
 void GameMap::updateVisibleEntities()
 {
-    // Notify what happened to entities on visible tiles
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
+    // Notify what happened to entities on the tiles that changed. Notifying
+    // may add tiles to the list so we do not use iterators
+    for (uint32_t i = 0; i < mDirtyTiles.size(); ++i)
+        mDirtyTiles[i]->notifySeatsWithVision();
+
+    // Notify changes on visible tiles
+    for(Seat* seat : mSeats)
+        seat->notifyChangedVisibleTiles();
+
+    mNumDirtyTiles = mDirtyTiles.size();
+    for (Tile* tile : mDirtyTiles)
+        tile->mIsMarkedDirty = false;
+
+    mDirtyTiles.clear();
+}
+
+uint64_t GameMap::computeStateHash()
+{
+    StateHash hash;
+    for(int x = 0; x < getMapSizeX(); ++x)
     {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
+        for(int y = 0; y < getMapSizeY(); ++y)
         {
-            Tile* tile = getTile(ii,jj);
-            tile->notifySeatsWithVision();
+            Tile* tile = getTile(x, y);
+            hash.add(static_cast<uint64_t>(tile->getType()));
+            hash.add(tile->getFullness(), 0.01);
+            hash.add(tile->getClaimedPercentage(), 0.01);
+            hash.add(static_cast<uint64_t>((tile->getSeat() == nullptr) ? -1 : tile->getSeat()->getId()));
         }
     }
 
-    // Notify changes on visible tiles
+    for(Creature* creature : mCreatures)
+    {
+        const Ogre::Vector3& position = creature->getPosition();
+        hash.add(static_cast<uint64_t>(creature->getHandle()));
+        hash.add(position.x, 0.01);
+        hash.add(position.y, 0.01);
+        hash.add(position.z, 0.01);
+        hash.add(creature->getHP(), 0.01);
+        hash.add(static_cast<uint64_t>(creature->getLevel()));
+    }
+
     for(Seat* seat : mSeats)
-        seat->notifyChangedVisibleTiles();
+    {
+        hash.add(static_cast<uint64_t>(seat->getGold()));
+        hash.add(seat->getMana(), 0.01);
+    }
+
+    return hash.getValue();
+}
+
+uint64_t GameMap::computeVisibleTilesHash(Seat* seat)
+{
+    StateHash hash;
+    for(int x = 0; x < getMapSizeX(); ++x)
+    {
+        for(int y = 0; y < getMapSizeY(); ++y)
+        {
+            Tile* tile = getTile(x, y);
+            if(!seat->hasVisionOnTile(tile))
+                continue;
+
+            // The position is hashed too so that a difference of vision is detected
+            hash.add(static_cast<uint64_t>(x * getMapSizeY() + y));
+            hash.add(static_cast<uint64_t>(tile->getType()));
+            hash.add(tile->getFullness(), 1.0);
+        }
+    }
+
+    return hash.getValue();
+}
+
+void GameMap::markWorkerTasksDirty(Tile* tile)
+{
+    if(!isServerGameMap() || mWorkerTasksNeedRebuild)
+        return;
+
+    if(tile->mIsWorkerTaskDirty)
+        return;
+
+    tile->mIsWorkerTaskDirty = true;
+    mWorkerTaskDirtyTiles.push_back(tile);
+}
+
+void GameMap::refreshClaimTasks(Tile* tile)
+{
+    for(Seat* seat : mSeats)
+    {
+        WorkerTaskBoard& board = seat->getWorkerTaskBoard();
+        board.setTask(WorkerTaskBoard::TaskType::claimGround, tile->getX(), tile->getY(),
+            tile->canWorkerClaimGround(seat));
+        board.setTask(WorkerTaskBoard::TaskType::claimWall, tile->getX(), tile->getY(),
+            tile->isWallClaimable(seat));
+    }
+}
+
+void GameMap::updateWorkerTasks()
+{
+    if(mWorkerTasksNeedRebuild)
+    {
+        mWorkerTasksNeedRebuild = false;
+        for(Tile* tile : mWorkerTaskDirtyTiles)
+            tile->mIsWorkerTaskDirty = false;
+        mWorkerTaskDirtyTiles.clear();
+
+        for(Seat* seat : mSeats)
+        {
+            WorkerTaskBoard& board = seat->getWorkerTaskBoard();
+            board.setMapSize(getMapSizeX(), getMapSizeY());
+            Player* player = seat->getPlayer();
+            if(player == nullptr)
+                continue;
+
+            for(int xx = 0; xx < getMapSizeX(); ++xx)
+            {
+                for(int yy = 0; yy < getMapSizeY(); ++yy)
+                    board.setTask(WorkerTaskBoard::TaskType::dig, xx, yy, getTile(xx, yy)->getMarkedForDigging(player));
+            }
+        }
+
+        for(int xx = 0; xx < getMapSizeX(); ++xx)
+        {
+            for(int yy = 0; yy < getMapSizeY(); ++yy)
+                refreshClaimTasks(getTile(xx, yy));
+        }
+        return;
+    }
+
+    // Claiming a tile changes the claimability of its neighbors. The tiles are flagged as processed
+    // so that a tile next to several dirty tiles is refreshed once
+    std::vector<Tile*> tilesToRefresh;
+    for(Tile* tile : mWorkerTaskDirtyTiles)
+    {
+        tile->mIsWorkerTaskDirty = false;
+        tilesToRefresh.push_back(tile);
+        for(Tile* neigh : tile->getAllNeighbors())
+            tilesToRefresh.push_back(neigh);
+    }
+    mWorkerTaskDirtyTiles.clear();
+
+    for(Tile* tile : tilesToRefresh)
+    {
+        if(tile->mIsWorkerTaskDirty)
+            continue;
+
+        tile->mIsWorkerTaskDirty = true;
+        refreshClaimTasks(tile);
+    }
+
+    for(Tile* tile : tilesToRefresh)
+        tile->mIsWorkerTaskDirty = false;
+}
+
+void GameMap::markTileDirty(Tile* tile)
+{
+    if(!isServerGameMap())
+        return;
+
+    if(tile->mIsMarkedDirty)
+        return;
+
+    tile->mIsMarkedDirty = true;
+    mDirtyTiles.push_back(tile);
 }
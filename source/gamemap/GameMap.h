@@ -18,11 +18,20 @@
 #ifndef _GAMEMAP_H_
 #define _GAMEMAP_H_
 
+#include "gamemap/AstarSearch.h"
+#include "gamemap/ClusterGraph.h"
+#include "gamemap/DistanceField.h"
+#include "gamemap/EntityChunkIndex.h"
+#include "gamemap/EntityRegistry.h"
+#include "gamemap/FloodFillRegions.h"
 #include "gamemap/TileContainer.h"
 
 #include "ai/AIManager.h"
 #include "rooms/Room.h"
 
+#include "utils/ThreadPool.h"
+#include "utils/TurnProfiler.h"
+
 #ifdef __MINGW32__
 #ifndef mode_t
 #include <sys/types.h>
@@ -31,8 +40,10 @@
 
 #include <map>
 #include <string>
+#include <tuple>
 #include <cstdint>
 
+class Building;
 class Tile;
 class Creature;
 class Player;
@@ -110,6 +121,8 @@ public:
     const Creature* getCreature(int index) const;
     Creature* getCreature(const std::string& cName);
     const Creature* getCreature(const std::string& cName) const;
+    //! \brief Returns the creature with the given handle (see EntityRegistry) or nullptr if it is not on map.
+    Creature* getCreatureFromHandle(uint32_t handle);
 
     //! \brief Returns the total number of creatures stored in this game map.
     unsigned int numCreatures() const;
@@ -117,9 +130,21 @@ public:
     bool getIsFOWActivated() const
     { return mIsFOWActivated; }
 
-    //! \brief Returns a vector containing all the creatures controlled by the given seat.
-    std::vector<Creature*> getCreaturesByAlliedSeat(Seat* seat);
-    std::vector<Creature*> getCreaturesBySeat(Seat* seat);
+    /*! \brief Returns the alive creatures controlled by the given seat, in the order they were added. The
+     * returned vector is an index kept up to date by the game map: it should not be kept (copy it if needed)
+     * and it should not be iterated while creatures are added or removed. Creatures leave it when their
+     * death is processed (see notifyCreatureDeath).
+     */
+    const std::vector<Creature*>& getCreaturesBySeat(const Seat* seat) const;
+
+    //! \brief Returns the alive creatures of the given definition controlled by the given seat. Like
+    //! getCreaturesBySeat, it is an index that should not be kept nor iterated while creatures are added or removed.
+    const std::vector<Creature*>& getCreaturesBySeatAndDefinition(const Seat* seat,
+        const CreatureDefinition* definition) const;
+
+    //! \brief Called by a creature when its death is processed. It will not be counted as a creature of
+    //! its seat anymore while it lays dead on the ground.
+    void notifyCreatureDeath(Creature* creature);
 
     Creature* getWorkerToPickupBySeat(Seat* seat);
     Creature* getFighterToPickupBySeat(Seat* seat);
@@ -130,6 +155,7 @@ public:
     void removeAnimatedObject(MovableGameEntity *a);
     MovableGameEntity* getAnimatedObject(int index);
     MovableGameEntity* getAnimatedObject(const std::string& name);
+    MovableGameEntity* getAnimatedObjectFromHandle(uint32_t handle);
     unsigned int numAnimatedObjects();
 
     void addActiveObject(GameEntity* a);
@@ -183,17 +209,35 @@ public:
     //! \brief A simple accessor method to return the number of Rooms stored in the GameMap.
     unsigned int numRooms();
 
-    std::vector<Room*> getRoomsByType(Room::RoomType type);
-    std::vector<Room*> getRoomsByTypeAndSeat(Room::RoomType type,
-                        Seat* seat);
-    std::vector<const Room*> getRoomsByTypeAndSeat(Room::RoomType type,
-                          Seat* seat) const;
+    /*! \brief Returns the rooms of the given type, in the order they were added. Like getCreaturesBySeat,
+     * the returned vector is an index: it should not be kept nor iterated while rooms are added or removed.
+     */
+    const std::vector<Room*>& getRoomsByType(Room::RoomType type) const;
+    const std::vector<Room*>& getRoomsByTypeAndSeat(Room::RoomType type,
+                        const Seat* seat) const;
     unsigned int numRoomsByTypeAndSeat(Room::RoomType type,
-                      Seat* seat) const;
+                      const Seat* seat) const;
     std::vector<Room*> getReachableRooms(const std::vector<Room*> &vec,
                        Tile *startTile, const Creature* creature);
     std::vector<Building*> getReachableBuildingsPerSeat(Seat* seat,
         Tile *startTile, const Creature* creature);
+
+    //! \brief Returns the distance field to the tiles of the rooms of the given type owned by the given seat. The
+    //! field is cached and only computed again if a tile passability or a building has changed since the last call.
+    const DistanceField& getRoomsDistanceField(Room::RoomType type, Seat* seat, ClusterGraph::MovementClass movementClass);
+
+    //! \brief Returns the room of the given type owned by the given seat that is the closest (walking distance) to the
+    //! given creature or nullptr if there is none reachable.
+    Room* getClosestReachableRoom(Room::RoomType type, Seat* seat, const Creature* creature);
+
+    //! \brief Returns the rooms of the given type owned by the given seat that the given creature can reach, sorted
+    //! by walking distance (closest first). Unlike getClosestReachableRoom, it computes a distance field from the creature
+    //! so it should only be used when the closest room cannot be used.
+    std::vector<Room*> getReachableRoomsByDistance(Room::RoomType type, Seat* seat, const Creature* creature);
+
+    //! \brief Forgets the cached distance fields. Should be called when something that can change them happens.
+    inline void invalidateDistanceFields()
+    { ++mDistanceFieldsVersion; }
     Room* getRoomByName(const std::string& name);
     Trap* getTrapByName(const std::string& name);
 
@@ -322,6 +366,9 @@ public:
      * the 4 nearest neighbors of the previous tile in the path.
      * When building the path, we check if a diagonal can be used. We consider it can
      * if the creature can go through the 4 tiles.
+     * If the manhattan distance between the tiles is at least the HierarchicalPathMinDistance
+     * game config value, the cluster graph is used to find the entrances to cross and the path
+     * is only computed at the tile level between them.
      * \param seat The seat is used when searching a diggable path to know
      * what tile actually diggable for the given team.
      */
@@ -331,6 +378,10 @@ public:
     //! \note Returns a path for the given creature to the given destination.
     std::list<Tile*> path(const Creature* creature, Tile* destination, bool throughDiggableTiles = false);
 
+    //! \brief Returns true if there may be a creature/room/trap allied with the given seat (or if invert is true, not allied)
+    //! within radius of the given tile. If false is returned, there is none. Uses the chunks of mEntityChunkIndex.
+    bool isForcePossiblyInRadius(Tile* tile, int radius, Seat* seat, bool invert) const;
+
     //! \brief Loops over the visibleTiles and returns any creature/room/trap in those tiles allied with the given seat (or if invert is true, is not allied)
     std::vector<GameEntity*> getVisibleForce(const std::vector<Tile*>& visibleTiles, Seat* seat, bool invert);
 
@@ -347,12 +398,15 @@ public:
     Ogre::Real crowDistance(Tile *t1, Tile *t2);
     Ogre::Real crowDistance(Creature *c1, Creature *c2);
 
-    //! \brief Checks the neighboor tiles to see if the floodfill can be used. Floodfill consists on tagging all contiguous tiles
-    //! to be able to know before computing it if a path exists between 2 tiles. We do that to avoid computing paths when we
-    //! already know that no path exists.
-    bool doFloodFill(Tile* tile);
+    //! \brief Floodfill consists on tagging all contiguous tiles to be able to know before computing it if a path
+    //! exists between 2 tiles. We do that to avoid computing paths when we already know that no path exists.
+    //! When a tile becomes passable, refreshFloodFill merges the regions of its neighbors.
     void refreshFloodFill(Tile* tile);
 
+    //! \brief Should be called when the type or the fullness of the given tile changes to
+    //! refresh the cluster graph used for long distance path finding and the tiles opacity.
+    void tilePassabilityChanged(const Tile* tile);
+
     //! \brief Temporarily disables the flood fill computations on this game map.
     void disableFloodFill()
     { mFloodFillEnabled = false; }
@@ -434,6 +488,14 @@ public:
     void consoleSetLevelCreature(const std::string& creatureName, uint32_t level);
     void consoleAskToggleFOW();
 
+    //! \brief Logs the time spent in each turn phase. If traceFile is not empty, the zones are written
+    //! in this file as Chrome trace events until the command is called with "off".
+    void consoleProfiler(const std::string& traceFile);
+
+    //! \brief Measures the time spent by the server in each turn phase. Used on the server game map only.
+    inline TurnProfiler& getTurnProfiler()
+    { return mTurnProfiler; }
+
     //! \brief This functions create unique names. They check that there
     //! is no entity with the same name before returning
     std::string nextUniqueNameCreature(const std::string& className);
@@ -446,10 +508,9 @@ public:
     void addRenderedMovableEntity(RenderedMovableEntity *obj);
     void removeRenderedMovableEntity(RenderedMovableEntity *obj);
     RenderedMovableEntity* getRenderedMovableEntity(const std::string& name);
+    RenderedMovableEntity* getRenderedMovableEntityFromHandle(uint32_t handle);
     void clearRenderedMovableEntities();
     void clearActiveObjects();
-    MovableGameEntity* getEntityFromTypeAndName(GameEntity::ObjectType entityType,
-        const std::string& entityName);
 
     //! \brief Tells the game map a given player is attacking or under attack.
     //! Used on the server game map only.
@@ -462,10 +523,62 @@ public:
     void fillBuildableTilesAndPriceForPlayerInArea(int x1, int y1, int x2, int y2,
         Player* player, Room::RoomType type, std::vector<Tile*>& tiles, int& goldRequired);
 
+    //! \brief Notifies the seats about the entities and tiles that changed since the last call
+    //! (only the dirty tiles are processed)
     void updateVisibleEntities();
 
+    /*! \brief Returns a hash of the simulation state: the tiles, the creatures and the seats resources.
+     * 2 servers computing the same turns from the same random seed and the same player commands
+     * should get the same hash. Used on server side only.
+     */
+    uint64_t computeStateHash();
+
+    /*! \brief Returns a hash of the type and fullness of the tiles the given seat has vision on. On the
+     * client, seat should be the local player seat. As the server sends these tiles when they change,
+     * the client and the server should get the same hash at the end of a turn.
+     */
+    uint64_t computeVisibleTilesHash(Seat* seat);
+
+    //! \brief Adds the given tile to the dirty tiles if not already in. Should be called when the entities
+    //! on the tile, the seats seeing it or the tile itself change. Used on server side only.
+    void markTileDirty(Tile* tile);
+
+    //! \brief Tiles changed since the last call to updateVisibleEntities
+    inline const std::vector<Tile*>& getDirtyTiles() const
+    { return mDirtyTiles; }
+
+    //! \brief Should be called when the claimability of the given tile may have changed (type, fullness,
+    //! claiming seat or covering building). The claim tasks of the tile and its neighbors will be refreshed
+    //! for every seat at the next updateWorkerTasks. Used on server side only.
+    void markWorkerTasksDirty(Tile* tile);
+
+    //! \brief Updates the entity chunk index when an entity is added on (or removed from) the given tile. Called by
+    //! the tile on the server game map only. Only creatures and rendered movable entities are indexed.
+    void indexEntityOnTile(GameEntity* entity, Tile* tile, bool isAdded);
+
+    //! \brief Updates the entity chunk index when a room or a trap starts (or stops) covering the given tile.
+    void indexBuildingOnTile(Building* building, Tile* tile, bool isAdded);
+
+    //! \brief Refreshes the worker task boards of the seats. If the map or the seats changed, the boards
+    //! are rebuilt from every tile. Otherwise, only the tiles marked by markWorkerTasksDirty are processed.
+    void updateWorkerTasks();
+
 private:
-    void replaceFloodFill(Tile::FloodFillType floodFillType, int colorOld, int colorNew);
+    //! \brief Returns true if the given tile can be part of a region for the given flood fill type.
+    static bool isFloodFillPassable(const Tile* tile, Tile::FloodFillType floodFillType);
+
+    //! \brief Sets the claim tasks of the given tile in the task boards of every seat
+    void refreshClaimTasks(Tile* tile);
+
+    //! \brief Returns the slot of the given seat in mEntityChunkIndex (its position in mSeats)
+    uint32_t getEntityChunkSlot(const Seat* seat) const;
+
+    //! \brief Returns the mEntityChunkIndex seat mask of the seats allied with the given seat (or if invert is true,
+    //! not allied). The slot of the entities without seat is always set so that the mask never filters too much.
+    uint64_t getEntityChunkSeatMask(Seat* seat, bool invert) const;
+
+    //! \brief Returns true if both tiles are in the same region for the given flood fill type.
+    bool isInSameFloodFillRegion(Tile::FloodFillType floodFillType, Tile* tile1, Tile* tile2);
 
     //! \brief Tells whether this game map instance is used as a reference by the server-side,
     //! or as a standard client game map.
@@ -504,6 +617,12 @@ private:
 
     std::vector<Creature*> mCreatures;
 
+    //! \brief Index of the alive creatures of mCreatures by seat. The creatures are in the same order as in mCreatures.
+    std::map<const Seat*, std::vector<Creature*>> mCreaturesBySeat;
+
+    //! \brief Index of the alive creatures of mCreatures by seat and definition, in the same order as in mCreatures.
+    std::map<std::pair<const Seat*, const CreatureDefinition*>, std::vector<Creature*>> mCreaturesBySeatAndDefinition;
+
     //! \brief The creature definition data. We use a pair to be able to make the difference between the original
     //! data from the global creature definition file and the specific data from the level file. With this trick,
     //! we will be able to compare and write the differences in the level file.
@@ -516,6 +635,10 @@ private:
 
     //! \brief Map Entities
     std::vector<Room*> mRooms;
+
+    //! \brief Indexes of mRooms by type and by seat and type. The rooms are in the same order as in mRooms.
+    std::map<Room::RoomType, std::vector<Room*>> mRoomsByType;
+    std::map<std::pair<const Seat*, Room::RoomType>, std::vector<Room*>> mRoomsBySeatAndType;
     std::vector<Trap*> mTraps;
     std::vector<MapLight*> mMapLights;
 
@@ -530,6 +653,10 @@ private:
     //! \brief Tells whether the map color flood filling is enabled.
     bool mFloodFillEnabled;
 
+    //! \brief The regions of contiguous tiles for each flood fill type. The tiles flood fill colors are
+    //! only meaningful through them.
+    FloodFillRegions mFloodFillRegions[Tile::FloodFillTypeMax];
+
     //! When true, fog of war will work normally. When false, every connected client will see the whole map
     bool mIsFOWActivated;
 
@@ -547,6 +674,58 @@ private:
     //! \brief Debug member used to know how many call to pathfinding has been made within the same turn.
     unsigned int mNumCallsTo_path;
 
+    //! \brief Debug member used to know how much time (in microseconds) has been spent in pathfinding.
+    unsigned long int mTimeSpentIn_path;
+
+    //! \brief The A* engine used by path(). Its buffers are kept from one call to another.
+    AstarSearch mAstarSearch;
+
+    //! \brief Abstract graph used by path() for long distance searches.
+    ClusterGraph mClusterGraph;
+
+    //! \brief A distance field with the value of mDistanceFieldsVersion when it was computed.
+    class CachedDistanceField
+    {
+    public:
+        CachedDistanceField() :
+            mVersion(0)
+        {}
+
+        DistanceField mField;
+        uint32_t mVersion;
+    };
+
+    //! \brief Distance fields to the rooms indexed by seat id, room type and movement class.
+    std::map<std::tuple<int, int, int>, CachedDistanceField> mDistanceFields;
+
+    //! \brief Incremented each time the cached distance fields are invalidated. Starts at 1.
+    uint32_t mDistanceFieldsVersion;
+
+    //! \brief Tiles to process at the next updateVisibleEntities. A tile is in only once (see Tile::mIsMarkedDirty)
+    std::vector<Tile*> mDirtyTiles;
+
+    //! \brief Debug member used to know how many tiles were dirty during the last updateVisibleEntities.
+    uint32_t mNumDirtyTiles;
+
+    //! \brief Tiles to process at the next updateWorkerTasks. A tile is in only once (see Tile::mIsWorkerTaskDirty)
+    std::vector<Tile*> mWorkerTaskDirtyTiles;
+
+    //! \brief true if the worker task boards should be rebuilt from every tile at the next updateWorkerTasks
+    bool mWorkerTasksNeedRebuild;
+
+    //! \brief Threads used to compute what the creatures see at the beginning of each turn. Started at the
+    //! first turn with the number of threads given by ConfigManager::getSenseWorkerThreads
+    ThreadPool mSenseThreadPool;
+
+    TurnProfiler mTurnProfiler;
+
+    //! \brief Finds the creatures, rendered movable entities, rooms and traps on map by handle or by name
+    EntityRegistry mEntityRegistry;
+
+    //! \brief Counts the creatures, rendered movable entities and buildings on map per chunk and per seat so that
+    //! the visible force queries can skip the areas without any matching entity. Only used on the server game map.
+    EntityChunkIndex mEntityChunkIndex;
+
     std::vector<RenderedMovableEntity*> mRenderedMovableEntities;
 
     //! AI Handling manager
@@ -559,6 +738,13 @@ private:
     //! \brief Resets the unique numbers
     void resetUniqueNumbers();
 
+    //! \brief Registers an entity added to the map. On the server game map, the entity gets a handle the
+    //! first time it is added. On client game maps, it keeps the handle it got from the server (if any).
+    void registerEntity(GameEntity* entity);
+
+    //! \brief Unregisters an entity removed from the map. It keeps its handle until it is deleted.
+    void unregisterEntity(GameEntity* entity);
+
     //! \brief Updates every player's time value so they can handle timed events like fighting music
     //! Used on the server game map only.
     void updatePlayerTime(Ogre::Real timeSinceLastFrame);
@@ -20,6 +20,8 @@
 
 #include "entities/Tile.h"
 
+#include "gamemap/FieldOfView.h"
+
 #include <array>
 #include <bitset>
 #include <sstream>
@@ -105,8 +107,29 @@ public:
      */
     std::list<Tile*> tilesBetween(int x1, int y1, int x2, int y2);
 
-    //! \brief Returns the tiles visible from the given start tile within tilesWithinSightRadius.
-    std::vector<Tile*> visibleTiles(int x, int y, int radius);
+    //! \brief Fills tiles with the tiles visible from the given start tile within radius. The vector is
+    //! cleared first. It should be reused from one call to another to avoid allocating memory.
+    //! It can be called from several threads at the same time for radius up to the one given to
+    //! prepareVisionQueries as long as the map is not modified.
+    void visibleTiles(int x, int y, int radius, std::vector<Tile*>& tiles);
+
+    //! \brief Builds the data needed by visibleTiles and circularRegion up to the given radius so that
+    //! they do not have to build it while being called from several threads.
+    void prepareVisionQueries(int radius);
+
+    //! \brief Value returned by getTileSearchSlot when the tile has not been reached by the current search.
+    static const uint32_t TILE_SEARCH_NO_SLOT;
+
+    //! \brief Starts a new search over the tiles (like a path finding). The slots set by
+    //! the previous search are all invalidated at once by changing the search generation.
+    void startTileSearch();
+
+    //! \brief Returns the slot set for the given tile during the current search or
+    //! TILE_SEARCH_NO_SLOT if it has not been set yet.
+    uint32_t getTileSearchSlot(const Tile* tile) const;
+
+    //! \brief Sets the slot of the given tile for the current search.
+    void setTileSearchSlot(const Tile* tile, uint32_t slot);
 
 protected:
     //! \brief The map size
@@ -117,6 +140,10 @@ protected:
 
     //! \brief Set the map size and memory
     bool allocateMapMemory(int xSize, int ySize);
+
+    //! \brief Updates the vision blocking state of the given tile. Should be called when it
+    //! changes (see Tile::permitsVision)
+    void refreshTileOpacity(const Tile* tile);
 private:
     Tile*** mTiles;
 
@@ -129,6 +156,15 @@ private:
     //! \brief Stores the highest distance computed. If a bigger distance is asked, mTileDistance will have to be updated by
     //! calling buildTileDistance with the higher distance
     int mTileDistanceComputed;
+
+    //! \brief Opacity of the tiles used to compute visible tiles
+    FieldOfView mFieldOfView;
+
+    //! \brief Per tile search data. A slot is only valid if its stamp is equal to the current
+    //! search generation. That allows to reuse them from one search to another without clearing them.
+    std::vector<uint32_t> mTileSearchStamps;
+    std::vector<uint32_t> mTileSearchSlots;
+    uint32_t mTileSearchGeneration;
 };
 
 #endif //TILECONTAINER_H
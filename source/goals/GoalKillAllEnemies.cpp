@@ -41,14 +41,14 @@ bool GoalKillAllEnemies::isMet(Seat *s)
 
     // Considers also creature spawner rooms as enemy to be killed.
     // Temples
-    std::vector<Room*> temples = mGameMap->getRoomsByType(Room::dungeonTemple);
+    const std::vector<Room*>& temples = mGameMap->getRoomsByType(Room::dungeonTemple);
     for (Room* temple : temples)
     {
         if (!temple->getSeat()->isAlliedSeat(s))
             return false;
     }
     // Portals
-    std::vector<Room*> portals = mGameMap->getRoomsByType(Room::portal);
+    const std::vector<Room*>& portals = mGameMap->getRoomsByType(Room::portal);
     for (Room* portal : portals)
     {
         if (!portal->getSeat()->isAlliedSeat(s))
@@ -4,6 +4,7 @@
 #include "goals/Goal.h"
 #include "modes/ConsoleInterface.h"
 #include "modes/ServerConsoleCommands.h"
+#include "network/ODClient.h"
 #include "network/ODServer.h"
 #include "render/ODFrameListener.h"
 #include "utils/Helper.h"
@@ -48,7 +49,10 @@ const std::string HELPMESSAGE =
         "\n\tcatmullspline - Triggers the catmullspline camera movement type."
         "\n\tcirclearound - Triggers the circle camera movement type."
         "\n\tsetcamerafovy - Sets the camera vertical field of view aspect ratio value."
-        "\n\tlogfloodfill - Displays the FloodFillValues of all the Tiles in the GameMap.";
+        "\n\tlogfloodfill - Displays the FloodFillValues of all the Tiles in the GameMap."
+        "\n\n==Replays=="
+        "\n\treplayspeed - Sets how fast the replay is played."
+        "\n\treplayseek - Plays the replay up to the given turn.";
 
 //! \brief Template function to get/set a variable from the ODFrameListener object
 template<typename ValType>
@@ -515,6 +519,71 @@ Command::Result cLogFloodFill(const Command::ArgumentList_t&, ConsoleInterface&
     return Command::Result::SUCCESS;
 }
 
+Command::Result cProfiler(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
+{
+    if(!ODServer::getSingleton().isConnected())
+    {
+        c.print("\nERROR : This command is available on the server only\n");
+        return Command::Result::WRONG_MODE;
+    }
+
+    std::string traceFile;
+    if(args.size() >= 2)
+        traceFile = args[1];
+
+    ServerConsoleCommand* cc = new SCCProfiler(traceFile);
+    ODServer::getSingleton().queueConsoleCommand(cc);
+    return Command::Result::SUCCESS;
+}
+
+Command::Result cReplaySpeed(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
+{
+    ODClient& client = ODClient::getSingleton();
+    if(args.size() < 2)
+    {
+        c.print("\nCurrent replay speed is " + Helper::toString(client.getReplaySpeed()) + "\n");
+        return Command::Result::SUCCESS;
+    }
+
+    float speed = Helper::toFloat(args[1]);
+    if(speed < 0.0f)
+    {
+        c.print("\nERROR : The replay speed cannot be negative\n");
+        return Command::Result::INVALID_ARGUMENT;
+    }
+
+    client.setReplaySpeed(speed);
+    c.print("\nReplay speed set to " + Helper::toString(speed) + "\n");
+    return Command::Result::SUCCESS;
+}
+
+Command::Result cReplaySeek(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
+{
+    ODClient& client = ODClient::getSingleton();
+    int64_t lastTurn = client.getReplayLastTurn();
+    if(lastTurn < 0)
+    {
+        c.print("\nERROR : This command is available while watching a replay only\n");
+        return Command::Result::WRONG_MODE;
+    }
+
+    if(args.size() < 2)
+    {
+        c.print("\nThe replay ends at turn " + Helper::toString(static_cast<int32_t>(lastTurn)) + "\n");
+        return Command::Result::SUCCESS;
+    }
+
+    int turn = Helper::toInt(args[1]);
+    if(!client.seekReplay(turn))
+    {
+        c.print("\nERROR : Turn " + args[1] + " is not in the replay or has already been played\n");
+        return Command::Result::INVALID_ARGUMENT;
+    }
+
+    c.print("\nPlaying the replay up to turn " + args[1] + "\n");
+    return Command::Result::SUCCESS;
+}
+
 Command::Result cListMeshAnims(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
 {
     if(args.size() < 2)
@@ -697,6 +766,26 @@ void addConsoleCommands(ConsoleInterface& cl)
                    "'logfloodfill' logs the FloodFillValues of all the Tiles in the GameMap.",
                    cLogFloodFill,
                    {AbstractModeManager::ModeType::GAME});
+    cl.addCommand("profiler",
+                   "'profiler' logs the median, 95th percentile and maximum time spent by the server in each turn phase "
+                   "over the last turns. If a file name is given, the phases are also written in this file as Chrome "
+                   "trace events (to be loaded in chrome://tracing) until 'profiler off' is called.\n\nExample:\n"
+                   "profiler turns.json",
+                   cProfiler,
+                   {AbstractModeManager::ModeType::GAME});
+    cl.addCommand("replayspeed",
+                   "'replayspeed' sets how fast the replay being watched is played compared to the real time. "
+                   "0 plays it as fast as possible.\n\nExample:\n"
+                   "replayspeed 4",
+                   cReplaySpeed,
+                   {AbstractModeManager::ModeType::GAME});
+    cl.addCommand("replayseek",
+                   "'replayseek' plays the replay being watched without waiting until the given turn starts. "
+                   "Replays cannot go back to a turn already played. Without argument, it displays the last "
+                   "turn of the replay.\n\nExample:\n"
+                   "replayseek 1500",
+                   cReplaySeek,
+                   {AbstractModeManager::ModeType::GAME});
     cl.addCommand("listmeshanims",
                    "'listmeshanims' lists all the animations for the given mesh.",
                    cListMeshAnims,
@@ -407,9 +407,11 @@ bool EditorMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
 
                 if(ODClient::getSingleton().isConnected())
                 {
-                    ODClient::getSingleton().queueClientNotification(ClientNotification::askSlapEntity,
-                                                                     entity->getObjectType(),
-                                                                     entity->getName());
+                    uint32_t handle = entity->getHandle();
+                    ClientNotification *clientNotification = new ClientNotification(
+                        ClientNotification::askSlapEntity);
+                    clientNotification->mPacket << handle;
+                    ODClient::getSingleton().queueClientNotification(clientNotification);
                 }
 
                 return true;
@@ -457,12 +459,10 @@ bool EditorMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
 
         if (ODClient::getSingleton().isConnected())
         {
-            GameEntity::ObjectType entityType = entity->getObjectType();
-            const std::string& entityName = entity->getName();
+            uint32_t handle = entity->getHandle();
             ClientNotification *clientNotification = new ClientNotification(
                 ClientNotification::askEntityPickUp);
-            clientNotification->mPacket << entityType;
-            clientNotification->mPacket << entityName;
+            clientNotification->mPacket << handle;
             ODClient::getSingleton().queueClientNotification(clientNotification);
         }
         return true;
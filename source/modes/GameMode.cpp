@@ -479,11 +479,10 @@ bool GameMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
 
                 if(ODClient::getSingleton().isConnected())
                 {
-                    const std::string& entityName = entity->getName();
-                    GameEntity::ObjectType entityType = entity->getObjectType();
+                    uint32_t handle = entity->getHandle();
                     ClientNotification *clientNotification = new ClientNotification(
                         ClientNotification::askSlapEntity);
-                    clientNotification->mPacket << entityType << entityName;
+                    clientNotification->mPacket << handle;
                     ODClient::getSingleton().queueClientNotification(clientNotification);
                 }
 
@@ -532,12 +531,10 @@ bool GameMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
 
         if (ODClient::getSingleton().isConnected())
         {
-            GameEntity::ObjectType entityType = entity->getObjectType();
-            const std::string& entityName = entity->getName();
+            uint32_t handle = entity->getHandle();
             ClientNotification *clientNotification = new ClientNotification(
                 ClientNotification::askEntityPickUp);
-            clientNotification->mPacket << entityType;
-            clientNotification->mPacket << entityName;
+            clientNotification->mPacket << handle;
             ODClient::getSingleton().queueClientNotification(clientNotification);
         }
         return true;
@@ -25,6 +25,7 @@
 #include "render/ODFrameListener.h"
 #include "network/ODServer.h"
 #include "network/ODClient.h"
+#include "network/ODReplayFile.h"
 #include "network/ServerNotification.h"
 #include "ODApplication.h"
 #include "utils/LogManager.h"
@@ -181,19 +182,35 @@ void MenuModeReplay::listReplaysClicked()
 bool MenuModeReplay::checkReplayValid(const std::string& replayFileName, std::string& mapDescription, std::string& errorMsg)
 {
     std::string replayFile = ResourceManager::getSingleton().getReplayDataPath() + replayFileName;
-    // We open the replay to get the level file name
-    std::ifstream is(replayFile, std::ios::in | std::ios::binary);
+    // We open the replay to get the level file name from the loadLevel message
+    ODReplayReader reader;
+    if(!reader.open(replayFile))
+    {
+        errorMsg = "Invalid replay file";
+        return false;
+    }
+
+    ODPacket envelope;
     ODPacket packet;
-    ServerNotification::ServerNotificationType type;
-    do
+    bool isLevelFound = false;
+    while(!isLevelFound && (reader.readEnvelope(envelope) >= 0))
     {
-        packet.readPacket(is);
-        OD_ASSERT_TRUE(packet >> type);
-        if(is.eof())
-            break;
-    } while(type != ServerNotification::loadLevel);
+        uint32_t offset = 0;
+        while(offset < envelope.getDataSize())
+        {
+            if(!packet.readFromEnvelope(envelope.getData(), envelope.getDataSize(), offset))
+                break;
+
+            ServerNotification::ServerNotificationType type;
+            if((packet >> type) && (type == ServerNotification::loadLevel))
+            {
+                isLevelFound = true;
+                break;
+            }
+        }
+    }
 
-    if(is.eof())
+    if(!isLevelFound)
     {
         errorMsg = "Invalid replay file";
         return false;
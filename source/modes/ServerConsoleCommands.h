@@ -155,6 +155,24 @@ protected:
     }
 };
 
+class SCCProfiler : public ServerConsoleCommand
+{
+public:
+    SCCProfiler(const std::string& traceFile):
+        mTraceFile(traceFile)
+    {
+    }
+
+protected:
+    virtual void execute(GameMap* gameMap)
+    {
+        gameMap->consoleProfiler(mTraceFile);
+    }
+
+private:
+    std::string mTraceFile;
+};
+
 class SCCAddCreature : public ServerConsoleCommand
 {
 public:
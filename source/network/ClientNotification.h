@@ -57,6 +57,7 @@ public:
         askPickupWorker,
         askPickupFighter,
         askSlapEntity,
+        setInterestArea, // Tiles seen by the camera of the client: + InterestArea
 
         //  Editor
         editorAskSaveMap,
@@ -0,0 +1,473 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/EntitySnapshot.h"
+
+#include "network/ODPacket.h"
+
+#include <cmath>
+#include <utility>
+
+//! \brief Bits of the mask telling what changed for an entity
+enum EntitySnapshotField
+{
+    clearDestinationsField = 0x001,
+    destinationsField = 0x002,
+    animationField = 0x004,
+    animationLoopField = 0x008,
+    walkDirectionField = 0x010,
+    walkDirectionValueField = 0x020,
+    moveSpeedField = 0x040,
+    moveSpeedValueField = 0x080,
+    levelField = 0x100,
+    levelValueField = 0x200
+};
+
+//! \brief The walk direction is only used to orientate the creatures. It is sent rounded
+//! to this step, which is much smaller than what can be seen
+static const Ogre::Real WALK_DIRECTION_STEP = 1.0f / 256.0f;
+
+//! \brief Destinations are usually tile coordinates. If every coordinate is an integer, they
+//! are sent as differences with the previous destination.
+static bool isIntegral(Ogre::Real value)
+{
+    return (std::floor(value) == value) && (std::fabs(value) < 1000000.0f);
+}
+
+static bool areIntegral(const std::vector<Ogre::Vector3>& destinations)
+{
+    for(const Ogre::Vector3& destination : destinations)
+    {
+        if(!isIntegral(destination.x) || !isIntegral(destination.y) || !isIntegral(destination.z))
+            return false;
+    }
+    return true;
+}
+
+static void writeCoordinateDelta(ODPacket& packet, Ogre::Real value, Ogre::Real previous)
+{
+    packet.writeVarInt(static_cast<int32_t>(value) - static_cast<int32_t>(previous));
+}
+
+static bool readCoordinateDelta(ODPacket& packet, Ogre::Real& value, Ogre::Real previous)
+{
+    int32_t delta;
+    if(!packet.readVarInt(delta))
+        return false;
+
+    value = static_cast<Ogre::Real>(static_cast<int32_t>(previous) + delta);
+    return true;
+}
+
+EntitySnapshotChange::EntitySnapshotChange() :
+    mHandle(0),
+    mClearDestinations(false),
+    mHasAnimation(false),
+    mAnimationLoop(false),
+    mHasWalkDirection(false),
+    mWalkDirection(Ogre::Vector3::ZERO),
+    mHasMoveSpeed(false),
+    mMoveSpeed(0.0),
+    mHasLevel(false),
+    mLevel(0)
+{
+}
+
+void EntitySnapshotChange::reset(uint32_t handle)
+{
+    mHandle = handle;
+    mClearDestinations = false;
+    mDestinations.clear();
+    mHasAnimation = false;
+    mAnimationState.clear();
+    mAnimationLoop = false;
+    mHasWalkDirection = false;
+    mWalkDirection = Ogre::Vector3::ZERO;
+    mHasMoveSpeed = false;
+    mMoveSpeed = 0.0;
+    mHasLevel = false;
+    mLevel = 0;
+}
+
+EntitySnapshotBaseline::EntitySnapshotBaseline() :
+    mLastDestination(Ogre::Vector3::ZERO),
+    mWalkDirection(Ogre::Vector3::ZERO),
+    mMoveSpeed(0.0),
+    mLevel(0)
+{
+}
+
+EntitySnapshotEncoder::EntitySnapshotEncoder() :
+    mNbEntitiesSent(0),
+    mNbAnimationsSent(0),
+    mNbPendingChanges(0),
+    mNbDeferredChanges(0)
+{
+}
+
+EntitySnapshotChange& EntitySnapshotEncoder::getPendingChange(uint32_t handle)
+{
+    uint32_t entityIndex;
+    auto it = mEntityIndexes.find(handle);
+    if(it != mEntityIndexes.end())
+    {
+        entityIndex = it->second;
+    }
+    else
+    {
+        entityIndex = mEntityIndexes.size();
+        mEntityIndexes.emplace(handle, entityIndex);
+        mBaselines.emplace_back();
+        mSentIndexes.push_back(-1);
+        mPendingChangeByEntity.push_back(-1);
+    }
+
+    int32_t changeIndex = mPendingChangeByEntity[entityIndex];
+    if(changeIndex >= 0)
+        return mPendingChanges[changeIndex];
+
+    if(mNbPendingChanges >= mPendingChanges.size())
+    {
+        mPendingChanges.emplace_back();
+        mPendingEntityIndexes.push_back(0);
+        mIsPendingChangeDeferred.push_back(0);
+    }
+
+    changeIndex = mNbPendingChanges;
+    ++mNbPendingChanges;
+    mPendingChangeByEntity[entityIndex] = changeIndex;
+    mPendingEntityIndexes[changeIndex] = entityIndex;
+    mIsPendingChangeDeferred[changeIndex] = 0;
+    EntitySnapshotChange& change = mPendingChanges[changeIndex];
+    change.reset(handle);
+    return change;
+}
+
+void EntitySnapshotEncoder::clearDestinations(uint32_t handle)
+{
+    EntitySnapshotChange& change = getPendingChange(handle);
+    // The destinations added before are cleared on the client
+    change.mClearDestinations = true;
+    change.mDestinations.clear();
+}
+
+void EntitySnapshotEncoder::addDestination(uint32_t handle, const Ogre::Vector3& destination)
+{
+    getPendingChange(handle).mDestinations.push_back(destination);
+}
+
+void EntitySnapshotEncoder::setAnimationState(uint32_t handle, const std::string& state, bool loop,
+    bool hasWalkDirection, const Ogre::Vector3& walkDirection)
+{
+    EntitySnapshotChange& change = getPendingChange(handle);
+    // Only the last animation of the turn is visible. However, if a previous one changed the walk
+    // direction and not the last one, we keep the direction
+    change.mHasAnimation = true;
+    change.mAnimationState = state;
+    change.mAnimationLoop = loop;
+    if(hasWalkDirection)
+    {
+        change.mHasWalkDirection = true;
+        change.mWalkDirection = walkDirection;
+    }
+}
+
+void EntitySnapshotEncoder::setMoveSpeed(uint32_t handle, double moveSpeed)
+{
+    EntitySnapshotChange& change = getPendingChange(handle);
+    change.mHasMoveSpeed = true;
+    change.mMoveSpeed = moveSpeed;
+}
+
+void EntitySnapshotEncoder::setLevel(uint32_t handle, uint32_t level)
+{
+    EntitySnapshotChange& change = getPendingChange(handle);
+    change.mHasLevel = true;
+    change.mLevel = level;
+}
+
+void EntitySnapshotEncoder::setPendingChangeDeferred(uint32_t index, bool deferred)
+{
+    uint8_t value = deferred ? 1 : 0;
+    if(mIsPendingChangeDeferred[index] == value)
+        return;
+
+    mIsPendingChangeDeferred[index] = value;
+    if(deferred)
+        ++mNbDeferredChanges;
+    else
+        --mNbDeferredChanges;
+}
+
+void EntitySnapshotEncoder::writeSnapshot(ODPacket& packet)
+{
+    packet.writeVarUInt(mNbPendingChanges - mNbDeferredChanges);
+    // The deferred changes are moved at the beginning of mPendingChanges, keeping their order
+    uint32_t nbKeptChanges = 0;
+    for(uint32_t i = 0; i < mNbPendingChanges; ++i)
+    {
+        uint32_t entityIndex = mPendingEntityIndexes[i];
+        if(mIsPendingChangeDeferred[i] != 0)
+        {
+            mIsPendingChangeDeferred[i] = 0;
+            if(i != nbKeptChanges)
+            {
+                std::swap(mPendingChanges[i], mPendingChanges[nbKeptChanges]);
+                std::swap(mPendingEntityIndexes[i], mPendingEntityIndexes[nbKeptChanges]);
+            }
+            mPendingChangeByEntity[entityIndex] = nbKeptChanges;
+            ++nbKeptChanges;
+            continue;
+        }
+
+        const EntitySnapshotChange& change = mPendingChanges[i];
+        mPendingChangeByEntity[entityIndex] = -1;
+        EntitySnapshotBaseline& baseline = mBaselines[entityIndex];
+
+        // The handle of new entities is sent once. Then, only their index is sent
+        if(mSentIndexes[entityIndex] < 0)
+        {
+            mSentIndexes[entityIndex] = mNbEntitiesSent;
+            packet.writeVarUInt(mNbEntitiesSent);
+            packet.writeVarUInt(change.mHandle);
+            ++mNbEntitiesSent;
+        }
+        else
+        {
+            packet.writeVarUInt(static_cast<uint32_t>(mSentIndexes[entityIndex]));
+        }
+
+        uint32_t mask = 0;
+        if(change.mClearDestinations)
+            mask |= clearDestinationsField;
+        if(!change.mDestinations.empty())
+            mask |= destinationsField;
+        if(change.mHasAnimation)
+        {
+            mask |= animationField;
+            if(change.mAnimationLoop)
+                mask |= animationLoopField;
+        }
+        if(change.mHasWalkDirection)
+        {
+            mask |= walkDirectionField;
+            if(change.mWalkDirection != baseline.mWalkDirection)
+                mask |= walkDirectionValueField;
+        }
+        if(change.mHasMoveSpeed)
+        {
+            mask |= moveSpeedField;
+            if(change.mMoveSpeed != baseline.mMoveSpeed)
+                mask |= moveSpeedValueField;
+        }
+        if(change.mHasLevel)
+        {
+            mask |= levelField;
+            if(change.mLevel != baseline.mLevel)
+                mask |= levelValueField;
+        }
+        packet.writeVarUInt(mask);
+
+        if((mask & destinationsField) != 0)
+        {
+            bool integral = areIntegral(change.mDestinations);
+            uint32_t nbDestinations = change.mDestinations.size();
+            // The lowest bit tells if the destinations are sent as integer deltas
+            packet.writeVarUInt((nbDestinations << 1) | (integral ? 1 : 0));
+            for(const Ogre::Vector3& destination : change.mDestinations)
+            {
+                if(integral && isIntegral(baseline.mLastDestination.x) &&
+                   isIntegral(baseline.mLastDestination.y) && isIntegral(baseline.mLastDestination.z))
+                {
+                    writeCoordinateDelta(packet, destination.x, baseline.mLastDestination.x);
+                    writeCoordinateDelta(packet, destination.y, baseline.mLastDestination.y);
+                    writeCoordinateDelta(packet, destination.z, baseline.mLastDestination.z);
+                }
+                else
+                {
+                    packet << destination;
+                }
+                baseline.mLastDestination = destination;
+            }
+        }
+
+        if((mask & animationField) != 0)
+        {
+            auto it = mAnimationIndexes.find(change.mAnimationState);
+            if(it != mAnimationIndexes.end())
+            {
+                packet.writeVarUInt(it->second);
+            }
+            else
+            {
+                packet.writeVarUInt(mNbAnimationsSent);
+                packet << change.mAnimationState;
+                mAnimationIndexes.emplace(change.mAnimationState, mNbAnimationsSent);
+                ++mNbAnimationsSent;
+            }
+        }
+
+        if((mask & walkDirectionValueField) != 0)
+        {
+            packet.writeQuantizedVector3(change.mWalkDirection, WALK_DIRECTION_STEP);
+            baseline.mWalkDirection = change.mWalkDirection;
+        }
+
+        if((mask & moveSpeedValueField) != 0)
+        {
+            packet << change.mMoveSpeed;
+            baseline.mMoveSpeed = change.mMoveSpeed;
+        }
+
+        if((mask & levelValueField) != 0)
+        {
+            packet.writeVarUInt(change.mLevel);
+            baseline.mLevel = change.mLevel;
+        }
+    }
+
+    mNbPendingChanges = nbKeptChanges;
+    mNbDeferredChanges = 0;
+}
+
+void EntitySnapshotDecoder::reset()
+{
+    mEntityHandles.clear();
+    mAnimationStates.clear();
+    mBaselines.clear();
+}
+
+bool EntitySnapshotDecoder::readSnapshot(ODPacket& packet, std::vector<EntitySnapshotChange>& changes)
+{
+    uint32_t nbChanges;
+    if(!packet.readVarUInt(nbChanges))
+        return false;
+
+    changes.resize(nbChanges);
+    for(EntitySnapshotChange& change : changes)
+    {
+        uint32_t entityIndex;
+        if(!packet.readVarUInt(entityIndex))
+            return false;
+
+        if(entityIndex == mEntityHandles.size())
+        {
+            uint32_t handle;
+            if(!packet.readVarUInt(handle))
+                return false;
+
+            mEntityHandles.push_back(handle);
+            mBaselines.emplace_back();
+        }
+        else if(entityIndex > mEntityHandles.size())
+        {
+            return false;
+        }
+
+        change.reset(mEntityHandles[entityIndex]);
+        EntitySnapshotBaseline& baseline = mBaselines[entityIndex];
+
+        uint32_t mask;
+        if(!packet.readVarUInt(mask))
+            return false;
+
+        change.mClearDestinations = (mask & clearDestinationsField) != 0;
+
+        if((mask & destinationsField) != 0)
+        {
+            uint32_t header;
+            if(!packet.readVarUInt(header))
+                return false;
+
+            bool integral = (header & 1) != 0;
+            uint32_t nbDestinations = header >> 1;
+            change.mDestinations.resize(nbDestinations);
+            for(Ogre::Vector3& destination : change.mDestinations)
+            {
+                if(integral && isIntegral(baseline.mLastDestination.x) &&
+                   isIntegral(baseline.mLastDestination.y) && isIntegral(baseline.mLastDestination.z))
+                {
+                    if(!readCoordinateDelta(packet, destination.x, baseline.mLastDestination.x) ||
+                       !readCoordinateDelta(packet, destination.y, baseline.mLastDestination.y) ||
+                       !readCoordinateDelta(packet, destination.z, baseline.mLastDestination.z))
+                    {
+                        return false;
+                    }
+                }
+                else if(!(packet >> destination))
+                {
+                    return false;
+                }
+                baseline.mLastDestination = destination;
+            }
+        }
+
+        if((mask & animationField) != 0)
+        {
+            uint32_t animationIndex;
+            if(!packet.readVarUInt(animationIndex))
+                return false;
+
+            if(animationIndex == mAnimationStates.size())
+            {
+                std::string state;
+                if(!(packet >> state))
+                    return false;
+
+                mAnimationStates.push_back(state);
+            }
+            else if(animationIndex > mAnimationStates.size())
+            {
+                return false;
+            }
+
+            change.mHasAnimation = true;
+            change.mAnimationState = mAnimationStates[animationIndex];
+            change.mAnimationLoop = (mask & animationLoopField) != 0;
+        }
+
+        if((mask & walkDirectionField) != 0)
+        {
+            if(((mask & walkDirectionValueField) != 0) &&
+               !packet.readQuantizedVector3(baseline.mWalkDirection, WALK_DIRECTION_STEP))
+                return false;
+
+            change.mHasWalkDirection = true;
+            change.mWalkDirection = baseline.mWalkDirection;
+        }
+
+        if((mask & moveSpeedField) != 0)
+        {
+            if(((mask & moveSpeedValueField) != 0) && !(packet >> baseline.mMoveSpeed))
+                return false;
+
+            change.mHasMoveSpeed = true;
+            change.mMoveSpeed = baseline.mMoveSpeed;
+        }
+
+        if((mask & levelField) != 0)
+        {
+            if(((mask & levelValueField) != 0) && !packet.readVarUInt(baseline.mLevel))
+                return false;
+
+            change.mHasLevel = true;
+            change.mLevel = baseline.mLevel;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYSNAPSHOT_H
+#define ENTITYSNAPSHOT_H
+
+#include <OgreVector3.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ODPacket;
+
+/*! \brief The changes of one moving entity merged from the movement and state events of a turn.
+ * When applied, the destinations are cleared first (if mClearDestinations), then the new
+ * destinations are added, then the move speed, walk direction, animation and level are set.
+ */
+class EntitySnapshotChange
+{
+public:
+    EntitySnapshotChange();
+
+    //! \brief Resets every field so that the change can be reused for another entity.
+    void reset(uint32_t handle);
+
+    uint32_t mHandle;
+    bool mClearDestinations;
+    std::vector<Ogre::Vector3> mDestinations;
+    bool mHasAnimation;
+    std::string mAnimationState;
+    bool mAnimationLoop;
+    bool mHasWalkDirection;
+    Ogre::Vector3 mWalkDirection;
+    bool mHasMoveSpeed;
+    double mMoveSpeed;
+    bool mHasLevel;
+    uint32_t mLevel;
+};
+
+/*! \brief Last values sent for an entity. The encoder and the decoder keep the same baselines
+ * so that a field equal to its baseline is not sent again.
+ */
+class EntitySnapshotBaseline
+{
+public:
+    EntitySnapshotBaseline();
+
+    Ogre::Vector3 mLastDestination;
+    Ogre::Vector3 mWalkDirection;
+    double mMoveSpeed;
+    uint32_t mLevel;
+};
+
+/*! \brief Merges the movement and state events sent to one client into a single snapshot packet.
+ * Entity handles and animation states are sent once and then referenced by index. For each
+ * entity, a mask tells which fields changed and fields equal to the last value sent are omitted.
+ * As the snapshots are sent through TCP, the client always receives them in order and the
+ * baseline is the last snapshot sent.
+ */
+class EntitySnapshotEncoder
+{
+public:
+    EntitySnapshotEncoder();
+
+    void clearDestinations(uint32_t handle);
+    void addDestination(uint32_t handle, const Ogre::Vector3& destination);
+    void setAnimationState(uint32_t handle, const std::string& state, bool loop,
+        bool hasWalkDirection, const Ogre::Vector3& walkDirection);
+    void setMoveSpeed(uint32_t handle, double moveSpeed);
+    void setLevel(uint32_t handle, uint32_t level);
+
+    inline bool hasPendingChanges() const
+    { return mNbPendingChanges > 0; }
+
+    //! \brief Returns true if writeSnapshot would write something, that is if some pending changes
+    //! are not deferred
+    inline bool hasChangesToWrite() const
+    { return mNbPendingChanges > mNbDeferredChanges; }
+
+    inline uint32_t getNbPendingChanges() const
+    { return mNbPendingChanges; }
+
+    //! \brief Returns the handle of the entity of the index-th pending change
+    inline uint32_t getPendingChangeHandle(uint32_t index) const
+    { return mPendingChanges[index].mHandle; }
+
+    /*! \brief A deferred change is not written by the next call to writeSnapshot. It stays pending
+     * and the next events of the entity are merged into it until it is written.
+     */
+    void setPendingChangeDeferred(uint32_t index, bool deferred);
+
+    //! \brief Writes the pending changes that are not deferred in the given packet and clears them.
+    //! The notification type should already have been written.
+    void writeSnapshot(ODPacket& packet);
+
+private:
+    //! \brief Index given to each entity handle. It is used to find the baseline and the pending change of the entity
+    std::unordered_map<uint32_t, uint32_t> mEntityIndexes;
+    //! \brief Index sent for each entity or -1 if it has never been sent. As changes can be deferred,
+    //! entities are not always sent in the order they are indexed.
+    std::vector<int32_t> mSentIndexes;
+    uint32_t mNbEntitiesSent;
+    std::unordered_map<std::string, uint32_t> mAnimationIndexes;
+    uint32_t mNbAnimationsSent;
+    std::vector<EntitySnapshotBaseline> mBaselines;
+
+    //! \brief The first mNbPendingChanges changes are the ones to send, in the order of their first event.
+    //! The others are kept to avoid allocating memory for the next snapshots
+    std::vector<EntitySnapshotChange> mPendingChanges;
+    std::vector<uint32_t> mPendingEntityIndexes;
+    uint32_t mNbPendingChanges;
+    //! \brief Index in mPendingChanges of the change of each entity or -1 if there is none
+    std::vector<int32_t> mPendingChangeByEntity;
+    //! \brief 1 if the pending change with the same index is deferred
+    std::vector<uint8_t> mIsPendingChangeDeferred;
+    uint32_t mNbDeferredChanges;
+
+    //! \brief Returns the pending change of the given entity, creating it if needed
+    EntitySnapshotChange& getPendingChange(uint32_t handle);
+};
+
+//! \brief Reads the snapshots written by EntitySnapshotEncoder. There should be one decoder per encoder.
+class EntitySnapshotDecoder
+{
+public:
+    //! \brief Forgets every entity, animation and baseline. Should be called when connecting to a new server.
+    void reset();
+
+    /*! \brief Reads a snapshot from the packet (after the notification type). Fills changes
+     * with the changes of the snapshot. Returns false if the packet is invalid.
+     */
+    bool readSnapshot(ODPacket& packet, std::vector<EntitySnapshotChange>& changes);
+
+private:
+    std::vector<uint32_t> mEntityHandles;
+    std::vector<std::string> mAnimationStates;
+    std::vector<EntitySnapshotBaseline> mBaselines;
+};
+
+#endif // ENTITYSNAPSHOT_H
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/InterestArea.h"
+
+#include "network/ODPacket.h"
+
+ODPacket& operator<<(ODPacket& os, const InterestArea& area)
+{
+    os << area.mIsSet << area.mMinX << area.mMinY << area.mMaxX << area.mMaxY;
+    return os;
+}
+
+ODPacket& operator>>(ODPacket& is, InterestArea& area)
+{
+    is >> area.mIsSet >> area.mMinX >> area.mMinY >> area.mMaxX >> area.mMaxY;
+    return is;
+}
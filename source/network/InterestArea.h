@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERESTAREA_H
+#define INTERESTAREA_H
+
+#include <cstdint>
+
+class ODPacket;
+
+/*! \brief Rectangle of tiles a client is looking at.
+ *
+ * Clients send the tiles covered by their camera when it moves. The server sends the movements
+ * of the entities in that area (plus a margin, so that entities coming in are already up to date)
+ * every turn and the ones of the rest of what the client sees only every few turns.
+ * An area that has not been set contains every tile.
+ */
+class InterestArea
+{
+public:
+    InterestArea() :
+        mIsSet(false),
+        mMinX(0),
+        mMinY(0),
+        mMaxX(0),
+        mMaxY(0)
+    {}
+
+    InterestArea(int32_t minX, int32_t minY, int32_t maxX, int32_t maxY) :
+        mIsSet(true),
+        mMinX(minX),
+        mMinY(minY),
+        mMaxX(maxX),
+        mMaxY(maxY)
+    {}
+
+    inline bool isSet() const
+    { return mIsSet; }
+
+    inline void clear()
+    { mIsSet = false; }
+
+    //! \brief Returns true if the tile (x, y) is in the area or at most margin tiles away from it
+    inline bool contains(int32_t x, int32_t y, int32_t margin) const
+    {
+        if(!mIsSet)
+            return true;
+
+        return (x >= mMinX - margin) && (x <= mMaxX + margin) &&
+            (y >= mMinY - margin) && (y <= mMaxY + margin);
+    }
+
+    inline bool operator==(const InterestArea& other) const
+    {
+        return (mIsSet == other.mIsSet) && (mMinX == other.mMinX) && (mMinY == other.mMinY) &&
+            (mMaxX == other.mMaxX) && (mMaxY == other.mMaxY);
+    }
+
+    inline bool operator!=(const InterestArea& other) const
+    { return !(*this == other); }
+
+    friend ODPacket& operator<<(ODPacket& os, const InterestArea& area);
+    friend ODPacket& operator>>(ODPacket& is, InterestArea& area);
+
+private:
+    bool mIsSet;
+    int32_t mMinX;
+    int32_t mMinY;
+    int32_t mMaxX;
+    int32_t mMaxY;
+};
+
+#endif // INTERESTAREA_H
@@ -33,17 +33,27 @@
 #include "entities/RenderedMovableEntity.h"
 #include "entities/Weapon.h"
 #include "utils/LogManager.h"
+#include "utils/StateHash.h"
 #include "modes/ModeManager.h"
 #include "modes/MenuModeConfigureSeats.h"
 #include "sound/MusicPlayer.h"
 #include "camera/CameraManager.h"
 
+#include <algorithm>
 #include <string>
 
 template<> ODClient* Ogre::Singleton<ODClient>::msSingleton = 0;
 
+//! \brief Interval between 2 logs of the received messages statistics
+static const float RECEIVE_STATS_INTERVAL_S = 30.0f;
+
 ODClient::ODClient() :
-    ODSocketClient()
+    ODSocketClient(),
+    mNbStatsFrames(0),
+    mNbStatsMessages(0),
+    mMaxMessagesPerFrame(0),
+    mTotalQueueLatencyUs(0),
+    mMaxQueueLatencyUs(0)
 {
 }
 
@@ -57,7 +67,46 @@ void ODClient::processClientSocketMessages(GameMap& gameMap)
     // If we receive message for a new turn, after processing every message,
     // we will refresh what is needed
     // We loop until no more data is available
+    uint32_t nbMessages = mNbStatsMessages;
     while(isConnected() && processOneClientSocketMessage());
+
+    if(getSource() != ODSource::network)
+        return;
+
+    nbMessages = mNbStatsMessages - nbMessages;
+    ++mNbStatsFrames;
+    mMaxMessagesPerFrame = std::max(mMaxMessagesPerFrame, nbMessages);
+    if(mReceiveStatsClock.getElapsedTime().asSeconds() >= RECEIVE_STATS_INTERVAL_S)
+        logReceiveStats();
+}
+
+void ODClient::resetReceiveStats()
+{
+    mReceiveStatsClock.restart();
+    mNbStatsFrames = 0;
+    mNbStatsMessages = 0;
+    mMaxMessagesPerFrame = 0;
+    mTotalQueueLatencyUs = 0;
+    mMaxQueueLatencyUs = 0;
+}
+
+void ODClient::logReceiveStats()
+{
+    if(mNbStatsMessages > 0)
+    {
+        double messagesPerFrame = static_cast<double>(mNbStatsMessages) / std::max(mNbStatsFrames, static_cast<uint32_t>(1));
+        double latencyMs = static_cast<double>(mTotalQueueLatencyUs) / (mNbStatsMessages * 1000.0);
+        double maxLatencyMs = static_cast<double>(mMaxQueueLatencyUs) / 1000.0;
+        LogManager::getSingleton().logMessage("Client received "
+            + Ogre::StringConverter::toString(mNbStatsMessages) + " messages in "
+            + Ogre::StringConverter::toString(mNbStatsFrames) + " frames: "
+            + Ogre::StringConverter::toString(messagesPerFrame) + " messages/frame (max "
+            + Ogre::StringConverter::toString(mMaxMessagesPerFrame) + "), queue latency "
+            + Ogre::StringConverter::toString(latencyMs) + "ms (max "
+            + Ogre::StringConverter::toString(maxLatencyMs) + "ms)");
+    }
+
+    resetReceiveStats();
 }
 
 bool ODClient::processOneClientSocketMessage()
@@ -78,6 +127,9 @@ bool ODClient::processOneClientSocketMessage()
 
     // Check if data available
     ODComStatus comStatus = recv(packetReceived);
+    if(comStatus == ODComStatus::NotReady)
+        return false;
+
     if(comStatus != ODComStatus::OK)
     {
         // Place a chat message in the queue to inform
@@ -88,6 +140,11 @@ bool ODClient::processOneClientSocketMessage()
         return false;
     }
 
+    ++mNbStatsMessages;
+    int64_t queueLatencyUs = getLastQueueLatencyUs();
+    mTotalQueueLatencyUs += queueLatencyUs;
+    mMaxQueueLatencyUs = std::max(mMaxQueueLatencyUs, queueLatencyUs);
+
     ServerNotification::ServerNotificationType serverCommand;
     OD_ASSERT_TRUE(packetReceived >> serverCommand);
 
@@ -424,10 +481,10 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::removeCreature:
         {
-            std::string creatureName;
-            OD_ASSERT_TRUE(packetReceived >> creatureName);
-            Creature* creature = gameMap->getCreature(creatureName);
-            OD_ASSERT_TRUE_MSG(creature != nullptr, "creatureName=" + creatureName);
+            uint32_t handle;
+            OD_ASSERT_TRUE(packetReceived >> handle);
+            Creature* creature = gameMap->getCreatureFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(creature != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(creature == nullptr)
                 break;
 
@@ -450,6 +507,9 @@ bool ODClient::processOneClientSocketMessage()
             packSend << ClientNotification::ackNewTurn << turnNum;
             send(packSend);
 
+            // Updates the minimap at least once per turn
+            frameListener->updateMinimap();
+
             // For the first turn, we stop processing events because we want the gamemap to
             // be initialized
             if(turnNum == 0)
@@ -460,11 +520,11 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::animatedObjectAddDestination:
         {
-            std::string objName;
+            uint32_t handle;
             Ogre::Vector3 vect;
-            OD_ASSERT_TRUE(packetReceived >> objName >> vect);
-            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObject(objName);
-            OD_ASSERT_TRUE_MSG(tempAnimatedObject != nullptr, "objName=" + objName);
+            OD_ASSERT_TRUE(packetReceived >> handle >> vect);
+            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(tempAnimatedObject != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if (tempAnimatedObject != nullptr)
                 tempAnimatedObject->addDestination(vect.x, vect.y, vect.z);
 
@@ -473,10 +533,10 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::animatedObjectClearDestinations:
         {
-            std::string objName;
-            OD_ASSERT_TRUE(packetReceived >> objName);
-            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObject(objName);
-            OD_ASSERT_TRUE_MSG(tempAnimatedObject != nullptr, "objName=" + objName);
+            uint32_t handle;
+            OD_ASSERT_TRUE(packetReceived >> handle);
+            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(tempAnimatedObject != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if (tempAnimatedObject != nullptr)
                 tempAnimatedObject->clearDestinations();
 
@@ -487,16 +547,15 @@ bool ODClient::processOneClientSocketMessage()
         {
             bool isEditorMode;
             int seatId;
-            GameEntity::ObjectType entityType;
-            std::string entityName;
-            OD_ASSERT_TRUE(packetReceived >> isEditorMode >> seatId >> entityType >> entityName);
+            uint32_t handle;
+            OD_ASSERT_TRUE(packetReceived >> isEditorMode >> seatId >> handle);
             Player *tempPlayer = gameMap->getPlayerBySeatId(seatId);
             OD_ASSERT_TRUE_MSG(tempPlayer != nullptr, "seatId=" + Ogre::StringConverter::toString(seatId));
             if(tempPlayer == nullptr)
                 break;
 
-            MovableGameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
-            OD_ASSERT_TRUE_MSG(entity != nullptr, "entityType=" + Ogre::StringConverter::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+            MovableGameEntity* entity = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(entity != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(entity == nullptr)
                 break;
 
@@ -529,14 +588,14 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::setObjectAnimationState:
         {
-            std::string objName;
+            uint32_t handle;
             std::string animState;
             bool loop;
             bool shouldSetWalkDirection;
-            OD_ASSERT_TRUE(packetReceived >> objName >> animState
+            OD_ASSERT_TRUE(packetReceived >> handle >> animState
                 >> loop >> shouldSetWalkDirection);
-            MovableGameEntity *obj = gameMap->getAnimatedObject(objName);
-            OD_ASSERT_TRUE_MSG(obj != nullptr, "objName=" + objName + ", state=" + animState);
+            MovableGameEntity *obj = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(obj != nullptr, "handle=" + Ogre::StringConverter::toString(handle) + ", state=" + animState);
             if (obj == nullptr)
                 break;
 
@@ -553,11 +612,11 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::setMoveSpeed:
         {
-            std::string objName;
+            uint32_t handle;
             double moveSpeed;
-            OD_ASSERT_TRUE(packetReceived >> objName >> moveSpeed);
-            MovableGameEntity *obj = gameMap->getAnimatedObject(objName);
-            OD_ASSERT_TRUE_MSG(obj != nullptr, "objName=" + objName + ", moveSpeed=" + Ogre::StringConverter::toString(moveSpeed));
+            OD_ASSERT_TRUE(packetReceived >> handle >> moveSpeed);
+            MovableGameEntity *obj = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(obj != nullptr, "handle=" + Ogre::StringConverter::toString(handle) + ", moveSpeed=" + Ogre::StringConverter::toString(moveSpeed));
             if (obj == nullptr)
                 break;
 
@@ -577,11 +636,11 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::creatureRefresh:
         {
-            std::string name;
+            uint32_t handle;
             unsigned int level;
-            OD_ASSERT_TRUE(packetReceived >> name >> level);
-            Creature* creature = gameMap->getCreature(name);
-            OD_ASSERT_TRUE_MSG(creature != nullptr, "name=" + name);
+            OD_ASSERT_TRUE(packetReceived >> handle >> level);
+            Creature* creature = gameMap->getCreatureFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(creature != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(creature == nullptr)
                 break;
 
@@ -589,6 +648,62 @@ bool ODClient::processOneClientSocketMessage()
             break;
         }
 
+        case ServerNotification::entitySnapshot:
+        {
+            bool isSnapshotValid = mSnapshotDecoder.readSnapshot(packetReceived, mSnapshotChanges);
+            OD_ASSERT_TRUE(isSnapshotValid);
+            if(!isSnapshotValid)
+                break;
+
+            for(const EntitySnapshotChange& change : mSnapshotChanges)
+            {
+                MovableGameEntity* obj = gameMap->getAnimatedObjectFromHandle(change.mHandle);
+                OD_ASSERT_TRUE_MSG(obj != nullptr, "handle=" + Ogre::StringConverter::toString(change.mHandle));
+                if(obj == nullptr)
+                    continue;
+
+                if(change.mClearDestinations)
+                    obj->clearDestinations();
+
+                for(const Ogre::Vector3& destination : change.mDestinations)
+                    obj->addDestination(destination.x, destination.y, destination.z);
+
+                if(change.mHasMoveSpeed)
+                    obj->setMoveSpeed(change.mMoveSpeed);
+
+                if(change.mHasWalkDirection)
+                    obj->setWalkDirection(change.mWalkDirection);
+
+                if(change.mHasAnimation)
+                    obj->setAnimationState(change.mAnimationState, change.mAnimationLoop);
+
+                if(change.mHasLevel)
+                {
+                    Creature* creature = gameMap->getCreatureFromHandle(change.mHandle);
+                    OD_ASSERT_TRUE_MSG(creature != nullptr, "handle=" + Ogre::StringConverter::toString(change.mHandle));
+                    if(creature != nullptr)
+                        creature->setLevel(change.mLevel);
+                }
+            }
+            break;
+        }
+
+        case ServerNotification::stateHash:
+        {
+            int64_t turn;
+            uint64_t serverHash;
+            OD_ASSERT_TRUE(packetReceived >> turn >> serverHash);
+            uint64_t clientHash = gameMap->computeVisibleTilesHash(getPlayer()->getSeat());
+            if(clientHash != serverHash)
+            {
+                LogManager::getSingleton().logMessage("ERROR: Desync detected at turn="
+                    + Ogre::StringConverter::toString(static_cast<int32_t>(turn))
+                    + ", server hash=" + StateHash::toString(serverHash)
+                    + ", client hash=" + StateHash::toString(clientHash));
+            }
+            break;
+        }
+
         case ServerNotification::playerFighting:
         {
             std::string fightMusic = gameMap->getLevelFightMusicFile();
@@ -616,10 +731,13 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::removeRenderedMovableEntity:
         {
-            std::string name;
-            OD_ASSERT_TRUE(packetReceived >> name);
-            RenderedMovableEntity* tempRenderedMovableEntity = gameMap->getRenderedMovableEntity(name);
-            OD_ASSERT_TRUE_MSG(tempRenderedMovableEntity != nullptr, "name=" + name);
+            uint32_t handle;
+            OD_ASSERT_TRUE(packetReceived >> handle);
+            RenderedMovableEntity* tempRenderedMovableEntity = gameMap->getRenderedMovableEntityFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(tempRenderedMovableEntity != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
+            if(tempRenderedMovableEntity == nullptr)
+                break;
+
             gameMap->removeRenderedMovableEntity(tempRenderedMovableEntity);
             tempRenderedMovableEntity->deleteYourself();
             break;
@@ -627,12 +745,12 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::setEntityOpacity:
         {
-            std::string entityName;
+            uint32_t handle;
             float opacity;
-            OD_ASSERT_TRUE(packetReceived >> entityName >> opacity);
+            OD_ASSERT_TRUE(packetReceived >> handle >> opacity);
 
-            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntity(entityName);
-            OD_ASSERT_TRUE_MSG(entity != nullptr, "entityName=" + entityName);
+            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntityFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(entity != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(entity == nullptr)
                 break;
 
@@ -653,11 +771,11 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::notifyCreatureInfo:
         {
-            std::string name;
+            uint32_t handle;
             std::string infos;
-            OD_ASSERT_TRUE(packetReceived >> name >> infos);
-            Creature* creature = gameMap->getCreature(name);
-            OD_ASSERT_TRUE_MSG(creature != nullptr, "name=" + name);
+            OD_ASSERT_TRUE(packetReceived >> handle >> infos);
+            Creature* creature = gameMap->getCreatureFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(creature != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(creature == nullptr)
                 break;
 
@@ -667,11 +785,11 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::refreshCreatureVisDebug:
         {
-            std::string name;
+            uint32_t handle;
             bool isDebugVisibleTilesActive;
-            OD_ASSERT_TRUE(packetReceived >> name >> isDebugVisibleTilesActive);
-            Creature* creature = gameMap->getCreature(name);
-            OD_ASSERT_TRUE_MSG(creature != nullptr, "name=" + name);
+            OD_ASSERT_TRUE(packetReceived >> handle >> isDebugVisibleTilesActive);
+            Creature* creature = gameMap->getCreatureFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(creature != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(creature == nullptr)
                 break;
 
@@ -800,17 +918,16 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::carryEntity:
         {
-            std::string carrierName;
-            GameEntity::ObjectType entityType;
-            std::string carriedName;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName);
-            Creature* carrier = gameMap->getCreature(carrierName);
-            OD_ASSERT_TRUE_MSG(carrier != nullptr, "carrierName=" + carrierName);
+            uint32_t carrierHandle;
+            uint32_t carriedHandle;
+            OD_ASSERT_TRUE(packetReceived >> carrierHandle >> carriedHandle);
+            Creature* carrier = gameMap->getCreatureFromHandle(carrierHandle);
+            OD_ASSERT_TRUE_MSG(carrier != nullptr, "carrierHandle=" + Ogre::StringConverter::toString(carrierHandle));
             if(carrier == nullptr)
                 break;
 
-            MovableGameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
-            OD_ASSERT_TRUE_MSG(carried != nullptr, "entityType=" + Ogre::StringConverter::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+            MovableGameEntity* carried = gameMap->getAnimatedObjectFromHandle(carriedHandle);
+            OD_ASSERT_TRUE_MSG(carried != nullptr, "carriedHandle=" + Ogre::StringConverter::toString(carriedHandle));
             if(carried == nullptr)
                 break;
 
@@ -820,18 +937,17 @@ bool ODClient::processOneClientSocketMessage()
 
         case ServerNotification::releaseCarriedEntity:
         {
-            std::string carrierName;
-            GameEntity::ObjectType entityType;
-            std::string carriedName;
+            uint32_t carrierHandle;
+            uint32_t carriedHandle;
             Ogre::Vector3 pos;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName >> pos);
-            Creature* carrier = gameMap->getCreature(carrierName);
-            OD_ASSERT_TRUE_MSG(carrier != nullptr, "carrierName=" + carrierName);
+            OD_ASSERT_TRUE(packetReceived >> carrierHandle >> carriedHandle >> pos);
+            Creature* carrier = gameMap->getCreatureFromHandle(carrierHandle);
+            OD_ASSERT_TRUE_MSG(carrier != nullptr, "carrierHandle=" + Ogre::StringConverter::toString(carrierHandle));
             if(carrier == nullptr)
                 break;
 
-            MovableGameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
-            OD_ASSERT_TRUE_MSG(carried != nullptr, "entityType=" + Ogre::StringConverter::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+            MovableGameEntity* carried = gameMap->getAnimatedObjectFromHandle(carriedHandle);
+            OD_ASSERT_TRUE_MSG(carried != nullptr, "carriedHandle=" + Ogre::StringConverter::toString(carriedHandle));
             if(carried == nullptr)
                 break;
 
@@ -893,13 +1009,18 @@ bool ODClient::connect(const std::string& host, const int port)
         return false;
     }
 
+    mSnapshotDecoder.reset();
+    mInterestArea.clear();
+    resetReceiveStats();
     if(!ODSocketClient::connect(host, port))
         return false;
 
     // Send a hello request to start the conversation with the server
     ODPacket packSend;
+    // We tell the server we can decompress the envelopes it sends
     packSend << ClientNotification::hello
-        << std::string("OpenDungeons V ") + ODApplication::VERSION;
+        << std::string("OpenDungeons V ") + ODApplication::VERSION
+        << true;
     sendToServer(packSend);
 
     return true;
@@ -915,6 +1036,7 @@ bool ODClient::replay(const std::string& filename)
         return false;
     }
 
+    mSnapshotDecoder.reset();
     if(!ODSocketClient::replay(filename))
         return false;
 
@@ -926,8 +1048,20 @@ void ODClient::queueClientNotification(ClientNotification* n)
     mClientNotificationQueue.push_back(n);
 }
 
+void ODClient::setInterestArea(const InterestArea& area)
+{
+    if((getSource() != ODSource::network) || (area == mInterestArea))
+        return;
+
+    mInterestArea = area;
+    queueClientNotification(ClientNotification::setInterestArea, area);
+}
+
 void ODClient::disconnect(bool keepReplay)
 {
+    if(getSource() == ODSource::network)
+        logReceiveStats();
+
     ODSocketClient::disconnect(keepReplay);
     while(!mClientNotificationQueue.empty())
     {
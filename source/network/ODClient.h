@@ -19,6 +19,7 @@
 #define ODCLIENT_H
 
 #include "ClientNotification.h"
+#include "EntitySnapshot.h"
 #include "ODSocketClient.h"
 
 #include <OgreSingleton.h>
@@ -85,7 +86,13 @@ class ODClient: public Ogre::Singleton<ODClient>,
 
     const std::string& getLevelFilename() {return mLevelFilename;}
 
+    //! \brief Tells the server which tiles the camera shows. Nothing is sent if they did not change
+    //! since the last call.
+    void setInterestArea(const InterestArea& area);
+
  private:
+    //! \brief Processes the next message received from the server. Returns false if there is
+    //! none or if the remaining ones should be processed next frame.
     bool processOneClientSocketMessage();
 
     void sendToServer(ODPacket& packetToSend);
@@ -95,6 +102,25 @@ class ODClient: public Ogre::Singleton<ODClient>,
 
     std::deque<ClientNotification*> mClientNotificationQueue;
 
+    //! \brief Last interest area sent to the server
+    InterestArea mInterestArea;
+
+    EntitySnapshotDecoder mSnapshotDecoder;
+    //! \brief Changes read from the last snapshot. Kept to avoid allocating memory for each snapshot
+    std::vector<EntitySnapshotChange> mSnapshotChanges;
+
+    //! \brief Statistics on the messages received from the server. They are logged and reset
+    //! regularly by logReceiveStats
+    sf::Clock mReceiveStatsClock;
+    uint32_t mNbStatsFrames;
+    uint32_t mNbStatsMessages;
+    uint32_t mMaxMessagesPerFrame;
+    int64_t mTotalQueueLatencyUs;
+    int64_t mMaxQueueLatencyUs;
+
+    void resetReceiveStats();
+    void logReceiveStats();
+
 };
 
 template<typename ...Args>
@@ -17,263 +17,594 @@
 
 #include "network/ODPacket.h"
 
-#define OD_INT64TOINT32H(valInt64)              (static_cast<int32_t>(valInt64 >> 32))
-#define OD_INT64TOINT32L(valInt64)              (static_cast<int32_t>(valInt64))
-#define OD_INT32TOINT64(valInt32h,valInt32l)    ((((static_cast<int64_t>(valInt32h)) << 32) & static_cast<int64_t>(0xFFFFFFFF00000000)) + ((static_cast<int64_t>(valInt32l)) & static_cast<int64_t>(0x00000000FFFFFFFF)))
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+//! \brief Maximum number of buffers kept by a pool
+const uint32_t MAX_POOLED_BUFFERS = 256;
+//! \brief Buffers bigger than that (like the ones used to send the whole map) are freed
+//! instead of being kept by the pool
+const uint32_t MAX_POOLED_BUFFER_CAPACITY = 64 * 1024;
+
+//! \brief Set when the pool of the current thread has been destroyed. The packets destroyed
+//! after that (when the thread exits) free their buffer
+static thread_local bool isBufferPoolDestroyed = false;
+
+//! \brief Buffers of the destroyed packets kept to be used by the next ones. There is one
+//! pool per thread so that no lock is needed.
+class ODPacketBufferPool
+{
+public:
+    ODPacketBufferPool()
+    {
+        mBuffers.reserve(MAX_POOLED_BUFFERS);
+    }
+
+    ~ODPacketBufferPool()
+    {
+        isBufferPoolDestroyed = true;
+    }
+
+    //! \brief Gives a pooled buffer to the given empty one if any
+    void take(std::vector<char>& buffer)
+    {
+        if(mBuffers.empty())
+            return;
+
+        buffer.swap(mBuffers.back());
+        mBuffers.pop_back();
+    }
+
+    //! \brief Keeps the given buffer if it is worth it. buffer is left empty
+    void giveBack(std::vector<char>& buffer)
+    {
+        if((buffer.capacity() == 0) ||
+           (buffer.capacity() > MAX_POOLED_BUFFER_CAPACITY) ||
+           (mBuffers.size() >= MAX_POOLED_BUFFERS))
+        {
+            return;
+        }
+
+        buffer.clear();
+        mBuffers.emplace_back();
+        mBuffers.back().swap(buffer);
+    }
+
+private:
+    std::vector<std::vector<char>> mBuffers;
+};
+
+static ODPacketBufferPool& getBufferPool()
+{
+    static thread_local ODPacketBufferPool pool;
+    return pool;
+}
+
+ODPacket::ODPacket() :
+    mReadPos(0),
+    mIsValid(true)
+{
+    if(!isBufferPoolDestroyed)
+        getBufferPool().take(mData);
+}
+
+ODPacket::ODPacket(const ODPacket& other) :
+    mReadPos(other.mReadPos),
+    mIsValid(other.mIsValid)
+{
+    if(!isBufferPoolDestroyed)
+        getBufferPool().take(mData);
+
+    mData.assign(other.mData.begin(), other.mData.end());
+}
+
+ODPacket::~ODPacket()
+{
+    if(!isBufferPoolDestroyed)
+        getBufferPool().giveBack(mData);
+}
+
+ODPacket& ODPacket::operator =(const ODPacket& other)
+{
+    if(this == &other)
+        return *this;
+
+    mData.assign(other.mData.begin(), other.mData.end());
+    mReadPos = other.mReadPos;
+    mIsValid = other.mIsValid;
+    return *this;
+}
+
+bool ODPacket::checkSize(uint32_t size)
+{
+    mIsValid = mIsValid && (size <= mData.size() - mReadPos);
+    return mIsValid;
+}
+
+void ODPacket::writeBytes(const void* data, uint32_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    mData.insert(mData.end(), bytes, bytes + size);
+}
+
+void ODPacket::writeUInt16(uint16_t data)
+{
+    char bytes[2] = {
+        static_cast<char>(data >> 8),
+        static_cast<char>(data)
+    };
+    writeBytes(bytes, sizeof(bytes));
+}
+
+void ODPacket::writeUInt32(uint32_t data)
+{
+    char bytes[4] = {
+        static_cast<char>(data >> 24),
+        static_cast<char>(data >> 16),
+        static_cast<char>(data >> 8),
+        static_cast<char>(data)
+    };
+    writeBytes(bytes, sizeof(bytes));
+}
+
+void ODPacket::writeUInt64(uint64_t data)
+{
+    writeUInt32(static_cast<uint32_t>(data >> 32));
+    writeUInt32(static_cast<uint32_t>(data));
+}
+
+bool ODPacket::readUInt16(uint16_t& data)
+{
+    if(!checkSize(2))
+        return false;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&mData[mReadPos]);
+    data = static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+    mReadPos += 2;
+    return true;
+}
+
+bool ODPacket::readUInt32(uint32_t& data)
+{
+    if(!checkSize(4))
+        return false;
 
-// The max buffer size when reading packets.
-const int32_t BUFFER_SIZE = 1024;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&mData[mReadPos]);
+    data = (static_cast<uint32_t>(bytes[0]) << 24) |
+        (static_cast<uint32_t>(bytes[1]) << 16) |
+        (static_cast<uint32_t>(bytes[2]) << 8) |
+        static_cast<uint32_t>(bytes[3]);
+    mReadPos += 4;
+    return true;
+}
+
+bool ODPacket::readUInt64(uint64_t& data)
+{
+    uint32_t dataH;
+    uint32_t dataL;
+    if(!readUInt32(dataH) || !readUInt32(dataL))
+        return false;
+
+    data = (static_cast<uint64_t>(dataH) << 32) | dataL;
+    return true;
+}
 
 ODPacket& ODPacket::operator >>(bool& data)
 {
-    mPacket>>data;
+    uint8_t value;
+    if(*this >> value)
+        data = (value != 0);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int8_t& data)
 {
-    mPacket>>data;
+    if(checkSize(1))
+    {
+        data = static_cast<int8_t>(mData[mReadPos]);
+        ++mReadPos;
+    }
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint8_t& data)
 {
-    mPacket>>data;
+    if(checkSize(1))
+    {
+        data = static_cast<uint8_t>(mData[mReadPos]);
+        ++mReadPos;
+    }
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int16_t& data)
 {
-    mPacket>>data;
+    uint16_t value;
+    if(readUInt16(value))
+        data = static_cast<int16_t>(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint16_t& data)
 {
-    mPacket>>data;
+    readUInt16(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int32_t& data)
 {
-    mPacket>>data;
+    uint32_t value;
+    if(readUInt32(value))
+        data = static_cast<int32_t>(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint32_t& data)
 {
-    mPacket>>data;
+    readUInt32(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int64_t& data)
 {
-    // TODO : currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH;
-    int32_t dataL;
-    mPacket>>dataH;
-    mPacket>>dataL;
-    data = OD_INT32TOINT64(dataH,dataL);
+    uint64_t value;
+    if(readUInt64(value))
+        data = static_cast<int64_t>(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint64_t& data)
 {
-    // TODO : currently, SFML 2.1 do not handle int64. We do it ourselves
-    uint32_t dataH;
-    uint32_t dataL;
-    mPacket>>dataH;
-    mPacket>>dataL;
-    data = OD_INT32TOINT64(dataH,dataL);
+    readUInt64(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(float& data)
 {
-    mPacket>>data;
+    uint32_t value;
+    if(readUInt32(value))
+        std::memcpy(&data, &value, sizeof(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(double& data)
 {
-    mPacket>>data;
+    uint64_t value;
+    if(readUInt64(value))
+        std::memcpy(&data, &value, sizeof(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(char* data)
 {
-    mPacket>>data;
+    const char* str;
+    uint32_t length;
+    if(readStringView(str, length))
+    {
+        std::memcpy(data, str, length);
+        data[length] = '\0';
+    }
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(std::string& data)
 {
-    mPacket>>data;
+    const char* str;
+    uint32_t length;
+    if(readStringView(str, length))
+        data.assign(str, length);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(wchar_t* data)
 {
-    mPacket>>data;
+    uint32_t length;
+    if(!readUInt32(length) || !checkSize(length) || !checkSize(length * 4))
+        return *this;
+
+    for(uint32_t i = 0; i < length; ++i)
+    {
+        uint32_t character = 0;
+        readUInt32(character);
+        data[i] = static_cast<wchar_t>(character);
+    }
+    data[length] = L'\0';
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(std::wstring& data)
 {
-    mPacket>>data;
+    uint32_t length;
+    if(!readUInt32(length) || !checkSize(length) || !checkSize(length * 4))
+        return *this;
+
+    data.clear();
+    data.reserve(length);
+    for(uint32_t i = 0; i < length; ++i)
+    {
+        uint32_t character = 0;
+        readUInt32(character);
+        data.push_back(static_cast<wchar_t>(character));
+    }
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(Ogre::Vector3& data)
 {
-    mPacket >> data.x >> data.y >> data.z;
+    *this >> data.x >> data.y >> data.z;
     return *this;
 }
+
 ODPacket& ODPacket::operator <<(bool data)
 {
-    mPacket<<data;
-    return *this;
+    uint8_t value = data ? 1 : 0;
+    return *this << value;
 }
 
 ODPacket& ODPacket::operator <<(int8_t data)
 {
-    mPacket<<data;
+    mData.push_back(static_cast<char>(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint8_t data)
 {
-    mPacket<<data;
+    mData.push_back(static_cast<char>(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int16_t data)
 {
-    mPacket<<data;
+    writeUInt16(static_cast<uint16_t>(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint16_t data)
 {
-    mPacket<<data;
+    writeUInt16(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int32_t data)
 {
-    mPacket<<data;
+    writeUInt32(static_cast<uint32_t>(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint32_t data)
 {
-    mPacket<<data;
+    writeUInt32(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int64_t data)
 {
-    // TODO : currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH = OD_INT64TOINT32H(data);
-    int32_t dataL = OD_INT64TOINT32L(data);
-    mPacket<<dataH;
-    mPacket<<dataL;
+    writeUInt64(static_cast<uint64_t>(data));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint64_t data)
 {
-    // TODO : currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH = OD_INT64TOINT32H(data);
-    int32_t dataL = OD_INT64TOINT32L(data);
-    mPacket<<dataH;
-    mPacket<<dataL;
+    writeUInt64(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(float data)
 {
-    mPacket<<data;
+    uint32_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    writeUInt32(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(double data)
 {
-    mPacket<<data;
+    uint64_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    writeUInt64(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const char* data)
 {
-    mPacket<<data;
+    uint32_t length = static_cast<uint32_t>(std::strlen(data));
+    writeUInt32(length);
+    writeBytes(data, length);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const std::string& data)
 {
-    mPacket<<data;
+    uint32_t length = static_cast<uint32_t>(data.size());
+    writeUInt32(length);
+    writeBytes(data.data(), length);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const wchar_t* data)
 {
-    mPacket<<data;
+    uint32_t length = static_cast<uint32_t>(std::wcslen(data));
+    writeUInt32(length);
+    for(uint32_t i = 0; i < length; ++i)
+        writeUInt32(static_cast<uint32_t>(data[i]));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const std::wstring& data)
 {
-    mPacket<<data;
+    uint32_t length = static_cast<uint32_t>(data.size());
+    writeUInt32(length);
+    for(wchar_t character : data)
+        writeUInt32(static_cast<uint32_t>(character));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const Ogre::Vector3&   data)
 {
-    mPacket << data.x << data.y << data.z;
+    *this << data.x << data.y << data.z;
     return *this;
 }
 
+void ODPacket::writeVarUInt(uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        mData.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    mData.push_back(static_cast<char>(value));
+}
+
+bool ODPacket::readVarUInt(uint32_t& value)
+{
+    uint32_t result = 0;
+    for(uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        if(!checkSize(1))
+            return false;
+
+        uint8_t byte = static_cast<uint8_t>(mData[mReadPos]);
+        ++mReadPos;
+        result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0)
+        {
+            value = result;
+            return true;
+        }
+    }
+
+    // A 32 bits value cannot take more than 5 bytes
+    mIsValid = false;
+    return false;
+}
+
+void ODPacket::writeVarInt(int32_t value)
+{
+    writeVarUInt((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+bool ODPacket::readVarInt(int32_t& value)
+{
+    uint32_t encoded;
+    if(!readVarUInt(encoded))
+        return false;
+
+    value = static_cast<int32_t>(encoded >> 1) ^ -static_cast<int32_t>(encoded & 1);
+    return true;
+}
+
+void ODPacket::writeQuantizedVector3(const Ogre::Vector3& data, Ogre::Real step)
+{
+    writeVarInt(static_cast<int32_t>(std::floor(data.x / step + 0.5f)));
+    writeVarInt(static_cast<int32_t>(std::floor(data.y / step + 0.5f)));
+    writeVarInt(static_cast<int32_t>(std::floor(data.z / step + 0.5f)));
+}
+
+bool ODPacket::readQuantizedVector3(Ogre::Vector3& data, Ogre::Real step)
+{
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    if(!readVarInt(x) || !readVarInt(y) || !readVarInt(z))
+        return false;
+
+    data.x = static_cast<Ogre::Real>(x) * step;
+    data.y = static_cast<Ogre::Real>(y) * step;
+    data.z = static_cast<Ogre::Real>(z) * step;
+    return true;
+}
+
+bool ODPacket::readStringView(const char*& data, uint32_t& size)
+{
+    uint32_t length;
+    if(!readUInt32(length) || !checkSize(length))
+        return false;
+
+    data = mData.data() + mReadPos;
+    size = length;
+    mReadPos += length;
+    return true;
+}
+
 ODPacket::operator bool() const
 {
-    return mPacket;
+    return mIsValid;
 }
 
 void ODPacket::clear()
 {
-    mPacket.clear();
+    mData.clear();
+    mReadPos = 0;
+    mIsValid = true;
+}
+
+void ODPacket::reserve(uint32_t size)
+{
+    mData.reserve(size);
 }
 
-void ODPacket::writePacket(int32_t timestamp, std::ofstream& os)
+void ODPacket::swap(ODPacket& other)
 {
-    int32_t bufferSize = mPacket.getDataSize();
-    const char* buffer = static_cast<const char*>(mPacket.getData());
-    os.write(reinterpret_cast<const char*>(&timestamp), sizeof(int32_t));
-    os.write(reinterpret_cast<const char*>(&bufferSize), sizeof(int32_t));
-    os.write(buffer, bufferSize);
+    mData.swap(other.mData);
+    std::swap(mReadPos, other.mReadPos);
+    std::swap(mIsValid, other.mIsValid);
 }
 
-int32_t ODPacket::readPacket(std::ifstream& is)
+void ODPacket::append(const char* data, uint32_t size)
 {
-    int32_t timestamp;
-    int32_t packetSize;
+    writeBytes(data, size);
+}
 
-    is.read(reinterpret_cast<char*>(&timestamp), sizeof(int32_t));
-    if(is.eof())
-        return -1;
+void ODPacket::writeToStream(std::ostream& os) const
+{
+    os.write(mData.data(), mData.size());
+}
 
-    is.read(reinterpret_cast<char*>(&packetSize), sizeof(int32_t));
-    if(is.eof())
-        return -1;
+bool ODPacket::readFromStream(std::istream& is, uint32_t size)
+{
+    clear();
+    if(size == 0)
+        return true;
 
-    mPacket.clear();
-    char buffer[BUFFER_SIZE];
-    while(packetSize > 0)
+    mData.resize(size);
+    is.read(mData.data(), size);
+    if(static_cast<uint32_t>(is.gcount()) != size)
     {
-        int32_t sizeToRead = std::min(packetSize, BUFFER_SIZE);
-        is.read(buffer, sizeToRead);
-        mPacket.append(buffer, sizeToRead);
-        packetSize -= sizeToRead;
+        clear();
+        return false;
     }
 
-    return timestamp;
+    return true;
+}
+
+void ODPacket::appendToEnvelope(std::vector<char>& buffer) const
+{
+    // The size is written in network byte order like SFML does for the packets
+    uint32_t size = static_cast<uint32_t>(mData.size());
+    buffer.push_back(static_cast<char>((size >> 24) & 0xFF));
+    buffer.push_back(static_cast<char>((size >> 16) & 0xFF));
+    buffer.push_back(static_cast<char>((size >> 8) & 0xFF));
+    buffer.push_back(static_cast<char>(size & 0xFF));
+    buffer.insert(buffer.end(), mData.begin(), mData.end());
+}
+
+bool ODPacket::readFromEnvelope(const char* envelope, uint32_t envelopeSize, uint32_t& offset)
+{
+    clear();
+    if((offset > envelopeSize) || (envelopeSize - offset < 4))
+        return false;
+
+    uint32_t size = 0;
+    for(uint32_t i = 0; i < 4; ++i)
+        size = (size << 8) | static_cast<uint8_t>(envelope[offset + i]);
+
+    offset += 4;
+    if(size > envelopeSize - offset)
+        return false;
+
+    mData.assign(envelope + offset, envelope + offset + size);
+    offset += size;
+    return true;
 }
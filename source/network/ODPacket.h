@@ -19,10 +19,11 @@
 #define ODPACKET_H
 
 #include <OgreVector3.h>
-#include <SFML/Network.hpp>
 
-#include <string>
 #include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
 
 /*! \brief This class is an utility class to transfer data through ODSocketClient.
  * It should also override operators << and >> for each standard types.
@@ -62,16 +63,19 @@
  * Emission : packet << creature->mHp;
  * Reception : packet >> creature->mHp;
  * This way, if mHp changes (from float to double for example), it will still work.
+ *
+ * The data is written in network byte order in a buffer taken from a per thread pool when the
+ * packet is created and given back when it is destroyed. Once the pool is warm, creating, filling
+ * and destroying packets does not allocate memory.
  */
 class ODPacket
 {
-    friend class ODSocketClient;
-
     public:
-        ODPacket()
-        {}
-        ~ODPacket()
-        {}
+        ODPacket();
+        ODPacket(const ODPacket& other);
+        ~ODPacket();
+
+        ODPacket& operator =(const ODPacket& other);
 
         /*! \brief Export data operators.
          * The behaviour is the same as standard C++ streams
@@ -113,6 +117,27 @@ class ODPacket
         ODPacket& operator <<(const std::wstring&   data);
         ODPacket& operator <<(const Ogre::Vector3&   data);
 
+        //! \brief Writes value with 7 bits per byte. Values lower than 128 take 1 byte.
+        void writeVarUInt(uint32_t value);
+        bool readVarUInt(uint32_t& value);
+
+        //! \brief Writes value as a varint after mapping it so that small negative values stay small.
+        void writeVarInt(int32_t value);
+        bool readVarInt(int32_t& value);
+
+        /*! \brief Writes each coordinate rounded to the closest multiple of step as a varint. Small vectors
+         * take a few bytes instead of 12 but the precision is lost. The same step should be given to
+         * readQuantizedVector3.
+         */
+        void writeQuantizedVector3(const Ogre::Vector3& data, Ogre::Real step);
+        bool readQuantizedVector3(Ogre::Vector3& data, Ogre::Real step);
+
+        /*! \brief Reads a string written with operator << without copying it. data points to the
+         * characters (not null terminated) inside the packet and is only valid until the packet is
+         * modified or destroyed. Useful to compare received strings with known values.
+         */
+        bool readStringView(const char*& data, uint32_t& size);
+
         /*! \brief Return true if there were no error exporting data (operator >>).
          * This behaviour is the same as standard C++ streams :
          * If we try to export data while the packet is empty or from incompatible types,
@@ -125,15 +150,40 @@ class ODPacket
          */
         void clear();
 
-        /*! \brief Writes the packet content to the given ofstream.
+        //! \brief Allocates enough memory for size bytes of data. Should be called before filling
+        //! big packets to avoid growing the buffer several times.
+        void reserve(uint32_t size);
+
+        //! \brief Exchanges the content of the 2 packets without copying.
+        void swap(ODPacket& other);
+
+        //! \brief Appends size raw bytes to the packet.
+        void append(const char* data, uint32_t size);
+
+        inline const char* getData() const
+        { return mData.data(); }
+
+        inline uint32_t getDataSize() const
+        { return static_cast<uint32_t>(mData.size()); }
+
+        //! \brief Writes the packet content to the given stream.
+        void writeToStream(std::ostream& os) const;
+
+        /*! \brief Replaces the packet content with size bytes read from the given stream.
+         * Returns false if the stream ends before. Used to read replays (see ODReplayReader).
+         */
+        bool readFromStream(std::istream& is, uint32_t size);
+
+        /*! \brief Appends the packet content to the given buffer, prefixed with its size.
+         * Several packets appended this way form an envelope that can be sent at once
+         * (see ODSendBuffer).
          */
-        void writePacket(int32_t timestamp, std::ofstream& os);
+        void appendToEnvelope(std::vector<char>& buffer) const;
 
-        /*! \brief Reads the packet content from the given ifstream.
-         *         Returns the timestamp at which the packet has been sent.
-         *         If EOF has been reached, returns -1
+        /*! \brief Reads the packet starting at offset in the given envelope of envelopeSize bytes and
+         * moves offset to the next packet. Returns false if the envelope is truncated.
          */
-        int32_t readPacket(std::ifstream& is);
+        bool readFromEnvelope(const char* envelope, uint32_t envelopeSize, uint32_t& offset);
 
         /*! \brief Template function to put arguments in a packet, used for in-place construction.
          */
@@ -151,7 +201,22 @@ class ODPacket
         }
 
     private:
-        sf::Packet mPacket;
+        //! \brief Returns true if size bytes can be read. If not, the packet becomes invalid.
+        bool checkSize(uint32_t size);
+
+        void writeBytes(const void* data, uint32_t size);
+        void writeUInt16(uint16_t data);
+        void writeUInt32(uint32_t data);
+        void writeUInt64(uint64_t data);
+        bool readUInt16(uint16_t& data);
+        bool readUInt32(uint32_t& data);
+        bool readUInt64(uint64_t& data);
+
+        std::vector<char> mData;
+        //! \brief Offset of the next byte to read
+        uint32_t mReadPos;
+        //! \brief false if a read failed since the last clear
+        bool mIsValid;
 
 };
 
@@ -0,0 +1,297 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/ODReplayFile.h"
+
+#include "network/ServerNotification.h"
+
+#include <chrono>
+
+//! \brief "ODRP"
+static const uint32_t REPLAY_MAGIC = 0x4F445250;
+static const uint32_t REPLAY_FORMAT_VERSION = 2;
+//! \brief Oldest version that can still be read. Version 1 files have no compressed envelope
+static const uint32_t REPLAY_MIN_FORMAT_VERSION = 1;
+//! \brief Magic number, format version and index offset
+static const uint32_t HEADER_SIZE = 16;
+//! \brief Offset of the index offset in the header
+static const uint32_t HEADER_INDEX_OFFSET = 8;
+//! \brief Timestamp and size written before each envelope
+static const uint32_t RECORD_HEADER_SIZE = 8;
+//! \brief Turn, timestamp and offset
+static const uint32_t INDEX_ENTRY_SIZE = 20;
+static const uint32_t STREAM_BUFFER_SIZE = 64 * 1024;
+//! \brief Set in the size of the compressed envelopes
+static const uint32_t COMPRESSED_ENVELOPE_FLAG = 0x80000000;
+//! \brief Smaller envelopes are not worth compressing
+static const uint32_t MIN_COMPRESSED_ENVELOPE_SIZE = 64;
+//! \brief The compressor cannot do better than this ratio. Used to refuse invalid sizes before allocating
+static const uint32_t MAX_COMPRESSION_RATIO = 255;
+
+//! \brief Looks for a turnStarted message in the given envelope. Returns true and sets turn
+//! if there is one. message is used to read the packets of the envelope.
+static bool findTurnStart(const ODPacket& envelope, ODPacket& message, int64_t& turn)
+{
+    uint32_t offset = 0;
+    while(offset < envelope.getDataSize())
+    {
+        if(!message.readFromEnvelope(envelope.getData(), envelope.getDataSize(), offset))
+            return false;
+
+        int32_t type;
+        if(!(message >> type) || (type != static_cast<int32_t>(ServerNotification::turnStarted)))
+            continue;
+
+        return static_cast<bool>(message >> turn);
+    }
+    return false;
+}
+
+ODReplayWriter::ODReplayWriter() :
+    mOffset(0)
+{
+}
+
+ODReplayWriter::~ODReplayWriter()
+{
+    close();
+}
+
+bool ODReplayWriter::open(const std::string& filename)
+{
+    close();
+    mStreamBuffer.resize(STREAM_BUFFER_SIZE);
+    // The buffer has to be set before opening the file
+    mStream.rdbuf()->pubsetbuf(mStreamBuffer.data(), mStreamBuffer.size());
+    mStream.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!mStream.is_open())
+        return false;
+
+    mIndex.clear();
+    mCompressionStats.reset();
+    mScratchPacket.clear();
+    mScratchPacket << REPLAY_MAGIC << REPLAY_FORMAT_VERSION << static_cast<uint64_t>(0);
+    mScratchPacket.writeToStream(mStream);
+    mOffset = HEADER_SIZE;
+    return true;
+}
+
+void ODReplayWriter::writeEnvelope(int32_t timestamp, const ODPacket& envelope)
+{
+    if(!isOpen())
+        return;
+
+    int64_t turn;
+    if(findTurnStart(envelope, mScratchPacket, turn))
+        mIndex.emplace_back(turn, timestamp, mOffset);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t rawSize = envelope.getDataSize();
+    bool isCompressed = false;
+    if(rawSize >= MIN_COMPRESSED_ENVELOPE_SIZE)
+    {
+        mCodec.compress(envelope.getData(), rawSize, mCompressedEnvelope);
+        // The uncompressed size is written before the compressed data
+        isCompressed = (mCompressedEnvelope.size() + 4 < rawSize);
+    }
+    int64_t timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    mScratchPacket.clear();
+    uint32_t size;
+    if(isCompressed)
+    {
+        size = mCompressedEnvelope.size() + 4;
+        mScratchPacket << timestamp << (size | COMPRESSED_ENVELOPE_FLAG) << rawSize;
+        mScratchPacket.writeToStream(mStream);
+        mStream.write(mCompressedEnvelope.data(), mCompressedEnvelope.size());
+    }
+    else
+    {
+        size = rawSize;
+        mScratchPacket << timestamp << size;
+        mScratchPacket.writeToStream(mStream);
+        envelope.writeToStream(mStream);
+    }
+    mCompressionStats.add(RECORD_HEADER_SIZE + rawSize, RECORD_HEADER_SIZE + size, timeUs);
+    mOffset += RECORD_HEADER_SIZE + size;
+}
+
+void ODReplayWriter::close()
+{
+    if(!isOpen())
+        return;
+
+    mScratchPacket.clear();
+    mScratchPacket.reserve(4 + INDEX_ENTRY_SIZE * mIndex.size());
+    mScratchPacket << static_cast<uint32_t>(mIndex.size());
+    for(const ODReplayIndexEntry& entry : mIndex)
+        mScratchPacket << entry.mTurn << entry.mTimestamp << entry.mOffset;
+    mScratchPacket.writeToStream(mStream);
+
+    // Now that the index is written, we can tell where it is
+    mScratchPacket.clear();
+    mScratchPacket << mOffset;
+    mStream.seekp(HEADER_INDEX_OFFSET);
+    mScratchPacket.writeToStream(mStream);
+    mStream.close();
+    mIndex.clear();
+}
+
+ODReplayReader::ODReplayReader() :
+    mEndOffset(0),
+    mOffset(0)
+{
+}
+
+bool ODReplayReader::open(const std::string& filename)
+{
+    close();
+    mStreamBuffer.resize(STREAM_BUFFER_SIZE);
+    mStream.rdbuf()->pubsetbuf(mStreamBuffer.data(), mStreamBuffer.size());
+    mStream.open(filename, std::ios::in | std::ios::binary);
+    if(!mStream.is_open())
+        return false;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t indexOffset;
+    if(!mScratchPacket.readFromStream(mStream, HEADER_SIZE) ||
+       !(mScratchPacket >> magic >> version >> indexOffset) ||
+       (magic != REPLAY_MAGIC) ||
+       (version < REPLAY_MIN_FORMAT_VERSION) ||
+       (version > REPLAY_FORMAT_VERSION))
+    {
+        close();
+        return false;
+    }
+
+    mStream.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(mStream.tellg());
+    mStream.seekg(HEADER_SIZE);
+    mOffset = HEADER_SIZE;
+    if((indexOffset < HEADER_SIZE) || (indexOffset > fileSize))
+    {
+        // The file was not closed properly. We read every envelope until the first truncated one
+        mEndOffset = fileSize;
+        rebuildIndex();
+        mStream.clear();
+        mStream.seekg(HEADER_SIZE);
+        mOffset = HEADER_SIZE;
+        return true;
+    }
+
+    mEndOffset = indexOffset;
+    mStream.seekg(indexOffset);
+    uint32_t nbEntries;
+    if(!mScratchPacket.readFromStream(mStream, 4) ||
+       !(mScratchPacket >> nbEntries) ||
+       (nbEntries > (fileSize - indexOffset) / INDEX_ENTRY_SIZE) ||
+       !mScratchPacket.readFromStream(mStream, nbEntries * INDEX_ENTRY_SIZE))
+    {
+        close();
+        return false;
+    }
+
+    mIndex.reserve(nbEntries);
+    for(uint32_t i = 0; i < nbEntries; ++i)
+    {
+        int64_t turn;
+        int32_t timestamp;
+        uint64_t offset;
+        mScratchPacket >> turn >> timestamp >> offset;
+        mIndex.emplace_back(turn, timestamp, offset);
+    }
+
+    mStream.seekg(HEADER_SIZE);
+    return true;
+}
+
+void ODReplayReader::close()
+{
+    if(mStream.is_open())
+        mStream.close();
+
+    mStream.clear();
+    mIndex.clear();
+    mEndOffset = 0;
+    mOffset = 0;
+}
+
+int32_t ODReplayReader::readEnvelope(ODPacket& envelope)
+{
+    if(!isOpen() || (mOffset > mEndOffset) || (mEndOffset - mOffset < RECORD_HEADER_SIZE))
+        return -1;
+
+    int32_t timestamp;
+    uint32_t size;
+    if(!mScratchPacket.readFromStream(mStream, RECORD_HEADER_SIZE) ||
+       !(mScratchPacket >> timestamp >> size) ||
+       ((size & ~COMPRESSED_ENVELOPE_FLAG) > mEndOffset - mOffset - RECORD_HEADER_SIZE) ||
+       !readEnvelopeData(size, envelope))
+    {
+        // We do not read further
+        mOffset = mEndOffset;
+        return -1;
+    }
+
+    size &= ~COMPRESSED_ENVELOPE_FLAG;
+
+    mOffset += RECORD_HEADER_SIZE + size;
+    return timestamp;
+}
+
+bool ODReplayReader::readEnvelopeData(uint32_t size, ODPacket& envelope)
+{
+    if((size & COMPRESSED_ENVELOPE_FLAG) == 0)
+        return envelope.readFromStream(mStream, size);
+
+    size &= ~COMPRESSED_ENVELOPE_FLAG;
+    uint32_t rawSize;
+    if((size < 4) ||
+       !mCompressedEnvelope.readFromStream(mStream, size) ||
+       !(mCompressedEnvelope >> rawSize) ||
+       (rawSize / MAX_COMPRESSION_RATIO > size - 4) ||
+       !LZCodec::decompress(mCompressedEnvelope.getData() + 4, size - 4, rawSize, mDecompressedEnvelope))
+    {
+        return false;
+    }
+
+    envelope.clear();
+    envelope.append(mDecompressedEnvelope.data(), rawSize);
+    return true;
+}
+
+void ODReplayReader::rebuildIndex()
+{
+    mIndex.clear();
+    ODPacket envelope;
+    ODPacket message;
+    uint64_t offset = mOffset;
+    int32_t timestamp;
+    while((timestamp = readEnvelope(envelope)) >= 0)
+    {
+        int64_t turn;
+        if(findTurnStart(envelope, message, turn))
+            mIndex.emplace_back(turn, timestamp, offset);
+
+        offset = mOffset;
+    }
+
+    // The truncated envelope, if any, is not read
+    mEndOffset = offset;
+}
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ODREPLAYFILE_H
+#define ODREPLAYFILE_H
+
+#include "network/ODPacket.h"
+
+#include "utils/LZCodec.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*! \brief Replay file format.
+ *
+ * A replay file starts with a header: the magic number, the format version and the offset
+ * of the index (0 if the file was not closed properly). Then come the envelopes received from
+ * the server, each one prefixed with the time at which it was received (in ms from the connection)
+ * and its size. Since version 2, envelopes are compressed with LZCodec when it makes them
+ * smaller: the highest bit of the size is set and the data starts with the uncompressed size. The index is written at the end when the file is closed. It gives the offset and
+ * time of the envelope starting each turn so that a replay can be reviewed from a given turn
+ * without scanning the file.
+ * Every number is written in network byte order.
+ */
+
+//! \brief Locates the envelope that contains the start of a turn in a replay file
+class ODReplayIndexEntry
+{
+public:
+    ODReplayIndexEntry(int64_t turn, int32_t timestamp, uint64_t offset) :
+        mTurn(turn),
+        mTimestamp(timestamp),
+        mOffset(offset)
+    {}
+
+    int64_t mTurn;
+    int32_t mTimestamp;
+    uint64_t mOffset;
+};
+
+//! \brief Writes the envelopes received by a client in a replay file
+class ODReplayWriter
+{
+public:
+    ODReplayWriter();
+    ~ODReplayWriter();
+
+    //! \brief Creates the file and writes the header. Returns false if the file cannot be created.
+    bool open(const std::string& filename);
+
+    inline bool isOpen() const
+    { return mStream.is_open(); }
+
+    //! \brief Writes the given envelope. If it contains the start of a turn, it is added to the index.
+    void writeEnvelope(int32_t timestamp, const ODPacket& envelope);
+
+    //! \brief Writes the index and closes the file. Does nothing if it is not opened.
+    void close();
+
+    //! \brief Start of the turns written since the file was opened
+    inline const std::vector<ODReplayIndexEntry>& getIndex() const
+    { return mIndex; }
+
+    //! \brief Sizes of the envelopes written since the file was opened and time spent compressing them
+    inline const LZCodecStats& getCompressionStats() const
+    { return mCompressionStats; }
+
+private:
+    std::ofstream mStream;
+    //! \brief Buffer used by mStream so that envelopes are written by big blocks
+    std::vector<char> mStreamBuffer;
+    //! \brief Offset in the file of the next envelope
+    uint64_t mOffset;
+    std::vector<ODReplayIndexEntry> mIndex;
+    //! \brief Used to write the headers and to look for the start of turns in the envelopes
+    ODPacket mScratchPacket;
+    LZCodec mCodec;
+    std::vector<char> mCompressedEnvelope;
+    LZCodecStats mCompressionStats;
+};
+
+//! \brief Reads the envelopes of a replay file
+class ODReplayReader
+{
+public:
+    ODReplayReader();
+
+    /*! \brief Opens the given file and reads its index. If the file was not closed properly,
+     * the index is rebuilt by reading the whole file. Returns false if the file cannot be opened
+     * or is not a replay file.
+     */
+    bool open(const std::string& filename);
+
+    inline bool isOpen() const
+    { return mStream.is_open(); }
+
+    void close();
+
+    /*! \brief Reads the next envelope. Returns the time at which it was received or -1 if the
+     * end of the replay has been reached.
+     */
+    int32_t readEnvelope(ODPacket& envelope);
+
+    //! \brief Returns the start of the turns, sorted by turn
+    inline const std::vector<ODReplayIndexEntry>& getIndex() const
+    { return mIndex; }
+
+private:
+    //! \brief Reads the data of an envelope, size being the size written in the file before it.
+    bool readEnvelopeData(uint32_t size, ODPacket& envelope);
+
+    //! \brief Reads the envelopes from the current position up to mEndOffset to build the index
+    void rebuildIndex();
+
+    std::ifstream mStream;
+    std::vector<char> mStreamBuffer;
+    //! \brief Offset of the end of the envelopes (where the index starts)
+    uint64_t mEndOffset;
+    uint64_t mOffset;
+    std::vector<ODReplayIndexEntry> mIndex;
+    ODPacket mScratchPacket;
+    //! \brief Used to read and decompress the compressed envelopes
+    ODPacket mCompressedEnvelope;
+    std::vector<char> mDecompressedEnvelope;
+};
+
+#endif // ODREPLAYFILE_H
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/ODSendBuffer.h"
+
+#include "network/ODPacket.h"
+
+#include <chrono>
+
+const uint32_t ODSendBuffer::COMPRESSED_ENVELOPE_MARKER = 0xFFFFFFFF;
+const uint32_t ODSendBuffer::MAX_PENDING_BYTES = 16 * 1024 * 1024;
+
+//! \brief When more than this number of bytes have been sent, they are removed from the buffer
+static const uint32_t COMPACT_THRESHOLD = 64 * 1024;
+//! \brief Smaller envelopes (like a single acknowledgement) are not worth compressing
+static const uint32_t MIN_COMPRESSED_ENVELOPE_SIZE = 64;
+//! \brief Marker and uncompressed size written before the compressed data
+static const uint32_t COMPRESSED_HEADER_SIZE = 8;
+//! \brief The compressor cannot do better than this ratio. Used to refuse invalid sizes before allocating
+static const uint32_t MAX_COMPRESSION_RATIO = 255;
+
+static inline void writeUInt32(char* data, uint32_t value)
+{
+    data[0] = static_cast<char>((value >> 24) & 0xFF);
+    data[1] = static_cast<char>((value >> 16) & 0xFF);
+    data[2] = static_cast<char>((value >> 8) & 0xFF);
+    data[3] = static_cast<char>(value & 0xFF);
+}
+
+static inline uint32_t readUInt32(const char* data)
+{
+    return (static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24) |
+        (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16) |
+        (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8) |
+        static_cast<uint32_t>(static_cast<uint8_t>(data[3]));
+}
+
+ODSendBuffer::ODSendBuffer() :
+    mNbBytesSent(0),
+    mNbBytesReady(0),
+    mIsEnvelopeOpen(false),
+    mIsCompressionEnabled(false)
+{
+}
+
+bool ODSendBuffer::addPacket(const ODPacket& packet)
+{
+    // The packet is prefixed with its size and a new envelope with its own
+    uint64_t nbBytesAdded = static_cast<uint64_t>(packet.getDataSize()) + (mIsEnvelopeOpen ? 4 : 8);
+    if(getNbPendingBytes() + nbBytesAdded > MAX_PENDING_BYTES)
+        return false;
+
+    if(!mIsEnvelopeOpen)
+    {
+        // The size of the envelope is written when it is closed
+        mData.insert(mData.end(), 4, 0);
+        mIsEnvelopeOpen = true;
+    }
+
+    packet.appendToEnvelope(mData);
+    return true;
+}
+
+void ODSendBuffer::closeEnvelope()
+{
+    if(!mIsEnvelopeOpen)
+        return;
+
+    uint32_t size = mData.size() - mNbBytesReady - 4;
+    if(mIsCompressionEnabled)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint32_t rawSize = size;
+        if(rawSize >= MIN_COMPRESSED_ENVELOPE_SIZE)
+        {
+            mCodec.compress(mData.data() + mNbBytesReady + 4, rawSize, mCompressedEnvelope);
+            // If the envelope cannot be compressed, it is sent as is
+            if(mCompressedEnvelope.size() + COMPRESSED_HEADER_SIZE < rawSize)
+            {
+                mData.resize(mNbBytesReady + 4 + COMPRESSED_HEADER_SIZE);
+                writeUInt32(mData.data() + mNbBytesReady + 4, COMPRESSED_ENVELOPE_MARKER);
+                writeUInt32(mData.data() + mNbBytesReady + 8, rawSize);
+                mData.insert(mData.end(), mCompressedEnvelope.begin(), mCompressedEnvelope.end());
+                size = mData.size() - mNbBytesReady - 4;
+            }
+        }
+        int64_t timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        mCompressionStats.add(rawSize + 4, size + 4, timeUs);
+    }
+
+    writeUInt32(mData.data() + mNbBytesReady, size);
+    mNbBytesReady = mData.size();
+    mIsEnvelopeOpen = false;
+}
+
+void ODSendBuffer::consume(uint32_t nbBytes)
+{
+    mNbBytesSent += nbBytes;
+    if(mNbBytesSent > mNbBytesReady)
+        mNbBytesSent = mNbBytesReady;
+
+    if(mNbBytesSent == mData.size())
+    {
+        // Everything has been sent. We keep the memory for the next envelopes
+        clear();
+        return;
+    }
+
+    if(mNbBytesSent < COMPACT_THRESHOLD)
+        return;
+
+    mData.erase(mData.begin(), mData.begin() + mNbBytesSent);
+    mNbBytesReady -= mNbBytesSent;
+    mNbBytesSent = 0;
+}
+
+void ODSendBuffer::clear()
+{
+    mData.clear();
+    mNbBytesSent = 0;
+    mNbBytesReady = 0;
+    mIsEnvelopeOpen = false;
+}
+
+bool ODSendBuffer::readFrame(const char* frame, uint32_t frameSize, std::vector<char>& buffer, ODPacket& envelope)
+{
+    envelope.clear();
+    if((frameSize < COMPRESSED_HEADER_SIZE) || (readUInt32(frame) != COMPRESSED_ENVELOPE_MARKER))
+    {
+        envelope.append(frame, frameSize);
+        return true;
+    }
+
+    uint32_t rawSize = readUInt32(frame + 4);
+    uint32_t compressedSize = frameSize - COMPRESSED_HEADER_SIZE;
+    if(rawSize / MAX_COMPRESSION_RATIO > compressedSize)
+        return false;
+
+    if(!LZCodec::decompress(frame + COMPRESSED_HEADER_SIZE, compressedSize, rawSize, buffer))
+        return false;
+
+    envelope.append(buffer.data(), rawSize);
+    return true;
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ODSENDBUFFER_H
+#define ODSENDBUFFER_H
+
+#include "utils/LZCodec.h"
+
+#include <cstdint>
+#include <vector>
+
+class ODPacket;
+
+/*! \brief Outgoing bytes waiting to be sent to one client.
+ *
+ * The packets added between 2 calls to closeEnvelope are grouped in one envelope: a block
+ * framed like a SFML packet (size in network byte order followed by the data) containing each
+ * packet prefixed with its own size. That way, all the messages of a turn are sent with one
+ * write and the receiver gets them with one sf::TcpSocket::receive. Only closed envelopes are
+ * sent. As the socket is not blocking, the bytes are sent when the client can receive them and
+ * the unsent ones stay in the buffer.
+ * If compression is enabled, closed envelopes are compressed when it makes them smaller. A compressed
+ * envelope starts with COMPRESSED_ENVELOPE_MARKER (that cannot be the size of a packet) followed by its
+ * uncompressed size and the compressed data. readFrame handles both kinds.
+ */
+class ODSendBuffer
+{
+public:
+    ODSendBuffer();
+
+    //! \brief Adds the packet to the current envelope, opening a new one if needed. Returns false
+    //! without adding it if the pending bytes would go over MAX_PENDING_BYTES.
+    bool addPacket(const ODPacket& packet);
+
+    //! \brief Closes the current envelope so that it can be sent. Does nothing if there is none.
+    void closeEnvelope();
+
+    //! \brief Returns the bytes of the closed envelopes not sent yet
+    inline const char* getDataToSend() const
+    { return mData.data() + mNbBytesSent; }
+
+    inline uint32_t getSizeToSend() const
+    { return mNbBytesReady - mNbBytesSent; }
+
+    //! \brief Tells the given number of bytes from getDataToSend have been sent.
+    void consume(uint32_t nbBytes);
+
+    //! \brief Returns the number of bytes in the buffer, including the envelope being built
+    inline uint32_t getNbPendingBytes() const
+    { return mData.size() - mNbBytesSent; }
+
+    void clear();
+
+    //! \brief Enables the compression of the envelopes closed from now on. It should only be enabled
+    //! if the receiver can decompress them.
+    inline void setCompression(bool compression)
+    { mIsCompressionEnabled = compression; }
+
+    inline bool isCompressionEnabled() const
+    { return mIsCompressionEnabled; }
+
+    //! \brief Sizes of the envelopes closed since the last call to resetCompressionStats
+    inline const LZCodecStats& getCompressionStats() const
+    { return mCompressionStats; }
+
+    inline void resetCompressionStats()
+    { mCompressionStats.reset(); }
+
+    /*! \brief Fills envelope with the envelope sent in the given frame (without the frame size),
+     * decompressing it if needed. buffer is used for the decompression and can be reused from one call
+     * to another to avoid allocating memory. Returns false if the frame is invalid.
+     */
+    static bool readFrame(const char* frame, uint32_t frameSize, std::vector<char>& buffer, ODPacket& envelope);
+
+    static const uint32_t COMPRESSED_ENVELOPE_MARKER;
+
+    //! \brief Maximum number of bytes waiting to be sent. A client that stops reading should be
+    //! disconnected when it is reached instead of letting the buffer grow
+    static const uint32_t MAX_PENDING_BYTES;
+
+private:
+    std::vector<char> mData;
+    //! \brief Bytes at the beginning of mData that have already been sent
+    uint32_t mNbBytesSent;
+    //! \brief Bytes at the beginning of mData that belong to closed envelopes
+    uint32_t mNbBytesReady;
+    //! \brief True if an envelope is open. It starts at mNbBytesReady
+    bool mIsEnvelopeOpen;
+
+    bool mIsCompressionEnabled;
+    LZCodec mCodec;
+    std::vector<char> mCompressedEnvelope;
+    LZCodecStats mCompressionStats;
+};
+
+#endif // ODSENDBUFFER_H
@@ -42,21 +42,60 @@
 #include "rooms/RoomTrainingHall.h"
 #include "rooms/RoomTreasury.h"
 #include "utils/ConfigManager.h"
+#include "utils/Helper.h"
+#include "utils/Random.h"
 
 #include <SFML/Network.hpp>
 #include <SFML/System.hpp>
 
+#include <algorithm>
+
 #include "boost/filesystem.hpp"
 
 const std::string ODServer::SERVER_INFORMATION = "SERVER_INFORMATION";
 
+//! \brief The movements of the entities outside of the interest area of a client are sent every
+//! INTEREST_SUMMARY_TURNS turns. Those inside or at most INTEREST_AREA_MARGIN tiles away are sent every turn
+static const int64_t INTEREST_SUMMARY_TURNS = 5;
+static const int32_t INTEREST_AREA_MARGIN = 4;
+
+//! \brief Returns true if the given notification moves an entity or removes it from the client. The
+//! movements kept for a later snapshot have to be sent before such notifications as they would
+//! be applied on a wrong position or an entity the client does not know anymore.
+static bool isDeferredSnapshotSentBefore(ServerNotification::ServerNotificationType type)
+{
+    switch(type)
+    {
+        case ServerNotification::entityPickedUp:
+        case ServerNotification::entityDropped:
+        case ServerNotification::carryEntity:
+        case ServerNotification::releaseCarriedEntity:
+        case ServerNotification::removeCreature:
+        case ServerNotification::removeRenderedMovableEntity:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+//! \brief When the stream compression is enabled, the bytes sent are logged every time this number of turns is computed
+static const int64_t STREAM_STATS_LOG_TURNS = 100;
+
+const int64_t ODServer::DEFAULT_STATE_HASH_PERIOD = 10;
+
 template<> ODServer* Ogre::Singleton<ODServer>::msSingleton = 0;
 
 ODServer::ODServer() :
     mServerMode(ServerMode::ModeNone),
     mServerState(ServerState::StateNone),
     mGameMap(new GameMap(true)),
-    mSeatsConfigured(false)
+    mSeatsConfigured(false),
+    mNbHumanPlayersToWait(-1),
+    mTurnLimit(0),
+    mIsTurnLimitReached(false),
+    mIsStreamCompressionEnabled(false),
+    mStateHashPeriod(DEFAULT_STATE_HASH_PERIOD)
 {
 }
 
@@ -71,6 +110,7 @@ bool ODServer::startServer(const std::string& levelFilename, ServerMode mode)
     logManager.logMessage("Asked to launch server with levelFilename=" + levelFilename);
 
     mSeatsConfigured = false;
+    mIsTurnLimitReached = false;
 
     // Start the server socket listener as well as the server socket thread
     if (isConnected())
@@ -78,7 +118,7 @@ bool ODServer::startServer(const std::string& levelFilename, ServerMode mode)
         logManager.logMessage("Couldn't start server: The server is already connected");
         return false;
     }
-    if (ODClient::getSingleton().isConnected())
+    if ((ODClient::getSingletonPtr() != nullptr) && ODClient::getSingleton().isConnected())
     {
         logManager.logMessage("Couldn't start server: The client is already connected");
         return false;
@@ -171,6 +211,132 @@ void ODServer::processServerCommandQueue()
     }
 }
 
+void ODServer::addAIPlayer(Seat* seat)
+{
+    // We set player id = 0 for AI players. ID is only used during seat configuration phase
+    // During the game, one should use the seat ID to identify a player
+    GameMap* gameMap = mGameMap;
+    Player* aiPlayer = new Player(gameMap, 0);
+    aiPlayer->setNick("Keeper AI " + Ogre::StringConverter::toString(seat->getId()));
+    gameMap->addPlayer(aiPlayer);
+    seat->setPlayer(aiPlayer);
+    gameMap->assignAI(*aiPlayer, "KeeperAI");
+}
+
+void ODServer::finishSeatsConfiguration()
+{
+    GameMap* gameMap = mGameMap;
+
+    // Now, we can disconnect the players that were not configured
+    std::vector<ODSocketClient*> clientsToRemove;
+    for (ODSocketClient* client : mSockClients)
+    {
+        if((client->getPlayer() != nullptr) && (client->getPlayer()->getSeat() == nullptr))
+            clientsToRemove.push_back(client);
+    }
+
+    if(!clientsToRemove.empty())
+    {
+        ODPacket packetSend;
+        packetSend << ServerNotification::clientRejected;
+        for(ODSocketClient* client : clientsToRemove)
+        {
+            Player* player = client->getPlayer();
+            LogManager::getSingleton().logMessage("Rejecting player id="
+                + Ogre::StringConverter::toString(player->getId())
+                + ", nick=" + player->getNick());
+            setClientState(client, "rejected");
+            sendMsgToClient(client, packetSend);
+            delete player;
+            client->setPlayer(nullptr);
+        }
+    }
+
+    ODPacket packetSend;
+    packetSend << ServerNotification::clientAccepted << ODApplication::turnsPerSecond;
+    const std::vector<Player*>& players = gameMap->getPlayers();
+    int32_t nbPlayers = players.size();
+    packetSend << nbPlayers;
+    for (Player* player : players)
+    {
+        packetSend << player->getNick() << player->getId() << player->getSeat()->getId();
+        player->getSeat()->setMapSize(gameMap->getMapSizeX(), gameMap->getMapSizeY());
+    }
+    sendMsg(nullptr, packetSend);
+
+    for (ODSocketClient* client : mSockClients)
+    {
+        if(!client->isConnected() || (client->getPlayer() == nullptr))
+            continue;
+
+        ODPacket packetSend;
+        int seatId = client->getPlayer()->getSeat()->getId();
+        packetSend << ServerNotification::startGameMode << seatId << mServerMode;
+        sendMsgToClient(client, packetSend);
+    }
+
+    mSeatsConfigured = true;
+}
+
+void ODServer::configureSeatsAutomatically()
+{
+    GameMap* gameMap = mGameMap;
+    mServerState = ServerState::StateGame;
+
+    // The connected players take the seats a human can use in the level order
+    std::vector<ODSocketClient*> readyClients;
+    for (ODSocketClient* client : mSockClients)
+    {
+        if(client->getState().compare("ready") == 0)
+            readyClients.push_back(client);
+    }
+
+    uint32_t nextClient = 0;
+    const std::vector<std::string>& factions = ConfigManager::getSingleton().getFactions();
+    for(Seat* seat : gameMap->getSeats())
+    {
+        // If the faction is a choice or is not found, we use the first defined
+        std::string faction = factions[0];
+        if(std::find(factions.begin(), factions.end(), seat->getFaction()) != factions.end())
+            faction = seat->getFaction();
+
+        seat->setFaction(faction);
+
+        const std::vector<int>& availableTeamIds = seat->getAvailableTeamIds();
+        OD_ASSERT_TRUE_MSG(!availableTeamIds.empty(), "Empty availableTeamIds for seat id="
+            + Ogre::StringConverter::toString(seat->getId()));
+        if(!availableTeamIds.empty())
+            seat->setTeamId(availableTeamIds[0]);
+
+        const std::string& playerType = seat->getPlayerType();
+        if(playerType.compare(Seat::PLAYER_TYPE_INACTIVE) == 0)
+        {
+            LogManager::getSingleton().logMessage("No spawn pool created for seat id="
+                + Ogre::StringConverter::toString(seat->getId()));
+            continue;
+        }
+
+        bool humanAllowed = (playerType.compare(Seat::PLAYER_TYPE_HUMAN) == 0) ||
+            (playerType.compare(Seat::PLAYER_TYPE_CHOICE) == 0);
+        if(humanAllowed && (nextClient < readyClients.size()))
+        {
+            Player* player = readyClients[nextClient]->getPlayer();
+            ++nextClient;
+            seat->setPlayer(player);
+            gameMap->addPlayer(player);
+        }
+        else
+        {
+            // The seats nobody took are played by the AI
+            addAIPlayer(seat);
+        }
+
+        seat->initSpawnPool();
+    }
+
+    finishSeatsConfiguration();
+}
+
 void ODServer::startNewTurn(double timeSinceLastFrame)
 {
     GameMap* gameMap = mGameMap;
@@ -184,6 +350,8 @@ void ODServer::startNewTurn(double timeSinceLastFrame)
             return;
     }
 
+    TurnProfilerZone zone(gameMap->getTurnProfiler(), TurnProfiler::startNewTurn);
+
     gameMap->setTurnNumber(++turn);
 
     ServerNotification* serverNotification = new ServerNotification(
@@ -212,12 +380,12 @@ void ODServer::startNewTurn(double timeSinceLastFrame)
 
         // Here, the creature list is pulled. It could be possible that the creature dies before the stat window is
         // closed. So, if we cannot find the creature, we just erase it.
-        std::vector<std::string>& creatures = mCreaturesInfoWanted[sock];
-        std::vector<std::string>::iterator itCreatures = creatures.begin();
+        std::vector<uint32_t>& creatures = mCreaturesInfoWanted[sock];
+        std::vector<uint32_t>::iterator itCreatures = creatures.begin();
         while(itCreatures != creatures.end())
         {
-            std::string& name = *itCreatures;
-            Creature* creature = gameMap->getCreature(name);
+            uint32_t handle = *itCreatures;
+            Creature* creature = gameMap->getCreatureFromHandle(handle);
             if(creature == nullptr)
                 itCreatures = creatures.erase(itCreatures);
             else
@@ -226,7 +394,7 @@ void ODServer::startNewTurn(double timeSinceLastFrame)
 
                 ServerNotification *serverNotification = new ServerNotification(
                     ServerNotification::notifyCreatureInfo, player);
-                serverNotification->mPacket << name << creatureInfos;
+                serverNotification->mPacket << handle << creatureInfos;
                 ODServer::getSingleton().queueServerNotification(serverNotification);
 
                 ++itCreatures;
@@ -240,6 +408,8 @@ void ODServer::startNewTurn(double timeSinceLastFrame)
         case ServerMode::ModeGameMultiPlayer:
         {
             gameMap->doTurn();
+
+            TurnProfilerZone aiZone(gameMap->getTurnProfiler(), TurnProfiler::aiTurn);
             gameMap->doPlayerAITurn(timeSinceLastFrame);
             break;
         }
@@ -252,23 +422,71 @@ void ODServer::startNewTurn(double timeSinceLastFrame)
             break;
     }
 
+    TurnProfilerZone updateVisibleEntitiesZone(gameMap->getTurnProfiler(), TurnProfiler::updateVisibleEntities);
     gameMap->updateVisibleEntities();
+    updateVisibleEntitiesZone.stop();
+
     gameMap->processDeletionQueues();
+
+    // In editor mode, the turns are not computed so there is nothing to compare
+    if((mServerMode != ServerMode::ModeEditor) && (mStateHashPeriod > 0) && (turn % mStateHashPeriod == 0))
+        sendStateHashes();
+}
+
+void ODServer::sendStateHashes()
+{
+    GameMap* gameMap = mGameMap;
+    int64_t turn = gameMap->getTurnNumber();
+    LogManager::getSingleton().logMessage("State hash turn=" + Ogre::StringConverter::toString(static_cast<int32_t>(turn))
+        + ", hash=" + StateHash::toString(gameMap->computeStateHash()));
+
+    // The notifications are queued after the ones refreshing the tiles during this turn so that the
+    // clients compute their hash once they are up to date
+    for(ODSocketClient* client : mSockClients)
+    {
+        Player* player = client->getPlayer();
+        if((player == nullptr) || (player->getSeat() == nullptr))
+            continue;
+
+        ServerNotification* serverNotification = new ServerNotification(
+            ServerNotification::stateHash, player);
+        serverNotification->mPacket << turn << gameMap->computeVisibleTilesHash(player->getSeat());
+        queueServerNotification(serverNotification);
+    }
 }
 
 void ODServer::serverThread()
 {
+    // The simulation draws from the global stream so that a game only depends on the match seed,
+    // whichever thread drew a number first
+    Random::setThreadStream(Random::StreamType::global, 0);
+
     GameMap* gameMap = mGameMap;
     sf::Clock clock;
+    sf::Clock gameClock;
     double turnLengthMs = 1000.0 / ODApplication::turnsPerSecond;
     while(isConnected())
     {
         // doTask sould return after the length of 1 turn even if their are communications. When
-        // it returns, we can launch next turn.
-        doTask(static_cast<int32_t>(turnLengthMs));
+        // it returns, we can launch next turn. Note that a timeout of 0 would mean no timeout
+        doTask(std::max(1, static_cast<int32_t>(turnLengthMs)));
 
         if(gameMap->getTurnNumber() == -1)
         {
+            // On a dedicated server, the seats are configured as soon as enough players are connected
+            if(!mSeatsConfigured && (mNbHumanPlayersToWait >= 0))
+            {
+                int32_t nbReadyClients = 0;
+                for (ODSocketClient* client : mSockClients)
+                {
+                    if(client->getState().compare("ready") == 0)
+                        ++nbReadyClients;
+                }
+
+                if(nbReadyClients >= mNbHumanPlayersToWait)
+                    configureSeatsAutomatically();
+            }
+
             // The game is not started
             if(mSeatsConfigured)
             {
@@ -303,6 +521,7 @@ void ODServer::serverThread()
                 queueServerNotification(serverNotification);
 
                 LogManager::getSingleton().logMessage("Server ready, starting game");
+                gameClock.restart();
                 gameMap->setTurnNumber(0);
                 gameMap->setGamePaused(false);
 
@@ -319,6 +538,8 @@ void ODServer::serverThread()
                             }
                         }
 
+                        seat->computeTilesWithVision();
+
                         seat->sendVisibleTiles();
                     }
                 }
@@ -350,14 +571,56 @@ void ODServer::serverThread()
         // to wait for server. If server is in advance, he might send commands before the
         // creatures arrive at their destination. That could result in weird issues like
         // creatures going through walls.
+        TurnProfiler& profiler = gameMap->getTurnProfiler();
+        int64_t turn = gameMap->getTurnNumber();
+        TurnProfilerZone turnZone(profiler, TurnProfiler::turn);
         startNewTurn(static_cast<double>(clock.restart().asSeconds()) * 0.95);
 
+        TurnProfilerZone notificationsZone(profiler, TurnProfiler::serverNotifications);
         processServerNotifications();
+        notificationsZone.stop();
+        turnZone.stop();
+
+        // If no turn has been computed (some clients did not acknowledge the last one), we do not
+        // count this loop as a turn
+        if(gameMap->getTurnNumber() != turn)
+        {
+            profiler.endTurn();
+            if(mIsStreamCompressionEnabled && (gameMap->getTurnNumber() % STREAM_STATS_LOG_TURNS == 0))
+                logStreamStats();
+        }
+        else
+            profiler.discardTurn();
 
         processServerCommandQueue();
+
+        if((mTurnLimit > 0) && (gameMap->getTurnNumber() >= mTurnLimit))
+        {
+            double seconds = static_cast<double>(gameClock.getElapsedTime().asSeconds());
+            LogManager::getSingleton().logMessage("Turn limit reached: "
+                + Ogre::StringConverter::toString(static_cast<int32_t>(mTurnLimit)) + " turns computed in "
+                + Ogre::StringConverter::toString(seconds) + "s ("
+                + Ogre::StringConverter::toString(static_cast<double>(mTurnLimit) / std::max(seconds, 0.001)) + " turns/s)");
+            LogManager::getSingleton().logMessage(profiler.getReport());
+            mIsTurnLimitReached = true;
+            break;
+        }
     }
 }
 
+void ODServer::logStreamStats()
+{
+    LZCodecStats stats;
+    for(ODSocketClient* client : mSockClients)
+    {
+        stats.add(client->getSendStats());
+        client->resetSendStats();
+    }
+
+    LogManager::getSingleton().logMessage("Stream compression: "
+        + stats.getReport(STREAM_STATS_LOG_TURNS));
+}
+
 void ODServer::processServerNotifications()
 {
     GameMap* gameMap = mGameMap;
@@ -378,6 +641,16 @@ void ODServer::processServerNotifications()
         if(event == nullptr)
             continue;
 
+        if(addToEntitySnapshot(*event))
+        {
+            delete event;
+            continue;
+        }
+
+        // The events merged in the snapshot happened before this one so the snapshot has to be
+        // sent first
+        sendEntitySnapshots(event->mConcernedPlayer, isDeferredSnapshotSentBefore(event->mType));
+
         switch (event->mType)
         {
             case ServerNotification::turnStarted:
@@ -417,6 +690,133 @@ void ODServer::processServerNotifications()
         delete event;
         event = nullptr;
     }
+
+    sendEntitySnapshots(nullptr, gameMap->getTurnNumber() % INTEREST_SUMMARY_TURNS == 0);
+
+    // Everything sent during the turn is sent to each client in one envelope
+    flushClients();
+}
+
+bool ODServer::addToEntitySnapshot(ServerNotification& notification)
+{
+    if(!ConfigManager::getSingleton().getUseEntitySnapshots())
+        return false;
+
+    // Broadcasted messages are sent as is
+    if(notification.mConcernedPlayer == nullptr)
+        return false;
+
+    switch(notification.mType)
+    {
+        case ServerNotification::animatedObjectAddDestination:
+        case ServerNotification::animatedObjectClearDestinations:
+        case ServerNotification::setObjectAnimationState:
+        case ServerNotification::setMoveSpeed:
+        case ServerNotification::creatureRefresh:
+            break;
+
+        default:
+            return false;
+    }
+
+    ODSocketClient* client = getClientFromPlayer(notification.mConcernedPlayer);
+    if(client == nullptr)
+        return false;
+
+    EntitySnapshotEncoder& encoder = client->getSnapshotEncoder();
+    ODPacket& packet = notification.mPacket;
+    ServerNotification::ServerNotificationType type;
+    uint32_t handle;
+    OD_ASSERT_TRUE(packet >> type >> handle);
+    switch(notification.mType)
+    {
+        case ServerNotification::animatedObjectAddDestination:
+        {
+            Ogre::Vector3 destination;
+            OD_ASSERT_TRUE(packet >> destination);
+            encoder.addDestination(handle, destination);
+            break;
+        }
+        case ServerNotification::animatedObjectClearDestinations:
+        {
+            encoder.clearDestinations(handle);
+            break;
+        }
+        case ServerNotification::setObjectAnimationState:
+        {
+            std::string state;
+            bool loop;
+            bool hasWalkDirection;
+            Ogre::Vector3 walkDirection = Ogre::Vector3::ZERO;
+            OD_ASSERT_TRUE(packet >> state >> loop >> hasWalkDirection);
+            if(hasWalkDirection)
+            {
+                OD_ASSERT_TRUE(packet >> walkDirection);
+            }
+
+            encoder.setAnimationState(handle, state, loop, hasWalkDirection, walkDirection);
+            break;
+        }
+        case ServerNotification::setMoveSpeed:
+        {
+            double moveSpeed;
+            OD_ASSERT_TRUE(packet >> moveSpeed);
+            encoder.setMoveSpeed(handle, moveSpeed);
+            break;
+        }
+        case ServerNotification::creatureRefresh:
+        {
+            uint32_t level;
+            OD_ASSERT_TRUE(packet >> level);
+            encoder.setLevel(handle, level);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return true;
+}
+
+void ODServer::sendEntitySnapshots(Player* player, bool sendOutsideInterest)
+{
+    for(ODSocketClient* client : mSockClients)
+    {
+        if((player != nullptr) && (client->getPlayer() != player))
+            continue;
+
+        EntitySnapshotEncoder& encoder = client->getSnapshotEncoder();
+        if(!encoder.hasPendingChanges())
+            continue;
+
+        // The entities are checked each time as they may have entered or left the area since their change was deferred
+        const InterestArea& area = client->getInterestArea();
+        uint32_t nbChanges = encoder.getNbPendingChanges();
+        for(uint32_t i = 0; i < nbChanges; ++i)
+        {
+            bool isDeferred = false;
+            if(!sendOutsideInterest && area.isSet())
+            {
+                MovableGameEntity* entity = mGameMap->getAnimatedObjectFromHandle(encoder.getPendingChangeHandle(i));
+                if(entity != nullptr)
+                {
+                    const Ogre::Vector3& position = entity->getPosition();
+                    isDeferred = !area.contains(Helper::round(position.x), Helper::round(position.y),
+                        INTEREST_AREA_MARGIN);
+                }
+            }
+            encoder.setPendingChangeDeferred(i, isDeferred);
+        }
+
+        if(!encoder.hasChangesToWrite())
+            continue;
+
+        ODPacket packet;
+        ServerNotification::ServerNotificationType type = ServerNotification::entitySnapshot;
+        packet << type;
+        encoder.writeSnapshot(packet);
+        sendMsgToClient(client, packet);
+    }
 }
 
 bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
@@ -430,6 +830,10 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
     ODSocketClient::ODComStatus status = receiveMsgFromClient(clientSocket, packetReceived);
 
+    // The socket is not blocking. The message may not be fully received yet
+    if (status == ODSocketClient::ODComStatus::NotReady)
+        return true;
+
     // If the client closed the connection
     if (status != ODSocketClient::ODComStatus::OK)
     {
@@ -461,17 +865,28 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
         {
             if(std::string("connected").compare(clientSocket->getState()) != 0)
                 return false;
-            std::string version;
-            OD_ASSERT_TRUE(packetReceived >> version);
+            // The version is compared inside the packet without copying it
+            const char* version = nullptr;
+            uint32_t versionSize = 0;
+            OD_ASSERT_TRUE(packetReceived.readStringView(version, versionSize));
 
             // If the version is different, we refuse the client
-            if(version.compare(std::string("OpenDungeons V ") + ODApplication::VERSION) != 0)
+            std::string expectedVersion = std::string("OpenDungeons V ") + ODApplication::VERSION;
+            if(expectedVersion.compare(0, std::string::npos, version, versionSize) != 0)
             {
                 LogManager::getSingleton().logMessage("Server rejected client. Application version mismatch: required= "
-                    + ODApplication::VERSION + ", received=" + version);
+                    + ODApplication::VERSION + ", received=" + std::string(version, versionSize));
                 return false;
             }
 
+            // Clients able to decompress the envelopes tell it after the version
+            bool isCompressionSupported = false;
+            if(mIsStreamCompressionEnabled && (packetReceived >> isCompressionSupported) && isCompressionSupported)
+            {
+                LogManager::getSingleton().logMessage("Stream compression enabled for client");
+                clientSocket->setStreamCompression(true);
+            }
+
             // Tell the client to load the given map
             LogManager::getSingleton().logMessage("Level relative path sent to client: " + gameMap->getLevelFileName());
             setClientState(clientSocket, "loadLevel");
@@ -740,13 +1155,7 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
                     case 1:
                     {
                         // It is an AI
-                        // We set player id = 0 for AI players. ID is only used during seat configuration phase
-                        // During the game, one should use the seat ID to identify a player
-                        Player* aiPlayer = new Player(gameMap, 0);
-                        aiPlayer->setNick("Keeper AI " + Ogre::StringConverter::toString(seatId));
-                        gameMap->addPlayer(aiPlayer);
-                        seat->setPlayer(aiPlayer);
-                        gameMap->assignAI(*aiPlayer, "KeeperAI");
+                        addAIPlayer(seat);
                         break;
                     }
                     default:
@@ -780,55 +1189,7 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
                         + Ogre::StringConverter::toString(seat->getId()));
             }
 
-            // Now, we can disconnect the players that were not configured
-            std::vector<ODSocketClient*> clientsToRemove;
-            for (ODSocketClient* client : mSockClients)
-            {
-                if(client->getPlayer()->getSeat() == nullptr)
-                    clientsToRemove.push_back(client);
-            }
-
-            if(!clientsToRemove.empty())
-            {
-                ODPacket packetSend;
-                packetSend << ServerNotification::clientRejected;
-                for(ODSocketClient* client : clientsToRemove)
-                {
-                    Player* player = client->getPlayer();
-                    LogManager::getSingleton().logMessage("Rejecting player id="
-                        + Ogre::StringConverter::toString(player->getId())
-                        + ", nick=" + player->getNick());
-                    setClientState(client, "rejected");
-                    sendMsgToClient(client, packetSend);
-                    delete player;
-                    client->setPlayer(nullptr);
-                }
-            }
-
-            ODPacket packetSend;
-            packetSend << ServerNotification::clientAccepted << ODApplication::turnsPerSecond;
-            const std::vector<Player*>& players = gameMap->getPlayers();
-            int32_t nbPlayers = players.size();
-            packetSend << nbPlayers;
-            for (Player* player : players)
-            {
-                packetSend << player->getNick() << player->getId() << player->getSeat()->getId();
-                player->getSeat()->setMapSize(gameMap->getMapSizeX(), gameMap->getMapSizeY());
-            }
-            sendMsg(nullptr, packetSend);
-
-            for (ODSocketClient* client : mSockClients)
-            {
-                if(!client->isConnected() || (client->getPlayer() == nullptr))
-                    continue;
-
-                ODPacket packetSend;
-                int seatId = client->getPlayer()->getSeat()->getId();
-                packetSend << ServerNotification::startGameMode << seatId << mServerMode;
-                sendMsgToClient(client, packetSend);
-            }
-
-            mSeatsConfigured = true;
+            finishSeatsConfiguration();
             break;
         }
 
@@ -851,22 +1212,19 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
         case ClientNotification::askEntityPickUp:
         {
-            std::string entityName;
-            GameEntity::ObjectType entityType;
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
+            uint32_t handle;
+            OD_ASSERT_TRUE(packetReceived >> handle);
 
             Player *player = clientSocket->getPlayer();
-            MovableGameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
-            OD_ASSERT_TRUE_MSG(entity != nullptr, "entityType=" + Ogre::StringConverter::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+            MovableGameEntity* entity = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(entity != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(entity == nullptr)
                 break;
             bool allowPickup = entity->tryPickup(player->getSeat(), mServerMode == ServerMode::ModeEditor);
             if(!allowPickup)
             {
                 LogManager::getSingleton().logMessage("player=" + player->getNick()
-                        + " could not pickup entity entityType="
-                        + Ogre::StringConverter::toString(static_cast<int32_t>(entityType))
-                        + ", entityName=" + entityName);
+                        + " could not pickup entity entityName=" + entity->getName());
                 break;
             }
 
@@ -940,12 +1298,11 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
         case ClientNotification::askSlapEntity:
         {
-            GameEntity::ObjectType entityType;
-            std::string entityName;
+            uint32_t handle;
             Player* player = clientSocket->getPlayer();
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
-            MovableGameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
-            OD_ASSERT_TRUE_MSG(entity != nullptr, "entityType=" + Ogre::StringConverter::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+            OD_ASSERT_TRUE(packetReceived >> handle);
+            MovableGameEntity* entity = gameMap->getAnimatedObjectFromHandle(handle);
+            OD_ASSERT_TRUE_MSG(entity != nullptr, "handle=" + Ogre::StringConverter::toString(handle));
             if(entity == nullptr)
                 break;
 
@@ -954,9 +1311,7 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
             if(!entity->canSlap(player->getSeat(), isEditorMode))
             {
                 LogManager::getSingleton().logMessage("player=" + player->getNick()
-                        + " could not slap entity entityType="
-                        + Ogre::StringConverter::toString(static_cast<int32_t>(entityType))
-                        + ", entityName=" + entityName);
+                        + " could not slap entity entityName=" + entity->getName());
                 break;
             }
 
@@ -1428,17 +1783,25 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
             break;
         }
 
+        case ClientNotification::setInterestArea:
+        {
+            InterestArea area;
+            OD_ASSERT_TRUE(packetReceived >> area);
+            clientSocket->setInterestArea(area);
+            break;
+        }
+
         case ClientNotification::askCreatureInfos:
         {
-            std::string name;
+            uint32_t handle;
             bool refreshEachTurn;
-            OD_ASSERT_TRUE(packetReceived >> name >> refreshEachTurn);
-            std::vector<std::string>& creatures = mCreaturesInfoWanted[clientSocket];
+            OD_ASSERT_TRUE(packetReceived >> handle >> refreshEachTurn);
+            std::vector<uint32_t>& creatures = mCreaturesInfoWanted[clientSocket];
 
-            std::vector<std::string>::iterator it = std::find(creatures.begin(), creatures.end(), name);
+            std::vector<uint32_t>::iterator it = std::find(creatures.begin(), creatures.end(), handle);
             if(refreshEachTurn && (it == creatures.end()))
             {
-                creatures.push_back(name);
+                creatures.push_back(handle);
             }
             else if(!refreshEachTurn && (it != creatures.end()))
                 creatures.erase(it);
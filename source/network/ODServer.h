@@ -23,9 +23,12 @@
 
 #include <OgreSingleton.h>
 
+#include <atomic>
+
 class ServerNotification;
 class GameMap;
 class ServerConsoleCommand;
+class Seat;
 
 /**
  * When playing single player or multiplayer, there is always one reference gamemap. It is
@@ -62,6 +65,9 @@ class ODServer: public Ogre::Singleton<ODServer>,
          StateConfiguration,
          StateGame
      };
+    //! \brief Default number of turns between 2 state hashes. See setStateHashPeriod.
+    static const int64_t DEFAULT_STATE_HASH_PERIOD;
+
     ODServer();
     virtual ~ODServer();
 
@@ -71,6 +77,32 @@ class ODServer: public Ogre::Singleton<ODServer>,
     bool startServer(const std::string& levelFilename, ServerMode mode);
     void stopServer();
 
+    //! \brief Used by the dedicated server: instead of waiting for a client to configure the seats, the
+    //! server configures them as soon as nbHumanPlayers clients are connected. The seats left are played
+    //! by the AI. -1 to let a client configure the seats. Should be called before startServer.
+    inline void setAutomaticSeatConfiguration(int32_t nbHumanPlayers)
+    { mNbHumanPlayersToWait = nbHumanPlayers; }
+
+    //! \brief The server stops computing turns after the given number of turns and logs the turn
+    //! throughput. 0 means no limit. Should be called before startServer.
+    inline void setTurnLimit(int64_t nbTurns)
+    { mTurnLimit = nbTurns; }
+
+    //! \brief Compresses the messages sent to the clients that support it. The compression ratio and time
+    //! are logged regularly. Should be called before startServer.
+    inline void setStreamCompression(bool compression)
+    { mIsStreamCompressionEnabled = compression; }
+
+    //! \brief Every period turns, the server logs a hash of the game state and sends each client a hash of
+    //! the tiles it sees so that the client can detect desyncs. 0 disables the hashes. Should be called
+    //! before startServer.
+    inline void setStateHashPeriod(int64_t period)
+    { mStateHashPeriod = period; }
+
+    //! \brief Returns true once the turn limit is reached. Can be called from any thread.
+    inline bool isTurnLimitReached() const
+    { return mIsTurnLimitReached; }
+
     //! \brief Adds a server notification to the server notification queue. The message will be sent to the concerned player
     void queueServerNotification(ServerNotification* n);
 
@@ -99,17 +131,33 @@ private:
     ServerState mServerState;
     GameMap *mGameMap;
     bool mSeatsConfigured;
+    int32_t mNbHumanPlayersToWait;
+    int64_t mTurnLimit;
+    std::atomic<bool> mIsTurnLimitReached;
+    bool mIsStreamCompressionEnabled;
+    int64_t mStateHashPeriod;
 
     std::deque<ServerNotification*> mServerNotificationQueue;
     std::deque<ServerConsoleCommand*> mConsoleCommandQueue;
 
-    std::map<ODSocketClient*, std::vector<std::string>> mCreaturesInfoWanted;
+    std::map<ODSocketClient*, std::vector<uint32_t>> mCreaturesInfoWanted;
 
     ODSocketClient* getClientFromPlayer(Player* player);
 
     //! \brief Called when a new turn started.
     void startNewTurn(double timeSinceLastFrame);
 
+    //! \brief Creates an AI player for the given seat.
+    void addAIPlayer(Seat* seat);
+
+    //! \brief Called once every seat has a player. Rejects the clients without seat and starts
+    //! the game for the others.
+    void finishSeatsConfiguration();
+
+    //! \brief Gives the seats a human can use to the connected clients and the others to the AI.
+    //! See setAutomaticSeatConfiguration.
+    void configureSeatsAutomatically();
+
     /*! \brief Monitors mServerNotificationQueue for new events and informs the clients about them.
      *
      * This function is used in server mode and acts as a "consumer" on
@@ -119,6 +167,23 @@ private:
      */
     void processServerNotifications();
 
+    //! \brief Logs the game state hash and queues to each human player the hash of the tiles it sees
+    void sendStateHashes();
+
+    //! \brief Logs the bytes sent to the clients since the last call, before and after compression
+    void logStreamStats();
+
+    /*! \brief Adds the given notification to the snapshot of its player if it is a movement or state
+     * event and snapshots are enabled. Returns false if the notification should be sent as is.
+     */
+    bool addToEntitySnapshot(ServerNotification& notification);
+
+    /*! \brief Sends the pending snapshot of the given player. If player is nullptr, the snapshots of
+     * every connected player are sent. If sendOutsideInterest is false, the changes of the entities
+     * outside of the interest area of the client are kept for a later snapshot.
+     */
+    void sendEntitySnapshots(Player* player, bool sendOutsideInterest);
+
     /*! \brief The function running in server-mode which listens for messages from an individual, already connected, client.
      *
      * This function recieves TCP packets one at a time from a connected client,
@@ -23,9 +23,14 @@
 
 #include <OgreStringConverter.h>
 
+#include <algorithm>
+
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
 
+//! \brief Maximum time the receive thread waits for data before checking if it should stop
+static const int32_t RECEIVE_WAIT_MS = 20;
+
 bool ODSocketClient::connect(const std::string& host, const int port)
 {
     mSource = ODSource::none;
@@ -45,24 +50,49 @@ bool ODSocketClient::connect(const std::string& host, const int port)
     ss << "replay_" << boost::posix_time::second_clock::local_time();
     mOutputReplayFilename = ResourceManager::getSingleton().getReplayDataPath() + ss.str() + ".odr";
 
-    mReplayOutputStream.open(mOutputReplayFilename, std::ios::out | std::ios::binary);
+    if(!mReplayWriter.open(mOutputReplayFilename))
+        LogManager::getSingleton().logMessage("ERROR : Could not create replay file " + mOutputReplayFilename);
     mGameClock.restart();
     mSource = ODSource::network;
+
+    mStopReceiveThread = false;
+    mHasReceiveFailed = false;
+    mReceivedPackets.clear();
+    mReceiveThread = std::thread(&ODSocketClient::receiveThread, this);
     return true;
 }
 
 bool ODSocketClient::replay(const std::string& filename)
 {
     LogManager::getSingleton().logMessage("Reading replay from file " + filename);
-    mReplayInputStream.open(filename, std::ios::in | std::ios::binary);
+    if(!mReplayReader.open(filename))
+    {
+        LogManager::getSingleton().logMessage("ERROR : " + filename + " is not a valid replay file");
+        return false;
+    }
+
     mGameClock.restart();
+    mReplayClock.restart();
+    mReplayTimeMs = 0.0;
+    mReplaySpeed = 1.0f;
+    mPendingTimestamp = -1;
     mSource = ODSource::file;
     return true;
 }
 
 void ODSocketClient::disconnect(bool keepReplay)
 {
+    // The receive thread uses the socket so it has to be stopped first
+    stopReceiveThread();
+    mReceivedPackets.clear();
+    mHasReceiveFailed = false;
     mPendingTimestamp = -1;
+    mSendBuffer.clear();
+    mSendBuffer.setCompression(false);
+    mHasSendOverflowed = false;
+    mInterestArea.clear();
+    mReceivedEnvelope.clear();
+    mReceivedOffset = 0;
     ODSource src = mSource;
     mSource = ODSource::none;
     switch(src)
@@ -82,12 +112,17 @@ void ODSocketClient::disconnect(bool keepReplay)
         }
         case ODSource::file:
         {
-            mReplayInputStream.close();
+            mReplayReader.close();
             return;
         }
     }
 
-    mReplayOutputStream.close();
+    if(mReplayWriter.isOpen())
+    {
+        LogManager::getSingleton().logMessage("Replay compression: "
+            + mReplayWriter.getCompressionStats().getReport(mReplayWriter.getIndex().size()));
+    }
+    mReplayWriter.close();
     // Delete the replay newly created if asked to.
     if (!keepReplay)
         boost::filesystem::remove(mOutputReplayFilename);
@@ -96,6 +131,9 @@ void ODSocketClient::disconnect(bool keepReplay)
 
 bool ODSocketClient::isDataAvailable()
 {
+    if(hasReceivedPackets())
+        return true;
+
     switch(mSource)
     {
         case ODSource::none:
@@ -104,27 +142,23 @@ bool ODSocketClient::isDataAvailable()
         }
         case ODSource::network:
         {
-            // There is only 1 socket in the selector so it should be ready if
-            // wait returns true but it doesn't hurt to return isReady...
-            if(!mSockSelector.wait(sf::milliseconds(5)))
-                return false;
-            return mSockSelector.isReady(mSockClient);
+            // The packets are received by the receive thread. If the connection failed, recv
+            // will report it
+            return !mReceivedPackets.isEmpty() || mHasReceiveFailed;
         }
         case ODSource::file:
         {
-            if(mReplayInputStream.eof())
-                return false;
-
             if(mPendingTimestamp == -1)
-                mPendingTimestamp = mPendingPacket.readPacket(mReplayInputStream);
+                mPendingTimestamp = mReplayReader.readEnvelope(mPendingPacket);
 
             if(mPendingTimestamp < 0)
                 return false;
 
-            if(mPendingTimestamp < mGameClock.getElapsedTime().asMilliseconds())
+            mReplayTimeMs += mReplayClock.restart().asMicroseconds() * static_cast<double>(mReplaySpeed) / 1000.0;
+            if(mReplaySpeed <= 0.0f)
                 return true;
 
-            return false;
+            return mPendingTimestamp <= mReplayTimeMs;
         }
     }
 
@@ -136,17 +170,116 @@ ODSocketClient::ODComStatus ODSocketClient::send(ODPacket& s)
     if(mSource != ODSource::network)
         return ODComStatus::OK;
 
-    sf::Socket::Status status = mSockClient.send(s.mPacket);
-    if (status == sf::Socket::Done)
+    // The packet is sent alone in an envelope
+    if(queueSend(s) != ODComStatus::OK)
+        return ODComStatus::Error;
+
+    return flushSend();
+}
+
+ODSocketClient::ODComStatus ODSocketClient::queueSend(const ODPacket& s)
+{
+    if(mSource != ODSource::network)
         return ODComStatus::OK;
 
-    LogManager::getSingleton().logMessage("ERROR : Could not send data from client status="
-        + Ogre::StringConverter::toString(status));
-    return ODComStatus::Error;
+    if(mHasSendOverflowed)
+        return ODComStatus::Error;
+
+    if(!mSendBuffer.addPacket(s))
+    {
+        // The client does not read what we send. We stop sending to it instead of keeping
+        // more and more data
+        LogManager::getSingleton().logMessage("ERROR : Too much data waiting to be sent to client state="
+            + mState + ", pendingBytes=" + Ogre::StringConverter::toString(mSendBuffer.getNbPendingBytes()));
+        mSendBuffer.clear();
+        mHasSendOverflowed = true;
+        return ODComStatus::Error;
+    }
+
+    return ODComStatus::OK;
+}
+
+ODSocketClient::ODComStatus ODSocketClient::flushSend()
+{
+    if(mHasSendOverflowed)
+        return ODComStatus::Error;
+
+    mSendBuffer.closeEnvelope();
+    while(mSendBuffer.getSizeToSend() > 0)
+    {
+#ifdef OD_NON_BLOCKING_SEND
+        std::size_t nbBytesSent = 0;
+        sf::Socket::Status status = mSockClient.send(mSendBuffer.getDataToSend(),
+            mSendBuffer.getSizeToSend(), nbBytesSent);
+        mSendBuffer.consume(nbBytesSent);
+        if(status == sf::Socket::Done)
+            continue;
+
+        // The client cannot receive more for now. We will try again later
+        if((status == sf::Socket::Partial) || (status == sf::Socket::NotReady))
+            return ODComStatus::NotReady;
+#else
+        sf::Socket::Status status = mSockClient.send(mSendBuffer.getDataToSend(),
+            mSendBuffer.getSizeToSend());
+        if(status == sf::Socket::Done)
+        {
+            mSendBuffer.consume(mSendBuffer.getSizeToSend());
+            continue;
+        }
+#endif
+
+        LogManager::getSingleton().logMessage("ERROR : Could not send data to client status="
+            + Ogre::StringConverter::toString(status));
+        mSendBuffer.clear();
+        return ODComStatus::Error;
+    }
+
+    return ODComStatus::OK;
+}
+
+ODSocketClient::ODComStatus ODSocketClient::readFromReceivedEnvelope(ODPacket& s)
+{
+    if(!s.readFromEnvelope(mReceivedEnvelope.getData(), mReceivedEnvelope.getDataSize(), mReceivedOffset))
+    {
+        LogManager::getSingleton().logMessage("ERROR : Received an invalid envelope");
+        mReceivedEnvelope.clear();
+        mReceivedOffset = 0;
+        return ODComStatus::Error;
+    }
+
+    return ODComStatus::OK;
 }
 
 ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
 {
+    if(mHasSendOverflowed)
+        return ODComStatus::Error;
+
+    mLastQueueLatencyUs = 0;
+    if(mReceiveThread.joinable())
+    {
+        ReceivedPacket* received = mReceivedPackets.getFront();
+        if(received == nullptr)
+        {
+            if(!mHasReceiveFailed)
+                return ODComStatus::NotReady;
+
+            // The failure is only reported once
+            mHasReceiveFailed = false;
+            return ODComStatus::Error;
+        }
+
+        // The buffers are exchanged so that the slot reuses the memory of s
+        s.swap(received->mPacket);
+        mLastQueueLatencyUs = mGameClock.getElapsedTime().asMicroseconds() - received->mReceivedTimeUs;
+        mReceivedPackets.pop();
+        return ODComStatus::OK;
+    }
+
+    // The packets are received by envelopes. We read the next one of the current envelope if any
+    if(hasReceivedPackets())
+        return readFromReceivedEnvelope(s);
+
     switch(mSource)
     {
         case ODSource::none:
@@ -157,12 +290,20 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
         }
         case ODSource::network:
         {
-            sf::Socket::Status status = mSockClient.receive(s.mPacket);
+            sf::Socket::Status status = mSockClient.receive(mSocketPacket);
             if (status == sf::Socket::Done)
             {
-                s.writePacket(mGameClock.getElapsedTime().asMilliseconds(),
-                    mReplayOutputStream);
-                return ODComStatus::OK;
+                mReceivedOffset = 0;
+                if(!ODSendBuffer::readFrame(static_cast<const char*>(mSocketPacket.getData()),
+                    mSocketPacket.getDataSize(), mDecompressedFrame, mReceivedEnvelope))
+                {
+                    LogManager::getSingleton().logMessage("ERROR : Received an invalid compressed envelope");
+                    mReceivedEnvelope.clear();
+                    return ODComStatus::Error;
+                }
+                mReplayWriter.writeEnvelope(mGameClock.getElapsedTime().asMilliseconds(),
+                    mReceivedEnvelope);
+                return readFromReceivedEnvelope(s);
             }
             else if((!mSockClient.isBlocking()) &&
                     (status == sf::Socket::NotReady))
@@ -176,14 +317,113 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
         case ODSource::file:
         {
             OD_ASSERT_TRUE(mPendingPacket != 0);
-            s = mPendingPacket;
+            mReceivedEnvelope.swap(mPendingPacket);
+            mReceivedOffset = 0;
+            // When the replay is played unthrottled, the replay time follows the envelopes read so
+            // that it goes on from there if the speed is changed
+            mReplayTimeMs = std::max(mReplayTimeMs, static_cast<double>(mPendingTimestamp));
             mPendingTimestamp = -1;
-            return ODComStatus::OK;
+            return readFromReceivedEnvelope(s);
         }
     }
     return ODComStatus::Error;
 }
 
+void ODSocketClient::receiveThread()
+{
+    while(!mStopReceiveThread)
+    {
+        // There is only 1 socket in the selector so it should be ready if
+        // wait returns true but it doesn't hurt to check isReady...
+        if(!mSockSelector.wait(sf::milliseconds(RECEIVE_WAIT_MS)) ||
+           !mSockSelector.isReady(mSockClient))
+        {
+            continue;
+        }
+
+        sf::Socket::Status status = mSockClient.receive(mSocketPacket);
+        if(status != sf::Socket::Done)
+        {
+            LogManager::getSingleton().logMessage("ERROR : Could not receive data from server status="
+                + Ogre::StringConverter::toString(status));
+            mHasReceiveFailed = true;
+            return;
+        }
+
+        if(!ODSendBuffer::readFrame(static_cast<const char*>(mSocketPacket.getData()),
+            mSocketPacket.getDataSize(), mDecompressedFrame, mReceiveThreadEnvelope))
+        {
+            LogManager::getSingleton().logMessage("ERROR : Received an invalid compressed envelope from server");
+            mHasReceiveFailed = true;
+            return;
+        }
+        mReplayWriter.writeEnvelope(mGameClock.getElapsedTime().asMilliseconds(), mReceiveThreadEnvelope);
+        uint32_t offset = 0;
+        while(offset < mReceiveThreadEnvelope.getDataSize())
+        {
+            // If the client does not process the packets fast enough, we wait for it
+            ReceivedPacket* slot;
+            while((slot = mReceivedPackets.getFreeSlot()) == nullptr)
+            {
+                if(mStopReceiveThread)
+                    return;
+
+                sf::sleep(sf::milliseconds(1));
+            }
+
+            if(!slot->mPacket.readFromEnvelope(mReceiveThreadEnvelope.getData(),
+                mReceiveThreadEnvelope.getDataSize(), offset))
+            {
+                LogManager::getSingleton().logMessage("ERROR : Received an invalid envelope from server");
+                mHasReceiveFailed = true;
+                return;
+            }
+
+            slot->mReceivedTimeUs = mGameClock.getElapsedTime().asMicroseconds();
+            mReceivedPackets.push();
+        }
+    }
+}
+
+void ODSocketClient::stopReceiveThread()
+{
+    if(!mReceiveThread.joinable())
+        return;
+
+    mStopReceiveThread = true;
+    mReceiveThread.join();
+    mStopReceiveThread = false;
+}
+
+bool ODSocketClient::seekReplay(int64_t turn)
+{
+    if(mSource != ODSource::file)
+        return false;
+
+    for(const ODReplayIndexEntry& entry : mReplayReader.getIndex())
+    {
+        if(entry.mTurn < turn)
+            continue;
+
+        if(entry.mTimestamp < mReplayTimeMs)
+            return false;
+
+        // The messages received up to the start of the turn are available at once
+        mReplayTimeMs = entry.mTimestamp;
+        return true;
+    }
+
+    return false;
+}
+
+int64_t ODSocketClient::getReplayLastTurn() const
+{
+    if((mSource != ODSource::file) || mReplayReader.getIndex().empty())
+        return -1;
+
+    return mReplayReader.getIndex().back().mTurn;
+}
+
 bool ODSocketClient::isConnected()
 {
     return mSource != ODSource::none;
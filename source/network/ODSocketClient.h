@@ -19,13 +19,28 @@
 #define ODSOCKETCLIENT_H
 
 #include <network/ODPacket.h>
+#include <network/ODReplayFile.h>
+#include <network/ODSendBuffer.h>
+#include <network/EntitySnapshot.h>
+#include <network/InterestArea.h>
+
+#include "utils/SpscQueue.h"
 
 #include <SFML/Network.hpp>
 
+#include <atomic>
 #include <string>
 #include <cstdint>
 #include <fstream>
 #include <istream>
+#include <thread>
+#include <vector>
+
+// SFML tells how many bytes have been sent by a non blocking socket since 2.3. With older
+// versions, the sockets used by the server stay blocking
+#if (SFML_VERSION_MAJOR > 2) || ((SFML_VERSION_MAJOR == 2) && (SFML_VERSION_MINOR >= 3))
+#define OD_NON_BLOCKING_SEND
+#endif
 
 class Player;
 
@@ -50,11 +65,19 @@ class ODSocketClient
             mSource(ODSource::none),
             mPlayer(nullptr),
             mLastTurnAck(-1),
-            mPendingTimestamp(-1)
+            mHasSendOverflowed(false),
+            mReceivedOffset(0),
+            mReceivedPackets(RECEIVE_QUEUE_SIZE),
+            mStopReceiveThread(false),
+            mHasReceiveFailed(false),
+            mLastQueueLatencyUs(0),
+            mPendingTimestamp(-1),
+            mReplayTimeMs(0.0),
+            mReplaySpeed(1.0f)
         {}
 
         virtual ~ODSocketClient()
-        {}
+        { stopReceiveThread(); }
 
         // Client initialization
         bool isConnected();
@@ -66,11 +89,49 @@ class ODSocketClient
         void setPlayer(Player* player) { mPlayer = player; }
         int64_t getLastTurnAck() { return mLastTurnAck; }
         void setLastTurnAck(int64_t lastTurnAck) { mLastTurnAck = lastTurnAck; }
+        EntitySnapshotEncoder& getSnapshotEncoder() { return mSnapshotEncoder; }
+        //! \brief Tiles seen by the camera of this client. Used by the server to send the movements
+        //! of the entities outside of it less often.
+        const InterestArea& getInterestArea() const { return mInterestArea; }
+        void setInterestArea(const InterestArea& area) { mInterestArea = area; }
         const std::string& getState() {return mState;}
+        //! \brief Returns true if recv can be called without waiting.
         bool isDataAvailable();
         int32_t getGameTimeMillis()
         { return mGameClock.getElapsedTime().asMilliseconds(); }
 
+        /*! \brief Sets how fast the replay being watched is played compared to real time.
+         * 0 plays it as fast as the messages can be processed.
+         */
+        inline void setReplaySpeed(float speed)
+        { mReplaySpeed = speed; }
+
+        inline float getReplaySpeed() const
+        { return mReplaySpeed; }
+
+        /*! \brief Plays the replay being watched without waiting until the given turn starts. Returns
+         * false if the turn is not in the replay or has already been played (replays cannot go back).
+         */
+        bool seekReplay(int64_t turn);
+
+        //! \brief Returns the last turn started in the replay being watched or -1 if there is none
+        int64_t getReplayLastTurn() const;
+
+        //! \brief Compresses the envelopes sent from now on. Used by the server for the clients
+        //! that told they can decompress them.
+        inline void setStreamCompression(bool compression)
+        { mSendBuffer.setCompression(compression); }
+
+        inline bool isStreamCompressed() const
+        { return mSendBuffer.isCompressionEnabled(); }
+
+        //! \brief Sizes and compression time of the envelopes sent since the last call to resetSendStats
+        inline const LZCodecStats& getSendStats() const
+        { return mSendBuffer.getCompressionStats(); }
+
+        inline void resetSendStats()
+        { mSendBuffer.resetCompressionStats(); }
+
     protected:
         virtual bool connect(const std::string& host, const int port);
         virtual bool replay(const std::string& filename);
@@ -91,9 +152,68 @@ class ODSocketClient
          */
         ODComStatus recv(ODPacket& s);
 
+        //! \brief Returns true if the last envelope received still contains packets to read with recv
+        inline bool hasReceivedPackets() const
+        { return mReceivedOffset < mReceivedEnvelope.getDataSize(); }
+
+        /*! \brief Adds the packet to the send buffer. It will be sent with the other packets
+         * queued until the next call to flushSend. Used by the server. If the client does not read
+         * its data and the buffer is full, the pending data is dropped, Error is returned and the
+         * client should be disconnected (see hasSendOverflowed).
+         */
+        ODComStatus queueSend(const ODPacket& s);
+
+        /*! \brief Sends the packets queued with queueSend in one envelope. If the socket is not
+         * blocking and the client cannot receive everything, the remaining bytes are kept and
+         * NotReady is returned. They will be sent by the next call.
+         */
+        ODComStatus flushSend();
+
+        //! \brief Returns true if some queued bytes have not been sent yet
+        inline bool hasDataToSend() const
+        { return mSendBuffer.getNbPendingBytes() > 0; }
+
+        //! \brief Returns true if the send buffer of the client got full. Once it happens,
+        //! recv and flushSend return Error until the client is disconnected
+        inline bool hasSendOverflowed() const
+        { return mHasSendOverflowed; }
+
+        //! \brief Returns the time the last packet returned by recv waited in the receive queue.
+        //! 0 if the packet was not received by the receive thread.
+        inline int64_t getLastQueueLatencyUs() const
+        { return mLastQueueLatencyUs; }
+
     private :
         void setState(const std::string& state) {mState = state;}
 
+        //! \brief Reads the next packet of the received envelope
+        ODComStatus readFromReceivedEnvelope(ODPacket& s);
+
+        /*! \brief Receives the envelopes from the server and pushes their packets in mReceivedPackets
+         * until stopReceiveThread is called or the connection fails. Started by connect so that the
+         * client never waits for the socket.
+         */
+        void receiveThread();
+
+        //! \brief Waits for the receive thread to end. Does nothing if it is not running.
+        void stopReceiveThread();
+
+        //! \brief A packet received by the receive thread
+        class ReceivedPacket
+        {
+        public:
+            ReceivedPacket() :
+                mReceivedTimeUs(0)
+            {}
+
+            ODPacket mPacket;
+            //! \brief Value of mGameClock when the packet was received
+            int64_t mReceivedTimeUs;
+        };
+
+        //! \brief Maximum number of packets received and not processed yet
+        static const uint32_t RECEIVE_QUEUE_SIZE = 1024;
+
         ODSource mSource;
         sf::SocketSelector mSockSelector;
         sf::TcpSocket mSockClient;
@@ -101,12 +221,49 @@ class ODSocketClient
         int64_t mLastTurnAck;
         std::string mState;
 
+        //! \brief Used by the server to merge the movement events sent to this client
+        EntitySnapshotEncoder mSnapshotEncoder;
+        InterestArea mInterestArea;
+
+        //! \brief Packets queued by the server for this client
+        ODSendBuffer mSendBuffer;
+        //! \brief True if the client did not read its data fast enough and its send buffer went
+        //! over ODSendBuffer::MAX_PENDING_BYTES. Nothing is sent to it anymore.
+        bool mHasSendOverflowed;
+
+        //! \brief Last envelope received and offset of the next packet to read in it
+        ODPacket mReceivedEnvelope;
+        uint32_t mReceivedOffset;
+
+        //! \brief Used to receive the envelopes from the socket. Kept from one call to another
+        //! so that its memory is reused
+        sf::Packet mSocketPacket;
+        //! \brief Used to decompress the envelopes received
+        std::vector<char> mDecompressedFrame;
+
+        //! \brief Packets received from the server by the receive thread. The receive thread
+        //! is the only one using mSockSelector, mReplayWriter, mSocketPacket, mDecompressedFrame
+        //! and mReceiveThreadEnvelope
+        SpscQueue<ReceivedPacket> mReceivedPackets;
+        std::thread mReceiveThread;
+        std::atomic<bool> mStopReceiveThread;
+        //! \brief Set by the receive thread when the connection fails
+        std::atomic<bool> mHasReceiveFailed;
+        ODPacket mReceiveThreadEnvelope;
+        int64_t mLastQueueLatencyUs;
+
         sf::Clock mGameClock;
-        std::ifstream mReplayInputStream;
-        std::ofstream mReplayOutputStream;
+        ODReplayReader mReplayReader;
+        ODReplayWriter mReplayWriter;
         ODPacket mPendingPacket;
         int32_t mPendingTimestamp;
 
+        //! \brief Time in the replay being watched. The envelopes received before are available.
+        //! It is increased by the real time elapsed multiplied by mReplaySpeed.
+        double mReplayTimeMs;
+        float mReplaySpeed;
+        sf::Clock mReplayClock;
+
         //! \brief the replay filename being written. Used to later optionally delete it
         //! if asked to.
         std::string mOutputReplayFilename;
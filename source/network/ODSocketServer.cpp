@@ -24,6 +24,9 @@
 #include <SFML/System.hpp>
 #include <OgreStringConverter.h>
 
+//! \brief Delay between 2 tries to send the data a client could not receive
+static const int SEND_RETRY_DELAY_MS = 5;
+
 ODSocketServer::ODSocketServer():
     mThread(nullptr),
     mNewClient(nullptr),
@@ -72,12 +75,21 @@ void ODSocketServer::doTask(int timeoutMs)
     while((timeoutMs == 0) ||
           (timeoutMs > mClockMainTask.getElapsedTime().asMilliseconds()))
     {
+        removeOverflowedClients();
+
+        // The selector only tells when we can receive. If some data could not be sent, we
+        // wake up regularly to try again
+        bool hasDataToSend = flushClients();
+
         bool isSockReady;
         if(timeoutMs != 0)
         {
             // We adapt the timeout so that the function returns after timeoutMs
             // even if events occured
             int timeoutMsAdjusted = std::max(1, timeoutMs - mClockMainTask.getElapsedTime().asMilliseconds());
+            if(hasDataToSend)
+                timeoutMsAdjusted = std::min(timeoutMsAdjusted, SEND_RETRY_DELAY_MS);
+
             isSockReady = mSockSelector.wait(sf::milliseconds(timeoutMsAdjusted));
         }
         else
@@ -100,7 +112,11 @@ void ODSocketServer::doTask(int timeoutMs)
                     LogManager::getSingleton().logMessage("New client connected");
                     if(notifyNewConnection(mNewClient))
                     {
-                        // The server wants to keep the client
+                        // The server wants to keep the client. Its socket is not blocking so that
+                        // a slow client cannot block the server
+#ifdef OD_NON_BLOCKING_SEND
+                        mNewClient->mSockClient.setBlocking(false);
+#endif
                         mNewClient->mSource = ODSocketClient::ODSource::network;
                         mSockSelector.add(mNewClient->mSockClient);
                         mSockClients.push_back(mNewClient);
@@ -126,12 +142,21 @@ void ODSocketServer::doTask(int timeoutMs)
                 for(std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end();)
                 {
                     ODSocketClient* client = *it;
-                    if((mSockSelector.isReady(client->mSockClient)) &&
-                       (!notifyClientMessage(client)))
+                    bool keepClient = true;
+                    if(mSockSelector.isReady(client->mSockClient))
+                    {
+                        // A client envelope can contain more than 1 message
+                        keepClient = notifyClientMessage(client);
+                        while(keepClient && client->hasReceivedPackets())
+                            keepClient = notifyClientMessage(client);
+                    }
+
+                    if(!keepClient)
                     {
                         // The server wants to remove the client
                         it = mSockClients.erase(it);
                         mSockSelector.remove(client->mSockClient);
+                        client->flushSend();
                         client->disconnect();
                         delete client;
                     }
@@ -143,6 +168,9 @@ void ODSocketServer::doTask(int timeoutMs)
             }
         }
     }
+
+    // The answers to the messages received are sent without waiting for the end of the turn
+    flushClients();
 }
 
 ODSocketClient::ODComStatus ODSocketServer::receiveMsgFromClient(ODSocketClient* client, ODPacket& packetReceived)
@@ -152,7 +180,46 @@ ODSocketClient::ODComStatus ODSocketServer::receiveMsgFromClient(ODSocketClient*
 
 ODSocketClient::ODComStatus ODSocketServer::sendMsgToClient(ODSocketClient* client, ODPacket& packetReceived)
 {
-    return client->send(packetReceived);
+    return client->queueSend(packetReceived);
+}
+
+void ODSocketServer::removeOverflowedClients()
+{
+    for(std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end();)
+    {
+        ODSocketClient* client = *it;
+        if(!client->hasSendOverflowed())
+        {
+            ++it;
+            continue;
+        }
+
+        // The client cannot receive anything. The server is notified as if the connection was
+        // closed (reading from the client fails) and the client is removed
+        LogManager::getSingleton().logMessage("Disconnecting client that does not read its data");
+        notifyClientMessage(client);
+        it = mSockClients.erase(it);
+        mSockSelector.remove(client->mSockClient);
+        client->disconnect();
+        delete client;
+    }
+}
+
+bool ODSocketServer::flushClients()
+{
+    bool hasDataToSend = false;
+    for(ODSocketClient* client : mSockClients)
+    {
+        if(!client->hasDataToSend())
+            continue;
+
+        // If sending fails, the client is removed when its socket is read
+        client->flushSend();
+        if(client->hasDataToSend())
+            hasDataToSend = true;
+    }
+
+    return hasDataToSend;
 }
 
 void ODSocketServer::stopServer()
@@ -166,6 +233,8 @@ void ODSocketServer::stopServer()
     for (std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end(); ++it)
     {
         ODSocketClient* client = *it;
+        // We try to send the last messages (for example, the exit notification)
+        client->flushSend();
         client->disconnect();
         delete client;
     }
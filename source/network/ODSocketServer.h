@@ -66,12 +66,23 @@ class ODSocketServer
          */
         void doTask(int timeoutMs);
         ODSocketClient::ODComStatus receiveMsgFromClient(ODSocketClient* client, ODPacket& packetReceived);
+        /*! \brief Queues the packet in the client send buffer. The queued packets are sent in one
+         * envelope by flushClients. doTask flushes the clients while waiting for messages.
+         */
         ODSocketClient::ODComStatus sendMsgToClient(ODSocketClient* client, ODPacket& packetReceived);
+
+        //! \brief Sends the packets queued for each client. Returns true if some clients could
+        //! not receive everything. The remaining data will be sent by the next call.
+        bool flushClients();
         std::vector<ODSocketClient*> mSockClients;
         void setClientState(ODSocketClient* client, const std::string& state);
         virtual void serverThread() = 0;
 
     private:
+        //! \brief Removes the clients whose send buffer got full because they stopped reading. The server is
+        //! notified through notifyClientMessage, where reading from these clients fails.
+        void removeOverflowedClients();
+
         sf::Thread* mThread;
         sf::TcpListener mSockListener;
         sf::SocketSelector mSockSelector;
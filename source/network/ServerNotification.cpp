@@ -20,6 +20,40 @@
 
 #include <OgreStringConverter.h>
 
+#include <vector>
+
+//! \brief Maximum number of freed notifications kept by a free list
+const uint32_t MAX_FREE_NOTIFICATIONS = 1024;
+
+//! \brief Set when the free list of the current thread has been destroyed. The notifications
+//! deleted after that (when the thread exits) are freed
+static thread_local bool isFreeListDestroyed = false;
+
+//! \brief Memory of the deleted notifications. There is one list per thread so that no lock is needed.
+class ServerNotificationFreeList
+{
+public:
+    ServerNotificationFreeList()
+    {
+        mBlocks.reserve(MAX_FREE_NOTIFICATIONS);
+    }
+
+    ~ServerNotificationFreeList()
+    {
+        isFreeListDestroyed = true;
+        for(void* block : mBlocks)
+            ::operator delete(block);
+    }
+
+    std::vector<void*> mBlocks;
+};
+
+static ServerNotificationFreeList& getFreeList()
+{
+    static thread_local ServerNotificationFreeList freeList;
+    return freeList;
+}
+
 ServerNotification::ServerNotification(ServerNotificationType type,
     Player* concernedPlayer)
 {
@@ -28,6 +62,40 @@ ServerNotification::ServerNotification(ServerNotificationType type,
     mPacket << type;
 }
 
+void* ServerNotification::operator new(std::size_t size)
+{
+    if((size == sizeof(ServerNotification)) && !isFreeListDestroyed)
+    {
+        std::vector<void*>& blocks = getFreeList().mBlocks;
+        if(!blocks.empty())
+        {
+            void* block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ServerNotification::operator delete(void* ptr, std::size_t size)
+{
+    if(ptr == nullptr)
+        return;
+
+    if((size == sizeof(ServerNotification)) && !isFreeListDestroyed)
+    {
+        std::vector<void*>& blocks = getFreeList().mBlocks;
+        if(blocks.size() < MAX_FREE_NOTIFICATIONS)
+        {
+            blocks.push_back(ptr);
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
 std::string ServerNotification::typeString(ServerNotificationType type)
 {
     switch(type)
@@ -110,6 +178,10 @@ std::string ServerNotification::typeString(ServerNotificationType type)
             return "carryEntity";
         case ServerNotificationType::releaseCarriedEntity:
             return "releaseCarriedEntity";
+        case ServerNotificationType::entitySnapshot:
+            return "entitySnapshot";
+        case ServerNotificationType::stateHash:
+            return "stateHash";
         case ServerNotificationType::exit:
             return "exit";
         default:
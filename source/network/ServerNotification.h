@@ -20,6 +20,7 @@
 
 #include "network/ODPacket.h"
 
+#include <cstddef>
 #include <deque>
 #include <string>
 #include <OgreVector3.h>
@@ -87,6 +88,8 @@ class ServerNotification
             refreshVisibleTiles,
             carryEntity,
             releaseCarriedEntity,
+            entitySnapshot, // The movement and state events of a turn merged by EntitySnapshotEncoder
+            stateHash, // Hash of the tiles the player sees at the end of a turn, to detect desyncs
 
             exit
         };
@@ -98,6 +101,12 @@ class ServerNotification
         virtual ~ServerNotification()
         {}
 
+        /*! \brief Notifications are created and deleted all the time while playing. Instead of being
+         * freed, their memory is kept in a per thread free list and reused by the next ones.
+         */
+        static void* operator new(std::size_t size);
+        static void operator delete(void* ptr, std::size_t size);
+
         ODPacket mPacket;
 
         static std::string typeString(ServerNotificationType type);
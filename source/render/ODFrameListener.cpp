@@ -236,6 +236,16 @@ bool ODFrameListener::frameRenderingQueued(const Ogre::FrameEvent& evt)
         return mContinue;
     }
 
+    // The server sends the movements of the entities shown by the camera more often than the others
+    if(ODClient::getSingleton().isConnected())
+    {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+        mCameraManager->getViewedTiles(minX, minY, maxX, maxY);
+        ODClient::getSingleton().setInterestArea(InterestArea(minX, minY, maxX, maxY));
+    }
 
     ODClient::getSingleton().processClientSocketMessages(*mGameMap);
     ODClient::getSingleton().processClientNotifications();
@@ -20,6 +20,7 @@
 #include "entities/Creature.h"
 #include "entities/SmallSpiderEntity.h"
 #include "entities/Tile.h"
+#include "game/Seat.h"
 #include "gamemap/GameMap.h"
 #include "network/ODServer.h"
 #include "network/ServerNotification.h"
@@ -140,7 +141,7 @@ void RoomCrypt::doUpkeep()
         p.second.second = -1;
 
         int32_t maxCreatures = ConfigManager::getSingleton().getMaxCreaturesPerSeat();
-        int32_t numCreatures = getGameMap()->getCreaturesBySeat(getSeat()).size();
+        int32_t numCreatures = getSeat()->getLedger().getNbCreatures();
         int32_t cryptPointsForSpawn = ConfigManager::getSingleton().getRoomConfigInt32("CryptPointsForSpawn");
         if((numCreatures < maxCreatures) &&
            (mRottenPoints >= cryptPointsForSpawn))
@@ -31,7 +31,8 @@ static const int maxGoldinTile = 5000;
 
 RoomTreasury::RoomTreasury(GameMap* gameMap) :
     Room(gameMap),
-    mGoldChanged(false)
+    mGoldChanged(false),
+    mTotalGold(0)
 {
     setMeshName("Treasury");
 }
@@ -63,7 +64,9 @@ void RoomTreasury::absorbRoom(Room *r)
         int gold = p.second;
         mGoldInTile[tile] = gold;
     }
+    mTotalGold += rt->mTotalGold;
     rt->mGoldInTile.clear();
+    rt->mTotalGold = 0;
 
     for(std::pair<Tile* const, std::string>& p : rt->mMeshOfTile)
     {
@@ -108,6 +111,7 @@ bool RoomTreasury::removeCoveredTile(Tile* t)
             obj->createMesh();
             obj->setPosition(spawnPosition, false);
         }
+        mTotalGold -= value;
         mGoldInTile.erase(t);
     }
     mMeshOfTile.erase(t);
@@ -115,16 +119,6 @@ bool RoomTreasury::removeCoveredTile(Tile* t)
     return Room::removeCoveredTile(t);
 }
 
-int RoomTreasury::getTotalGold()
-{
-    int tempInt = 0;
-
-    for (std::pair<Tile* const, int>& p : mGoldInTile)
-        tempInt += p.second;
-
-    return tempInt;
-}
-
 int RoomTreasury::emptyStorageSpace()
 {
     return numCoveredTiles() * maxGoldinTile - getTotalGold();
@@ -156,6 +150,7 @@ int RoomTreasury::depositGold(int gold, Tile *tile)
     // Return the amount we were actually able to deposit
     // (i.e. the amount we wanted to deposit minus the amount we were unable to deposit).
     int wasDeposited = gold - goldToDeposit;
+    mTotalGold += wasDeposited;
     // If we couldn't deposit anything, we do not notify
     if(wasDeposited == 0)
         return wasDeposited;
@@ -209,6 +204,7 @@ int RoomTreasury::withdrawGold(int gold)
         }
     }
 
+    mTotalGold -= withdrawlAmount;
     return withdrawlAmount;
 }
 
@@ -36,7 +36,9 @@ public:
     bool removeCoveredTile(Tile* t);
 
     // Functions specific to this class.
-    int getTotalGold();
+    inline int getTotalGold() const
+    { return mTotalGold; }
+
     int emptyStorageSpace();
     int depositGold(int gold, Tile *tile);
     int withdrawGold(int gold);
@@ -59,6 +61,10 @@ private:
     std::map<Tile*, int> mGoldInTile;
     std::map<Tile*, std::string> mMeshOfTile;
     bool mGoldChanged;
+
+    //! \brief Sum of mGoldInTile. Updated each time gold is added or removed so that it can be read
+    //! without going through the tiles
+    int mTotalGold;
 };
 
 #endif // ROOMTREASURY_H
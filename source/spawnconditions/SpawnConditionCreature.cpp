@@ -15,7 +15,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "entities/Creature.h"
+#include "game/Seat.h"
 
 #include "gamemap/GameMap.h"
 
@@ -23,13 +23,7 @@
 
 bool SpawnConditionCreature::computePointsForSeat(GameMap* gameMap, Seat* seat, int32_t& computedPoints) const
 {
-    int32_t nbCreatures = 0;
-    std::vector<Creature*> creatures = gameMap->getCreaturesBySeat(seat);
-    for(Creature* creature : creatures)
-    {
-        if(creature->getDefinition() == mCreatureDefinition)
-            ++nbCreatures;
-    }
+    int32_t nbCreatures = seat->getLedger().getNbCreatures(mCreatureDefinition);
     if(nbCreatures < mNbCreatureMin)
         return false;
 
@@ -0,0 +1,794 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the time spent computing visible tiles with FieldOfView and with the algorithm
+// previously used by TileContainer::visibleTiles on all the levels shipped with the game.
+// Usage: FieldOfViewBenchmark [levels list file]
+
+#include "gamemap/FieldOfView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const int MIN_RADIUS = 5;
+static const int MAX_RADIUS = 20;
+
+//! \brief Maximum number of viewer positions tested per level and radius
+static const uint32_t MAX_VIEWERS = 400;
+
+class TestMap
+{
+public:
+    int mSizeX = 0;
+    int mSizeY = 0;
+    std::vector<bool> mOpaque;
+
+    //! \brief Returns the index of the given cell or -1 if it is not on the map
+    int getCell(int x, int y) const
+    {
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return -1;
+
+        return x * mSizeY + y;
+    }
+
+    bool isOpaque(int cell) const
+    { return mOpaque[cell]; }
+};
+
+//! \brief Reads the tiles of a level file the same way MapLoader does. Tiles that are
+//! not in the file are full dirt. Water and lava tiles never block vision.
+static bool loadLevelTiles(const std::string& fileName, TestMap& map)
+{
+    std::ifstream levelFile(fileName.c_str());
+    if(!levelFile.good())
+        return false;
+
+    std::vector<std::string> values;
+    std::string line;
+    bool isInTiles = false;
+    while(std::getline(levelFile, line))
+    {
+        std::string::size_type comment = line.find('#');
+        if(comment != std::string::npos)
+            line = line.substr(0, comment);
+
+        std::stringstream ss(line);
+        std::string value;
+        if(!(ss >> value))
+            continue;
+
+        if(value == "[Tiles]")
+        {
+            isInTiles = true;
+            continue;
+        }
+        if(!isInTiles)
+            continue;
+        if(value == "[/Tiles]")
+            break;
+
+        values.clear();
+        values.push_back(value);
+        while(ss >> value)
+            values.push_back(value);
+
+        if(map.mSizeX == 0)
+        {
+            map.mSizeX = std::stoi(values[0]);
+            continue;
+        }
+        if(map.mSizeY == 0)
+        {
+            map.mSizeY = std::stoi(values[0]);
+            map.mOpaque.assign(map.mSizeX * map.mSizeY, true);
+            continue;
+        }
+
+        if(values.size() < 4)
+            return false;
+
+        // Values from Tile::TileType
+        int type = std::stoi(values[2]);
+        bool isWaterOrLava = (type == 4) || (type == 5);
+        int cell = map.getCell(std::stoi(values[0]), std::stoi(values[1]));
+        if(cell < 0)
+            return false;
+
+        map.mOpaque[cell] = !isWaterOrLava && (std::stod(values[3]) > 0.0);
+    }
+
+    return !map.mOpaque.empty();
+}
+
+//! \brief The algorithm previously used by TileContainer::visibleTiles. For each tile, the part
+//! hidden by closer tiles is precomputed and a tile is visible if less than half of it is hidden.
+class ReferenceVisibility
+{
+public:
+    ReferenceVisibility() :
+        mTileDistanceComputed(0)
+    {
+    }
+
+class TileDistance
+{
+public:
+    enum TileDistanceType
+    {
+        Horizontal,
+        Diagonal,
+        Other
+    };
+
+    TileDistance(int diffX, int diffY, TileDistanceType type, int distSquared):
+        mDiffX(diffX),
+        mDiffY(diffY),
+        mType(type),
+        mDistSquared(distSquared)
+    {
+    }
+
+    inline int getDiffX() const
+    { return mDiffX; }
+
+    inline int getDiffY() const
+    { return mDiffY; }
+
+    inline TileDistanceType getType() const
+    { return mType; }
+
+    inline int getDistSquared() const
+    { return mDistSquared; }
+
+    void computeTileDistances(double coefNorth, double coefSouth, const TileDistance& tileDistance,
+        uint32_t indexTileDistance)
+    {
+        // A tile can only hide tiles behind (x > tile.x and y > tile.y)
+        if(tileDistance.getDiffX() < getDiffX())
+            return;
+        if(tileDistance.getDiffY() < getDiffY())
+            return;
+
+        // We don't want a tile to hide itself
+        if((tileDistance.getDiffX() == getDiffX()) &&
+           (tileDistance.getDiffY() == getDiffY()))
+        {
+            return;
+        }
+
+        if(getType() == TileDistance::TileDistanceType::Horizontal)
+        {
+            // For horizontal tiles, we hide following tiles (x > tile.x). But we process
+            // north tiles normally
+            if(tileDistance.getType() == TileDistance::TileDistanceType::Horizontal)
+            {
+                addHiddenTileSouth(indexTileDistance, 1.0);
+                return;
+            }
+
+            double xTileDeb = static_cast<double>(tileDistance.getDiffX()) - 0.5;
+            double xTileEnd = xTileDeb + 1.0;
+            double yTileDeb = static_cast<double>(tileDistance.getDiffY()) - 0.5;
+            double yTileEnd = yTileDeb + 1.0;
+            double yHideDebNorth = coefNorth * xTileDeb;
+            double yHideEndNorth = coefNorth * xTileEnd;
+
+            // If the tile is over the North ray, it is not hidden
+            if(yHideEndNorth <= yTileDeb)
+                return;
+
+            // We check which part of the tile is hidden
+            if((yHideDebNorth >= yTileDeb) &&
+               (yHideEndNorth <= yTileEnd))
+            {
+                // The ray hits the left side of the tile and the right side.
+                // The south part is partially hidden
+                double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
+                hiddenArea += yHideDebNorth - yTileDeb;
+                addHiddenTileSouth(indexTileDistance, hiddenArea);
+            }
+            else if((yHideDebNorth < yTileDeb) &&
+                    (yHideEndNorth > yTileDeb))
+            {
+                // The ray hits the bottom side of the tile but hits the right side. We compute
+                // the south visible part
+                double xHit = yTileDeb / coefNorth;
+                double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+                addHiddenTileSouth(indexTileDistance, hiddenArea);
+            }
+            else if((yHideDebNorth < yTileEnd) &&
+                    (yHideEndNorth > yTileEnd))
+            {
+                // The ray hits the left side of the tile but is over the right side. We compute
+                // the hidden part on north.
+                double xHit = yTileEnd / coefNorth;
+                double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
+                addHiddenTileSouth(indexTileDistance, 1.0 - visibleArea);
+            }
+            else
+            {
+                // The entire tile is hidden
+                addHiddenTileSouth(indexTileDistance, 1.0);
+            }
+
+            return;
+        }
+
+        double xTileDeb = static_cast<double>(tileDistance.getDiffX()) - 0.5;
+        double xTileEnd = xTileDeb + 1.0;
+        double yTileDeb = static_cast<double>(tileDistance.getDiffY()) - 0.5;
+        double yTileEnd = yTileDeb + 1.0;
+
+        // We check if the current tile is hidden by the tile. To consider that the
+        // tile is hidden by the south, as we know the angle will be between 0 and 45 degrees,
+        // we consider that the tile has to be hit by the ray passing through the hiding tile
+        // on the left side of the tile (otherwise, the hidden part will be too small).
+        double yHideDebSouth = coefSouth * xTileDeb;
+        double yHideEndSouth = coefSouth * xTileEnd;
+        double yHideDebNorth = coefNorth * xTileDeb;
+        double yHideEndNorth = coefNorth * xTileEnd;
+        // We check if at least a part of the tile is hidden
+        if((yHideDebSouth < yTileEnd) &&
+           (yHideEndNorth > yTileDeb))
+        {
+            // At least a part of this tile is hidden
+            if((yHideDebSouth >= yTileDeb) &&
+               (yHideEndSouth <= yTileEnd))
+            {
+                // The ray hits the left side of the tile and the right side.
+                // The south part is partially hidden
+                // The visible part is composed from a square between the tile inferior part and
+                // the triangle made by the ray
+                double visibleArea = (yHideEndSouth - yHideDebSouth) / 2.0;
+                visibleArea += yHideDebSouth - yTileDeb;
+                addHiddenTileNorth(indexTileDistance, 1.0 - visibleArea);
+            }
+            else if((yHideDebSouth < yTileDeb) &&
+                    (yHideEndSouth > yTileDeb))
+            {
+                // The ray hits the bottom side of the tile but hits the right side. We compute
+                // the south visible part
+                double xHit = yTileDeb / coefSouth;
+                double visibleArea = (yHideEndSouth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+                addHiddenTileNorth(indexTileDistance, 1.0 - visibleArea);
+            }
+            else if((yHideDebSouth < yTileEnd) &&
+                    (yHideEndSouth > yTileEnd))
+            {
+                // The ray hits the left side of the tile but is over the right side. We compute
+                // the hidden part on north.
+                double xHit = yTileEnd / coefSouth;
+                double hiddenArea = (yTileEnd - yHideDebSouth) * (xHit - xTileDeb) / 2.0;
+                addHiddenTileNorth(indexTileDistance, hiddenArea);
+
+            }
+            else if((yHideDebNorth >= yTileDeb) &&
+               (yHideEndNorth <= yTileEnd))
+            {
+                double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
+                hiddenArea += yHideDebNorth - yTileDeb;
+                addHiddenTileSouth(indexTileDistance, hiddenArea);
+            }
+            else if((yHideDebNorth < yTileDeb) &&
+                    (yHideEndNorth > yTileDeb))
+            {
+                // The ray hits the bottom side of the tile but hits the right side. We compute
+                // the south visible part
+                double xHit = yTileDeb / coefNorth;
+                double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+                addHiddenTileSouth(indexTileDistance, hiddenArea);
+            }
+            else if((yHideDebNorth < yTileEnd) &&
+                    (yHideEndNorth > yTileEnd))
+            {
+                // The ray hits the left side of the tile but is over the right side. We compute
+                // the hidden part on north.
+                double xHit = yTileEnd / coefNorth;
+                double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
+                addHiddenTileSouth(indexTileDistance, 1.0 - visibleArea);
+            }
+            else
+            {
+                // The entire tile is hidden
+                addHiddenTileSouth(indexTileDistance, 1.0);
+            }
+        }
+    }
+
+
+    const std::vector<std::pair<uint32_t, double>>& getHiddenTilesNorth() const
+    {
+        return mHiddenTilesNorth;
+    }
+
+    const std::vector<std::pair<uint32_t, double>>& getHiddenTilesSouth() const
+    {
+        return mHiddenTilesSouth;
+    }
+
+private:
+    void addHiddenTileNorth(uint32_t indexTile, double hiddenPercent)
+    {
+        mHiddenTilesNorth.push_back(std::pair<uint32_t, double>(indexTile, hiddenPercent));
+    }
+
+    void addHiddenTileSouth(uint32_t indexTile, double hiddenPercent)
+    {
+        mHiddenTilesSouth.push_back(std::pair<uint32_t, double>(indexTile, hiddenPercent));
+    }
+
+    int mDiffX;
+    int mDiffY;
+    TileDistanceType mType;
+    int mDistSquared;
+    std::vector<std::pair<uint32_t, double>> mHiddenTilesNorth;
+    std::vector<std::pair<uint32_t, double>> mHiddenTilesSouth;
+};
+
+class TileDistanceProcess
+{
+public:
+    TileDistanceProcess(const TileDistance& tileDistance, int cell):
+        mTileDistance(tileDistance),
+        mCell(cell),
+        mHiddenValueNorth(0.0),
+        mHiddenValueSouth(0.0)
+    {
+    }
+
+    inline const TileDistance& getTileDistance() const
+    {
+        return mTileDistance;
+    }
+
+    void addHiddenValueNorth(double val)
+    {
+        // We only add the highest value
+        if(val <= mHiddenValueNorth)
+            return;
+
+        mHiddenValueNorth = val;
+    }
+
+    void addHiddenValueSouth(double val)
+    {
+        // We only add the highest value
+        if(val <= mHiddenValueSouth)
+            return;
+
+        mHiddenValueSouth = val;
+    }
+
+    inline bool isTileVisible() const
+    {
+        return (mHiddenValueNorth + mHiddenValueSouth) <= 0.5;
+    }
+
+    inline double getHiddenValueNorth() const
+    {
+        return mHiddenValueNorth;
+    }
+
+    inline double getHiddenValueSouth() const
+    {
+        return mHiddenValueSouth;
+    }
+
+    inline int getCell() const
+    {
+        return mCell;
+    }
+
+private:
+    const TileDistance& mTileDistance;
+    int mCell;
+    double mHiddenValueNorth;
+    double mHiddenValueSouth;
+};
+
+    void buildTileDistance(int distance)
+    {
+        if(mTileDistanceComputed >= distance)
+            return;
+
+        // We want to be able to fill a vector of tiles sorted beginning with the closest tile. If we look a grid (each letter
+        // represents a tile at the same distance from the center: a):
+        // jihghij
+        // ifedefi
+        // hecbceh
+        // gdbabdg
+        // hecbceh
+        // ifedefi
+        // jihghij
+        // We can see that there are 3 kind of tiles:
+        // - Vertical/Horizontal tiles (abdg): at each distance, there are 4 of them
+        // - Diagonal tiles (acfj): at each distance, there are 4 of them
+        // - Other tiles (ehi...): at each distance, there are 8 of them
+        // Moreover, we can see a symmetry. We can compute all tiles by computing only 1/8 tiles:
+        //    j
+        //   fi
+        //  ceh
+        // abdg
+
+        // If we compute only the minimum tiles needed, we have no vertical tiles (since each of them can be deduced from the horizontal)
+        // To compute tiles easily, we will compute the 1/8 tiles until distance. Then, we will sort the tiles to begin with
+        // closest distance until farthest
+        mTileDistance.clear();
+        for(int y = 0; y <= distance; ++y)
+        {
+            for(int x = y; x <= distance; ++x)
+            {
+                TileDistance::TileDistanceType type;
+                if(y == 0)
+                {
+                    type = TileDistance::TileDistanceType::Horizontal;
+                }
+                else if(x == y)
+                {
+                    type = TileDistance::TileDistanceType::Diagonal;
+                }
+                else
+                {
+                    type = TileDistance::TileDistanceType::Other;
+                }
+                int distSquared = x * x + y * y;
+                mTileDistance.push_back(TileDistance(x, y, type, distSquared));
+            }
+        }
+
+        std::sort(mTileDistance.begin(), mTileDistance.end(), sortByDistSquared);
+
+        // We have filled the tile distance vector. Now, we fill how each tile hides the
+        // other ones when they mask vision to help calculate visible tiles
+        for(TileDistance& tileDistance : mTileDistance)
+        {
+            // We dont process the first tile
+            if(tileDistance.getDiffX() == 0 && tileDistance.getDiffY() == 0)
+                continue;
+
+            // Other tiles can hide with their down side and their up side other tiles
+            // or diagonal tiles (but not Horizontal tiles)
+            // We compute the tiles hidden from the south. In this case, only tiles with
+            // x > tile.x can be hidden
+            double coefNorth = (static_cast<double>(tileDistance.getDiffY()) + 0.5) / (static_cast<double>(tileDistance.getDiffX()) - 0.5);
+            double coefSouth = (static_cast<double>(tileDistance.getDiffY()) - 0.5) / (static_cast<double>(tileDistance.getDiffX()) + 0.5);
+            for(uint32_t index = 0; index < mTileDistance.size(); ++index)
+            {
+                const TileDistance& tileDistance2 = mTileDistance[index];
+                tileDistance.computeTileDistances(coefNorth, coefSouth, tileDistance2, index);
+            }
+        }
+
+        mTileDistanceComputed = distance;
+    }
+
+    void visibleCells(const TestMap& map, int x, int y, int radius, std::vector<uint32_t>& cells)
+    {
+        // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
+        // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
+        cells.clear();
+
+        if(radius > mTileDistanceComputed)
+            buildTileDistance(radius);
+
+        int radiusSquared = radius * radius;
+
+        // To have all the tiles around, we process mTileDistance 8 times.
+        // Because of the symetry, there will be some duplicates (horizontal and diagonal
+        // tiles). We will process in, this order (c being the starting tile):
+        // 514
+        // 2c0
+        // 637
+        // Then, we will have to merge diagonal/horizontal tiles
+        // Because we want the index to be correct, we will add tiles even when null in tilesProcess
+        std::vector<TileDistanceProcess> tilesProcess[8];
+        for(uint32_t k = 0; k < 8; ++k)
+        {
+            for(const TileDistance& tileDist : mTileDistance)
+            {
+                if(tileDist.getDistSquared() > radiusSquared)
+                    break;
+
+                switch(k)
+                {
+                    case 0:
+                    {
+                        int tile = map.getCell(x + tileDist.getDiffX(), y + tileDist.getDiffY());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 1:
+                    {
+                        int tile = map.getCell(x + tileDist.getDiffY(), y - tileDist.getDiffX());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 2:
+                    {
+                        int tile = map.getCell(x - tileDist.getDiffX(), y - tileDist.getDiffY());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 3:
+                    {
+                        int tile = map.getCell(x - tileDist.getDiffY(), y + tileDist.getDiffX());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 4:
+                    {
+                        int tile = map.getCell(x + tileDist.getDiffY(), y + tileDist.getDiffX());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 5:
+                    {
+                        int tile = map.getCell(x + tileDist.getDiffX(), y - tileDist.getDiffY());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 6:
+                    {
+                        int tile = map.getCell(x - tileDist.getDiffY(), y - tileDist.getDiffX());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    case 7:
+                    {
+                        int tile = map.getCell(x - tileDist.getDiffX(), y + tileDist.getDiffY());
+                        tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+
+        // The array of tiles is filled. Now, we apply the visibility.
+        for(uint32_t k = 0; k < 8; ++k)
+        {
+            for(TileDistanceProcess& tileDistanceProcess : tilesProcess[k])
+            {
+                if(tileDistanceProcess.getCell() < 0)
+                    continue;
+
+                if(!map.isOpaque(tileDistanceProcess.getCell()))
+                    continue;
+
+                // The tile hides vision. We process tiles it hides
+                for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesNorth())
+                {
+                    // mTileDistance might be bigger than the actual vector because it can include tiles
+                    // farther than the ones currently computed (for example if sight < computedSight)
+                    if(p.first >= tilesProcess[k].size())
+                        continue;
+
+                    tilesProcess[k][p.first].addHiddenValueNorth(p.second);
+                }
+                for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesSouth())
+                {
+                    // mTileDistance might be bigger than the actual vector because it can include tiles
+                    // farther than the ones currently computed (for example if sight < computedSight)
+                    if(p.first >= tilesProcess[k].size())
+                        continue;
+
+                    tilesProcess[k][p.first].addHiddenValueSouth(p.second);
+                }
+            }
+        }
+
+        // Now, we process all the tiles. Note that horizontal tiles are common for 2 consecutive
+        // vectors in tilesProcess and that diagonal tiles should be merged.
+        // The 8 vectors have the same size
+        for(uint32_t i = 0; i < tilesProcess[0].size(); ++i)
+        {
+            for(uint32_t k = 0; k < 8; ++k)
+            {
+                TileDistanceProcess& tileDistanceProcess = tilesProcess[k][i];
+                if(tileDistanceProcess.getCell() < 0)
+                    continue;
+
+                // Because horizontal tiles are common, we don't process them for the 4 last vectors
+                if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Horizontal) &&
+                   (k > 3))
+                {
+                    continue;
+                }
+
+                // Diagonal tiles need to be merged (because south hiding and north hiding are not
+                // computed within the same array). They will be processed for k < 4
+                if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal) &&
+                   (k > 3))
+                {
+                    continue;
+                }
+
+                if(tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal)
+                {
+                    // We merge diagonal tiles. Because they are inverted, south hidden value becomes north and vice-versa
+                    TileDistanceProcess& tileDistanceProcess2 = tilesProcess[k + 4][i];
+                    tileDistanceProcess.addHiddenValueNorth(tileDistanceProcess2.getHiddenValueSouth());
+                    tileDistanceProcess.addHiddenValueSouth(tileDistanceProcess2.getHiddenValueNorth());
+                }
+
+                if(!tileDistanceProcess.isTileVisible())
+                    continue;
+
+                cells.push_back(tileDistanceProcess.getCell());
+            }
+        }
+    }
+private:
+    std::vector<TileDistance> mTileDistance;
+    int mTileDistanceComputed;
+
+    static bool sortByDistSquared(const TileDistance& tileDist1, const TileDistance& tileDist2)
+    {
+        return tileDist1.getDistSquared() < tileDist2.getDistSquared();
+    }
+};
+
+class BenchmarkResult
+{
+public:
+    BenchmarkResult() :
+        mNbCalls(0),
+        mReferenceMicroseconds(0),
+        mFieldOfViewMicroseconds(0),
+        mReferenceCells(0),
+        mFieldOfViewCells(0),
+        mCommonCells(0)
+    {
+    }
+
+    uint64_t mNbCalls;
+    uint64_t mReferenceMicroseconds;
+    uint64_t mFieldOfViewMicroseconds;
+    uint64_t mReferenceCells;
+    uint64_t mFieldOfViewCells;
+    uint64_t mCommonCells;
+};
+
+static uint64_t microsecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmarkLevel(const TestMap& map, std::vector<BenchmarkResult>& results)
+{
+    FieldOfView fieldOfView;
+    fieldOfView.setMapSize(map.mSizeX, map.mSizeY);
+    std::vector<int> viewers;
+    for(int x = 0; x < map.mSizeX; ++x)
+    {
+        for(int y = 0; y < map.mSizeY; ++y)
+        {
+            int cell = map.getCell(x, y);
+            fieldOfView.setOpaque(x, y, map.isOpaque(cell));
+            if(!map.isOpaque(cell))
+                viewers.push_back(cell);
+        }
+    }
+
+    // We keep viewers spread over the whole map
+    uint32_t step = std::max(1u, static_cast<uint32_t>(viewers.size()) / MAX_VIEWERS);
+
+    ReferenceVisibility reference;
+    std::vector<uint32_t> referenceCells;
+    std::vector<uint32_t> fieldOfViewCells;
+    for(int radius = MIN_RADIUS; radius <= MAX_RADIUS; ++radius)
+    {
+        BenchmarkResult& result = results[radius - MIN_RADIUS];
+        // We compute once before timing so that the precomputed tables are not counted
+        reference.visibleCells(map, 0, 0, radius, referenceCells);
+        fieldOfView.compute(0, 0, radius, fieldOfViewCells);
+
+        for(uint32_t i = 0; i < viewers.size(); i += step)
+        {
+            int x = viewers[i] / map.mSizeY;
+            int y = viewers[i] % map.mSizeY;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            reference.visibleCells(map, x, y, radius, referenceCells);
+            result.mReferenceMicroseconds += microsecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            fieldOfView.compute(x, y, radius, fieldOfViewCells);
+            result.mFieldOfViewMicroseconds += microsecondsSince(start);
+
+            ++result.mNbCalls;
+            result.mReferenceCells += referenceCells.size();
+            result.mFieldOfViewCells += fieldOfViewCells.size();
+            std::sort(referenceCells.begin(), referenceCells.end());
+            std::sort(fieldOfViewCells.begin(), fieldOfViewCells.end());
+            std::vector<uint32_t> common;
+            std::set_intersection(referenceCells.begin(), referenceCells.end(),
+                fieldOfViewCells.begin(), fieldOfViewCells.end(), std::back_inserter(common));
+            result.mCommonCells += common.size();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string levelsList = OD_TEST_LEVELS_LIST;
+    if(argc > 1)
+        levelsList = argv[1];
+
+    std::ifstream levelsFile(levelsList.c_str());
+    if(!levelsFile.good())
+    {
+        std::cerr << "Cannot open levels list " << levelsList << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results(MAX_RADIUS - MIN_RADIUS + 1);
+    uint32_t nbLevels = 0;
+    std::string levelFileName;
+    while(std::getline(levelsFile, levelFileName))
+    {
+        if(levelFileName.empty())
+            continue;
+
+        TestMap map;
+        if(!loadLevelTiles(levelFileName, map))
+        {
+            std::cerr << "Cannot load level " << levelFileName << std::endl;
+            return 1;
+        }
+
+        benchmarkLevel(map, results);
+        ++nbLevels;
+    }
+
+    std::cout << "Visible tiles computed on " << nbLevels << " levels" << std::endl;
+    std::cout << "radius  calls  reference(us/call)  fieldOfView(us/call)  speedup  reference(tiles)  fieldOfView(tiles)  common(%)" << std::endl;
+    for(int radius = MIN_RADIUS; radius <= MAX_RADIUS; ++radius)
+    {
+        const BenchmarkResult& result = results[radius - MIN_RADIUS];
+        if(result.mNbCalls == 0)
+            continue;
+
+        double nbCalls = static_cast<double>(result.mNbCalls);
+        double referenceTime = static_cast<double>(result.mReferenceMicroseconds) / nbCalls;
+        double fieldOfViewTime = static_cast<double>(result.mFieldOfViewMicroseconds) / nbCalls;
+        double speedup = (result.mFieldOfViewMicroseconds == 0) ? 0.0 :
+            static_cast<double>(result.mReferenceMicroseconds) / static_cast<double>(result.mFieldOfViewMicroseconds);
+        uint64_t nbCells = std::max(result.mReferenceCells, result.mFieldOfViewCells);
+        double common = (nbCells == 0) ? 100.0 : 100.0 * static_cast<double>(result.mCommonCells) / static_cast<double>(nbCells);
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(6) << radius
+            << std::setw(7) << result.mNbCalls
+            << std::setw(20) << referenceTime
+            << std::setw(22) << fieldOfViewTime
+            << std::setw(9) << speedup
+            << std::setw(18) << static_cast<double>(result.mReferenceCells) / nbCalls
+            << std::setw(20) << static_cast<double>(result.mFieldOfViewCells) / nbCalls
+            << std::setw(11) << common << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/EntityChunkIndex.h"
+
+#define BOOST_TEST_MODULE EntityChunkIndex
+#include "BoostTestTargetConfig.h"
+
+static const uint32_t CREATURE = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::creature);
+static const uint32_t BUILDING = EntityChunkIndex::getCategoryBit(EntityChunkIndex::Category::building);
+
+BOOST_AUTO_TEST_CASE(test_AddAndRemove)
+{
+    // 20 x 13 so that the last chunks are not full
+    EntityChunkIndex index;
+    index.setMapSize(20, 13);
+    index.add(EntityChunkIndex::Category::creature, 2, 3, 4);
+    index.add(EntityChunkIndex::Category::creature, 2, 7, 7);
+    index.add(EntityChunkIndex::Category::building, 5, 19, 12);
+    index.add(EntityChunkIndex::Category::creature, 1, 20, 0);
+    BOOST_CHECK(index.getCount(EntityChunkIndex::Category::creature, 2, 0, 0) == 2);
+    BOOST_CHECK(index.hasEntityInChunk(CREATURE, EntityChunkIndex::getSeatSlotBit(2), 5, 5));
+    BOOST_CHECK(!index.hasEntityInChunk(BUILDING, EntityChunkIndex::ALL_SEATS, 5, 5));
+    BOOST_CHECK(!index.hasEntityInChunk(CREATURE, EntityChunkIndex::getSeatSlotBit(1), 5, 5));
+    BOOST_CHECK(index.hasEntityInChunk(BUILDING, EntityChunkIndex::getSeatSlotBit(5), 16, 8));
+
+    // The mask is cleared only when the last entity of the slot leaves the chunk
+    index.remove(EntityChunkIndex::Category::creature, 2, 3, 4);
+    BOOST_CHECK(index.hasEntityInChunk(CREATURE, EntityChunkIndex::getSeatSlotBit(2), 0, 0));
+    index.remove(EntityChunkIndex::Category::creature, 2, 7, 7);
+    BOOST_CHECK(!index.hasEntityInChunk(CREATURE, EntityChunkIndex::ALL_SEATS, 0, 0));
+    index.remove(EntityChunkIndex::Category::creature, 2, 7, 7);
+    BOOST_CHECK(index.getCount(EntityChunkIndex::Category::creature, 2, 0, 0) == 0);
+
+    index.clear();
+    BOOST_CHECK(!index.hasEntityInChunk(BUILDING, EntityChunkIndex::ALL_SEATS, 16, 8));
+}
+
+BOOST_AUTO_TEST_CASE(test_Radius)
+{
+    EntityChunkIndex index;
+    index.setMapSize(64, 64);
+    index.add(EntityChunkIndex::Category::creature, 3, 30, 30);
+    uint64_t seatMask = EntityChunkIndex::getSeatSlotBit(3);
+
+    // Chunk (3, 3) covers tiles 24 to 31
+    BOOST_CHECK(index.hasEntityInRadius(CREATURE, seatMask, 20, 20, 4));
+    BOOST_CHECK(!index.hasEntityInRadius(CREATURE, seatMask, 20, 20, 3));
+    BOOST_CHECK(index.hasEntityInRadius(CREATURE, seatMask, 0, 63, 40));
+    BOOST_CHECK(!index.hasEntityInRadius(CREATURE | BUILDING, ~seatMask, 30, 30, 10));
+    BOOST_CHECK(!index.hasEntityInRadius(CREATURE, seatMask, 30, 30, -1));
+
+    // High slots and entities without seat share the last slot
+    index.add(EntityChunkIndex::Category::building, 200, 60, 60);
+    BOOST_CHECK(index.getCount(EntityChunkIndex::Category::building, EntityChunkIndex::NO_SEAT_SLOT, 60, 60) == 1);
+    BOOST_CHECK(index.hasEntityInRadius(BUILDING, EntityChunkIndex::getSeatSlotBit(EntityChunkIndex::NO_SEAT_SLOT),
+        63, 63, 2));
+}
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/EntityRegistry.h"
+
+#define BOOST_TEST_MODULE EntityRegistry
+#include "BoostTestTargetConfig.h"
+
+// The registry only stores pointers so we do not need real entities
+static int dummyEntities[3];
+static GameEntity* const entityA = reinterpret_cast<GameEntity*>(&dummyEntities[0]);
+static GameEntity* const entityB = reinterpret_cast<GameEntity*>(&dummyEntities[1]);
+static GameEntity* const entityC = reinterpret_cast<GameEntity*>(&dummyEntities[2]);
+
+BOOST_AUTO_TEST_CASE(test_Handles)
+{
+    EntityRegistry registry;
+    uint32_t handleA = registry.createHandle(entityA);
+    uint32_t handleB = registry.createHandle(entityB);
+    BOOST_CHECK(handleA != EntityRegistry::INVALID_HANDLE);
+    BOOST_CHECK(handleB != EntityRegistry::INVALID_HANDLE);
+    BOOST_CHECK(handleA != handleB);
+
+    // Entities are only found when on map
+    BOOST_CHECK(registry.getEntity(handleA) == nullptr);
+    registry.setOnMap(handleA, true);
+    registry.setOnMap(handleB, true);
+    BOOST_CHECK(registry.getEntity(handleA) == entityA);
+    BOOST_CHECK(registry.getEntity(handleB) == entityB);
+    registry.setOnMap(handleA, false);
+    BOOST_CHECK(registry.getEntity(handleA) == nullptr);
+    registry.setOnMap(handleA, true);
+    BOOST_CHECK(registry.getEntity(handleA) == entityA);
+
+    // Once released, the handle is not valid anymore, even if the slot is reused
+    registry.releaseHandle(entityA, handleA);
+    BOOST_CHECK(registry.getEntity(handleA) == nullptr);
+    uint32_t handleC = registry.createHandle(entityC);
+    registry.setOnMap(handleC, true);
+    BOOST_CHECK(handleC != handleA);
+    BOOST_CHECK(registry.getEntity(handleA) == nullptr);
+    BOOST_CHECK(registry.getEntity(handleC) == entityC);
+
+    // Releasing with a wrong entity does nothing
+    registry.releaseHandle(entityA, handleC);
+    BOOST_CHECK(registry.getEntity(handleC) == entityC);
+
+    // After clear, the old handles are not valid
+    registry.clear();
+    BOOST_CHECK(registry.getEntity(handleB) == nullptr);
+    BOOST_CHECK(registry.getEntity(handleC) == nullptr);
+    uint32_t handleD = registry.createHandle(entityA);
+    BOOST_CHECK(handleD != handleB);
+    BOOST_CHECK(handleD != handleC);
+}
+
+BOOST_AUTO_TEST_CASE(test_UseHandle)
+{
+    // The client registry uses the handles of the server one
+    EntityRegistry server;
+    EntityRegistry client;
+    uint32_t handleA = server.createHandle(entityA);
+    uint32_t handleB = server.createHandle(entityB);
+    BOOST_CHECK(client.useHandle(entityB, handleB));
+    client.setOnMap(handleB, true);
+    BOOST_CHECK(client.getEntity(handleB) == entityB);
+    BOOST_CHECK(client.getEntity(handleA) == nullptr);
+
+    // Registering again the same entity is allowed (after being dropped for example)
+    BOOST_CHECK(client.useHandle(entityB, handleB));
+    BOOST_CHECK(client.getEntity(handleB) == entityB);
+
+    // A slot used by another entity is replaced
+    BOOST_CHECK(!client.useHandle(entityC, handleB));
+    client.setOnMap(handleB, true);
+    BOOST_CHECK(client.getEntity(handleB) == entityC);
+
+    // Once released on both sides, the new handle of the slot can be used by the client
+    server.releaseHandle(entityA, handleA);
+    uint32_t handleC = server.createHandle(entityC);
+    BOOST_CHECK(client.useHandle(entityC, handleC));
+    client.setOnMap(handleC, true);
+    BOOST_CHECK(client.getEntity(handleC) == entityC);
+    BOOST_CHECK(client.getEntity(handleA) == nullptr);
+
+    // The client can still create its own handles without using the server slots
+    uint32_t handleOther = client.createHandle(entityA);
+    BOOST_CHECK(handleOther != handleB);
+    BOOST_CHECK(handleOther != handleC);
+}
+
+BOOST_AUTO_TEST_CASE(test_Names)
+{
+    EntityRegistry registry;
+    registry.addName("Kobold_1", entityA);
+    registry.addName("Room_Treasury_2", entityB);
+    BOOST_CHECK(registry.getEntity("Kobold_1") == entityA);
+    BOOST_CHECK(registry.getEntity("Room_Treasury_2") == entityB);
+    BOOST_CHECK(registry.getEntity("Kobold_2") == nullptr);
+
+    // Only the entity with the name can remove it
+    registry.removeName("Kobold_1", entityB);
+    BOOST_CHECK(registry.getEntity("Kobold_1") == entityA);
+    registry.removeName("Kobold_1", entityA);
+    BOOST_CHECK(registry.getEntity("Kobold_1") == nullptr);
+}
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/EntitySnapshot.h"
+#include "network/ODPacket.h"
+
+#define BOOST_TEST_MODULE EntitySnapshot
+#include "BoostTestTargetConfig.h"
+
+// Handles as given by EntityRegistry (slot index in the low bits, generation in the high bits)
+static const uint32_t KOBOLD = (1 << 20) | 0;
+static const uint32_t TROLL = (3 << 20) | 1;
+static const uint32_t IMP = (1 << 20) | 2;
+
+BOOST_AUTO_TEST_CASE(test_RoundTrip)
+{
+    EntitySnapshotEncoder encoder;
+    EntitySnapshotDecoder decoder;
+    std::vector<EntitySnapshotChange> changes;
+
+    // First snapshot: the handles and animations are new
+    {
+        encoder.clearDestinations(KOBOLD);
+        encoder.addDestination(KOBOLD, Ogre::Vector3(10, 12, 0));
+        encoder.addDestination(KOBOLD, Ogre::Vector3(11, 12, 0));
+        encoder.setAnimationState(KOBOLD, "Walk", true, true, Ogre::Vector3(1, 0, 0));
+        encoder.setMoveSpeed(KOBOLD, 1.5);
+        encoder.setLevel(TROLL, 4);
+        encoder.addDestination(TROLL, Ogre::Vector3(3.5, 2.25, 0));
+        BOOST_CHECK(encoder.hasPendingChanges());
+
+        ODPacket packet;
+        encoder.writeSnapshot(packet);
+        BOOST_CHECK(!encoder.hasPendingChanges());
+        BOOST_CHECK(decoder.readSnapshot(packet, changes));
+        BOOST_REQUIRE(changes.size() == 2);
+
+        const EntitySnapshotChange& kobold = changes[0];
+        BOOST_CHECK(kobold.mHandle == KOBOLD);
+        BOOST_CHECK(kobold.mClearDestinations);
+        BOOST_REQUIRE(kobold.mDestinations.size() == 2);
+        BOOST_CHECK(kobold.mDestinations[0] == Ogre::Vector3(10, 12, 0));
+        BOOST_CHECK(kobold.mDestinations[1] == Ogre::Vector3(11, 12, 0));
+        BOOST_CHECK(kobold.mHasAnimation);
+        BOOST_CHECK(kobold.mAnimationState == "Walk");
+        BOOST_CHECK(kobold.mAnimationLoop);
+        BOOST_CHECK(kobold.mHasWalkDirection);
+        BOOST_CHECK(kobold.mWalkDirection == Ogre::Vector3(1, 0, 0));
+        BOOST_CHECK(kobold.mHasMoveSpeed);
+        BOOST_CHECK(kobold.mMoveSpeed == 1.5);
+        BOOST_CHECK(!kobold.mHasLevel);
+
+        const EntitySnapshotChange& troll = changes[1];
+        BOOST_CHECK(troll.mHandle == TROLL);
+        BOOST_CHECK(!troll.mClearDestinations);
+        BOOST_REQUIRE(troll.mDestinations.size() == 1);
+        BOOST_CHECK(troll.mDestinations[0] == Ogre::Vector3(3.5, 2.25, 0));
+        BOOST_CHECK(!troll.mHasAnimation);
+        BOOST_CHECK(troll.mHasLevel);
+        BOOST_CHECK(troll.mLevel == 4);
+    }
+
+    // Second snapshot: the known handles and the values equal to the baselines are not sent
+    // but the decoder should give the same values
+    {
+        encoder.setLevel(TROLL, 4);
+        encoder.setAnimationState(KOBOLD, "Walk", true, true, Ogre::Vector3(1, 0, 0));
+        encoder.setMoveSpeed(KOBOLD, 1.5);
+        encoder.addDestination(KOBOLD, Ogre::Vector3(11, 13, 0));
+        encoder.setAnimationState(IMP, "Dig", false, false, Ogre::Vector3::ZERO);
+
+        ODPacket packet;
+        encoder.writeSnapshot(packet);
+        BOOST_CHECK(decoder.readSnapshot(packet, changes));
+        BOOST_REQUIRE(changes.size() == 3);
+
+        BOOST_CHECK(changes[0].mHandle == TROLL);
+        BOOST_CHECK(changes[0].mHasLevel);
+        BOOST_CHECK(changes[0].mLevel == 4);
+
+        BOOST_CHECK(changes[1].mHandle == KOBOLD);
+        BOOST_CHECK(!changes[1].mClearDestinations);
+        BOOST_REQUIRE(changes[1].mDestinations.size() == 1);
+        BOOST_CHECK(changes[1].mDestinations[0] == Ogre::Vector3(11, 13, 0));
+        BOOST_CHECK(changes[1].mAnimationState == "Walk");
+        BOOST_CHECK(changes[1].mWalkDirection == Ogre::Vector3(1, 0, 0));
+        BOOST_CHECK(changes[1].mMoveSpeed == 1.5);
+
+        BOOST_CHECK(changes[2].mHandle == IMP);
+        BOOST_CHECK(changes[2].mAnimationState == "Dig");
+        BOOST_CHECK(!changes[2].mAnimationLoop);
+        BOOST_CHECK(!changes[2].mHasWalkDirection);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_MergedEvents)
+{
+    EntitySnapshotEncoder encoder;
+    EntitySnapshotDecoder decoder;
+    std::vector<EntitySnapshotChange> changes;
+
+    // The destinations added before a clear are dropped and only the last animation is kept
+    encoder.addDestination(KOBOLD, Ogre::Vector3(1, 1, 0));
+    encoder.setAnimationState(KOBOLD, "Walk", true, true, Ogre::Vector3(0, 1, 0));
+    encoder.clearDestinations(KOBOLD);
+    encoder.addDestination(KOBOLD, Ogre::Vector3(2, 1, 0));
+    encoder.setAnimationState(KOBOLD, "Idle", true, false, Ogre::Vector3::ZERO);
+
+    ODPacket packet;
+    encoder.writeSnapshot(packet);
+    BOOST_CHECK(decoder.readSnapshot(packet, changes));
+    BOOST_REQUIRE(changes.size() == 1);
+    BOOST_CHECK(changes[0].mClearDestinations);
+    BOOST_REQUIRE(changes[0].mDestinations.size() == 1);
+    BOOST_CHECK(changes[0].mDestinations[0] == Ogre::Vector3(2, 1, 0));
+    BOOST_CHECK(changes[0].mAnimationState == "Idle");
+    // The direction set by the first animation is kept
+    BOOST_CHECK(changes[0].mHasWalkDirection);
+    BOOST_CHECK(changes[0].mWalkDirection == Ogre::Vector3(0, 1, 0));
+
+    // An empty snapshot is valid
+    ODPacket emptyPacket;
+    encoder.writeSnapshot(emptyPacket);
+    BOOST_CHECK(decoder.readSnapshot(emptyPacket, changes));
+    BOOST_CHECK(changes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_DeferredChanges)
+{
+    EntitySnapshotEncoder encoder;
+    EntitySnapshotDecoder decoder;
+    std::vector<EntitySnapshotChange> changes;
+
+    // The kobold is the first entity indexed but, as its change is deferred, the troll is sent first
+    encoder.addDestination(KOBOLD, Ogre::Vector3(1, 1, 0));
+    encoder.addDestination(TROLL, Ogre::Vector3(5, 5, 0));
+    BOOST_REQUIRE(encoder.getNbPendingChanges() == 2);
+    BOOST_CHECK(encoder.getPendingChangeHandle(0) == KOBOLD);
+    encoder.setPendingChangeDeferred(0, true);
+    BOOST_CHECK(encoder.hasChangesToWrite());
+    {
+        ODPacket packet;
+        encoder.writeSnapshot(packet);
+        BOOST_CHECK(decoder.readSnapshot(packet, changes));
+        BOOST_REQUIRE(changes.size() == 1);
+        BOOST_CHECK(changes[0].mHandle == TROLL);
+    }
+
+    // The deferred change is still pending and the next events are merged into it
+    BOOST_CHECK(encoder.hasPendingChanges());
+    BOOST_REQUIRE(encoder.getNbPendingChanges() == 1);
+    encoder.setPendingChangeDeferred(0, true);
+    BOOST_CHECK(!encoder.hasChangesToWrite());
+    encoder.clearDestinations(KOBOLD);
+    encoder.addDestination(KOBOLD, Ogre::Vector3(2, 1, 0));
+    encoder.addDestination(IMP, Ogre::Vector3(7, 7, 0));
+    encoder.setPendingChangeDeferred(0, false);
+    BOOST_CHECK(encoder.hasChangesToWrite());
+    {
+        ODPacket packet;
+        encoder.writeSnapshot(packet);
+        BOOST_CHECK(!encoder.hasPendingChanges());
+        BOOST_CHECK(decoder.readSnapshot(packet, changes));
+        BOOST_REQUIRE(changes.size() == 2);
+        BOOST_CHECK(changes[0].mHandle == KOBOLD);
+        BOOST_CHECK(changes[0].mClearDestinations);
+        BOOST_REQUIRE(changes[0].mDestinations.size() == 1);
+        BOOST_CHECK(changes[0].mDestinations[0] == Ogre::Vector3(2, 1, 0));
+        BOOST_CHECK(changes[1].mHandle == IMP);
+    }
+
+    // Entities already sent keep their index
+    encoder.addDestination(TROLL, Ogre::Vector3(6, 5, 0));
+    encoder.addDestination(KOBOLD, Ogre::Vector3(3, 1, 0));
+    {
+        ODPacket packet;
+        encoder.writeSnapshot(packet);
+        BOOST_CHECK(decoder.readSnapshot(packet, changes));
+        BOOST_REQUIRE(changes.size() == 2);
+        BOOST_CHECK(changes[0].mHandle == TROLL);
+        BOOST_CHECK(changes[0].mDestinations[0] == Ogre::Vector3(6, 5, 0));
+        BOOST_CHECK(changes[1].mHandle == KOBOLD);
+        BOOST_CHECK(changes[1].mDestinations[0] == Ogre::Vector3(3, 1, 0));
+    }
+}
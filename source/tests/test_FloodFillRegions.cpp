@@ -0,0 +1,442 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FloodFillRegions.h"
+
+#define BOOST_TEST_MODULE FloodFillRegions
+#include "BoostTestTargetConfig.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Values from Tile::TileType and Tile::FloodFillType
+enum TestTileType { dirt = 1, gold = 2, rock = 3, water = 4, lava = 5, claimed = 6 };
+enum TestFloodFillType { ground = 0, groundWater, groundLava, groundWaterLava, floodFillTypeMax };
+
+class TestTile
+{
+public:
+    TestTile() :
+        mType(dirt),
+        mFullness(100.0)
+    {
+        for(int i = 0; i < floodFillTypeMax; ++i)
+            mColors[i] = -1;
+    }
+
+    int mType;
+    double mFullness;
+    int mColors[floodFillTypeMax];
+};
+
+class TestMap
+{
+public:
+    int mSizeX = 0;
+    int mSizeY = 0;
+    std::vector<TestTile> mTiles;
+
+    TestTile& tile(int x, int y)
+    { return mTiles[x * mSizeY + y]; }
+
+    void neighbors(int x, int y, std::vector<TestTile*>& neighs)
+    {
+        neighs.clear();
+        if(x > 0)
+            neighs.push_back(&tile(x - 1, y));
+        if(y > 0)
+            neighs.push_back(&tile(x, y - 1));
+        if(x < mSizeX - 1)
+            neighs.push_back(&tile(x + 1, y));
+        if(y < mSizeY - 1)
+            neighs.push_back(&tile(x, y + 1));
+    }
+};
+
+//! \brief Reads the tiles of a level file the same way MapLoader does. Tiles that are
+//! not in the file are full dirt.
+static bool loadLevelTiles(const std::string& fileName, TestMap& map)
+{
+    std::ifstream levelFile(fileName.c_str());
+    if(!levelFile.good())
+        return false;
+
+    std::vector<std::string> values;
+    std::string line;
+    bool isInTiles = false;
+    while(std::getline(levelFile, line))
+    {
+        std::string::size_type comment = line.find('#');
+        if(comment != std::string::npos)
+            line = line.substr(0, comment);
+
+        std::stringstream ss(line);
+        std::string value;
+        if(!(ss >> value))
+            continue;
+
+        if(value == "[Tiles]")
+        {
+            isInTiles = true;
+            continue;
+        }
+        if(!isInTiles)
+            continue;
+        if(value == "[/Tiles]")
+            break;
+
+        values.clear();
+        values.push_back(value);
+        while(ss >> value)
+            values.push_back(value);
+
+        if(map.mSizeX == 0)
+        {
+            map.mSizeX = std::stoi(values[0]);
+            continue;
+        }
+        if(map.mSizeY == 0)
+        {
+            map.mSizeY = std::stoi(values[0]);
+            map.mTiles.assign(map.mSizeX * map.mSizeY, TestTile());
+            continue;
+        }
+
+        if(values.size() < 4)
+            return false;
+
+        TestTile& tile = map.tile(std::stoi(values[0]), std::stoi(values[1]));
+        tile.mType = std::stoi(values[2]);
+        if((tile.mType == water) || (tile.mType == lava))
+            tile.mFullness = 0.0;
+        else
+            tile.mFullness = std::stod(values[3]);
+    }
+
+    return !map.mTiles.empty();
+}
+
+static bool isPassable(const TestTile& tile, int floodFillType)
+{
+    if(tile.mFullness > 0.0)
+        return false;
+
+    switch(tile.mType)
+    {
+        case dirt:
+        case gold:
+        case claimed:
+            return true;
+        case water:
+            return (floodFillType == groundWater) || (floodFillType == groundWaterLava);
+        case lava:
+            return (floodFillType == groundLava) || (floodFillType == groundWaterLava);
+        default:
+            return false;
+    }
+}
+
+static bool isFloodFillFilled(const TestTile& tile)
+{
+    if(tile.mFullness > 0.0)
+        return true;
+
+    switch(tile.mType)
+    {
+        case dirt:
+        case gold:
+        case claimed:
+            return (tile.mColors[ground] != -1) && (tile.mColors[groundWater] != -1) &&
+                (tile.mColors[groundLava] != -1) && (tile.mColors[groundWaterLava] != -1);
+        case water:
+            return (tile.mColors[groundWater] != -1) && (tile.mColors[groundWaterLava] != -1);
+        case lava:
+            return (tile.mColors[groundLava] != -1) && (tile.mColors[groundWaterLava] != -1);
+        default:
+            return true;
+    }
+}
+
+static void copyColor(TestTile& tile, const TestTile& neigh, int floodFillType, bool& hasChanged)
+{
+    if((tile.mColors[floodFillType] == -1) && (neigh.mColors[floodFillType] != -1))
+    {
+        tile.mColors[floodFillType] = neigh.mColors[floodFillType];
+        hasChanged = true;
+    }
+}
+
+//! \brief The flood fill previously used by GameMap::doFloodFill
+static bool doReferenceFloodFill(TestMap& map, int x, int y)
+{
+    TestTile& tile = map.tile(x, y);
+    if(isFloodFillFilled(tile))
+        return false;
+
+    bool hasChanged = false;
+    std::vector<TestTile*> neighs;
+    map.neighbors(x, y, neighs);
+    for(TestTile* neigh : neighs)
+    {
+        switch(neigh->mType)
+        {
+            case dirt:
+            case gold:
+            case claimed:
+                for(int i = 0; i < floodFillTypeMax; ++i)
+                    copyColor(tile, *neigh, i, hasChanged);
+                break;
+            case water:
+                copyColor(tile, *neigh, groundWater, hasChanged);
+                copyColor(tile, *neigh, groundWaterLava, hasChanged);
+                break;
+            case lava:
+                copyColor(tile, *neigh, groundLava, hasChanged);
+                copyColor(tile, *neigh, groundWaterLava, hasChanged);
+                break;
+            default:
+                break;
+        }
+    }
+    return hasChanged;
+}
+
+//! \brief The flood fill previously used by GameMap::enableFloodFill
+static void computeReferenceFloodFill(TestMap& map)
+{
+    int currentType = ground;
+    int floodFillValue = 0;
+    while(true)
+    {
+        int yy = 0;
+        bool isTileFound = false;
+        while(!isTileFound && (yy < map.mSizeY))
+        {
+            for(int xx = 0; xx < map.mSizeX; ++xx)
+            {
+                TestTile& tile = map.tile(xx, yy);
+                if(tile.mFullness > 0.0)
+                    continue;
+
+                if((currentType == ground) && (tile.mColors[ground] == -1) &&
+                   ((tile.mType == dirt) || (tile.mType == gold) || (tile.mType == claimed)))
+                {
+                    isTileFound = true;
+                    for(int i = 0; i < floodFillTypeMax; ++i)
+                    {
+                        if(tile.mColors[i] == -1)
+                            tile.mColors[i] = ++floodFillValue;
+                    }
+                    break;
+                }
+                if((currentType == groundWater) && (tile.mColors[groundWater] == -1) &&
+                   (tile.mType == water))
+                {
+                    isTileFound = true;
+                    tile.mColors[groundWater] = ++floodFillValue;
+                    if(tile.mColors[groundWaterLava] == -1)
+                        tile.mColors[groundWaterLava] = ++floodFillValue;
+                    break;
+                }
+                if((currentType == groundLava) && (tile.mColors[groundLava] == -1) &&
+                   (tile.mType == lava))
+                {
+                    isTileFound = true;
+                    tile.mColors[groundLava] = ++floodFillValue;
+                    if(tile.mColors[groundWaterLava] == -1)
+                        tile.mColors[groundWaterLava] = ++floodFillValue;
+                    break;
+                }
+            }
+
+            if(!isTileFound)
+                ++yy;
+        }
+
+        if(!isTileFound)
+        {
+            if(currentType == groundLava)
+                break;
+
+            ++currentType;
+            continue;
+        }
+
+        while(yy < map.mSizeY)
+        {
+            int nbTiles = 0;
+            for(int xx = 0; xx < map.mSizeX; ++xx)
+            {
+                if(doReferenceFloodFill(map, xx, yy))
+                    ++nbTiles;
+            }
+
+            if(nbTiles > 0)
+            {
+                for(int xx = map.mSizeX - 1; xx >= 0; --xx)
+                {
+                    if(doReferenceFloodFill(map, xx, yy))
+                        ++nbTiles;
+                }
+            }
+
+            if((nbTiles > 0) && (yy > 0))
+                --yy;
+            else
+                ++yy;
+        }
+    }
+}
+
+static std::vector<bool> computePassable(TestMap& map, int floodFillType)
+{
+    std::vector<bool> passable(map.mTiles.size(), false);
+    for(uint32_t i = 0; i < map.mTiles.size(); ++i)
+        passable[i] = isPassable(map.mTiles[i], floodFillType);
+    return passable;
+}
+
+//! \brief Checks that the passable tiles are split the same way in both labellings
+static bool isSamePartition(const std::vector<bool>& passable, const std::vector<int>& colors1,
+    const std::vector<int>& colors2)
+{
+    std::map<int, int> oneToTwo;
+    std::map<int, int> twoToOne;
+    for(uint32_t i = 0; i < passable.size(); ++i)
+    {
+        if(!passable[i])
+            continue;
+
+        if((colors1[i] == -1) || (colors2[i] == -1))
+            return false;
+
+        auto it1 = oneToTwo.find(colors1[i]);
+        if(it1 == oneToTwo.end())
+            oneToTwo[colors1[i]] = colors2[i];
+        else if(it1->second != colors2[i])
+            return false;
+
+        auto it2 = twoToOne.find(colors2[i]);
+        if(it2 == twoToOne.end())
+            twoToOne[colors2[i]] = colors1[i];
+        else if(it2->second != colors1[i])
+            return false;
+    }
+    return true;
+}
+
+static std::vector<std::string> getLevelFiles()
+{
+    std::vector<std::string> levels;
+    std::ifstream listFile(OD_TEST_LEVELS_LIST);
+    std::string line;
+    while(std::getline(listFile, line))
+    {
+        if(!line.empty())
+            levels.push_back(line);
+    }
+    return levels;
+}
+
+BOOST_AUTO_TEST_CASE(test_FloodFillRegions_Levels)
+{
+    std::vector<std::string> levels = getLevelFiles();
+    BOOST_REQUIRE(!levels.empty());
+    for(const std::string& level : levels)
+    {
+        BOOST_TEST_MESSAGE("Checking " + level);
+        TestMap map;
+        BOOST_REQUIRE(loadLevelTiles(level, map));
+        computeReferenceFloodFill(map);
+
+        for(int type = 0; type < floodFillTypeMax; ++type)
+        {
+            std::vector<bool> passable = computePassable(map, type);
+            std::vector<int> referenceColors(map.mTiles.size());
+            for(uint32_t i = 0; i < map.mTiles.size(); ++i)
+                referenceColors[i] = map.mTiles[i].mColors[type];
+
+            FloodFillRegions regions;
+            std::vector<int> colors;
+            regions.computeRegions(passable, map.mSizeX, map.mSizeY, colors);
+            BOOST_CHECK_MESSAGE(isSamePartition(passable, referenceColors, colors),
+                level + " type=" + std::to_string(type));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_FloodFillRegions_Merge)
+{
+    std::vector<std::string> levels = getLevelFiles();
+    BOOST_REQUIRE(!levels.empty());
+    for(const std::string& level : levels)
+    {
+        TestMap map;
+        BOOST_REQUIRE(loadLevelTiles(level, map));
+
+        for(int type = 0; type < floodFillTypeMax; ++type)
+        {
+            FloodFillRegions regions;
+            std::vector<int> colors;
+            regions.computeRegions(computePassable(map, type), map.mSizeX, map.mSizeY, colors);
+            for(uint32_t i = 0; i < map.mTiles.size(); ++i)
+                map.mTiles[i].mColors[type] = colors[i];
+
+            // We dig every full dirt tile next to an open one, like GameMap::refreshFloodFill does
+            TestMap dugMap = map;
+            std::vector<TestTile*> neighs;
+            for(int xx = 0; xx < dugMap.mSizeX; ++xx)
+            {
+                for(int yy = 0; yy < dugMap.mSizeY; ++yy)
+                {
+                    TestTile& tile = dugMap.tile(xx, yy);
+                    if((tile.mType != dirt) || (tile.mFullness == 0.0))
+                        continue;
+
+                    tile.mFullness = 0.0;
+                    dugMap.neighbors(xx, yy, neighs);
+                    for(TestTile* neigh : neighs)
+                    {
+                        if((neigh->mColors[type] == -1) || !isPassable(*neigh, type))
+                            continue;
+
+                        if(tile.mColors[type] == -1)
+                            tile.mColors[type] = neigh->mColors[type];
+                        else
+                            regions.mergeColors(tile.mColors[type], neigh->mColors[type]);
+                    }
+                    if(tile.mColors[type] == -1)
+                        tile.mColors[type] = regions.newColor();
+                }
+            }
+
+            std::vector<bool> passable = computePassable(dugMap, type);
+            std::vector<int> mergedRegions(dugMap.mTiles.size());
+            for(uint32_t i = 0; i < dugMap.mTiles.size(); ++i)
+                mergedRegions[i] = regions.getRegion(dugMap.mTiles[i].mColors[type]);
+
+            FloodFillRegions expectedRegions;
+            std::vector<int> expectedColors;
+            expectedRegions.computeRegions(passable, dugMap.mSizeX, dugMap.mSizeY, expectedColors);
+            BOOST_CHECK_MESSAGE(isSamePartition(passable, expectedColors, mergedRegions),
+                level + " type=" + std::to_string(type));
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/LZCodec.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE LZCodec
+#include "BoostTestTargetConfig.h"
+
+//! \brief Compresses and decompresses the given data and checks it is unchanged. Returns the compressed size.
+static uint32_t checkRoundTrip(LZCodec& codec, const std::vector<char>& data)
+{
+    std::vector<char> compressed;
+    codec.compress(data.data(), data.size(), compressed);
+    std::vector<char> decompressed;
+    BOOST_CHECK(LZCodec::decompress(compressed.data(), compressed.size(), data.size(), decompressed));
+    BOOST_CHECK(decompressed == data);
+    return compressed.size();
+}
+
+BOOST_AUTO_TEST_CASE(test_RoundTrip)
+{
+    LZCodec codec;
+
+    // Small inputs are stored as literals
+    std::vector<char> data;
+    checkRoundTrip(codec, data);
+    std::string text("OpenDungeons");
+    data.assign(text.begin(), text.end());
+    checkRoundTrip(codec, data);
+
+    // Repeated messages, like the ones sent every turn, are compressed
+    data.clear();
+    for(int32_t i = 0; i < 200; ++i)
+    {
+        std::string message = "turnStarted creature_" + std::to_string(i % 10) + " moves to tile";
+        data.insert(data.end(), message.begin(), message.end());
+    }
+    BOOST_CHECK(checkRoundTrip(codec, data) < data.size() / 4);
+
+    // A single repeated byte makes matches overlapping the bytes they produce and lengths longer than 255
+    data.assign(5000, 'x');
+    BOOST_CHECK(checkRoundTrip(codec, data) < 100);
+
+    // Data that cannot be compressed grows a little
+    data.clear();
+    uint32_t seed = 12345;
+    for(int32_t i = 0; i < 100000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        data.push_back(static_cast<char>(seed >> 24));
+    }
+    BOOST_CHECK(checkRoundTrip(codec, data) <= data.size() + data.size() / 255 + 16);
+
+    // Matches are not searched further than the maximum offset
+    std::vector<char> block(data.begin(), data.begin() + 1000);
+    data.insert(data.end(), block.begin(), block.end());
+    checkRoundTrip(codec, data);
+}
+
+BOOST_AUTO_TEST_CASE(test_InvalidData)
+{
+    LZCodec codec;
+    std::vector<char> data(1000, 'a');
+    std::string text("some text to compress, some text to compress");
+    data.insert(data.end(), text.begin(), text.end());
+    std::vector<char> compressed;
+    codec.compress(data.data(), data.size(), compressed);
+
+    std::vector<char> out;
+    // Wrong uncompressed size
+    BOOST_CHECK(!LZCodec::decompress(compressed.data(), compressed.size(), data.size() - 1, out));
+    BOOST_CHECK(!LZCodec::decompress(compressed.data(), compressed.size(), data.size() + 1, out));
+
+    // Every truncation is detected
+    for(uint32_t size = 0; size < compressed.size(); ++size)
+        BOOST_CHECK(!LZCodec::decompress(compressed.data(), size, data.size(), out));
+
+    // A match cannot refer to data before the beginning: a token with no literal and a match
+    std::vector<char> invalid = { 0x00, 0x01, 0x00, 0x00 };
+    BOOST_CHECK(!LZCodec::decompress(invalid.data(), invalid.size(), 4, out));
+}
+
+BOOST_AUTO_TEST_CASE(test_Stats)
+{
+    LZCodecStats stats;
+    stats.add(1000, 250, 10);
+    LZCodecStats other;
+    other.add(1000, 250, 30);
+    stats.add(other);
+    BOOST_CHECK(stats.getNbRawBytes() == 2000);
+    BOOST_CHECK(stats.getNbStoredBytes() == 500);
+    BOOST_CHECK(stats.getTimeUs() == 40);
+    BOOST_CHECK(stats.getReport(4).find("ratio 4.00") != std::string::npos);
+    stats.reset();
+    BOOST_CHECK(stats.getNbRawBytes() == 0);
+}
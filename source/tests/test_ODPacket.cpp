@@ -16,11 +16,49 @@
  */
 
 #include "network/ODPacket.h"
+#include "network/ODSendBuffer.h"
 #include <boost/mpl/map.hpp>
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
 #define BOOST_TEST_MODULE ODPacket
 #include "BoostTestTargetConfig.h"
 
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC does not know that the replaced operators below use malloc and free
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+//! \brief Number of calls to operator new. Used to check that the packets do not allocate memory
+static uint64_t nbAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    ++nbAllocations;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(test_ODPacket)
 {
     //Test input/output
@@ -55,3 +93,353 @@ BOOST_AUTO_TEST_CASE(test_ODPacket)
 
     }
 }
+
+BOOST_AUTO_TEST_CASE(test_Envelope)
+{
+    ODSendBuffer sendBuffer;
+    ODPacket packet1;
+    const int32_t inInt = 42;
+    packet1 << inInt;
+    ODPacket packet2;
+    const std::string inString("envelope");
+    packet2 << inString;
+
+    // The envelope is only sent when closed
+    sendBuffer.addPacket(packet1);
+    sendBuffer.addPacket(packet2);
+    BOOST_CHECK(sendBuffer.getSizeToSend() == 0);
+    sendBuffer.closeEnvelope();
+    uint32_t size = sendBuffer.getSizeToSend();
+    BOOST_CHECK(size == sendBuffer.getNbPendingBytes());
+
+    // The envelope starts with its size like a SFML packet
+    const char* data = sendBuffer.getDataToSend();
+    uint32_t envelopeSize = 0;
+    for(uint32_t i = 0; i < 4; ++i)
+        envelopeSize = (envelopeSize << 8) | static_cast<uint8_t>(data[i]);
+    BOOST_CHECK(envelopeSize == size - 4);
+
+    // A partial send keeps the remaining bytes
+    std::vector<char> received(data, data + 3);
+    sendBuffer.consume(3);
+    BOOST_CHECK(sendBuffer.getSizeToSend() == size - 3);
+    data = sendBuffer.getDataToSend();
+    received.insert(received.end(), data, data + sendBuffer.getSizeToSend());
+    sendBuffer.consume(sendBuffer.getSizeToSend());
+    BOOST_CHECK(sendBuffer.getNbPendingBytes() == 0);
+
+    std::vector<char> envelope(received.begin() + 4, received.end());
+    uint32_t offset = 0;
+    ODPacket outPacket;
+    int32_t outInt = 0;
+    BOOST_CHECK(outPacket.readFromEnvelope(envelope.data(), envelope.size(), offset));
+    BOOST_CHECK(outPacket >> outInt);
+    BOOST_CHECK(outInt == inInt);
+    std::string outString;
+    BOOST_CHECK(outPacket.readFromEnvelope(envelope.data(), envelope.size(), offset));
+    BOOST_CHECK(outPacket >> outString);
+    BOOST_CHECK(outString == inString);
+    BOOST_CHECK(offset == envelope.size());
+
+    // A truncated envelope is detected
+    envelope.pop_back();
+    offset = 0;
+    BOOST_CHECK(outPacket.readFromEnvelope(envelope.data(), envelope.size(), offset));
+    BOOST_CHECK(!outPacket.readFromEnvelope(envelope.data(), envelope.size(), offset));
+}
+
+BOOST_AUTO_TEST_CASE(test_MaxPendingBytes)
+{
+    ODSendBuffer sendBuffer;
+    ODPacket packet;
+    std::vector<char> data(64 * 1024, 'a');
+    packet.append(data.data(), data.size());
+
+    // Packets are refused once the limit is reached, even if envelopes are closed
+    uint32_t nbPackets = 0;
+    while(sendBuffer.addPacket(packet))
+    {
+        ++nbPackets;
+        if(nbPackets % 10 == 0)
+            sendBuffer.closeEnvelope();
+    }
+    BOOST_CHECK(nbPackets > 0);
+    BOOST_CHECK(sendBuffer.getNbPendingBytes() <= ODSendBuffer::MAX_PENDING_BYTES);
+    BOOST_CHECK(sendBuffer.getNbPendingBytes() + packet.getDataSize() + 8 > ODSendBuffer::MAX_PENDING_BYTES);
+
+    // Sent bytes free some space
+    sendBuffer.closeEnvelope();
+    sendBuffer.consume(sendBuffer.getSizeToSend());
+    BOOST_CHECK(sendBuffer.addPacket(packet));
+}
+
+BOOST_AUTO_TEST_CASE(test_CompressedEnvelope)
+{
+    ODSendBuffer sendBuffer;
+    sendBuffer.setCompression(true);
+    ODPacket packet;
+    for(int32_t i = 0; i < 50; ++i)
+    {
+        packet.clear();
+        packet << std::string("creature moves") << i;
+        sendBuffer.addPacket(packet);
+    }
+    sendBuffer.closeEnvelope();
+
+    // The envelope is smaller than the packets it contains
+    const LZCodecStats& stats = sendBuffer.getCompressionStats();
+    BOOST_CHECK(stats.getNbStoredBytes() == sendBuffer.getSizeToSend());
+    BOOST_CHECK(stats.getNbStoredBytes() < stats.getNbRawBytes());
+
+    const char* data = sendBuffer.getDataToSend();
+    std::vector<char> frame(data + 4, data + sendBuffer.getSizeToSend());
+    std::vector<char> buffer;
+    ODPacket envelope;
+    BOOST_CHECK(ODSendBuffer::readFrame(frame.data(), frame.size(), buffer, envelope));
+    BOOST_CHECK(envelope.getDataSize() + 4 == stats.getNbRawBytes());
+    uint32_t offset = 0;
+    for(int32_t i = 0; i < 50; ++i)
+    {
+        std::string outString;
+        int32_t outInt = -1;
+        BOOST_CHECK(packet.readFromEnvelope(envelope.getData(), envelope.getDataSize(), offset));
+        BOOST_CHECK(packet >> outString >> outInt);
+        BOOST_CHECK(outInt == i);
+    }
+    BOOST_CHECK(offset == envelope.getDataSize());
+
+    // A corrupted envelope is refused
+    frame.pop_back();
+    BOOST_CHECK(!ODSendBuffer::readFrame(frame.data(), frame.size(), buffer, envelope));
+
+    // Small envelopes are sent as is
+    sendBuffer.consume(sendBuffer.getSizeToSend());
+    sendBuffer.resetCompressionStats();
+    packet.clear();
+    packet << static_cast<int32_t>(42);
+    sendBuffer.addPacket(packet);
+    sendBuffer.closeEnvelope();
+    BOOST_CHECK(stats.getNbStoredBytes() == stats.getNbRawBytes());
+    data = sendBuffer.getDataToSend();
+    BOOST_CHECK(ODSendBuffer::readFrame(data + 4, sendBuffer.getSizeToSend() - 4, buffer, envelope));
+    BOOST_CHECK(envelope.getDataSize() == sendBuffer.getSizeToSend() - 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_RoundTrip)
+{
+    ODPacket packet;
+    const bool inBool = true;
+    const int8_t inInt8 = -12;
+    const uint8_t inUInt8 = 250;
+    const int16_t inInt16 = -1234;
+    const uint16_t inUInt16 = 65000;
+    const int32_t inInt32 = -123456789;
+    const uint32_t inUInt32 = 4000000000u;
+    const int64_t inInt64 = -1234567890123456789LL;
+    const uint64_t inUInt64 = 18000000000000000000ULL;
+    const float inFloat = -3.25f;
+    const double inDouble = 1.0 / 3.0;
+    const char* inChars = "chars";
+    const std::string inString("string");
+    const wchar_t* inWChars = L"wchars";
+    const std::wstring inWString(L"wstring");
+    const Ogre::Vector3 inVector(1.5f, -2.25f, 3.0f);
+    packet << inBool << inInt8 << inUInt8 << inInt16 << inUInt16 << inInt32 << inUInt32
+        << inInt64 << inUInt64 << inFloat << inDouble << inChars << inString << inWChars
+        << inWString << inVector;
+
+    // Integers are written in network byte order
+    BOOST_CHECK(static_cast<uint8_t>(packet.getData()[3]) == 0xFB);
+    BOOST_CHECK(static_cast<uint8_t>(packet.getData()[4]) == 0x2E);
+
+    bool outBool = false;
+    int8_t outInt8 = 0;
+    uint8_t outUInt8 = 0;
+    int16_t outInt16 = 0;
+    uint16_t outUInt16 = 0;
+    int32_t outInt32 = 0;
+    uint32_t outUInt32 = 0;
+    int64_t outInt64 = 0;
+    uint64_t outUInt64 = 0;
+    float outFloat = 0;
+    double outDouble = 0;
+    char outChars[16];
+    std::string outString;
+    wchar_t outWChars[16];
+    std::wstring outWString;
+    Ogre::Vector3 outVector(0, 0, 0);
+    BOOST_CHECK(packet >> outBool >> outInt8 >> outUInt8 >> outInt16 >> outUInt16 >> outInt32
+        >> outUInt32 >> outInt64 >> outUInt64 >> outFloat >> outDouble >> outChars >> outString
+        >> outWChars >> outWString >> outVector);
+    BOOST_CHECK(outBool == inBool);
+    BOOST_CHECK(outInt8 == inInt8);
+    BOOST_CHECK(outUInt8 == inUInt8);
+    BOOST_CHECK(outInt16 == inInt16);
+    BOOST_CHECK(outUInt16 == inUInt16);
+    BOOST_CHECK(outInt32 == inInt32);
+    BOOST_CHECK(outUInt32 == inUInt32);
+    BOOST_CHECK(outInt64 == inInt64);
+    BOOST_CHECK(outUInt64 == inUInt64);
+    BOOST_CHECK(outFloat == inFloat);
+    BOOST_CHECK(outDouble == inDouble);
+    BOOST_CHECK(std::strcmp(outChars, inChars) == 0);
+    BOOST_CHECK(outString == inString);
+    BOOST_CHECK(std::wcscmp(outWChars, inWChars) == 0);
+    BOOST_CHECK(outWString == inWString);
+    BOOST_CHECK(outVector == inVector);
+
+    // Reading more than what was written invalidates the packet until it is cleared
+    BOOST_CHECK(!(packet >> outInt32));
+    BOOST_CHECK(!packet);
+    packet.clear();
+    BOOST_CHECK(packet);
+    BOOST_CHECK(packet.getDataSize() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_VarInt)
+{
+    const uint32_t values[] = { 0, 1, 127, 128, 16383, 16384, std::numeric_limits<uint32_t>::max() };
+    const uint32_t sizes[] = { 1, 1, 1, 2, 2, 3, 5 };
+    for(uint32_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        ODPacket packet;
+        packet.writeVarUInt(values[i]);
+        BOOST_CHECK(packet.getDataSize() == sizes[i]);
+        uint32_t value = 0;
+        BOOST_CHECK(packet.readVarUInt(value));
+        BOOST_CHECK(value == values[i]);
+    }
+
+    // Small negative values stay small
+    const int32_t signedValues[] = { 0, -1, 1, -64, 63, std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::max() };
+    ODPacket packet;
+    for(int32_t value : signedValues)
+        packet.writeVarInt(value);
+    BOOST_CHECK(packet.getDataSize() == 15);
+    for(int32_t value : signedValues)
+    {
+        int32_t outValue = 0;
+        BOOST_CHECK(packet.readVarInt(outValue));
+        BOOST_CHECK(outValue == value);
+    }
+
+    // A varint cannot be longer than 5 bytes
+    ODPacket invalid;
+    for(uint32_t i = 0; i < 6; ++i)
+        invalid << static_cast<uint8_t>(0xFF);
+    uint32_t value = 0;
+    BOOST_CHECK(!invalid.readVarUInt(value));
+    BOOST_CHECK(!invalid);
+}
+
+BOOST_AUTO_TEST_CASE(test_QuantizedVector3)
+{
+    const Ogre::Real step = 1.0f / 256.0f;
+    ODPacket packet;
+    const Ogre::Vector3 unit(1, 0, 0);
+    packet.writeQuantizedVector3(unit, step);
+    BOOST_CHECK(packet.getDataSize() < 12);
+    const Ogre::Vector3 inVector(0.3f, -2.7f, 5.001f);
+    packet.writeQuantizedVector3(inVector, step);
+
+    Ogre::Vector3 outVector(0, 0, 0);
+    BOOST_CHECK(packet.readQuantizedVector3(outVector, step));
+    BOOST_CHECK(outVector == unit);
+    BOOST_CHECK(packet.readQuantizedVector3(outVector, step));
+    BOOST_CHECK(std::fabs(outVector.x - inVector.x) <= step / 2);
+    BOOST_CHECK(std::fabs(outVector.y - inVector.y) <= step / 2);
+    BOOST_CHECK(std::fabs(outVector.z - inVector.z) <= step / 2);
+    BOOST_CHECK(!packet.readQuantizedVector3(outVector, step));
+}
+
+BOOST_AUTO_TEST_CASE(test_StringView)
+{
+    ODPacket packet;
+    const std::string inString("OpenDungeons");
+    const int32_t inInt = 7;
+    packet << inString << inInt;
+
+    const char* data = nullptr;
+    uint32_t size = 0;
+    BOOST_CHECK(packet.readStringView(data, size));
+    BOOST_CHECK(inString.compare(0, std::string::npos, data, size) == 0);
+    int32_t outInt = 0;
+    BOOST_CHECK(packet >> outInt);
+    BOOST_CHECK(outInt == inInt);
+
+    // The size is checked before pointing in the packet
+    ODPacket truncated;
+    truncated << static_cast<uint32_t>(100) << inInt;
+    BOOST_CHECK(!truncated.readStringView(data, size));
+    BOOST_CHECK(!truncated);
+}
+
+BOOST_AUTO_TEST_CASE(test_CopyAndSwap)
+{
+    ODPacket packet1;
+    const int32_t inInt = 1;
+    packet1 << inInt;
+    ODPacket packet2(packet1);
+    int32_t outInt = 0;
+    BOOST_CHECK(packet2 >> outInt);
+    BOOST_CHECK(outInt == inInt);
+
+    // The copy keeps reading where the source is
+    ODPacket packet3 = packet2;
+    BOOST_CHECK(!(packet3 >> outInt));
+
+    const std::string inString("swap");
+    ODPacket packet4;
+    packet4 << inString;
+    packet4.swap(packet1);
+    std::string outString;
+    BOOST_CHECK(packet1 >> outString);
+    BOOST_CHECK(outString == inString);
+    BOOST_CHECK(packet4 >> outInt);
+    BOOST_CHECK(outInt == inInt);
+}
+
+//! \brief Builds a packet like the server does for a notification and reads it back
+static uint32_t buildAndReadPacket(int32_t seed)
+{
+    ODPacket packet;
+    packet.reserve(256);
+    const std::string name("Kobold_12");
+    packet << seed << name;
+    for(int32_t i = 0; i < 32; ++i)
+        packet << i;
+    packet.writeVarUInt(static_cast<uint32_t>(seed));
+    packet.writeQuantizedVector3(Ogre::Vector3(0.5f, 0.25f, 0.0f), 1.0f / 256.0f);
+
+    ODPacket copy(packet);
+    int32_t result = 0;
+    const char* data;
+    uint32_t size;
+    copy >> result;
+    copy.readStringView(data, size);
+    return static_cast<uint32_t>(result) + size;
+}
+
+BOOST_AUTO_TEST_CASE(test_Allocations)
+{
+    const uint32_t NB_PACKETS = 100000;
+
+    // The first packets allocate the buffers that will be reused. We use the biggest seed
+    // so that the buffers do not have to grow for the longest varints
+    uint32_t total = 0;
+    for(int32_t i = 0; i < 10; ++i)
+        total += buildAndReadPacket(std::numeric_limits<int32_t>::max());
+
+    uint64_t nbAllocationsBefore = nbAllocations;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < NB_PACKETS; ++i)
+        total += buildAndReadPacket(static_cast<int32_t>(i));
+    uint64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    uint64_t nbPacketAllocations = nbAllocations - nbAllocationsBefore;
+
+    BOOST_TEST_MESSAGE("Built, copied and read " << 2 * NB_PACKETS << " packets in " << duration
+        << " us with " << nbPacketAllocations << " allocations (check=" << total << ")");
+    BOOST_CHECK(nbPacketAllocations == 0);
+}
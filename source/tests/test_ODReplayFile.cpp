@@ -0,0 +1,172 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/ODReplayFile.h"
+#include "network/ServerNotification.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#define BOOST_TEST_MODULE ODReplayFile
+#include "BoostTestTargetConfig.h"
+
+static const std::string REPLAY_FILE = "test_ODReplayFile.odr";
+static const std::string TRUNCATED_REPLAY_FILE = "test_ODReplayFile_truncated.odr";
+
+//! \brief Builds an envelope containing a chat message and, if turn is not negative, the start of turn
+static void buildEnvelope(ODPacket& envelope, int64_t turn)
+{
+    std::vector<char> buffer;
+    ODPacket message;
+    message << static_cast<int32_t>(ServerNotification::chat) << std::string("nick") << std::string("msg");
+    message.appendToEnvelope(buffer);
+    if(turn >= 0)
+    {
+        message.clear();
+        message << static_cast<int32_t>(ServerNotification::turnStarted) << turn;
+        message.appendToEnvelope(buffer);
+    }
+    envelope.clear();
+    envelope.append(buffer.data(), buffer.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_ReplayIndex)
+{
+    ODPacket envelope;
+    {
+        ODReplayWriter writer;
+        BOOST_CHECK(writer.open(REPLAY_FILE));
+        buildEnvelope(envelope, -1);
+        writer.writeEnvelope(0, envelope);
+        for(int64_t turn = 1; turn <= 10; ++turn)
+        {
+            buildEnvelope(envelope, turn);
+            writer.writeEnvelope(static_cast<int32_t>(turn * 100), envelope);
+        }
+        writer.close();
+    }
+
+    ODReplayReader reader;
+    BOOST_CHECK(reader.open(REPLAY_FILE));
+    const std::vector<ODReplayIndexEntry>& index = reader.getIndex();
+    BOOST_CHECK(index.size() == 10);
+    for(uint32_t i = 0; i < index.size(); ++i)
+    {
+        BOOST_CHECK(index[i].mTurn == i + 1);
+        BOOST_CHECK(index[i].mTimestamp == static_cast<int32_t>((i + 1) * 100));
+    }
+
+    // Every envelope is read back in order
+    BOOST_CHECK(reader.readEnvelope(envelope) == 0);
+    ODPacket expected;
+    buildEnvelope(expected, -1);
+    BOOST_CHECK(envelope.getDataSize() == expected.getDataSize());
+    for(int64_t turn = 1; turn <= 10; ++turn)
+    {
+        BOOST_CHECK(reader.readEnvelope(envelope) == turn * 100);
+        buildEnvelope(expected, turn);
+        BOOST_CHECK(envelope.getDataSize() == expected.getDataSize());
+        uint32_t offset = 0;
+        ODPacket message;
+        BOOST_CHECK(message.readFromEnvelope(envelope.getData(), envelope.getDataSize(), offset));
+        BOOST_CHECK(message.readFromEnvelope(envelope.getData(), envelope.getDataSize(), offset));
+        int32_t type = 0;
+        int64_t readTurn = 0;
+        BOOST_CHECK(message >> type >> readTurn);
+        BOOST_CHECK(readTurn == turn);
+    }
+    // The index is not read as an envelope
+    BOOST_CHECK(reader.readEnvelope(envelope) == -1);
+    reader.close();
+
+    // We simulate a crash while writing the replay: there is no index and the last envelope is truncated
+    std::ifstream is(REPLAY_FILE, std::ios::in | std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    is.close();
+    uint64_t indexOffset = 0;
+    for(uint32_t i = 8; i < 16; ++i)
+        indexOffset = (indexOffset << 8) | static_cast<uint8_t>(data[i]);
+    BOOST_CHECK(indexOffset < data.size());
+    data.resize(indexOffset - 3);
+    for(uint32_t i = 8; i < 16; ++i)
+        data[i] = 0;
+    std::ofstream os(TRUNCATED_REPLAY_FILE, std::ios::out | std::ios::binary);
+    os.write(data.data(), data.size());
+    os.close();
+
+    BOOST_CHECK(reader.open(TRUNCATED_REPLAY_FILE));
+    BOOST_CHECK(reader.getIndex().size() == 9);
+    BOOST_CHECK(reader.getIndex().back().mTurn == 9);
+    uint32_t nbEnvelopes = 0;
+    while(reader.readEnvelope(envelope) >= 0)
+        ++nbEnvelopes;
+    BOOST_CHECK(nbEnvelopes == 10);
+    reader.close();
+
+    // A file that is not a replay is refused
+    BOOST_CHECK(!reader.open("test_ODReplayFile_missing.odr"));
+    data.assign(32, 'x');
+    os.open(TRUNCATED_REPLAY_FILE, std::ios::out | std::ios::binary | std::ios::trunc);
+    os.write(data.data(), data.size());
+    os.close();
+    BOOST_CHECK(!reader.open(TRUNCATED_REPLAY_FILE));
+
+    std::remove(REPLAY_FILE.c_str());
+    std::remove(TRUNCATED_REPLAY_FILE.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_CompressedEnvelopes)
+{
+    // Big envelopes are compressed and small ones written as is
+    std::vector<ODPacket> envelopes(3);
+    buildEnvelope(envelopes[0], 1);
+    std::vector<char> buffer;
+    ODPacket message;
+    for(int32_t i = 0; i < 100; ++i)
+    {
+        message.clear();
+        message << static_cast<int32_t>(ServerNotification::chat) << std::string("nick") << i;
+        message.appendToEnvelope(buffer);
+    }
+    envelopes[1].append(buffer.data(), buffer.size());
+    buildEnvelope(envelopes[2], 2);
+
+    ODReplayWriter writer;
+    BOOST_CHECK(writer.open(REPLAY_FILE));
+    for(uint32_t i = 0; i < envelopes.size(); ++i)
+        writer.writeEnvelope(static_cast<int32_t>(i), envelopes[i]);
+    const LZCodecStats& stats = writer.getCompressionStats();
+    BOOST_CHECK(stats.getNbStoredBytes() < stats.getNbRawBytes());
+    writer.close();
+
+    ODReplayReader reader;
+    BOOST_CHECK(reader.open(REPLAY_FILE));
+    BOOST_CHECK(reader.getIndex().size() == 2);
+    ODPacket envelope;
+    for(uint32_t i = 0; i < envelopes.size(); ++i)
+    {
+        BOOST_CHECK(reader.readEnvelope(envelope) == static_cast<int32_t>(i));
+        BOOST_CHECK(envelope.getDataSize() == envelopes[i].getDataSize());
+        BOOST_CHECK(std::equal(envelope.getData(), envelope.getData() + envelope.getDataSize(),
+            envelopes[i].getData()));
+    }
+    BOOST_CHECK(reader.readEnvelope(envelope) == -1);
+    reader.close();
+
+    std::remove(REPLAY_FILE.c_str());
+}
@@ -20,8 +20,178 @@
 #define BOOST_TEST_MODULE Random
 #include "BoostTestTargetConfig.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
 BOOST_AUTO_TEST_CASE(test_Random)
 {
     Random::initialize();
     BOOST_CHECK (Random::Int(1, 2 ) <= 2);
 }
+
+BOOST_AUTO_TEST_CASE(test_Bounds)
+{
+    RandomGenerator generator;
+    generator.seed(42);
+    bool hasMin = false;
+    bool hasMax = false;
+    for(uint32_t i = 0; i < 10000; ++i)
+    {
+        int value = generator.Int(-3, 3);
+        BOOST_REQUIRE(value >= -3 && value <= 3);
+        hasMin |= (value == -3);
+        hasMax |= (value == 3);
+
+        // Swapped bounds
+        unsigned int uvalue = generator.Uint(10, 5);
+        BOOST_REQUIRE(uvalue >= 5 && uvalue <= 10);
+
+        double dvalue = generator.Double(-1.0, 1.0);
+        BOOST_REQUIRE(dvalue >= -1.0 && dvalue < 1.0);
+    }
+    BOOST_CHECK(hasMin && hasMax);
+
+    // Full ranges should not overflow
+    generator.Int(INT32_MIN, INT32_MAX);
+    generator.Uint(0, UINT32_MAX);
+    BOOST_CHECK_EQUAL(generator.Int(7, 7), 7);
+}
+
+BOOST_AUTO_TEST_CASE(test_Streams)
+{
+    // The same seed gives the same numbers
+    RandomGenerator generator1;
+    RandomGenerator generator2;
+    generator1.seed(1234);
+    generator2.seed(1234);
+    for(uint32_t i = 0; i < 100; ++i)
+        BOOST_REQUIRE_EQUAL(generator1.next(), generator2.next());
+
+    // The streams depend on the match seed, the type and the id
+    Random::initialize(1234);
+    BOOST_CHECK_EQUAL(Random::getMatchSeed(), 1234u);
+    uint64_t seatSeed = Random::getStreamSeed(Random::StreamType::seat, 1);
+    BOOST_CHECK_EQUAL(seatSeed, Random::getStreamSeed(Random::StreamType::seat, 1));
+    BOOST_CHECK(seatSeed != Random::getStreamSeed(Random::StreamType::seat, 2));
+    BOOST_CHECK(seatSeed != Random::getStreamSeed(Random::StreamType::creature, 1));
+    Random::initialize(1235);
+    BOOST_CHECK(seatSeed != Random::getStreamSeed(Random::StreamType::seat, 1));
+
+    // The functions of the namespace are seeded again when the match seed changes
+    Random::initialize(99);
+    std::vector<int> values;
+    for(uint32_t i = 0; i < 20; ++i)
+        values.push_back(Random::Int(0, 1000000));
+    Random::initialize(99);
+    for(uint32_t i = 0; i < 20; ++i)
+        BOOST_CHECK_EQUAL(Random::Int(0, 1000000), values[i]);
+}
+
+//! \brief Draws numbers on a new thread. If hasStream is true, the thread draws from the server stream
+static std::vector<uint32_t> drawOnThread(bool hasStream)
+{
+    std::vector<uint32_t> values;
+    std::thread worker([&values, hasStream]()
+    {
+        if(hasStream)
+            Random::setThreadStream(Random::StreamType::global, 0);
+
+        for(uint32_t i = 0; i < 20; ++i)
+            values.push_back(Random::Uint(0, 1000000));
+    });
+    worker.join();
+    return values;
+}
+
+BOOST_AUTO_TEST_CASE(test_ThreadStreams)
+{
+    // The server draws the same numbers for the same seed whichever thread draws first
+    Random::initialize(99);
+    std::vector<uint32_t> otherValues = drawOnThread(false);
+    std::vector<uint32_t> serverValues = drawOnThread(true);
+
+    Random::initialize(99);
+    BOOST_CHECK(drawOnThread(true) == serverValues);
+    drawOnThread(false);
+
+    // Threads without an explicit stream do not draw the same numbers as the server nor as each other
+    BOOST_CHECK(otherValues != serverValues);
+    BOOST_CHECK(drawOnThread(false) != otherValues);
+
+    // Each worker has its own stream
+    Random::setThreadStream(Random::StreamType::worker, 0);
+    std::vector<uint32_t> workerValues;
+    for(uint32_t i = 0; i < 20; ++i)
+        workerValues.push_back(Random::Uint(0, 1000000));
+    Random::setThreadStream(Random::StreamType::worker, 1);
+    std::vector<uint32_t> otherWorkerValues;
+    for(uint32_t i = 0; i < 20; ++i)
+        otherWorkerValues.push_back(Random::Uint(0, 1000000));
+    BOOST_CHECK(workerValues != otherWorkerValues);
+}
+
+BOOST_AUTO_TEST_CASE(test_Distribution)
+{
+    RandomGenerator generator;
+    generator.seed(Random::getStreamSeed(Random::StreamType::creature, 3));
+
+    // Chi-squared test on 10 buckets. With 9 degrees of freedom, the statistic is above
+    // 27.88 with a probability of 0.001
+    const uint32_t nbBuckets = 10;
+    const uint32_t nbDraws = 100000;
+    std::vector<uint32_t> buckets(nbBuckets, 0);
+    for(uint32_t i = 0; i < nbDraws; ++i)
+        ++buckets[generator.Uint(0, nbBuckets - 1)];
+
+    double expected = static_cast<double>(nbDraws) / nbBuckets;
+    double chiSquared = 0.0;
+    for(uint32_t count : buckets)
+        chiSquared += (count - expected) * (count - expected) / expected;
+    BOOST_CHECK_LT(chiSquared, 27.88);
+
+    // Over a large range, the old generator could only give 32768 different values
+    const int largeRange = 1 << 24;
+    double sum = 0.0;
+    bool hasOddValue = false;
+    for(uint32_t i = 0; i < nbDraws; ++i)
+    {
+        int value = generator.Int(0, largeRange - 1);
+        sum += value;
+        hasOddValue |= ((value & 1) != 0);
+    }
+    BOOST_CHECK(hasOddValue);
+    BOOST_CHECK_CLOSE(sum / nbDraws, (largeRange - 1) / 2.0, 1.0);
+
+    double gaussianSum = 0.0;
+    double gaussianSquaredSum = 0.0;
+    for(uint32_t i = 0; i < nbDraws; ++i)
+    {
+        double value = generator.gaussianRandomDouble();
+        gaussianSum += value;
+        gaussianSquaredSum += value * value;
+    }
+    double mean = gaussianSum / nbDraws;
+    BOOST_CHECK_SMALL(mean, 0.02);
+    BOOST_CHECK_CLOSE(std::sqrt(gaussianSquaredSum / nbDraws - mean * mean), 1.0, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_Throughput)
+{
+    RandomGenerator generator;
+    generator.seed(7);
+    const uint32_t nbDraws = 10000000;
+    uint64_t sum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < nbDraws; ++i)
+        sum += generator.Uint(0, 1000);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("Random throughput: " << (nbDraws / std::max(seconds, 1e-9) / 1e6) << " M draws/s");
+
+    // The sum is checked so that the loop is not optimized out. The bound is loose so that
+    // the test passes on slow or instrumented builds
+    BOOST_CHECK_GT(sum, 0u);
+    BOOST_CHECK_LT(seconds, 10.0);
+}
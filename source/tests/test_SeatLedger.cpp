@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/SeatLedger.h"
+
+#define BOOST_TEST_MODULE SeatLedger
+#include "BoostTestTargetConfig.h"
+
+BOOST_AUTO_TEST_CASE(test_Counts)
+{
+    SeatLedger ledger;
+    ledger.addClaimedTile();
+    ledger.addClaimedTile();
+    ledger.removeClaimedTile();
+    BOOST_CHECK(ledger.getNbClaimedTiles() == 1);
+    ledger.removeClaimedTile();
+    ledger.removeClaimedTile();
+    BOOST_CHECK(ledger.getNbClaimedTiles() == 0);
+
+    ledger.addRoom(3);
+    ledger.addRoom(3);
+    ledger.addRoom(1);
+    ledger.removeRoom(1);
+    ledger.removeRoom(7);
+    BOOST_CHECK(ledger.getNbRooms(3) == 2);
+    BOOST_CHECK(ledger.getNbRooms(1) == 0);
+    BOOST_CHECK(ledger.getNbRooms(12) == 0);
+
+    // The definitions are only used as keys
+    const CreatureDefinition* kobold = reinterpret_cast<const CreatureDefinition*>(&ledger);
+    const CreatureDefinition* troll = reinterpret_cast<const CreatureDefinition*>(&kobold);
+    ledger.addCreature(kobold);
+    ledger.addCreature(kobold);
+    ledger.addCreature(troll);
+    ledger.removeCreature(kobold);
+    ledger.removeCreature(nullptr);
+    BOOST_CHECK(ledger.getNbCreatures() == 2);
+    BOOST_CHECK(ledger.getNbCreatures(kobold) == 1);
+    BOOST_CHECK(ledger.getNbCreatures(troll) == 1);
+    BOOST_CHECK(ledger.getNbCreatures(nullptr) == 0);
+
+    ledger.clear();
+    BOOST_CHECK(ledger.getNbCreatures() == 0);
+    BOOST_CHECK(ledger.getNbRooms(3) == 0);
+}
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/SpscQueue.h"
+
+#include <thread>
+
+#define BOOST_TEST_MODULE SpscQueue
+#include "BoostTestTargetConfig.h"
+
+BOOST_AUTO_TEST_CASE(test_FillAndEmpty)
+{
+    SpscQueue<int32_t> queue(3);
+    BOOST_CHECK(queue.getCapacity() == 4);
+    BOOST_CHECK(queue.isEmpty());
+    BOOST_CHECK(queue.getFront() == nullptr);
+
+    for(int32_t i = 0; i < 4; ++i)
+    {
+        int32_t* slot = queue.getFreeSlot();
+        BOOST_REQUIRE(slot != nullptr);
+        *slot = i;
+        queue.push();
+    }
+    // The queue is full
+    BOOST_CHECK(queue.getFreeSlot() == nullptr);
+
+    for(int32_t i = 0; i < 4; ++i)
+    {
+        int32_t* item = queue.getFront();
+        BOOST_REQUIRE(item != nullptr);
+        BOOST_CHECK(*item == i);
+        queue.pop();
+    }
+    BOOST_CHECK(queue.isEmpty());
+    BOOST_CHECK(queue.getFreeSlot() != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_TwoThreads)
+{
+    const int32_t nbItems = 100000;
+    SpscQueue<int32_t> queue(64);
+    std::thread producer([&queue, nbItems]()
+    {
+        for(int32_t i = 0; i < nbItems; ++i)
+        {
+            int32_t* slot;
+            while((slot = queue.getFreeSlot()) == nullptr)
+                std::this_thread::yield();
+
+            *slot = i;
+            queue.push();
+        }
+    });
+
+    // The items should be received once each and in order
+    int32_t nbErrors = 0;
+    for(int32_t expected = 0; expected < nbItems; ++expected)
+    {
+        int32_t* item;
+        while((item = queue.getFront()) == nullptr)
+            std::this_thread::yield();
+
+        if(*item != expected)
+            ++nbErrors;
+
+        queue.pop();
+    }
+    producer.join();
+
+    BOOST_CHECK(nbErrors == 0);
+    BOOST_CHECK(queue.isEmpty());
+}
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/TurnProfiler.h"
+
+#define BOOST_TEST_MODULE TurnProfiler
+#include "BoostTestTargetConfig.h"
+
+BOOST_AUTO_TEST_CASE(test_Percentiles)
+{
+    TurnProfiler profiler;
+    BOOST_CHECK(profiler.getNbTurns() == 0);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::vision, 50) == 0);
+
+    // Turn i spends i microseconds in vision, split in 2 zones
+    for(int64_t i = 1; i <= 100; ++i)
+    {
+        profiler.addZone(TurnProfiler::vision, 0, i / 2);
+        profiler.addZone(TurnProfiler::vision, 0, i - (i / 2));
+        profiler.endTurn();
+    }
+
+    BOOST_CHECK(profiler.getNbTurns() == 100);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::vision, 0) == 1);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::vision, 50) == 51);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::vision, 95) == 95);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::vision, 100) == 100);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::aiTurn, 100) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_RollingWindow)
+{
+    TurnProfiler profiler;
+    // The first turns are slow and should be forgotten once enough turns are measured
+    for(uint32_t i = 0; i < TurnProfiler::NB_TURNS_KEPT; ++i)
+    {
+        profiler.addZone(TurnProfiler::turn, 0, 1000);
+        profiler.endTurn();
+    }
+    for(uint32_t i = 0; i < TurnProfiler::NB_TURNS_KEPT; ++i)
+    {
+        profiler.addZone(TurnProfiler::turn, 0, 10);
+        profiler.endTurn();
+    }
+    BOOST_CHECK(profiler.getNbTurns() == TurnProfiler::NB_TURNS_KEPT);
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::turn, 100) == 10);
+
+    // Discarded zones are not counted in the next turn
+    profiler.addZone(TurnProfiler::turn, 0, 5000);
+    profiler.discardTurn();
+    profiler.endTurn();
+    BOOST_CHECK(profiler.getPercentile(TurnProfiler::turn, 0) == 0);
+
+    profiler.reset();
+    BOOST_CHECK(profiler.getNbTurns() == 0);
+}
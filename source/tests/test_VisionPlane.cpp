@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/VisionPlane.h"
+
+#define BOOST_TEST_MODULE VisionPlane
+#include "BoostTestTargetConfig.h"
+
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_SetAndEnumerate)
+{
+    // 13 * 11 = 143 bits so the last word is not full
+    VisionPlane plane;
+    plane.setMapSize(13, 11);
+    BOOST_CHECK(plane.count() == 0);
+
+    plane.set(0, 0);
+    plane.set(5, 9);
+    plane.set(12, 10);
+    BOOST_CHECK(plane.test(5, 9));
+    BOOST_CHECK(!plane.test(9, 5));
+    BOOST_CHECK(plane.count() == 3);
+
+    std::vector<uint32_t> cells;
+    plane.fillSetCells(cells);
+    BOOST_REQUIRE(cells.size() == 3);
+    BOOST_CHECK(cells[0] == 0);
+    BOOST_CHECK(cells[1] == 5 * 11 + 9);
+    BOOST_CHECK(cells[2] == 12 * 11 + 10);
+
+    plane.clear();
+    BOOST_CHECK(plane.count() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_MergeAndChanges)
+{
+    VisionPlane previous;
+    VisionPlane current;
+    VisionPlane allied;
+    previous.setMapSize(20, 20);
+    current.setMapSize(20, 20);
+    allied.setMapSize(20, 20);
+
+    previous.set(1, 1);
+    previous.set(10, 10);
+    current.set(1, 1);
+    allied.set(19, 19);
+    current.orWith(allied);
+    BOOST_CHECK(current.test(19, 19));
+
+    std::vector<uint32_t> gained;
+    std::vector<uint32_t> lost;
+    VisionPlane::fillChangedCells(previous, current, gained, lost);
+    BOOST_REQUIRE(gained.size() == 1);
+    BOOST_CHECK(gained[0] == 19 * 20 + 19);
+    BOOST_REQUIRE(lost.size() == 1);
+    BOOST_CHECK(lost[0] == 10 * 20 + 10);
+
+    previous.swap(current);
+    BOOST_CHECK(previous.test(19, 19));
+    BOOST_CHECK(current.test(10, 10));
+}
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/WorkerTaskBoard.h"
+
+#define BOOST_TEST_MODULE WorkerTaskBoard
+#include "BoostTestTargetConfig.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+static bool alwaysValid(int, int)
+{
+    return true;
+}
+
+BOOST_AUTO_TEST_CASE(test_AddAndRemove)
+{
+    // 21 x 13 so that the last buckets are not full
+    WorkerTaskBoard board;
+    board.setMapSize(21, 13);
+    board.setTask(WorkerTaskBoard::TaskType::dig, 3, 4, true);
+    board.setTask(WorkerTaskBoard::TaskType::dig, 3, 4, true);
+    board.setTask(WorkerTaskBoard::TaskType::dig, 20, 12, true);
+    board.setTask(WorkerTaskBoard::TaskType::claimWall, 3, 4, true);
+    board.setTask(WorkerTaskBoard::TaskType::dig, 21, 0, true);
+    BOOST_CHECK(board.getNbTasks(WorkerTaskBoard::TaskType::dig) == 2);
+    BOOST_CHECK(board.getNbTasks(WorkerTaskBoard::TaskType::claimWall) == 1);
+    BOOST_CHECK(board.hasTask(WorkerTaskBoard::TaskType::dig, 20, 12));
+    BOOST_CHECK(!board.hasTask(WorkerTaskBoard::TaskType::claimGround, 3, 4));
+
+    board.setTask(WorkerTaskBoard::TaskType::dig, 3, 4, false);
+    board.setTask(WorkerTaskBoard::TaskType::dig, 5, 5, false);
+    BOOST_CHECK(board.getNbTasks(WorkerTaskBoard::TaskType::dig) == 1);
+    BOOST_CHECK(!board.hasTask(WorkerTaskBoard::TaskType::dig, 3, 4));
+    BOOST_CHECK(board.hasTask(WorkerTaskBoard::TaskType::claimWall, 3, 4));
+
+    std::vector<uint32_t> tiles;
+    board.fillTasksInRadius(WorkerTaskBoard::TaskType::dig, 18, 10, 3, tiles);
+    BOOST_REQUIRE(tiles.size() == 1);
+    BOOST_CHECK(tiles[0] == 20 * 13 + 12);
+    board.fillTasksInRadius(WorkerTaskBoard::TaskType::dig, 17, 10, 3, tiles);
+    BOOST_CHECK(tiles.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_Reservation)
+{
+    WorkerTaskBoard board;
+    board.setMapSize(40, 40);
+    board.setTask(WorkerTaskBoard::TaskType::claimGround, 10, 10, true);
+    board.setTask(WorkerTaskBoard::TaskType::claimGround, 30, 30, true);
+
+    // The closest task is reserved by the first worker, the second one gets the other one
+    int x = -1;
+    int y = -1;
+    BOOST_REQUIRE(board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 12, 12, 40, 1, 0, 5,
+        alwaysValid, x, y));
+    BOOST_CHECK(x == 10 && y == 10);
+    BOOST_CHECK(board.getReservingWorker(WorkerTaskBoard::TaskType::claimGround, 10, 10, 0) == 1);
+    BOOST_REQUIRE(board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 12, 12, 40, 2, 0, 5,
+        alwaysValid, x, y));
+    BOOST_CHECK(x == 30 && y == 30);
+
+    // No task left for a third worker until the reservations expire
+    BOOST_CHECK(!board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 12, 12, 40, 3, 5, 10,
+        alwaysValid, x, y));
+    BOOST_CHECK(board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 12, 12, 40, 3, 6, 10,
+        alwaysValid, x, y));
+    BOOST_CHECK(x == 10 && y == 10);
+
+    // A worker can reserve again its own task
+    BOOST_CHECK(board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 0, 0, 40, 3, 7, 10,
+        alwaysValid, x, y));
+    BOOST_CHECK(x == 10 && y == 10);
+
+    // Out of range and rejected tasks are not reserved
+    BOOST_CHECK(!board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 0, 0, 10, 4, 20, 25,
+        alwaysValid, x, y));
+    BOOST_CHECK(board.reserveNearestTask(WorkerTaskBoard::TaskType::claimGround, 12, 12, 40, 4, 20, 25,
+        [](int taskX, int) { return taskX != 10; }, x, y));
+    BOOST_CHECK(x == 30 && y == 30);
+}
+
+BOOST_AUTO_TEST_CASE(test_NearestMatchesBruteForce)
+{
+    WorkerTaskBoard board;
+    const int sizeX = 53;
+    const int sizeY = 37;
+    board.setMapSize(sizeX, sizeY);
+    std::srand(1);
+    std::vector<std::pair<int, int>> tasks;
+    for(int i = 0; i < 150; ++i)
+    {
+        int x = std::rand() % sizeX;
+        int y = std::rand() % sizeY;
+        if(board.hasTask(WorkerTaskBoard::TaskType::dig, x, y))
+            continue;
+
+        board.setTask(WorkerTaskBoard::TaskType::dig, x, y, true);
+        tasks.push_back(std::make_pair(x, y));
+    }
+
+    for(int i = 0; i < 200; ++i)
+    {
+        int x = std::rand() % sizeX;
+        int y = std::rand() % sizeY;
+        int maxDistance = std::rand() % 30;
+
+        // Tasks are never reserved for more than the current turn so every task is available
+        int bestDistance = maxDistance * maxDistance + 1;
+        for(const std::pair<int, int>& task : tasks)
+        {
+            int distance = (task.first - x) * (task.first - x) + (task.second - y) * (task.second - y);
+            bestDistance = std::min(bestDistance, distance);
+        }
+
+        int taskX = -1;
+        int taskY = -1;
+        bool isFound = board.reserveNearestTask(WorkerTaskBoard::TaskType::dig, x, y, maxDistance, 1,
+            2 * i, 2 * i, alwaysValid, taskX, taskY);
+        BOOST_REQUIRE(isFound == (bestDistance <= maxDistance * maxDistance));
+        if(isFound)
+            BOOST_CHECK((taskX - x) * (taskX - x) + (taskY - y) * (taskY - y) == bestDistance);
+    }
+}
@@ -36,7 +36,10 @@ ConfigManager::ConfigManager() :
     mCreatureDeathCounter(10),
     mMaxCreaturesPerSeat(15),
     mSlapDamagePercent(15),
-    mTimePayDay(300)
+    mTimePayDay(300),
+    mHierarchicalPathMinDistance(0),
+    mSenseWorkerThreads(0),
+    mUseEntitySnapshots(false)
 {
     if(!loadGlobalConfig())
     {
@@ -380,6 +383,27 @@ bool ConfigManager::loadGlobalGameConfig(std::stringstream& configFile)
             mTimePayDay = Helper::toDouble(nextParam);
             // Not mandatory
         }
+
+        if(nextParam == "HierarchicalPathMinDistance")
+        {
+            configFile >> nextParam;
+            mHierarchicalPathMinDistance = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
+        if(nextParam == "SenseWorkerThreads")
+        {
+            configFile >> nextParam;
+            mSenseWorkerThreads = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
+        if(nextParam == "UseEntitySnapshots")
+        {
+            configFile >> nextParam;
+            mUseEntitySnapshots = (Helper::toUInt32(nextParam) != 0);
+            // Not mandatory
+        }
     }
 
     if(paramsOk != 0x01)
@@ -56,6 +56,15 @@ public:
     inline int64_t getTimePayDay() const
     { return mTimePayDay; }
 
+    inline uint32_t getHierarchicalPathMinDistance() const
+    { return mHierarchicalPathMinDistance; }
+
+    inline uint32_t getSenseWorkerThreads() const
+    { return mSenseWorkerThreads; }
+
+    inline bool getUseEntitySnapshots() const
+    { return mUseEntitySnapshots; }
+
     inline uint32_t getNetworkPort() const
     { return mNetworkPort; }
 
@@ -110,6 +119,13 @@ private:
     uint32_t mMaxCreaturesPerSeat;
     double mSlapDamagePercent;
     int64_t mTimePayDay;
+    //! \brief Minimum manhattan distance for a path to be computed with the cluster graph. 0 means never
+    uint32_t mHierarchicalPathMinDistance;
+    //! \brief Number of threads helping the server thread to compute what the creatures see. 0 means no thread
+    uint32_t mSenseWorkerThreads;
+    //! \brief If true, the movement and state events of the creatures sent to a client during a
+    //! turn are merged in one snapshot packet instead of one packet per event
+    bool mUseEntitySnapshots;
     std::map<const CreatureDefinition*, std::vector<const SpawnCondition*> > mCreatureSpawnConditions;
     std::map<const std::string, std::vector<std::string> > mFactionSpawnPool;
     std::vector<std::string> mFactions;
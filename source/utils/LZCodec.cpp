@@ -0,0 +1,237 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/LZCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+const uint32_t LZCodec::MIN_MATCH = 4;
+const uint32_t LZCodec::MAX_OFFSET = 0xFFFF;
+
+static const uint32_t HASH_LOG = 12;
+//! \brief Below this size, the data is stored as literals
+static const uint32_t MIN_INPUT_SIZE = 16;
+//! \brief Without any match found for this number of bytes, the search goes faster through the
+//! data by skipping bytes (the further from the last match, the more bytes are skipped)
+static const uint32_t SKIP_TRIGGER = 6;
+
+static inline uint32_t read32(const char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash(uint32_t value)
+{
+    return (value * 2654435761U) >> (32 - HASH_LOG);
+}
+
+//! \brief Writes the part of a length that does not fit in the token
+static inline void writeLength(uint32_t length, std::vector<char>& out)
+{
+    while(length >= 255)
+    {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+//! \brief Reads the part of a length that does not fit in the token. Returns false if the end
+//! of the data is reached.
+static inline bool readLength(const unsigned char* data, uint32_t dataSize, uint32_t& pos, uint32_t& length)
+{
+    unsigned char byte;
+    do
+    {
+        if(pos >= dataSize)
+            return false;
+
+        byte = data[pos++];
+        length += byte;
+    }
+    while(byte == 255);
+
+    return true;
+}
+
+//! \brief Writes a sequence: the literals from data + literalsStart to data + literalsEnd followed by a match
+//! if matchLength is not 0
+static void writeSequence(const char* data, uint32_t literalsStart, uint32_t literalsEnd,
+    uint32_t offset, uint32_t matchLength, std::vector<char>& out)
+{
+    uint32_t nbLiterals = literalsEnd - literalsStart;
+    uint32_t matchCode = (matchLength == 0) ? 0 : matchLength - LZCodec::MIN_MATCH;
+    unsigned char token = static_cast<unsigned char>((std::min(nbLiterals, 15U) << 4) | std::min(matchCode, 15U));
+    out.push_back(static_cast<char>(token));
+    if(nbLiterals >= 15)
+        writeLength(nbLiterals - 15, out);
+
+    out.insert(out.end(), data + literalsStart, data + literalsEnd);
+    if(matchLength == 0)
+        return;
+
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>((offset >> 8) & 0xFF));
+    if(matchCode >= 15)
+        writeLength(matchCode - 15, out);
+}
+
+LZCodec::LZCodec()
+{
+}
+
+void LZCodec::compress(const char* data, uint32_t size, std::vector<char>& out)
+{
+    out.clear();
+    // In the worst case, every byte is a literal
+    out.reserve(size + size / 255 + 16);
+
+    uint32_t anchor = 0;
+    if(size >= MIN_INPUT_SIZE)
+    {
+        mHashTable.assign(1 << HASH_LOG, 0);
+        // The last bytes are always literals so that a match never reads past the end
+        uint32_t limit = size - MIN_MATCH;
+        uint32_t pos = 0;
+        while(pos < limit)
+        {
+            uint32_t value = read32(data + pos);
+            uint32_t& entry = mHashTable[hash(value)];
+            uint32_t candidate = entry;
+            entry = pos + 1;
+            if((candidate == 0) || (pos - (candidate - 1) > MAX_OFFSET) ||
+               (read32(data + candidate - 1) != value))
+            {
+                pos += 1 + ((pos - anchor) >> SKIP_TRIGGER);
+                continue;
+            }
+
+            uint32_t matchPos = candidate - 1;
+            uint32_t matchLength = MIN_MATCH;
+            while((pos + matchLength < size) && (data[matchPos + matchLength] == data[pos + matchLength]))
+                ++matchLength;
+
+            writeSequence(data, anchor, pos, pos - matchPos, matchLength, out);
+            pos += matchLength;
+            anchor = pos;
+        }
+    }
+
+    writeSequence(data, anchor, size, 0, 0, out);
+}
+
+bool LZCodec::decompress(const char* data, uint32_t dataSize, uint32_t rawSize, std::vector<char>& out)
+{
+    out.resize(rawSize);
+    const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+    char* output = out.data();
+    uint32_t inPos = 0;
+    uint32_t outPos = 0;
+    while(inPos < dataSize)
+    {
+        unsigned char token = input[inPos++];
+        uint32_t nbLiterals = token >> 4;
+        if((nbLiterals == 15) && !readLength(input, dataSize, inPos, nbLiterals))
+            return false;
+
+        if((nbLiterals > dataSize - inPos) || (nbLiterals > rawSize - outPos))
+            return false;
+
+        if(nbLiterals > 0)
+            std::memcpy(output + outPos, data + inPos, nbLiterals);
+        inPos += nbLiterals;
+        outPos += nbLiterals;
+
+        // The last sequence has no match
+        if(inPos == dataSize)
+            return outPos == rawSize;
+
+        if(dataSize - inPos < 2)
+            return false;
+
+        uint32_t offset = input[inPos] | (static_cast<uint32_t>(input[inPos + 1]) << 8);
+        inPos += 2;
+        uint32_t matchLength = token & 0x0F;
+        if((matchLength == 15) && !readLength(input, dataSize, inPos, matchLength))
+            return false;
+
+        matchLength += MIN_MATCH;
+        if((offset == 0) || (offset > outPos) || (matchLength > rawSize - outPos))
+            return false;
+
+        // The match can overlap the bytes it writes (for repeated patterns) so it is copied byte by byte
+        // unless it is far enough
+        const char* match = output + outPos - offset;
+        if(offset >= matchLength)
+            std::memcpy(output + outPos, match, matchLength);
+        else
+        {
+            for(uint32_t i = 0; i < matchLength; ++i)
+                output[outPos + i] = match[i];
+        }
+        outPos += matchLength;
+    }
+
+    // The block has been truncated after a match
+    return false;
+}
+
+LZCodecStats::LZCodecStats() :
+    mNbRawBytes(0),
+    mNbStoredBytes(0),
+    mTimeUs(0)
+{
+}
+
+void LZCodecStats::add(uint32_t rawSize, uint32_t storedSize, int64_t timeUs)
+{
+    mNbRawBytes += rawSize;
+    mNbStoredBytes += storedSize;
+    mTimeUs += timeUs;
+}
+
+void LZCodecStats::add(const LZCodecStats& stats)
+{
+    mNbRawBytes += stats.mNbRawBytes;
+    mNbStoredBytes += stats.mNbStoredBytes;
+    mTimeUs += stats.mTimeUs;
+}
+
+void LZCodecStats::reset()
+{
+    mNbRawBytes = 0;
+    mNbStoredBytes = 0;
+    mTimeUs = 0;
+}
+
+std::string LZCodecStats::getReport(uint64_t nbTurns) const
+{
+    double ratio = (mNbStoredBytes == 0) ? 1.0 :
+        static_cast<double>(mNbRawBytes) / static_cast<double>(mNbStoredBytes);
+    double timePerTurn = (nbTurns == 0) ? 0.0 :
+        static_cast<double>(mTimeUs) / static_cast<double>(nbTurns);
+    std::stringstream report;
+    report << mNbRawBytes << " bytes stored in " << mNbStoredBytes << " bytes (ratio "
+        << std::fixed << std::setprecision(2) << ratio << "), compression time "
+        << std::setprecision(1) << timePerTurn << "us per turn over " << nbTurns << " turns";
+    return report.str();
+}
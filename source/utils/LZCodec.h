@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LZCODEC_H
+#define LZCODEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*! \brief Small and fast LZ77 compressor used for the network stream and the replays.
+ *
+ * The block format is close to LZ4: a sequence of tokens, each one giving a number of literals
+ * copied as is followed by a match (an offset back in the decompressed data and a length).
+ * The high 4 bits of the token are the number of literals and the low 4 bits the match length
+ * minus MIN_MATCH. 15 means the length goes on in the next bytes: each one is added and the
+ * length ends with the first byte that is not 255. The offset is 2 bytes in little endian.
+ * The last sequence only has literals. Matches are found with a hash table of the last position
+ * where each group of 4 bytes was seen, which favours speed over ratio: the messages sent each
+ * turn are small and repetitive, so there is no need for a better search.
+ * The size of the decompressed data is not stored in the block and has to be kept by the caller.
+ */
+class LZCodec
+{
+public:
+    LZCodec();
+
+    //! \brief Compresses the given data. out is cleared first and can be reused from one call
+    //! to another to avoid allocating memory.
+    void compress(const char* data, uint32_t size, std::vector<char>& out);
+
+    /*! \brief Decompresses a block of dataSize bytes that should give rawSize bytes. Returns false
+     * if the block is invalid (then, the content of out is unspecified). out is cleared first.
+     */
+    static bool decompress(const char* data, uint32_t dataSize, uint32_t rawSize, std::vector<char>& out);
+
+    static const uint32_t MIN_MATCH;
+    static const uint32_t MAX_OFFSET;
+
+private:
+    //! \brief Position + 1 of the last 4 bytes with the given hash, 0 if none
+    std::vector<uint32_t> mHashTable;
+};
+
+//! \brief Accumulates the sizes before and after compression and the time spent compressing
+class LZCodecStats
+{
+public:
+    LZCodecStats();
+
+    //! \brief Counts rawSize bytes that have been stored in storedSize bytes after timeUs
+    //! microseconds of compression.
+    void add(uint32_t rawSize, uint32_t storedSize, int64_t timeUs);
+
+    //! \brief Adds the counters of the given stats
+    void add(const LZCodecStats& stats);
+
+    void reset();
+
+    inline uint64_t getNbRawBytes() const
+    { return mNbRawBytes; }
+
+    inline uint64_t getNbStoredBytes() const
+    { return mNbStoredBytes; }
+
+    inline int64_t getTimeUs() const
+    { return mTimeUs; }
+
+    //! \brief Returns a line giving the sizes, the compression ratio and the compression time per
+    //! turn, the counters having been accumulated over nbTurns turns.
+    std::string getReport(uint64_t nbTurns) const;
+
+private:
+    uint64_t mNbRawBytes;
+    uint64_t mNbStoredBytes;
+    int64_t mTimeUs;
+};
+
+#endif // LZCODEC_H
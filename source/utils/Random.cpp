@@ -20,91 +20,221 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #include "utils/Random.h"
 #include "utils/Helper.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <ctime>
 
-unsigned long myRandomSeed;
-const unsigned long MAX = 32768;
-
-static unsigned long randgen()
+//! \brief Returns the next value of a splitmix64 sequence. Used to spread the bits of the seeds.
+static uint64_t splitMix(uint64_t& state)
 {
-    myRandomSeed = myRandomSeed * 1103515245 + 12345;
-    //TODO: What is the purpose of the cast?
-    unsigned long returnVal = static_cast<unsigned int>(myRandomSeed / 65536) % MAX;
-
-    return returnVal;
+    state += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
-//! \brief uniformly distributed number [0;1)
-static double uniform()
+static inline uint64_t rotl(uint64_t x, int k)
 {
-    return randgen() * 1.0 / static_cast<double>(MAX);
+    return (x << k) | (x >> (64 - k));
 }
 
-//! \brief uniformly distributed number [lo;hi)
-static double uniform(double lo, double hi)
+RandomGenerator::RandomGenerator()
 {
-    return uniform() * (hi - lo) + lo;
+    seed(0);
 }
 
-//! \brief random integer [lo;hi]
-static int randint(int lo, int hi)
+void RandomGenerator::seed(uint64_t seed)
 {
-    return static_cast<int>(uniform() * (hi - lo + 1) + lo);
+    // xoshiro must not have an all zero state. splitmix never gives 4 zeros in a row
+    uint64_t state = seed;
+    for(uint64_t& word : mState)
+        word = splitMix(state);
 }
 
-//! \brief random unsigned integer [lo;hi]
-static unsigned int randuint(unsigned int lo, unsigned int hi)
+uint64_t RandomGenerator::next()
 {
-    return static_cast<unsigned int>(uniform() * (hi - lo + 1) + lo);
-}
+    uint64_t result = rotl(mState[1] * 5, 7) * 9;
+    uint64_t t = mState[1] << 17;
 
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = rotl(mState[3], 45);
 
-namespace Random
-{
+    return result;
+}
 
-void initialize()
+uint32_t RandomGenerator::nextBelow(uint64_t range)
 {
-    myRandomSeed = static_cast<unsigned long>(std::time(0));
+    // Lemire's method: the high 32 bits of a 32 x 32 bits product are uniform in [0;range)
+    // once the few low values that would favour some results are rejected
+    if(range > 0xFFFFFFFFULL)
+        return static_cast<uint32_t>(next() >> 32);
+
+    uint64_t product = (next() >> 32) * range;
+    uint32_t low = static_cast<uint32_t>(product);
+    if(low < range)
+    {
+        uint32_t threshold = static_cast<uint32_t>((0x100000000ULL - range) % range);
+        while(low < threshold)
+        {
+            product = (next() >> 32) * range;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+
+    return static_cast<uint32_t>(product >> 32);
 }
 
-double Double(double min, double max)
+double RandomGenerator::Double(double min, double max)
 {
     if (min > max)
-    {
         std::swap(min, max);
-    }
 
-    return uniform(min, max);
+    // The 53 high bits give a double in [0;1)
+    double uniform = static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    return uniform * (max - min) + min;
 }
 
-int Int(int min, int max)
+int RandomGenerator::Int(int min, int max)
 {
     if (min > max)
-    {
         std::swap(min, max);
-    }
 
-    return randint(min, max);
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+    return static_cast<int>(static_cast<int64_t>(min) + nextBelow(range));
 }
 
-unsigned int Uint(unsigned int min, unsigned int max)
+unsigned int RandomGenerator::Uint(unsigned int min, unsigned int max)
 {
     if (min > max)
-    {
         std::swap(min, max);
+
+    uint64_t range = static_cast<uint64_t>(max - min) + 1;
+    return min + nextBelow(range);
+}
+
+double RandomGenerator::gaussianRandomDouble()
+{
+    // 1 - Double is in (0;1] so that the log is defined
+    double u1 = 1.0 - Double(0.0, 1.0);
+    double u2 = Double(0.0, 1.0);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+}
+
+//! \brief The match seed. The generation is incremented each time it changes so that the
+//! generators of every thread are seeded again.
+static std::atomic<uint64_t> matchSeed(0);
+static std::atomic<uint32_t> matchSeedGeneration(0);
+
+//! \brief Id of the otherThread stream given to the next thread that draws a number without
+//! having called setThreadStream
+static std::atomic<uint32_t> nextOtherThreadId(0);
+
+//! \brief Generator used by the functions of the Random namespace for the current thread
+class ThreadGenerator
+{
+public:
+    ThreadGenerator() :
+        mGeneration(0),
+        mHasStream(false),
+        mStreamType(Random::StreamType::otherThread),
+        mStreamId(0)
+    {}
+
+    RandomGenerator mGenerator;
+    uint32_t mGeneration;
+    //! \brief False until setThreadStream is called or until the thread first draws a number
+    bool mHasStream;
+    Random::StreamType mStreamType;
+    uint32_t mStreamId;
+};
+
+static thread_local ThreadGenerator threadGenerator;
+
+static RandomGenerator& getThreadGenerator()
+{
+    uint32_t generation = matchSeedGeneration.load(std::memory_order_acquire);
+    if(!threadGenerator.mHasStream)
+    {
+        threadGenerator.mHasStream = true;
+        threadGenerator.mStreamType = Random::StreamType::otherThread;
+        threadGenerator.mStreamId = nextOtherThreadId.fetch_add(1, std::memory_order_relaxed);
+        // Forces the generator to be seeded below
+        threadGenerator.mGeneration = generation - 1;
+    }
+
+    if(threadGenerator.mGeneration != generation)
+    {
+        threadGenerator.mGenerator.seed(Random::getStreamSeed(threadGenerator.mStreamType,
+            threadGenerator.mStreamId));
+        threadGenerator.mGeneration = generation;
     }
 
-    return randuint(min, max);
+    return threadGenerator.mGenerator;
+}
+
+namespace Random
+{
+
+void initialize()
+{
+    initialize(static_cast<uint64_t>(std::time(0)));
+}
+
+void initialize(uint64_t seed)
+{
+    matchSeed.store(seed, std::memory_order_relaxed);
+    matchSeedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t getMatchSeed()
+{
+    return matchSeed.load(std::memory_order_relaxed);
+}
+
+void setThreadStream(StreamType type, uint32_t id)
+{
+    threadGenerator.mHasStream = true;
+    threadGenerator.mStreamType = type;
+    threadGenerator.mStreamId = id;
+    threadGenerator.mGenerator.seed(getStreamSeed(type, id));
+    threadGenerator.mGeneration = matchSeedGeneration.load(std::memory_order_acquire);
+}
+
+uint64_t getStreamSeed(StreamType type, uint32_t id)
+{
+    uint64_t streamState = (static_cast<uint64_t>(type) << 32) | id;
+    uint64_t seedState = getMatchSeed();
+    return splitMix(seedState) ^ splitMix(streamState);
+}
+
+double Double(double min, double max)
+{
+    return getThreadGenerator().Double(min, max);
+}
+
+int Int(int min, int max)
+{
+    return getThreadGenerator().Int(min, max);
+}
+
+unsigned int Uint(unsigned int min, unsigned int max)
+{
+    return getThreadGenerator().Uint(min, max);
 }
 
 double gaussianRandomDouble()
 {
-    return std::sqrt(-2.0 * log(Double(0.0, 1.0))) * cos(2.0 * PI * Double(0.0, 1.0));
+    return getThreadGenerator().gaussianRandomDouble();
 }
 
 } // namespace Random
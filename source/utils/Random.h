@@ -20,14 +20,91 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #ifndef RANDOM_H_
 #define RANDOM_H_
 
+#include <cstdint>
+
+/*! \brief A xoshiro256** random generator.
+ *
+ * Each generator has its own state so that several threads can draw numbers at the same
+ * time, each from its own generator, and so that the numbers drawn by an entity do not
+ * depend on what the other entities drew. The functions follow the ones of the Random
+ * namespace. Generators for the game should be seeded with Random::getStreamSeed so that
+ * a game started with the same match seed gives the same numbers.
+ */
+class RandomGenerator
+{
+public:
+    //! \brief The generator is seeded with 0 until seed is called
+    RandomGenerator();
+
+    //! \brief Sets the state from the given seed (any value, 0 included, is valid)
+    void seed(uint64_t seed);
+
+    //! \brief Returns 64 uniformly distributed random bits
+    uint64_t next();
+
+    //! \brief Returns a uniformly distributed double in [min;max). min and max can be swapped.
+    double Double(double min, double max);
+
+    //! \brief Returns a uniformly distributed int in [min;max]. min and max can be swapped.
+    int Int(int min, int max);
+
+    //! \brief Returns a uniformly distributed unsigned int in [min;max]. min and max can be swapped.
+    unsigned int Uint(unsigned int min, unsigned int max);
+
+    //! \brief Returns a gaussian distributed double (mean 0, standard deviation 1)
+    double gaussianRandomDouble();
+
+private:
+    uint64_t mState[4];
+
+    //! \brief Returns a uniformly distributed integer in [0;range). range must not be 0.
+    uint32_t nextBelow(uint64_t range);
+};
+
 namespace Random
 {
-    //! \brief initializes the semaphore and seeds the generator
+    //! \brief The different streams the game draws numbers from. Each stream is seeded
+    //! differently from the match seed.
+    enum class StreamType
+    {
+        global,
+        seat,
+        creature,
+        ai,
+        //! \brief Worker threads of a thread pool (id is the worker index)
+        worker,
+        //! \brief Threads that did not call setThreadStream (id is given in the order they first draw)
+        otherThread
+    };
+
+    //! \brief seeds the generator with the current time
     void initialize();
 
+    //! \brief Sets the match seed and seeds the generator used by the functions below from it.
+    //! 2 games started with the same seed and the same commands will give the same random numbers
+    void initialize(uint64_t matchSeed);
+
+    uint64_t getMatchSeed();
+
+    //! \brief Returns the seed of the given stream. id identifies the owner of the stream within its type
+    //! (seat id, creature handle, ...).
+    uint64_t getStreamSeed(StreamType type, uint32_t id);
+
+    /*! \brief Sets the stream the functions below draw from on the calling thread. The simulation thread
+     * of the server uses the global stream (id 0) so that its numbers only depend on the match seed. Threads
+     * that do not call it get an otherThread stream depending on the order they first draw in, so their
+     * numbers are not reproducible.
+     */
+    void setThreadStream(StreamType type, uint32_t id);
+
+    // The functions below draw from a generator per thread seeded from the stream of the thread. The
+    // simulation should rather use the generator of the seat, creature or AI concerned so that
+    // its numbers do not depend on the order the entities are updated in.
+
     /*! \brief generate a random double
      *
      *  \param min, max One or both can be negative
@@ -57,7 +134,7 @@ namespace Random
 
     /*! \brief generates a gaussian distributed random double
      *
-     *  \return a gaussian distributed random double value in [-1,1]
+     *  \return a gaussian distributed random double value (mean 0, standard deviation 1)
      */
     double gaussianRandomDouble();
 }
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/*! \brief Bounded lock-free queue with one producer thread and one consumer thread.
+ *
+ * The items live in a ring of preallocated slots. The producer fills the slot returned by
+ * getFreeSlot and publishes it with push. The consumer reads the slot returned by getFront
+ * and releases it with pop. Items are never copied nor allocated by the queue, which is why
+ * slots are reused as they are (the producer should overwrite every field it uses).
+ * The capacity is rounded up to a power of 2.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(uint32_t capacity) :
+        mMask(roundUpToPowerOf2(capacity) - 1),
+        mHead(0),
+        mTail(0)
+    {
+        mSlots.resize(mMask + 1);
+    }
+
+    inline uint32_t getCapacity() const
+    { return mMask + 1; }
+
+    //! \brief Producer: returns the slot to fill or nullptr if the queue is full
+    T* getFreeSlot()
+    {
+        uint32_t tail = mTail.load(std::memory_order_relaxed);
+        if(tail - mHead.load(std::memory_order_acquire) > mMask)
+            return nullptr;
+
+        return &mSlots[tail & mMask];
+    }
+
+    //! \brief Producer: makes the slot returned by getFreeSlot available to the consumer
+    void push()
+    {
+        mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    //! \brief Consumer: returns the oldest item or nullptr if the queue is empty
+    T* getFront()
+    {
+        uint32_t head = mHead.load(std::memory_order_relaxed);
+        if(head == mTail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &mSlots[head & mMask];
+    }
+
+    //! \brief Consumer: releases the item returned by getFront
+    void pop()
+    {
+        mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool isEmpty() const
+    { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire); }
+
+    //! \brief Empties the queue. Must only be called while no other thread uses it.
+    void clear()
+    {
+        mHead.store(0, std::memory_order_relaxed);
+        mTail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static uint32_t roundUpToPowerOf2(uint32_t value)
+    {
+        uint32_t result = 1;
+        while(result < value)
+            result <<= 1;
+
+        return result;
+    }
+
+    std::vector<T> mSlots;
+    const uint32_t mMask;
+
+    //! \brief Index of the next item to read. Only written by the consumer.
+    std::atomic<uint32_t> mHead;
+    //! \brief Keeps mHead and mTail in different cache lines so that the threads do not slow each other
+    char mPadding[64];
+    //! \brief Index of the next slot to fill. Only written by the producer.
+    std::atomic<uint32_t> mTail;
+};
+
+#endif // SPSCQUEUE_H
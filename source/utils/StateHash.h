@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+/*! \brief Accumulates values in a 64 bits FNV-1a hash.
+ *
+ * Used to compare game states computed by different processes (the server and a client,
+ * or 2 runs of the server with the same seed). The values are added as 64 bits integers in
+ * a fixed byte order so that the hash does not depend on the platform. Floating point values
+ * are rounded to a given step first so that tiny differences in the computations do not
+ * change it.
+ */
+class StateHash
+{
+public:
+    StateHash() :
+        mValue(OFFSET_BASIS)
+    {}
+
+    inline void add(uint64_t value)
+    {
+        for(uint32_t i = 0; i < 8; ++i)
+        {
+            mValue ^= (value >> (i * 8)) & 0xFF;
+            mValue *= PRIME;
+        }
+    }
+
+    inline void add(double value, double step)
+    {
+        add(static_cast<uint64_t>(std::llround(value / step)));
+    }
+
+    inline uint64_t getValue() const
+    { return mValue; }
+
+    //! \brief Formats the given hash as 16 hexadecimal digits for the logs
+    static std::string toString(uint64_t hash)
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return ss.str();
+    }
+
+private:
+    static const uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+    static const uint64_t PRIME = 1099511628211ULL;
+
+    uint64_t mValue;
+};
+
+#endif // STATEHASH_H
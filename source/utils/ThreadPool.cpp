@@ -0,0 +1,123 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/ThreadPool.h"
+
+#include "utils/Random.h"
+
+ThreadPool::ThreadPool() :
+    mJob(nullptr),
+    mNbItems(0),
+    mNextItem(0),
+    mGeneration(0),
+    mNbBusyWorkers(0),
+    mStopping(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+void ThreadPool::start(uint32_t nbThreads)
+{
+    if(!mThreads.empty())
+        return;
+
+    for(uint32_t i = 0; i < nbThreads; ++i)
+        mThreads.push_back(std::thread(&ThreadPool::workerLoop, this, i, mGeneration));
+}
+
+void ThreadPool::stop()
+{
+    if(mThreads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkCondition.notify_all();
+
+    for(std::thread& thread : mThreads)
+        thread.join();
+
+    mThreads.clear();
+    mStopping = false;
+}
+
+void ThreadPool::parallelFor(uint32_t nbItems, const std::function<void(uint32_t)>& job)
+{
+    if(nbItems == 0)
+        return;
+
+    if(mThreads.empty() || (nbItems == 1))
+    {
+        for(uint32_t i = 0; i < nbItems; ++i)
+            job(i);
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJob = &job;
+        mNbItems = nbItems;
+        mNextItem = 0;
+        mNbBusyWorkers = mThreads.size();
+        ++mGeneration;
+    }
+    mWorkCondition.notify_all();
+
+    processItems();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this] { return mNbBusyWorkers == 0; });
+    mJob = nullptr;
+}
+
+void ThreadPool::workerLoop(uint32_t workerIndex, uint32_t generation)
+{
+    Random::setThreadStream(Random::StreamType::worker, workerIndex);
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkCondition.wait(lock, [this, generation] { return mStopping || (mGeneration != generation); });
+            if(mStopping)
+                return;
+
+            generation = mGeneration;
+        }
+
+        processItems();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mNbBusyWorkers;
+        if(mNbBusyWorkers == 0)
+            mDoneCondition.notify_one();
+    }
+}
+
+void ThreadPool::processItems()
+{
+    uint32_t item;
+    while((item = mNextItem.fetch_add(1)) < mNbItems)
+        (*mJob)(item);
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \brief Runs the iterations of a loop on several threads.
+ *
+ * The threads are created once by start and wait between 2 calls to parallelFor. The
+ * calling thread also processes items so a pool with no thread runs the loop serially.
+ * The items are handed out one at a time, which order they are processed in is not defined.
+ * Each worker draws its random numbers from its own worker stream (see Random::setThreadStream).
+ */
+class ThreadPool
+{
+public:
+    ThreadPool();
+    ~ThreadPool();
+
+    //! \brief Creates the given number of worker threads. Does nothing if the pool is already started.
+    void start(uint32_t nbThreads);
+
+    //! \brief Waits for the worker threads to end.
+    void stop();
+
+    inline uint32_t getNbThreads() const
+    { return mThreads.size(); }
+
+    //! \brief Calls job for every index from 0 to nbItems - 1 and returns once all of them
+    //! have been processed. Must not be called from a job.
+    void parallelFor(uint32_t nbItems, const std::function<void(uint32_t)>& job);
+
+private:
+    std::vector<std::thread> mThreads;
+
+    //! \brief Protects the members below except mNextItem
+    std::mutex mMutex;
+    std::condition_variable mWorkCondition;
+    std::condition_variable mDoneCondition;
+
+    const std::function<void(uint32_t)>* mJob;
+    uint32_t mNbItems;
+    std::atomic<uint32_t> mNextItem;
+
+    //! \brief Incremented at each call to parallelFor so that the workers know there is a new job
+    uint32_t mGeneration;
+
+    //! \brief Number of workers that have not finished the current job yet
+    uint32_t mNbBusyWorkers;
+
+    bool mStopping;
+
+    void workerLoop(uint32_t workerIndex, uint32_t generation);
+
+    //! \brief Processes items of the current job until there is no more
+    void processItems();
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/TurnProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+const uint32_t TurnProfiler::NB_TURNS_KEPT = 512;
+
+TurnProfiler::TurnProfiler() :
+    mStartTime(std::chrono::steady_clock::now()),
+    mCurrentTurn(nbTurnPhases, 0),
+    mTurns(nbTurnPhases, std::vector<int64_t>(NB_TURNS_KEPT, 0)),
+    mNextTurnIndex(0),
+    mNbTurns(0),
+    mIsFirstTraceEvent(true)
+{
+}
+
+TurnProfiler::~TurnProfiler()
+{
+    stopTrace();
+}
+
+const char* TurnProfiler::getTurnPhaseName(TurnPhase phase)
+{
+    switch(phase)
+    {
+        case turn:
+            return "turn";
+        case startNewTurn:
+            return "startNewTurn";
+        case doTurn:
+            return "doTurn";
+        case goals:
+            return "goals";
+        case vision:
+            return "vision";
+        case activeObjects:
+            return "activeObjects";
+        case seatUpkeep:
+            return "seatUpkeep";
+        case aiTurn:
+            return "aiTurn";
+        case updateVisibleEntities:
+            return "updateVisibleEntities";
+        case serverNotifications:
+            return "serverNotifications";
+        default:
+            return "unknown";
+    }
+}
+
+int64_t TurnProfiler::getTimeMicroseconds() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mStartTime).count();
+}
+
+void TurnProfiler::addZone(TurnPhase phase, int64_t startTime, int64_t duration)
+{
+    if((phase < 0) || (phase >= nbTurnPhases))
+        return;
+
+    mCurrentTurn[phase] += duration;
+
+    if(!mTraceFile.is_open())
+        return;
+
+    if(!mIsFirstTraceEvent)
+        mTraceFile << ",\n";
+
+    mIsFirstTraceEvent = false;
+    mTraceFile << "{\"name\":\"" << getTurnPhaseName(phase) << "\",\"ph\":\"X\",\"ts\":" << startTime
+        << ",\"dur\":" << duration << ",\"pid\":1,\"tid\":1}";
+}
+
+void TurnProfiler::endTurn()
+{
+    for(uint32_t phase = 0; phase < nbTurnPhases; ++phase)
+    {
+        mTurns[phase][mNextTurnIndex] = mCurrentTurn[phase];
+        mCurrentTurn[phase] = 0;
+    }
+
+    mNextTurnIndex = (mNextTurnIndex + 1) % NB_TURNS_KEPT;
+    if(mNbTurns < NB_TURNS_KEPT)
+        ++mNbTurns;
+}
+
+void TurnProfiler::discardTurn()
+{
+    std::fill(mCurrentTurn.begin(), mCurrentTurn.end(), 0);
+}
+
+void TurnProfiler::reset()
+{
+    discardTurn();
+    mNextTurnIndex = 0;
+    mNbTurns = 0;
+}
+
+uint32_t TurnProfiler::getNbTurns() const
+{
+    return mNbTurns;
+}
+
+int64_t TurnProfiler::getPercentile(TurnPhase phase, uint32_t percentile) const
+{
+    if((phase < 0) || (phase >= nbTurnPhases) || (mNbTurns == 0))
+        return 0;
+
+    // As long as the ring buffer is not full, the turns are stored from the beginning
+    std::vector<int64_t> times(mTurns[phase].begin(), mTurns[phase].begin() + mNbTurns);
+    uint32_t index = (std::min(percentile, 100u) * (mNbTurns - 1) + 50) / 100;
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+    return times[index];
+}
+
+std::string TurnProfiler::getReport() const
+{
+    std::stringstream report;
+    report << "Time spent per turn phase over the last " << mNbTurns << " turns (microseconds)\n";
+    report << std::left << std::setw(24) << "phase" << std::right << std::setw(10) << "p50"
+        << std::setw(10) << "p95" << std::setw(10) << "max" << "\n";
+    for(uint32_t i = 0; i < nbTurnPhases; ++i)
+    {
+        TurnPhase phase = static_cast<TurnPhase>(i);
+        report << std::left << std::setw(24) << getTurnPhaseName(phase) << std::right
+            << std::setw(10) << getPercentile(phase, 50)
+            << std::setw(10) << getPercentile(phase, 95)
+            << std::setw(10) << getPercentile(phase, 100) << "\n";
+    }
+
+    return report.str();
+}
+
+bool TurnProfiler::startTrace(const std::string& fileName)
+{
+    stopTrace();
+    mTraceFile.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+    if(!mTraceFile.is_open())
+        return false;
+
+    mIsFirstTraceEvent = true;
+    mTraceFile << "[\n";
+    return true;
+}
+
+void TurnProfiler::stopTrace()
+{
+    if(!mTraceFile.is_open())
+        return;
+
+    mTraceFile << "\n]\n";
+    mTraceFile.close();
+}
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2011-2015  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TURNPROFILER_H
+#define TURNPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*! \brief Measures the time spent by the server in the different phases of each turn.
+ *
+ * The time spent in a phase is accumulated during the turn (a phase can be entered several
+ * times, like the AI for each player) and stored when the turn ends. The last NB_TURNS_KEPT
+ * turns are kept for each phase so that the report gives the median, the 95th percentile
+ * and the maximum over a rolling window. If a trace file is opened, each zone is also written
+ * as a Chrome trace event (it can be loaded in chrome://tracing).
+ * It should only be used by the server thread.
+ */
+class TurnProfiler
+{
+public:
+    enum TurnPhase
+    {
+        turn = 0,
+        startNewTurn,
+        doTurn,
+        goals,
+        vision,
+        activeObjects,
+        seatUpkeep,
+        aiTurn,
+        updateVisibleEntities,
+        serverNotifications,
+        nbTurnPhases
+    };
+
+    static const uint32_t NB_TURNS_KEPT;
+
+    TurnProfiler();
+    ~TurnProfiler();
+
+    static const char* getTurnPhaseName(TurnPhase phase);
+
+    //! \brief Returns the time in microseconds since the profiler was created. Used as the
+    //! start time of the zones.
+    int64_t getTimeMicroseconds() const;
+
+    //! \brief Adds the duration of a zone of the given phase to the current turn. startTime is
+    //! the time given by getTimeMicroseconds when the zone began.
+    void addZone(TurnPhase phase, int64_t startTime, int64_t duration);
+
+    //! \brief Stores the time spent in each phase during the current turn and starts a new one.
+    void endTurn();
+
+    //! \brief Forgets the zones measured since the last turn ended. Called when no turn was computed.
+    void discardTurn();
+
+    //! \brief Forgets every measured turn.
+    void reset();
+
+    //! \brief Returns the number of turns the statistics are computed on.
+    uint32_t getNbTurns() const;
+
+    //! \brief Returns the given percentile (from 0 to 100) of the time spent in the given phase
+    //! over the kept turns, in microseconds.
+    int64_t getPercentile(TurnPhase phase, uint32_t percentile) const;
+
+    //! \brief Returns a table with the median, 95th percentile and maximum time of each phase.
+    std::string getReport() const;
+
+    //! \brief Starts writing the zones in the given file as Chrome trace events. Returns false if the
+    //! file cannot be opened.
+    bool startTrace(const std::string& fileName);
+
+    void stopTrace();
+
+    inline bool isTracing() const
+    { return mTraceFile.is_open(); }
+
+private:
+    std::chrono::steady_clock::time_point mStartTime;
+
+    //! \brief Time spent in each phase during the current turn
+    std::vector<int64_t> mCurrentTurn;
+
+    //! \brief mTurns[phase] is a ring buffer of the time spent in the phase during the kept turns
+    std::vector<std::vector<int64_t>> mTurns;
+
+    //! \brief Index in the ring buffers where the next turn will be stored
+    uint32_t mNextTurnIndex;
+
+    uint32_t mNbTurns;
+
+    std::ofstream mTraceFile;
+
+    //! \brief true if no event has been written yet in the trace file
+    bool mIsFirstTraceEvent;
+};
+
+/*! \brief Measures the time spent between its construction and its destruction (or the call
+ * to stop) and adds it to the given phase.
+ */
+class TurnProfilerZone
+{
+public:
+    TurnProfilerZone(TurnProfiler& profiler, TurnProfiler::TurnPhase phase) :
+        mProfiler(profiler),
+        mPhase(phase),
+        mStartTime(profiler.getTimeMicroseconds()),
+        mIsStopped(false)
+    {}
+
+    ~TurnProfilerZone()
+    { stop(); }
+
+    void stop()
+    {
+        if(mIsStopped)
+            return;
+
+        mIsStopped = true;
+        mProfiler.addZone(mPhase, mStartTime, mProfiler.getTimeMicroseconds() - mStartTime);
+    }
+
+private:
+    TurnProfiler& mProfiler;
+    TurnProfiler::TurnPhase mPhase;
+    int64_t mStartTime;
+    bool mIsStopped;
+};
+
+#endif // TURNPROFILER_H